@@ -0,0 +1,99 @@
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include "arena.h"
+
+
+
+Arena::Arena(size_t firstBlockSize) : current(nullptr), remaining(0), nextBlockSize(firstBlockSize),
+                                      firstBlockSize(firstBlockSize), used(0)
+{
+}
+
+
+
+Arena::~Arena()
+{
+    clear();
+}
+
+
+
+// Free every block, the memory handed out becomes invalid
+
+void Arena::clear()
+{
+    for (char *block : blocks)
+        free(block);
+    blocks.clear();
+    current = nullptr;
+    remaining = 0;
+    nextBlockSize = firstBlockSize;
+    used = 0;
+}
+
+
+
+// Start a new block of at least minimumSize bytes, the rest of the last block is left unused
+
+void Arena::addBlock(size_t minimumSize)
+{
+    size_t size = nextBlockSize > minimumSize ? nextBlockSize : minimumSize;
+    char *block = (char *)malloc(size);
+    if (block == nullptr)
+        throw std::bad_alloc();
+
+    blocks.push_back(block);
+    current = block;
+    remaining = size;
+    nextBlockSize = size * 2;
+}
+
+
+
+// Make sure the next block holds at least size bytes, e.g. a whole document
+
+void Arena::reserve(size_t size)
+{
+    if (size > remaining && size > nextBlockSize)
+        nextBlockSize = size;
+}
+
+
+
+/*  Allocate size bytes aligned on alignment (a power of two).
+    Bumps a pointer in the last block, a new block is taken only when the
+    last one is full.
+*/
+
+void *Arena::allocate(size_t size, size_t alignment)
+{
+    size_t padding = (alignment - (uintptr_t)current % alignment) % alignment;
+    if (current == nullptr || padding + size > remaining)
+    {
+        addBlock(size + alignment);
+        padding = (alignment - (uintptr_t)current % alignment) % alignment;
+    }
+
+    char *result = current + padding;
+    current += padding + size;
+    remaining -= padding + size;
+    used += padding + size;
+    return result;
+}
+
+
+
+// Copy text into the arena, terminated by '\0'
+
+char *Arena::copyString(const char *text, size_t length)
+{
+    char *copy = (char *)allocate(length + 1, 1);
+    memcpy(copy, text, length);
+    copy[length] = '\0';
+    return copy;
+}
@@ -0,0 +1,31 @@
+// Bump allocator: hands out memory from large blocks and frees all of it at once.
+// Each new block is twice as large as the previous one, so a document of any
+// size takes a handful of allocations.
+
+class Arena
+{
+public:
+    Arena(size_t firstBlockSize = 64 * 1024);
+    ~Arena();
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void *allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+    char *copyString(const char *text, size_t length);     // Copy followed by '\0'
+    void reserve(size_t size);                              // Make the next block at least size bytes
+    void clear();                                           // Free every block
+
+    size_t bytesUsed() const { return used; }
+    size_t blockCount() const { return blocks.size(); }
+
+private:
+    std::vector <char *> blocks;    // Every block allocated, freed together
+    char    *current;               // Next free byte of the last block
+    size_t  remaining;              // Free bytes left in the last block
+    size_t  nextBlockSize;          // Size of the next block
+    size_t  firstBlockSize;         // Size of the first block after clear()
+    size_t  used;                   // Bytes handed out, padding included
+
+    void addBlock(size_t minimumSize);
+};
@@ -0,0 +1,100 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <functional>
+#include <atomic>
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+#include <cstdint>
+#include <cstddef>
+
+#include "common.h"
+#include "token.h"
+#include "inputBuffer.h"
+#include "lexer.h"
+#include "parser.h"
+#include "batch.h"
+
+
+
+/*  Expand the paths given into the files to validate: a directory stands for
+    the regular files below it (sorted by name), anything else for itself.
+*/
+
+std::vector <std::string> listFiles(const std::vector <std::string> &paths)
+{
+    std::vector <std::string> fileNames;
+    for (const std::string &path : paths)
+    {
+        std::error_code error;
+        if (!std::filesystem::is_directory(path, error))
+        {
+            fileNames.push_back(path);
+            continue;
+        }
+
+        std::vector <std::string> found;
+        for (const auto &entry : std::filesystem::recursive_directory_iterator(path, error))
+        {
+            if (entry.is_regular_file(error))
+                found.push_back(entry.path().string());
+        }
+        std::sort(found.begin(), found.end());
+        fileNames.insert(fileNames.end(), found.begin(), found.end());
+    }
+    return fileNames;
+}
+
+
+
+/*  Run work(i, tokens, context) for every i below count on a pool of threads.
+    Each thread takes the next i not taken yet, so large and small pieces of
+    work balance out, and keeps its tokens and context from one i to the next.
+    The calling thread is one of the workers.
+*/
+
+void runWorkers(size_t count, unsigned threads, const WorkFunction &work)
+{
+    std::atomic <size_t> next(0);
+
+    auto worker = [&]()
+    {
+        std::vector <Token> tokens;
+        ParseContext context;
+        for (size_t i = next++; i < count; i = next++)
+            work(i, tokens, context);
+    };
+
+    threads = std::max(1u, (unsigned) std::min((size_t) threads, count));
+    std::vector <std::thread> threadPool;
+    for (unsigned i = 1; i < threads; i++)
+        threadPool.emplace_back(worker);
+
+    worker();
+    for (std::thread &thread : threadPool)
+        thread.join();
+}
+
+
+
+// Validate the files on a pool of threads, the results are in the order of fileNames
+
+std::vector <BatchResult> validateFiles(const std::vector <std::string> &fileNames, unsigned threads)
+{
+    std::vector <BatchResult> results(fileNames.size());
+
+    runWorkers(fileNames.size(), threads, [&](size_t i, std::vector <Token> &tokens, ParseContext &context)
+    {
+        BatchResult &result = results[i];
+        result.fileName = fileNames[i];
+
+        InputBuffer input;
+        result.opened = input.mapFile(fileNames[i]);
+        result.bytes = input.size();
+        result.valid = result.opened && validateJson(input.data(), input.size(), tokens, context);
+    });
+
+    return results;
+}
\ No newline at end of file
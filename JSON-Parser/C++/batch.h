@@ -0,0 +1,25 @@
+// Validation of many files at once, spread over a pool of worker threads.
+// Each worker parses with its own ParseContext and tokens, the only thing the
+// workers share is the position of the next file to take.
+
+struct BatchResult
+{
+    std::string fileName;
+    bool        opened;         // false if the file could not be read
+    bool        valid;          // VALID JSON
+    size_t      bytes;          // Size of the file
+};
+
+
+// Work run by runWorkers() with the tokens and context of the thread running it
+
+using WorkFunction = std::function<void(size_t index, std::vector <Token> &tokens, ParseContext &context)>;
+
+
+// Function declarations
+
+void runWorkers(size_t count, unsigned threads, const WorkFunction &work);
+
+std::vector <std::string> listFiles(const std::vector <std::string> &paths);
+
+std::vector <BatchResult> validateFiles(const std::vector <std::string> &fileNames, unsigned threads);
\ No newline at end of file
@@ -0,0 +1,172 @@
+/*  CBOR benchmark: sizes of a document as JSON text and as CBOR, then the
+    time of getting it ready to read from each (building the tree from the
+    text, checking the CBOR bytes), of converting the tree to CBOR, and of
+    reading every value once from the tree and from the CBOR bytes.
+    Without files, an array of generated records is used.
+
+    Build (from the JSON-Parser/C++ directory):
+        g++ -O2 -o cbor_benchmark common.cpp inputBuffer.cpp numbers.cpp structural.cpp utf8.cpp lexer.cpp parser.cpp unescape.cpp arena.cpp dom.cpp keyTable.cpp writer.cpp cbor.cpp benchmarks/cborBenchmark.cpp
+
+    Run:
+        ./cbor_benchmark [fileName]...
+*/
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+#include "../common.h"
+#include "../inputBuffer.h"
+#include "../arena.h"
+#include "../dom.h"
+#include "../cbor.h"
+
+const double MB = 1024 * 1024;
+
+
+
+// Run a function repeatedly for at least half a second, returns milliseconds per run
+template <typename Function>
+double measureTime(Function function)
+{
+    auto start = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed;
+    size_t runs = 0;
+    do
+    {
+        function();
+        runs++;
+        elapsed = std::chrono::steady_clock::now() - start;
+    } while (elapsed.count() < 0.5);
+
+    return elapsed.count() * 1000 / runs;
+}
+
+
+
+// Array of count records
+static std::string records(int count)
+{
+    std::string text = "[";
+    for (int i = 0; i < count; i++)
+    {
+        std::string id = std::to_string(i);
+        text += (i > 0 ? "," : "") + std::string("{\"id\":") + id + ",\"name\":\"name " + id + "\",\"active\":"
+              + (i % 3 ? "true" : "false") + ",\"balance\":" + std::to_string(i * 0.25) + ",\"tags\":[\"a\",\"b\"]}";
+    }
+    return text + "]";
+}
+
+
+
+// Number of values of a tree and sum of its numbers, every value read once
+static void walk(const JsonValue &value, size_t &count, double &sum)
+{
+    count++;
+    double number;
+    if (value.type == JSONOBJECT)
+    {
+        for (uint32_t i = 0; i < value.size; i++)
+            walk(value.members[i].value, count, sum);
+    }
+    else if (value.type == JSONARRAY)
+    {
+        for (uint32_t i = 0; i < value.size; i++)
+            walk(value.items[i], count, sum);
+    }
+    else if (value.getDouble(number))
+        sum += number;
+}
+
+
+
+// The same on CBOR bytes
+static void walk(const CborValue &value, size_t &count, double &sum)
+{
+    count++;
+    double number;
+    jsonTypes type = value.type();
+    if (type == JSONOBJECT || type == JSONARRAY)
+    {
+        CborValue child = value.first();
+        for (uint32_t i = 0; i < value.size(); i++)
+        {
+            if (type == JSONOBJECT)
+                child = child.next();   // past the key
+            walk(child, count, sum);
+            child = child.next();
+        }
+    }
+    else if (value.getDouble(number))
+        sum += number;
+}
+
+
+
+static void measure(const std::string &name, const std::string &text)
+{
+    JsonDocument document;
+    if (!document.parse(text.data(), text.size()))
+    {
+        std::cout << std::left << std::setw(24) << name << "INVALID JSON\n";
+        return;
+    }
+
+    std::string cbor;
+    double encodeTime = measureTime([&] {
+        cbor.clear();
+        encodeCbor(document.root(), cbor);
+    });
+
+    double parseTime = measureTime([&] {
+        document.parse(text.data(), text.size());
+    });
+
+    CborDocument binary;
+    double loadTime = measureTime([&] {
+        binary.load(cbor.data(), cbor.size());
+    });
+
+    size_t treeCount = 0, cborCount = 0;
+    double treeSum = 0, cborSum = 0;
+    double treeWalkTime = measureTime([&] {
+        treeCount = 0;
+        walk(document.root(), treeCount, treeSum);
+    });
+    double cborWalkTime = measureTime([&] {
+        cborCount = 0;
+        walk(binary.root(), cborCount, cborSum);
+    });
+
+    std::cout << std::left << std::setw(24) << name << std::setw(10) << text.size() / MB << std::setw(10) << cbor.size() / MB
+              << std::setw(12) << parseTime << std::setw(12) << loadTime << std::setw(12) << encodeTime
+              << std::setw(12) << treeWalkTime << std::setw(12) << cborWalkTime
+              << (treeCount == cborCount ? "" : "  (values differ)") << "\n";
+}
+
+
+
+int main(int argc, char* argv[])
+{
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << std::left << std::setw(24) << "Input" << std::setw(10) << "JSON MB" << std::setw(10) << "CBOR MB"
+              << std::setw(12) << "Parse" << std::setw(12) << "Load CBOR" << std::setw(12) << "Encode"
+              << std::setw(12) << "Walk tree" << std::setw(12) << "Walk CBOR" << "\n";
+
+    measure("records (200000)", records(200000));
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::ifstream file(argv[i], std::ios::binary);
+        std::stringstream contents;
+        contents << file.rdbuf();
+        measure(argv[i], contents.str());
+    }
+    std::cout << "\nTimes in ms\n";
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,98 @@
+/*  DOM benchmark: builds the value tree of JSON files and reports the throughput
+    in MB/s, the arena memory and the number of arena blocks the tree takes.
+
+    Build (from the JSON-Parser/C++ directory):
+        g++ -O2 -o dom_benchmark common.cpp inputBuffer.cpp numbers.cpp structural.cpp utf8.cpp lexer.cpp parser.cpp unescape.cpp arena.cpp dom.cpp keyTable.cpp benchmarks/domBenchmark.cpp
+
+    Run:
+        ./dom_benchmark twitter.json citm_catalog.json canada.json
+*/
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+#include "../common.h"
+#include "../inputBuffer.h"
+#include "../arena.h"
+#include "../dom.h"
+
+const double MB = 1024 * 1024;
+
+
+
+// Run a function repeatedly for at least half a second, returns MB/s
+template <typename Function>
+double measureThroughput(size_t bytes, Function function)
+{
+    auto start = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed;
+    size_t runs = 0;
+    do
+    {
+        function();
+        runs++;
+        elapsed = std::chrono::steady_clock::now() - start;
+    } while (elapsed.count() < 0.5);
+
+    return bytes * runs / elapsed.count() / MB;
+}
+
+
+
+// Number of values in a tree
+static size_t countValues(const JsonValue &value)
+{
+    size_t count = 1;
+    for (uint32_t i = 0; value.type == JSONARRAY && i < value.size; i++)
+        count += countValues(value.items[i]);
+    for (uint32_t i = 0; value.type == JSONOBJECT && i < value.size; i++)
+        count += countValues(value.members[i].value);
+    return count;
+}
+
+
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <fileName>...\n";
+        return 1;
+    }
+
+    std::cout << std::left << std::setw(24) << "File" << std::setw(12) << "Size (MB)" << std::setw(12) << "Values"
+              << std::setw(13) << "Arena (MB)" << std::setw(9) << "Blocks" << "DOM (MB/s)\n";
+
+    for (int i = 1; i < argc; i++)
+    {
+        InputBuffer input;
+        if (!input.mapFile(argv[i]))
+        {
+            std::cerr << "Error in opening file " << argv[i] << "\n";
+            continue;
+        }
+
+        JsonDocument document;
+        bool valid = true;
+        double speed = measureThroughput(input.size(), [&] {
+            valid = document.parse(input);
+        });
+
+        if (!valid)
+        {
+            std::cout << std::left << std::setw(24) << argv[i] << "INVALID JSON\n";
+            continue;
+        }
+
+        std::cout << std::left << std::setw(24) << argv[i] << std::setw(12) << std::fixed << std::setprecision(2)
+                  << input.size() / MB << std::setw(12) << countValues(document.root())
+                  << std::setw(13) << document.memory().bytesUsed() / MB << std::setw(9) << document.memory().blockCount()
+                  << speed << "\n";
+    }
+
+    return 0;
+}
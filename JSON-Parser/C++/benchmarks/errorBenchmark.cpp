@@ -0,0 +1,113 @@
+/*  Error reporting benchmark: throughput of validateJson() on valid documents
+    and on the same documents cut before their last closing bracket, which fail
+    at the very end, then the time of getErrorMessage() for that failure. Errors
+    cost nothing while parsing: both throughputs should be the same, and only
+    the message scans the text again, for its line and column.
+
+    Build (from the JSON-Parser/C++ directory):
+        g++ -O2 -o error_benchmark common.cpp numbers.cpp structural.cpp utf8.cpp lexer.cpp parser.cpp benchmarks/errorBenchmark.cpp
+
+    Run:
+        ./error_benchmark [fileName]...
+*/
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+#include "../common.h"
+#include "../token.h"
+#include "../lexer.h"
+#include "../parser.h"
+
+const double MB = 1024 * 1024;
+
+
+
+// Run a function repeatedly for at least half a second, returns seconds per run
+template <typename Function>
+double measureTime(Function function)
+{
+    auto start = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed;
+    size_t runs = 0;
+    do
+    {
+        function();
+        runs++;
+        elapsed = std::chrono::steady_clock::now() - start;
+    } while (elapsed.count() < 0.5);
+
+    return elapsed.count() / runs;
+}
+
+
+
+// Array of count records on one line each
+static std::string records(int count)
+{
+    std::string text = "[\n";
+    for (int i = 0; i < count; i++)
+    {
+        std::string id = std::to_string(i);
+        text += (i > 0 ? ",\n" : "") + std::string("  {\"id\": ") + id + ", \"name\": \"name " + id
+              + "\", \"active\": " + (i % 3 ? "true" : "false") + ", \"scores\": [" + id + ".5, -" + id + "]}";
+    }
+    return text + "\n]";
+}
+
+
+
+static void measure(const std::string &name, const std::string &text)
+{
+    // Everything after the last closing bracket is dropped with it
+    std::string truncated = text.substr(0, text.find_last_of("]}"));
+
+    std::vector <Token> tokens;
+    ParseContext context;
+    bool valid = false;
+
+    double validTime = measureTime([&] {
+        valid = validateJson(text.data(), text.size(), tokens, context);
+    });
+
+    bool invalid = false;
+    double invalidTime = measureTime([&] {
+        invalid = !validateJson(truncated.data(), truncated.size(), tokens, context);
+    });
+
+    std::string message;
+    double messageTime = invalid ? measureTime([&] {
+        message = getErrorMessage(context);
+    }) : 0;
+
+    std::cout << std::left << std::setw(32) << name << std::setw(10) << text.size() / MB
+              << std::setw(14) << (valid ? text.size() / MB / validTime : 0)
+              << std::setw(16) << (invalid ? truncated.size() / MB / invalidTime : 0)
+              << std::setw(14) << messageTime * 1000 << message << "\n";
+}
+
+
+
+int main(int argc, char* argv[])
+{
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << std::left << std::setw(32) << "Input" << std::setw(10) << "MB" << std::setw(14) << "Valid MB/s"
+              << std::setw(16) << "Invalid MB/s" << std::setw(14) << "Message ms" << "Error\n";
+
+    measure("records (200000)", records(200000));
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::ifstream file(argv[i], std::ios::binary);
+        std::stringstream contents;
+        contents << file.rdbuf();
+        measure(argv[i], contents.str());
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,150 @@
+/*  Key interning benchmark: builds the DOM of record-oriented documents with and
+    without a key table and reports the memory the tree takes (arena plus table),
+    the DOM throughput, the number of distinct keys, and the time of a member
+    lookup by key string (JsonValue::find) and by key id (JsonValue::findKey).
+    The generated input is an array of records with the same fields, as exported
+    from a database; files given on the command line are measured the same way.
+
+    Build (from the JSON-Parser/C++ directory):
+        g++ -O2 -o key_benchmark common.cpp inputBuffer.cpp numbers.cpp structural.cpp utf8.cpp lexer.cpp parser.cpp unescape.cpp arena.cpp dom.cpp keyTable.cpp benchmarks/keyBenchmark.cpp
+
+    Run:
+        ./key_benchmark [fileName]...
+*/
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+#include "../common.h"
+#include "../arena.h"
+#include "../keyTable.h"
+#include "../dom.h"
+
+const double MB = 1024 * 1024;
+
+
+
+// Run a function repeatedly for at least half a second, returns the seconds per run
+template <typename Function>
+double measureTime(Function function)
+{
+    auto start = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed;
+    size_t runs = 0;
+    do
+    {
+        function();
+        runs++;
+        elapsed = std::chrono::steady_clock::now() - start;
+    } while (elapsed.count() < 0.5);
+
+    return elapsed.count() / runs;
+}
+
+
+
+// Array of count records with the same eight fields
+static std::string records(int count)
+{
+    std::string text = "[";
+    for (int i = 0; i < count; i++)
+    {
+        if (i > 0)
+            text += ",";
+        std::string id = std::to_string(i);
+        text += "{\"id\":" + id + ",\"customer_name\":\"name " + id + "\",\"email_address\":\"user" + id
+              + "@example.com\",\"created_at\":\"2024-01-01T00:00:00Z\",\"is_active\":" + (i % 3 ? "true" : "false")
+              + ",\"account_balance\":" + std::to_string(i * 0.25) + ",\"country_code\":\"FR\",\"last_login_ip\":null}";
+    }
+    return text + "]";
+}
+
+
+
+// Non-empty objects of a tree, where the lookups are made
+static void collectObjects(const JsonValue &value, std::vector <const JsonValue*> &objects)
+{
+    if (value.type == JSONOBJECT && value.size > 0)
+        objects.push_back(&value);
+    for (uint32_t i = 0; value.type == JSONARRAY && i < value.size; i++)
+        collectObjects(value.items[i], objects);
+    for (uint32_t i = 0; value.type == JSONOBJECT && i < value.size; i++)
+        collectObjects(value.members[i].value, objects);
+}
+
+
+
+static void measure(const std::string &name, const std::string &text)
+{
+    JsonDocument plain;
+    double plainTime = measureTime([&] { plain.parse(text.data(), text.size()); });
+    if (!plain.parse(text.data(), text.size()))
+    {
+        std::cout << std::left << std::setw(28) << name << "INVALID JSON\n";
+        return;
+    }
+
+    JsonDocument interned;
+    interned.internKeys();
+    double internedTime = measureTime([&] { interned.parse(text.data(), text.size()); });
+    const KeyTable &keys = *interned.keyTable();
+
+    // Look up the last key of each object, which compares the most members
+    std::vector <const JsonValue*> objects;
+    collectObjects(interned.root(), objects);
+    std::vector <std::string> names;
+    std::vector <uint32_t> ids;
+    for (const JsonValue *object : objects)
+    {
+        const JsonMember &last = object->members[object->size - 1];
+        names.push_back(std::string(last.key, last.keyLength));
+        ids.push_back(last.keyId);
+    }
+
+    size_t foundByString = 0, foundById = 0;
+    double stringTime = measureTime([&] {
+        foundByString = 0;
+        for (size_t i = 0; i < objects.size(); i++)
+            foundByString += objects[i]->find(names[i]) != nullptr;
+    });
+    double idTime = measureTime([&] {
+        foundById = 0;
+        for (size_t i = 0; i < objects.size(); i++)
+            foundById += objects[i]->findKey(ids[i]) != nullptr;
+    });
+
+    double lookups = objects.size() > 0 ? objects.size() : 1;
+    std::cout << std::left << std::setw(28) << name << std::fixed << std::setprecision(2)
+              << std::setw(10) << text.size() / MB << std::setw(8) << keys.size()
+              << std::setw(12) << plain.memory().bytesUsed() / MB
+              << std::setw(12) << (interned.memory().bytesUsed() + keys.memoryUsed()) / MB
+              << std::setw(12) << text.size() / plainTime / MB << std::setw(12) << text.size() / internedTime / MB
+              << std::setprecision(1) << std::setw(12) << stringTime / lookups * 1e9 << idTime / lookups * 1e9
+              << (foundByString == objects.size() && foundById == objects.size() ? "" : "  NOT FOUND") << "\n";
+}
+
+
+
+int main(int argc, char* argv[])
+{
+    std::cout << std::left << std::setw(28) << "Input" << std::setw(10) << "MB" << std::setw(8) << "Keys"
+              << std::setw(12) << "Plain (MB)" << std::setw(12) << "Keys (MB)" << std::setw(12) << "Plain MB/s"
+              << std::setw(12) << "Keys MB/s" << std::setw(12) << "find (ns)" << "findKey (ns)\n";
+
+    measure("records (200000 x 8 keys)", records(200000));
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::ifstream file(argv[i], std::ios::binary);
+        std::stringstream contents;
+        contents << file.rdbuf();
+        measure(argv[i], contents.str());
+    }
+    return 0;
+}
@@ -0,0 +1,167 @@
+/*  On-demand benchmark: extracts a few fields from a large file with the lazy
+    document, with the lazy document and full validation, and with the DOM, and
+    reports the time per extraction. Fields are paths of keys and indexes
+    separated by '/', e.g. statuses/0/user/name.
+
+    Build (from the JSON-Parser/C++ directory):
+        g++ -O2 -o lazy_benchmark common.cpp inputBuffer.cpp numbers.cpp structural.cpp utf8.cpp lexer.cpp parser.cpp unescape.cpp arena.cpp dom.cpp keyTable.cpp lazyDocument.cpp benchmarks/lazyBenchmark.cpp
+
+    Run:
+        ./lazy_benchmark twitter.json statuses/0/id search_metadata/count
+*/
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+
+#include "../common.h"
+#include "../inputBuffer.h"
+#include "../arena.h"
+#include "../dom.h"
+#include "../lazyDocument.h"
+
+
+
+// Run a function repeatedly for at least half a second, returns milliseconds per run
+template <typename Function>
+double measureTime(Function function)
+{
+    auto start = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed;
+    size_t runs = 0;
+    do
+    {
+        function();
+        runs++;
+        elapsed = std::chrono::steady_clock::now() - start;
+    } while (elapsed.count() < 0.5);
+
+    return elapsed.count() * 1000 / runs;
+}
+
+
+
+// Split a path on '/'
+static std::vector <std::string> splitPath(const std::string &path)
+{
+    std::vector <std::string> parts;
+    size_t start = 0, slash;
+    while ((slash = path.find('/', start)) != std::string::npos)
+    {
+        parts.push_back(path.substr(start, slash - start));
+        start = slash + 1;
+    }
+    parts.push_back(path.substr(start));
+    return parts;
+}
+
+
+
+// Follow a path, a numeric part is an index when the value is an array
+template <typename Value>
+static Value follow(Value value, const std::vector <std::string> &path)
+{
+    for (const std::string &part : path)
+    {
+        if (value.type() == JSONARRAY)
+            value = value.at(std::strtoul(part.c_str(), nullptr, 10));
+        else
+            value = value.find(part);
+    }
+    return value;
+}
+
+
+
+// The JsonValue counterpart of JsonLazyValue, for follow()
+struct DomValue
+{
+    const JsonValue *value;
+
+    jsonTypes type() const { return value != nullptr ? value->type : JSONNULL; }
+    DomValue at(size_t index) const { return DomValue{value != nullptr ? value->at(index) : nullptr}; }
+    DomValue find(const std::string &key) const { return DomValue{value != nullptr ? value->find(key) : nullptr}; }
+};
+
+
+
+// Text of a scalar lazy value
+static std::string describe(const JsonLazyValue &value)
+{
+    std::string text;
+    int64_t integer;
+    double real;
+    bool boolean;
+    if (value.getString(text))
+        return "\"" + text + "\"";
+    if (value.getInt64(integer))
+        return std::to_string(integer);
+    if (value.getDouble(real))
+        return std::to_string(real);
+    if (value.getBoolean(boolean))
+        return boolean ? "true" : "false";
+    if (value.isNull())
+        return "null";
+    return value.isValid() ? "(object or array)" : "(not found)";
+}
+
+
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " <fileName> <path>...\n";
+        return 1;
+    }
+
+    InputBuffer input;
+    if (!input.mapFile(argv[1]))
+    {
+        std::cerr << "Error in opening file " << argv[1] << "\n";
+        return 1;
+    }
+
+    std::vector <std::vector <std::string>> paths;
+    for (int i = 2; i < argc; i++)
+        paths.push_back(splitPath(argv[i]));
+
+    JsonLazyDocument lazy;
+    if (!lazy.load(input.data(), input.size(), true))
+    {
+        std::cout << "INVALID JSON\n";
+        return 1;
+    }
+    for (size_t i = 0; i < paths.size(); i++)
+        std::cout << argv[i + 2] << " = " << describe(follow(lazy.root(), paths[i])) << "\n";
+
+    size_t found = 0;
+    double lazyTime = measureTime([&] {
+        lazy.load(input.data(), input.size());
+        for (auto &path : paths)
+            found += follow(lazy.root(), path).isValid();
+    });
+
+    double validatedTime = measureTime([&] {
+        lazy.load(input.data(), input.size(), true);
+        for (auto &path : paths)
+            found += follow(lazy.root(), path).isValid();
+    });
+
+    JsonDocument document;
+    double domTime = measureTime([&] {
+        document.parse(input);
+        for (auto &path : paths)
+            found += follow(DomValue{&document.root()}, path).value != nullptr;
+    });
+
+    std::cout << std::fixed << std::setprecision(2) << "\n";
+    std::cout << "Lazy                  : " << lazyTime << " ms\n";
+    std::cout << "Lazy, full validation : " << validatedTime << " ms\n";
+    std::cout << "DOM                   : " << domTime << " ms (" << domTime / lazyTime << "x the lazy time)\n";
+    return found > 0 ? 0 : 1;
+}
@@ -0,0 +1,91 @@
+/*  Lexer benchmark: tokenizes JSON files and reports the throughput in MB/s, next to
+    the speed of a plain read over the same mapped bytes (the memory bandwidth bound),
+    and the memory taken by the tokens (12 bytes each, no characters are copied).
+
+    Standard corpora: twitter.json, citm_catalog.json and canada.json, e.g. from the
+    jsonexamples directory of the simdjson repository.
+
+    Build (from the JSON-Parser/C++ directory):
+        g++ -O2 -o lexer_benchmark common.cpp inputBuffer.cpp numbers.cpp structural.cpp utf8.cpp lexer.cpp benchmarks/lexerBenchmark.cpp
+
+    Run:
+        ./lexer_benchmark twitter.json citm_catalog.json canada.json
+*/
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <chrono>
+
+#include "../common.h"
+#include "../token.h"
+#include "../inputBuffer.h"
+#include "../lexer.h"
+
+const double MB = 1024 * 1024;
+
+
+
+// Run a function repeatedly for at least half a second, returns MB/s
+template <typename Function>
+double measureThroughput(size_t bytes, Function function)
+{
+    auto start = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed;
+    size_t runs = 0;
+    do
+    {
+        function();
+        runs++;
+        elapsed = std::chrono::steady_clock::now() - start;
+    } while (elapsed.count() < 0.5);
+
+    return bytes * runs / elapsed.count() / MB;
+}
+
+
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <fileName>...\n";
+        return 1;
+    }
+
+    std::cout << std::left << std::setw(24) << "File" << std::setw(12) << "Size (MB)"
+              << std::setw(12) << "Tokens" << std::setw(14) << "Tokens (MB)" << std::setw(16) << "Lexer (MB/s)" << "Read (MB/s)\n";
+
+    for (int i = 1; i < argc; i++)
+    {
+        InputBuffer input;
+        if (!input.mapFile(argv[i]))
+        {
+            std::cerr << "Error in opening file " << argv[i] << "\n";
+            continue;
+        }
+
+        std::vector <Token> tokens;
+        double lexerSpeed = measureThroughput(input.size(), [&] {
+            tokens.clear();
+            lexer(input, tokens);
+        });
+
+        // Touch every byte, the upper bound for any single-pass scanner
+        volatile unsigned long sink = 0;
+        double readSpeed = measureThroughput(input.size(), [&] {
+            unsigned long sum = 0;
+            for (size_t j = 0; j < input.size(); j++)
+                sum += (unsigned char)input.data()[j];
+            sink = sink + sum;
+        });
+
+        std::cout << std::left << std::setw(24) << argv[i] << std::setw(12) << std::fixed << std::setprecision(2)
+                  << input.size() / MB << std::setw(12) << tokens.size() << std::setw(14) << tokens.capacity() * sizeof(Token) / MB
+                  << std::setw(16) << lexerSpeed << readSpeed << "\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,130 @@
+/*  Number benchmark: validation and conversion of the number tokens of JSON files.
+    Compares the previous std::regex validation with scanNumber(), and strtod() with
+    parseDouble(), and checks that parseDouble() returns the same doubles as strtod().
+    Without files, a million random numbers in the style of canada.json are used.
+
+    Build (from the JSON-Parser/C++ directory):
+        g++ -O2 -o number_benchmark common.cpp inputBuffer.cpp numbers.cpp structural.cpp utf8.cpp lexer.cpp benchmarks/numberBenchmark.cpp
+
+    Run:
+        ./number_benchmark [canada.json ...]
+*/
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <random>
+#include <regex>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include "../common.h"
+#include "../token.h"
+#include "../inputBuffer.h"
+#include "../numbers.h"
+#include "../lexer.h"
+
+
+
+// Number validation as it was done before scanNumber()
+bool regexIsNumber(std::string input)
+{
+    std::regex numberPattern("^[-+]?(0|([1-9]\\d*\\.?\\d*)|0?\\.\\d+)([eE][-+]?\\d+)?$");
+    return std::regex_match(input, numberPattern);
+}
+
+
+
+// Time a function over all numbers, returns nanoseconds per number
+template <typename Function>
+double measure(const std::vector <std::string> &numbers, Function function)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (const std::string &number : numbers)
+        function(number);
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / numbers.size();
+}
+
+
+
+int main(int argc, char* argv[])
+{
+    std::vector <std::string> numbers;
+    for (int i = 1; i < argc; i++)
+    {
+        InputBuffer input;
+        if (!input.mapFile(argv[i]))
+        {
+            std::cerr << "Error in opening file " << argv[i] << "\n";
+            return 1;
+        }
+
+        std::vector <Token> tokens;
+        lexer(input, tokens);
+        for (Token &token : tokens)
+        {
+            if (token.type == NUMBER)
+                numbers.push_back(getTokenValue(input.data(), token));
+        }
+    }
+
+    if (numbers.empty())
+    {
+        // Coordinates with 14-16 significant digits, like canada.json
+        std::mt19937_64 random(42);
+        std::uniform_real_distribution<double> coordinate(-180, 180);
+        char buffer[32];
+        for (int i = 0; i < 1000000; i++)
+        {
+            snprintf(buffer, sizeof(buffer), "%.15g", coordinate(random));
+            numbers.push_back(buffer);
+        }
+    }
+
+    size_t bytes = 0;
+    for (const std::string &number : numbers)
+        bytes += number.length();
+
+    // The regex is slow, time it on a sample
+    std::vector <std::string> sample(numbers.begin(), numbers.begin() + std::min<size_t>(numbers.size(), 20000));
+
+    volatile double sink = 0;
+    double regexTime = measure(sample, [&](const std::string &number) { sink = sink + regexIsNumber(number); });
+    double scanTime = measure(numbers, [&](const std::string &number) {
+        sink = sink + (scanNumber(number.data(), number.data() + number.length()) != nullptr);
+    });
+    double strtodTime = measure(numbers, [&](const std::string &number) { sink = sink + strtod(number.c_str(), nullptr); });
+    double parseTime = measure(numbers, [&](const std::string &number) {
+        double value;
+        parseDouble(number, value);
+        sink = sink + value;
+    });
+
+    size_t mismatches = 0;
+    for (const std::string &number : numbers)
+    {
+        double value, expected = strtod(number.c_str(), nullptr);
+        if (!parseDouble(number, value) || memcmp(&value, &expected, sizeof(double)) != 0)
+            mismatches++;
+    }
+
+    double bytesPerNumber = (double)bytes / numbers.size();
+    auto report = [&](const char *name, double nanoseconds) {
+        std::cout << std::left << std::setw(16) << name << std::fixed << std::setprecision(1) << std::setw(12) << nanoseconds
+                  << bytesPerNumber / nanoseconds * 1e9 / (1024 * 1024) << "\n";
+    };
+
+    std::cout << numbers.size() << " numbers, " << std::setprecision(1) << std::fixed << bytesPerNumber << " bytes each\n";
+    std::cout << std::left << std::setw(16) << "" << std::setw(12) << "ns/number" << "MB/s\n";
+    report("std::regex", regexTime);
+    report("scanNumber", scanTime);
+    report("strtod", strtodTime);
+    report("parseDouble", parseTime);
+    std::cout << "parseDouble differs from strtod for " << mismatches << " numbers\n";
+
+    return mismatches == 0 ? 0 : 1;
+}
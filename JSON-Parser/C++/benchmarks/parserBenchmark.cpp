@@ -0,0 +1,116 @@
+/*  Parser benchmark: throughput of parser() in millions of tokens per second on
+    generated documents (nested arrays, nested objects, a long flat array) and on
+    files given on the command line. Tokens are produced once, outside the timing.
+
+    Build (from the JSON-Parser/C++ directory):
+        g++ -O2 -o parser_benchmark common.cpp numbers.cpp structural.cpp utf8.cpp lexer.cpp parser.cpp benchmarks/parserBenchmark.cpp
+
+    Run:
+        ./parser_benchmark [fileName]...
+*/
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+#include "../common.h"
+#include "../token.h"
+#include "../lexer.h"
+#include "../parser.h"
+
+
+
+// Documents of nesting depth 1000 in one array: [[[...[1]...]], [[...[1]...]], ...]
+static std::string nestedArrays(int documents, int depth)
+{
+    std::string text = "[";
+    for (int i = 0; i < documents; i++)
+    {
+        if (i > 0)
+            text += ",";
+        text += std::string(depth, '[') + "1" + std::string(depth, ']');
+    }
+    return text + "]";
+}
+
+
+
+// The same with objects: {"a":{"a":...{"a":1}...}}
+static std::string nestedObjects(int documents, int depth)
+{
+    std::string text = "[";
+    for (int i = 0; i < documents; i++)
+    {
+        if (i > 0)
+            text += ",";
+        for (int j = 0; j < depth; j++)
+            text += "{\"a\":";
+        text += "1" + std::string(depth, '}');
+    }
+    return text + "]";
+}
+
+
+
+// One array of count numbers
+static std::string flatArray(int count)
+{
+    std::string text = "[";
+    for (int i = 0; i < count; i++)
+        text += (i > 0 ? "," : "") + std::to_string(i);
+    return text + "]";
+}
+
+
+
+// Parse the tokens for at least half a second, returns millions of tokens per second
+static double measure(const std::string &name, const std::string &text)
+{
+    std::vector <Token> tokens;
+    lexer(text.data(), text.size(), tokens);
+    ParseContext context;
+    context.inputData = text.data();
+    context.tokenSize = tokens.size();
+
+    bool valid = true;
+    size_t runs = 0;
+    auto start = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed;
+    do
+    {
+        context.parseIndex = 0;
+        valid = parser(tokens, context);
+        runs++;
+        elapsed = std::chrono::steady_clock::now() - start;
+    } while (elapsed.count() < 0.5);
+
+    double speed = tokens.size() * runs / elapsed.count() / 1e6;
+    std::cout << std::left << std::setw(32) << name << std::setw(12) << tokens.size() << std::fixed
+              << std::setprecision(1) << speed << (valid ? "" : "  INVALID JSON") << "\n";
+    return speed;
+}
+
+
+
+int main(int argc, char* argv[])
+{
+    std::cout << std::left << std::setw(32) << "Input" << std::setw(12) << "Tokens" << "Mtokens/s\n";
+
+    measure("nested arrays (depth 1000)", nestedArrays(500, 1000));
+    measure("nested objects (depth 1000)", nestedObjects(200, 1000));
+    measure("flat array (100000 numbers)", flatArray(100000));
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::ifstream file(argv[i], std::ios::binary);
+        std::stringstream contents;
+        contents << file.rdbuf();
+        measure(argv[i], contents.str());
+    }
+    return 0;
+}
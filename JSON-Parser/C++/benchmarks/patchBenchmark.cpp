@@ -0,0 +1,171 @@
+/*  Patch benchmark: small edits to a large document. The time of applying a
+    JSON Patch and a JSON Merge Patch in place is compared with the time of
+    editing by rebuilding: parsing the text again and serializing the result.
+    The time of creating the patch from two versions of the document is also
+    measured. The patches are applied alternately with their inverse, so the
+    document stays the same size. Files given on the command line (whose root
+    must be an object) get a member added and removed.
+
+    Each input is also checked: after an even number of applications the
+    document must equal the original (member order aside), and the created patch must turn the
+    first version into the second. A failed check is reported and makes the
+    benchmark exit with 1.
+
+    Build (from the JSON-Parser/C++ directory):
+        g++ -O2 -o patch_benchmark common.cpp inputBuffer.cpp numbers.cpp structural.cpp utf8.cpp lexer.cpp parser.cpp unescape.cpp arena.cpp dom.cpp keyTable.cpp writer.cpp patch.cpp benchmarks/patchBenchmark.cpp
+
+    Run:
+        ./patch_benchmark [fileName]...
+*/
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+#include "../common.h"
+#include "../arena.h"
+#include "../dom.h"
+#include "../writer.h"
+#include "../patch.h"
+
+const double MB = 1024 * 1024;
+
+
+
+// Run a function repeatedly for at least half a second, returns milliseconds per run
+template <typename Function>
+double measureTime(Function function)
+{
+    auto start = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed;
+    size_t runs = 0;
+    do
+    {
+        function();
+        runs++;
+        elapsed = std::chrono::steady_clock::now() - start;
+    } while (elapsed.count() < 0.5);
+
+    return elapsed.count() * 1000 / runs;
+}
+
+
+
+// Configuration of count services and as many settings; version 1 has a few values changed, added and removed
+static std::string configuration(int count, int version)
+{
+    std::string text = "{\"settings\":{";
+    for (int i = 0; i < count; i++)
+    {
+        if (version == 1 && i == 7)
+            continue;
+        text += (i > 0 ? ",\"key" : "\"key") + std::to_string(i) + "\":\"" + (version == 1 && i == 5 ? "changed" : "value "
+              + std::to_string(i)) + "\"";
+    }
+    text += std::string(version == 1 ? ",\"added\":true" : "") + "},\"services\":[";
+    for (int i = 0; i < count; i++)
+    {
+        std::string id = std::to_string(i);
+        text += (i > 0 ? "," : "") + std::string("{\"name\":\"service ") + id + "\",\"port\":"
+              + std::to_string(version == 1 && i % 10000 == 3 ? 9000 : 8000 + i % 1000) + ",\"replicas\":" + std::to_string(1 + i % 5)
+              + ",\"env\":{\"LEVEL\":\"info\",\"REGION\":\"eu-" + std::to_string(i % 3) + "\"},\"tags\":[\"a\",\"b\"]"
+              + (version == 1 && i == count / 2 ? ",\"paused\":true" : "") + "}";
+    }
+    return text + "]}";
+}
+
+
+
+// Returns false if a patch failed or did not leave the document as it found it
+static bool measure(const std::string &name, const std::string &text, const std::string &patchText, const std::string &inverseText,
+                    const std::string &mergeText, const std::string &inverseMergeText)
+{
+    JsonDocument original, document, patch, inverse, merge, inverseMerge;
+    if (!original.parse(text.data(), text.size()) || !document.parse(text.data(), text.size()) || !patch.parse(patchText.data(), patchText.size()) ||
+        !inverse.parse(inverseText.data(), inverseText.size()) || !merge.parse(mergeText.data(), mergeText.size()) ||
+        !inverseMerge.parse(inverseMergeText.data(), inverseMergeText.size()))
+    {
+        std::cout << std::left << std::setw(24) << name << "INVALID JSON\n";
+        return false;
+    }
+
+    // Editing without patches: the whole text parsed again and written back
+    std::string output;
+    double rebuildTime = measureTime([&] {
+        document.parse(text.data(), text.size());
+        output = serialize(document.root());
+    });
+
+    bool applied = true, forward = true;
+    double patchTime = measureTime([&] {
+        applied = applyPatch(document, (forward ? patch : inverse).root()) && applied;
+        forward = !forward;
+    });
+    if (!forward)
+        applied = applyPatch(document, inverse.root()) && applied;
+    bool restored = equalValues(document.root(), original.root());
+
+    forward = true;
+    double mergeTime = measureTime([&] {
+        applyMergePatch(document, (forward ? merge : inverseMerge).root());
+        forward = !forward;
+    });
+    if (!forward)
+        applyMergePatch(document, inverseMerge.root());
+    bool mergeRestored = equalValues(document.root(), original.root());
+
+    std::cout << std::left << std::setw(24) << name << std::setw(10) << text.size() / MB << std::setw(14) << rebuildTime
+              << std::setw(14) << patchTime * 1000 << std::setw(14) << mergeTime * 1000
+              << (!applied ? "  (patch failed)" : !restored ? "  (patch changed the document)" :
+                  !mergeRestored ? "  (merge patch changed the document)" : "") << "\n";
+    return applied && restored && mergeRestored;
+}
+
+
+
+int main(int argc, char* argv[])
+{
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << std::left << std::setw(24) << "Input" << std::setw(10) << "MB" << std::setw(14) << "Rebuild ms"
+              << std::setw(14) << "Patch us" << std::setw(14) << "Merge us" << "\n";
+
+    std::string before = configuration(100000, 0), after = configuration(100000, 1);
+    JsonDocument first, second;
+    first.parse(before.data(), before.size());
+    second.parse(after.data(), after.size());
+
+    std::string patch, inverse;
+    double diffTime = measureTime([&] {
+        patch = createPatch(first.root(), second.root());
+    });
+    inverse = createPatch(second.root(), first.root());
+
+    // The created patch must turn the first version into the second
+    JsonDocument patchDocument;
+    bool passed = patchDocument.parse(patch.data(), patch.size()) && applyPatch(first, patchDocument.root()) &&
+                  equalValues(first.root(), second.root());
+    if (!passed)
+        std::cout << "configuration (100000)  created patch does not produce the second version\n";
+
+    passed = measure("configuration (100000)", before, patch, inverse,
+                     R"({"settings":{"key5":"changed","key7":null,"added":true}})",
+                     R"({"settings":{"key5":"value 5","key7":"value 7","added":null}})") && passed;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::ifstream file(argv[i], std::ios::binary);
+        std::stringstream contents;
+        contents << file.rdbuf();
+        passed = measure(argv[i], contents.str(), R"([{"op":"add","path":"/patched","value":{"a":[1,2,3]}}])",
+                         R"([{"op":"remove","path":"/patched"}])", R"({"patched":{"a":[1,2,3]}})", R"({"patched":null})") && passed;
+    }
+
+    std::cout << "\nPatch between the two versions of the configuration (" << diffTime << " ms to create):\n" << patch << "\n";
+    return passed ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,115 @@
+/*  Query benchmark: runs a JSONPath expression or JSON Pointer on a file by
+    building the tree and evaluating it, by evaluating an already built tree,
+    and on the events of the streaming parser, and reports the time of each.
+    The streamed query keeps only the matched values, against the whole arena
+    of the tree.
+
+    Build (from the JSON-Parser/C++ directory):
+        g++ -O2 -o query_benchmark common.cpp inputBuffer.cpp numbers.cpp structural.cpp utf8.cpp lexer.cpp parser.cpp unescape.cpp streamParser.cpp arena.cpp dom.cpp keyTable.cpp writer.cpp query.cpp benchmarks/queryBenchmark.cpp
+
+    Run:
+        ./query_benchmark twitter.json '$.statuses[*].user.screen_name' '$..hashtags[?(@.text == "jp")]' /search_metadata/count
+*/
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <deque>
+#include <chrono>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+
+#include "../common.h"
+#include "../inputBuffer.h"
+#include "../arena.h"
+#include "../dom.h"
+#include "../streamParser.h"
+#include "../query.h"
+
+const double MB = 1024 * 1024;
+
+
+
+// Run a function repeatedly for at least half a second, returns milliseconds per run
+template <typename Function>
+double measureTime(Function function)
+{
+    auto start = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed;
+    size_t runs = 0;
+    do
+    {
+        function();
+        runs++;
+        elapsed = std::chrono::steady_clock::now() - start;
+    } while (elapsed.count() < 0.5);
+
+    return elapsed.count() * 1000 / runs;
+}
+
+
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " <fileName> <expression>...\n";
+        return 1;
+    }
+
+    InputBuffer input;
+    if (!input.mapFile(argv[1]))
+    {
+        std::cerr << "Error in opening file " << argv[1] << "\n";
+        return 1;
+    }
+
+    JsonDocument document;
+    if (!document.parse(input))
+    {
+        std::cout << "INVALID JSON\n";
+        return 1;
+    }
+    std::cout << std::fixed << std::setprecision(2) << argv[1] << ": " << input.size() / MB << " MB, tree "
+              << document.memory().bytesUsed() / MB << " MB\n\n";
+
+    std::cout << std::left << std::setw(48) << "Query" << std::setw(10) << "Matches" << std::setw(14) << "Parse+eval"
+              << std::setw(12) << "Eval" << std::setw(12) << "Stream" << "Kept (MB)\n";
+
+    for (int i = 2; i < argc; i++)
+    {
+        JsonQuery query;
+        bool compiled = argv[i][0] == '$' ? query.compilePath(argv[i]) : query.compilePointer(argv[i]);
+        if (!compiled)
+        {
+            std::cout << std::left << std::setw(48) << argv[i] << "INVALID QUERY\n";
+            continue;
+        }
+
+        size_t matches = 0;
+        JsonDocument tree;
+        double parseTime = measureTime([&] {
+            tree.parse(input);
+            matches = query.evaluate(tree.root()).size();
+        });
+
+        double evaluateTime = measureTime([&] {
+            matches = query.evaluate(document.root()).size();
+        });
+
+        size_t kept = 0;
+        double streamTime = measureTime([&] {
+            kept = 0;
+            JsonQueryHandler handler(query, [&](const std::string &json) { kept += json.size(); });
+            JsonSaxParser parser(handler);
+            parser.feed(input.data(), input.size());
+            parser.finish();
+        });
+
+        std::cout << std::left << std::setw(48) << argv[i] << std::setw(10) << matches << std::setw(14) << parseTime
+                  << std::setw(12) << evaluateTime << std::setw(12) << streamTime << kept / MB << "\n";
+    }
+    std::cout << "\nTimes in ms\n";
+    return 0;
+}
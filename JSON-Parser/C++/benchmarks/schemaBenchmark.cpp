@@ -0,0 +1,154 @@
+/*  Schema benchmark: validates a document against a JSON Schema in the same
+    pass as the streaming parse, and the parse-then-validate way (building the
+    tree, then walking it), and reports the throughput of each in MB/s next to
+    the streaming parse alone. Without files, an array of generated records and
+    a schema for them are used.
+
+    Build (from the JSON-Parser/C++ directory):
+        g++ -O2 -o schema_benchmark common.cpp inputBuffer.cpp numbers.cpp structural.cpp utf8.cpp lexer.cpp parser.cpp unescape.cpp streamParser.cpp arena.cpp dom.cpp keyTable.cpp writer.cpp schema.cpp benchmarks/schemaBenchmark.cpp
+
+    Run:
+        ./schema_benchmark [schemaFileName fileName]
+*/
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <regex>
+#include <utility>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+#include "../common.h"
+#include "../arena.h"
+#include "../dom.h"
+#include "../streamParser.h"
+#include "../schema.h"
+
+const double MB = 1024 * 1024;
+
+// Schema of the generated records
+const char *RECORD_SCHEMA = R"({
+    "type": "array",
+    "items": {
+        "type": "object",
+        "required": ["id", "name", "email", "active", "balance", "tags"],
+        "additionalProperties": false,
+        "properties": {
+            "id": {"type": "integer", "minimum": 0},
+            "name": {"type": "string", "minLength": 1, "maxLength": 64},
+            "email": {"type": "string", "pattern": "@"},
+            "active": {"type": "boolean"},
+            "balance": {"type": "number", "minimum": 0},
+            "country": {"enum": ["FR", "DE", "US"]},
+            "tags": {"type": "array", "maxItems": 8, "items": {"type": "string"}}
+        }
+    }
+})";
+
+
+
+// Run a function repeatedly for at least half a second, returns MB/s
+template <typename Function>
+double measureThroughput(size_t bytes, Function function)
+{
+    auto start = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed;
+    size_t runs = 0;
+    do
+    {
+        function();
+        runs++;
+        elapsed = std::chrono::steady_clock::now() - start;
+    } while (elapsed.count() < 0.5);
+
+    return bytes * runs / elapsed.count() / MB;
+}
+
+
+
+// Array of count records conforming to RECORD_SCHEMA
+static std::string records(int count)
+{
+    static const char *COUNTRIES[] = {"FR", "DE", "US"};
+    std::string text = "[";
+    for (int i = 0; i < count; i++)
+    {
+        std::string id = std::to_string(i);
+        text += (i > 0 ? "," : "") + std::string("{\"id\":") + id + ",\"name\":\"name " + id + "\",\"email\":\"user" + id
+              + "@example.com\",\"active\":" + (i % 3 ? "true" : "false") + ",\"balance\":" + std::to_string(i * 0.25)
+              + ",\"country\":\"" + COUNTRIES[i % 3] + "\",\"tags\":[\"a\",\"b\"]}";
+    }
+    return text + "]";
+}
+
+
+
+static std::string readFile(const char *fileName)
+{
+    std::ifstream file(fileName, std::ios::binary);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+}
+
+
+
+int main(int argc, char* argv[])
+{
+    if (argc != 1 && argc != 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " [schemaFileName fileName]\n";
+        return 1;
+    }
+
+    std::string schemaText = argc == 3 ? readFile(argv[1]) : RECORD_SCHEMA;
+    std::string text = argc == 3 ? readFile(argv[2]) : records(200000);
+
+    JsonSchema schema;
+    if (!schema.load(schemaText.data(), schemaText.size()))
+    {
+        std::cerr << "Invalid schema\n";
+        return 1;
+    }
+
+    bool valid = false;
+    SchemaError error;
+
+    double parseSpeed = measureThroughput(text.size(), [&] {
+        JsonHandler handler;
+        JsonSaxParser parser(handler);
+        parser.feed(text.data(), text.size());
+        valid = parser.finish();
+    });
+
+    double onePassSpeed = measureThroughput(text.size(), [&] {
+        SchemaValidator validator(schema);
+        JsonSaxParser parser(validator);
+        parser.feed(text.data(), text.size());
+        valid = parser.finish();
+        if (validator.hasError())
+            error = validator.getError();
+    });
+
+    JsonDocument document;
+    double twoPassSpeed = measureThroughput(text.size(), [&] {
+        valid = document.parse(text.data(), text.size()) && schema.validate(document.root(), error);
+    });
+
+    double validateSpeed = measureThroughput(text.size(), [&] {
+        valid = schema.validate(document.root(), error);
+    });
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Size                       : " << text.size() / MB << " MB\n";
+    std::cout << "Result                     : " << (valid ? "VALID" : "INVALID at \"" + error.path + "\" : " + error.message) << "\n";
+    std::cout << "Streaming parse            : " << parseSpeed << " MB/s\n";
+    std::cout << "Streaming parse + schema   : " << onePassSpeed << " MB/s\n";
+    std::cout << "Tree, then schema          : " << twoPassSpeed << " MB/s\n";
+    std::cout << "Schema on a built tree     : " << validateSpeed << " MB/s\n";
+    return 0;
+}
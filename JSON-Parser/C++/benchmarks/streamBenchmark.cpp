@@ -0,0 +1,92 @@
+/*  Streaming parser benchmark: validates JSON files read in 64 KB chunks with
+    parseStream() and reports the throughput in MB/s and the peak resident memory,
+    which stays flat however large the file is.
+
+    Build (from the JSON-Parser/C++ directory):
+        g++ -O2 -o stream_benchmark common.cpp numbers.cpp structural.cpp utf8.cpp lexer.cpp unescape.cpp streamParser.cpp benchmarks/streamBenchmark.cpp
+
+    Run:
+        ./stream_benchmark twitter.json citm_catalog.json canada.json
+*/
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+
+#include "../common.h"
+#include "../streamParser.h"
+
+const double MB = 1024 * 1024;
+
+// Counts the events, so every one of them is produced
+class CountingHandler : public JsonHandler
+{
+public:
+    size_t events = 0;
+
+    bool startObject() override { events++; return true; }
+    bool endObject() override { events++; return true; }
+    bool startArray() override { events++; return true; }
+    bool endArray() override { events++; return true; }
+    bool key(const std::string &key) override { events++; return true; }
+    bool string(const std::string &value) override { events++; return true; }
+    bool number(const std::string &text) override { events++; return true; }
+    bool boolean(bool value) override { events++; return true; }
+    bool null() override { events++; return true; }
+};
+
+
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <fileName>...\n";
+        return 1;
+    }
+
+    std::cout << std::left << std::setw(24) << "File" << std::setw(12) << "Size (MB)" << std::setw(12) << "Events"
+              << std::setw(16) << "Stream (MB/s)" << "Peak RSS (MB)\n";
+
+    for (int i = 1; i < argc; i++)
+    {
+        struct stat fileStat;
+        if (stat(argv[i], &fileStat) != 0)
+        {
+            std::cerr << "Error in opening file " << argv[i] << "\n";
+            continue;
+        }
+
+        // Read the file several times, so the time is not dominated by a cold cache
+        CountingHandler handler;
+        bool valid = true;
+        size_t runs = 0;
+        auto start = std::chrono::steady_clock::now();
+        std::chrono::duration<double> elapsed;
+        do
+        {
+            int fd = open(argv[i], O_RDONLY);
+            handler.events = 0;
+            valid = parseStream(fd, handler);
+            close(fd);
+            runs++;
+            elapsed = std::chrono::steady_clock::now() - start;
+        } while (elapsed.count() < 0.5);
+
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+
+        std::cout << std::left << std::setw(24) << argv[i] << std::setw(12) << std::fixed << std::setprecision(2)
+                  << fileStat.st_size / MB << std::setw(12) << handler.events << std::setw(16)
+                  << fileStat.st_size * runs / elapsed.count() / MB << usage.ru_maxrss / 1024.0
+                  << (valid ? "" : "  INVALID JSON") << "\n";
+    }
+
+    return 0;
+}
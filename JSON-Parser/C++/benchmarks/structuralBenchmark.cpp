@@ -0,0 +1,94 @@
+/*  Stage 1 benchmark: throughput of findStructuralIndexes() with each implementation
+    the CPU supports (avx2, sse2, scalar), checked to return the same positions.
+
+    Build (from the JSON-Parser/C++ directory):
+        g++ -O2 -o structural_benchmark inputBuffer.cpp structural.cpp benchmarks/structuralBenchmark.cpp
+
+    Run:
+        ./structural_benchmark twitter.json citm_catalog.json canada.json
+*/
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+
+#include "../inputBuffer.h"
+#include "../structural.h"
+
+const double MB = 1024 * 1024;
+
+const char* const IMPLEMENTATIONS[] = {"avx2", "sse2", "scalar"};
+
+
+
+// Run a function repeatedly for at least half a second, returns MB/s
+template <typename Function>
+double measureThroughput(size_t bytes, Function function)
+{
+    auto start = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed;
+    size_t runs = 0;
+    do
+    {
+        function();
+        runs++;
+        elapsed = std::chrono::steady_clock::now() - start;
+    } while (elapsed.count() < 0.5);
+
+    return bytes * runs / elapsed.count() / MB;
+}
+
+
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <fileName>...\n";
+        return 1;
+    }
+
+    std::string defaultImplementation = getStructuralImplementation();
+    std::cout << "Default implementation: " << defaultImplementation << "\n\n";
+    std::cout << std::left << std::setw(24) << "File" << std::setw(12) << "Size (MB)"
+              << std::setw(12) << "Positions" << std::setw(10) << "Stage 1" << "MB/s\n";
+
+    int mismatches = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        InputBuffer input;
+        if (!input.mapFile(argv[i]))
+        {
+            std::cerr << "Error in opening file " << argv[i] << "\n";
+            continue;
+        }
+
+        std::vector <uint32_t> expected;
+        for (const char *implementation : IMPLEMENTATIONS)
+        {
+            if (!setStructuralImplementation(implementation))
+                continue;
+
+            std::vector <uint32_t> indexes;
+            double speed = measureThroughput(input.size(), [&] {
+                findStructuralIndexes(input.data(), input.size(), indexes);
+            });
+
+            if (expected.empty())
+                expected = indexes;
+            else if (indexes != expected)
+            {
+                std::cout << implementation << " returned different positions for " << argv[i] << "\n";
+                mismatches++;
+            }
+
+            std::cout << std::left << std::setw(24) << argv[i] << std::setw(12) << std::fixed << std::setprecision(2)
+                      << input.size() / MB << std::setw(12) << indexes.size() << std::setw(10) << implementation << speed << "\n";
+        }
+    }
+
+    setStructuralImplementation(defaultImplementation);
+    return mismatches == 0 ? 0 : 1;
+}
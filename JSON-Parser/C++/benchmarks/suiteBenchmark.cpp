@@ -0,0 +1,460 @@
+/*  Benchmark suite: the phases of the pipeline (lexing, validation, building
+    the tree, serializing it) on a corpus generated here with a fixed seed, so
+    the numbers can be compared between two versions of the code without
+    downloading anything. Files given on the command line are added to it.
+
+    Each phase is run a few times to warm up, then timed over a number of
+    samples (each long enough for the clock), and reported as the median
+    throughput with the spread of the samples, the heap allocations per run
+    and the peak resident memory above what was resident when it started.
+
+    Allocations are counted in malloc(), which everything (operator new, the
+    arena) goes through, and the peak is reset for each phase through
+    /proc/self/clear_refs: Linux and glibc only.
+
+    Build (from the JSON-Parser/C++ directory):
+        g++ -O2 -o suite_benchmark common.cpp inputBuffer.cpp numbers.cpp structural.cpp utf8.cpp lexer.cpp parser.cpp unescape.cpp arena.cpp dom.cpp keyTable.cpp writer.cpp benchmarks/suiteBenchmark.cpp
+
+    Run:
+        ./suite_benchmark [--samples N] [--warmup N] [fileName]...
+*/
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <sys/resource.h>
+#include <malloc.h>
+
+#include "../common.h"
+#include "../token.h"
+#include "../lexer.h"
+#include "../parser.h"
+#include "../arena.h"
+#include "../dom.h"
+#include "../writer.h"
+
+const double MB = 1024 * 1024;
+const uint64_t SEED = 20240611;
+const double SAMPLE_SECONDS = 0.02;     // Shortest sample, runs are batched up to it
+
+
+
+// Heap allocations, counted by replacing the allocation functions of the C library
+
+static size_t allocations = 0;
+static size_t allocatedBytes = 0;
+
+extern "C"
+{
+    void *__libc_malloc(size_t size);
+    void *__libc_calloc(size_t count, size_t size);
+    void *__libc_realloc(void *pointer, size_t size);
+
+    void *malloc(size_t size)
+    {
+        allocations++;
+        allocatedBytes += size;
+        return __libc_malloc(size);
+    }
+
+    void *calloc(size_t count, size_t size)
+    {
+        allocations++;
+        allocatedBytes += count * size;
+        return __libc_calloc(count, size);
+    }
+
+    void *realloc(void *pointer, size_t size)
+    {
+        allocations++;
+        allocatedBytes += size;
+        return __libc_realloc(pointer, size);
+    }
+}
+
+
+
+// Resident memory from /proc/self/status (VmRSS, VmHWM) in bytes, 0 if unavailable
+static size_t readMemory(const char *field)
+{
+    FILE *status = fopen("/proc/self/status", "r");
+    if (status == nullptr)
+        return 0;
+
+    char line[256];
+    size_t kilobytes = 0, length = strlen(field);
+    while (fgets(line, sizeof(line), status) != nullptr)
+    {
+        if (strncmp(line, field, length) == 0 && line[length] == ':')
+        {
+            kilobytes = strtoull(line + length + 1, nullptr, 10);
+            break;
+        }
+    }
+    fclose(status);
+    return kilobytes * 1024;
+}
+
+
+
+// Make the peak resident memory the current one, false if the kernel does not allow it
+static bool resetPeakMemory()
+{
+    FILE *clearRefs = fopen("/proc/self/clear_refs", "w");
+    if (clearRefs == nullptr)
+        return false;
+
+    bool reset = fputs("5", clearRefs) >= 0;
+    return fclose(clearRefs) == 0 && reset;
+}
+
+
+
+// Pseudorandom numbers with the same sequence on every platform (splitmix64)
+
+class Random
+{
+public:
+    Random(uint64_t seed) : state(seed) {}
+
+    uint64_t next()
+    {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    uint64_t below(uint64_t limit) { return next() % limit; }
+    double uniform() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+
+private:
+    uint64_t state;
+};
+
+
+
+// Text of a string value: ASCII words, with accented letters, CJK, emoji and escapes now and then
+static std::string randomText(Random &random, size_t words)
+{
+    static const char *const pieces[] = {
+        "lorem", "ipsum", "dolor", "sit", "amet", "caf\xC3\xA9", "na\xC3\xAFve", "\xE6\x97\xA5\xE6\x9C\xAC",
+        "\xF0\x9F\x98\x80", "\\n", "\\\"quoted\\\"", "\\u00e9t\\u00e9", "tab\\there", "path\\/to", "#json", "@user"
+    };
+
+    std::string text = "\"";
+    for (size_t i = 0; i < words; i++)
+    {
+        if (i > 0)
+            text += ' ';
+        text += pieces[random.below(sizeof(pieces) / sizeof(pieces[0]))];
+    }
+    return text + "\"";
+}
+
+
+
+// Statuses of a social network search: mixed objects, strings and integers, like twitter.json
+static std::string socialRecords(Random &random, int count)
+{
+    std::string text = "{\"statuses\":[";
+    for (int i = 0; i < count; i++)
+    {
+        std::string id = std::to_string(500000000000000000ULL + random.below(1000000000000ULL));
+        text += (i > 0 ? "," : "");
+        text += "{\"id\":" + id + ",\"id_str\":\"" + id + "\",\"text\":" + randomText(random, 4 + random.below(16))
+              + ",\"user\":{\"id\":" + std::to_string(random.below(4000000000ULL)) + ",\"screen_name\":\"user"
+              + std::to_string(random.below(100000)) + "\",\"followers_count\":" + std::to_string(random.below(100000))
+              + ",\"verified\":" + (random.below(10) == 0 ? "true" : "false") + ",\"description\":"
+              + randomText(random, random.below(12)) + "},\"entities\":{\"hashtags\":[";
+        for (uint64_t j = random.below(4); j > 0; j--)
+            text += "{\"text\":\"tag" + std::to_string(random.below(50)) + "\",\"indices\":[" + std::to_string(j * 10)
+                  + "," + std::to_string(j * 10 + 6) + "]}" + (j > 1 ? "," : "");
+        text += "]},\"coordinates\":" + (random.below(4) == 0 ? "[" + std::to_string(random.uniform() * 180 - 90) + ","
+              + std::to_string(random.uniform() * 360 - 180) + "]" : std::string("null"))
+              + ",\"retweet_count\":" + std::to_string(random.below(1000)) + ",\"favorited\":false}";
+    }
+    return text + "],\"search_metadata\":{\"count\":" + std::to_string(count) + "}}";
+}
+
+
+
+// Polygons of coordinates with full precision doubles, like canada.json
+static std::string coordinates(Random &random, int polygons, int points)
+{
+    std::string text = "{\"type\":\"FeatureCollection\",\"features\":[";
+    char number[32];
+    for (int i = 0; i < polygons; i++)
+    {
+        text += (i > 0 ? "," : "");
+        text += "{\"type\":\"Feature\",\"properties\":{\"name\":\"region " + std::to_string(i)
+              + "\"},\"geometry\":{\"type\":\"Polygon\",\"coordinates\":[[";
+        double x = random.uniform() * 100 - 140, y = random.uniform() * 30 + 42;
+        for (int j = 0; j < points; j++)
+        {
+            x += random.uniform() * 0.01 - 0.005;
+            y += random.uniform() * 0.01 - 0.005;
+            snprintf(number, sizeof(number), "%s[%.15g,", j > 0 ? "," : "", x);
+            text += number;
+            snprintf(number, sizeof(number), "%.15g]", y);
+            text += number;
+        }
+        text += "]]}}";
+    }
+    return text + "]}";
+}
+
+
+
+// Objects keyed by numeric ids, small integers, nulls and short arrays, like citm_catalog.json
+static std::string catalog(Random &random, int count)
+{
+    std::string text = "{\"events\":{";
+    for (int i = 0; i < count; i++)
+    {
+        std::string id = std::to_string(138586341 + i * 7);
+        text += (i > 0 ? "," : "");
+        text += "\"" + id + "\":{\"id\":" + id + ",\"name\":\"Event " + std::to_string(random.below(1000))
+              + "\",\"description\":null,\"logo\":" + (random.below(3) == 0 ? "\"/images/" + id + ".jpg\"" : std::string("null"))
+              + ",\"subTopicIds\":[";
+        for (uint64_t j = random.below(6); j > 0; j--)
+            text += std::to_string(337184262 + random.below(1000)) + (j > 1 ? "," : "");
+        text += "],\"topicIds\":[" + std::to_string(107888604 + random.below(100)) + "],\"prices\":[";
+        for (uint64_t j = 1 + random.below(4); j > 0; j--)
+            text += "{\"amount\":" + std::to_string(random.below(200) * 500) + ",\"seatCategoryId\":"
+                  + std::to_string(338937000 + random.below(1000)) + "}" + (j > 1 ? "," : "");
+        text += "]}";
+    }
+    return text + "}}";
+}
+
+
+
+// Long strings only, most of the time spent on escapes and UTF-8
+static std::string strings(Random &random, int count)
+{
+    std::string text = "[";
+    for (int i = 0; i < count; i++)
+        text += (i > 0 ? "," : "") + randomText(random, 50 + random.below(200));
+    return text + "]";
+}
+
+
+
+// Containers nested deep, many times over
+static std::string nested(Random &random, int count, int depth)
+{
+    std::string text = "[";
+    for (int i = 0; i < count; i++)
+    {
+        text += (i > 0 ? "," : "");
+        std::string closing;
+        for (int j = 0; j < depth; j++)
+        {
+            bool object = random.below(2) == 0;
+            text += object ? "{\"k\":" : "[";
+            closing += object ? '}' : ']';
+        }
+        text += std::to_string(i) + std::string(closing.rbegin(), closing.rend());
+    }
+    return text + "]";
+}
+
+
+
+struct Document
+{
+    std::string     name;
+    std::string     text;
+};
+
+struct Statistics
+{
+    double          median;         // MB/s
+    double          minimum;
+    double          maximum;
+    double          deviation;      // Relative standard deviation of the samples, in %
+    double          allocations;    // Per run
+    double          bytes;          // Allocated per run
+    double          peakMemory;     // Resident memory above the start of the phase, in bytes
+};
+
+
+
+/*  Run a phase warmup times, then time samples batches of runs: a batch is as
+    many runs as fill SAMPLE_SECONDS according to the warm-up, at least one.
+*/
+
+static Statistics measure(const std::function <void()> &phase, size_t length, int warmup, int samples)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    // Freed memory of the previous phase is returned first, so that it is not counted in the start
+    malloc_trim(0);
+    bool peakReset = resetPeakMemory();
+    size_t startMemory = readMemory("VmRSS");
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    size_t startPeak = usage.ru_maxrss * 1024;
+
+    auto start = Clock::now();
+    for (int i = 0; i < warmup; i++)
+        phase();
+    double runTime = std::chrono::duration<double>(Clock::now() - start).count() / std::max(warmup, 1);
+    size_t batch = runTime > 0 ? std::max((size_t)1, (size_t)(SAMPLE_SECONDS / runTime)) : 1;
+
+    std::vector <double> speeds;
+    size_t allocationsBefore = allocations, bytesBefore = allocatedBytes;
+    for (int i = 0; i < samples; i++)
+    {
+        start = Clock::now();
+        for (size_t j = 0; j < batch; j++)
+            phase();
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        speeds.push_back(length * batch / MB / seconds);
+    }
+
+    Statistics statistics;
+    size_t runs = batch * samples;
+    statistics.allocations = (double)(allocations - allocationsBefore) / runs;
+    statistics.bytes = (double)(allocatedBytes - bytesBefore) / runs;
+
+    // Without the reset only a new peak of the process can be seen
+    getrusage(RUSAGE_SELF, &usage);
+    size_t peak = peakReset ? readMemory("VmHWM") : usage.ru_maxrss * 1024;
+    size_t base = peakReset ? startMemory : startPeak;
+    statistics.peakMemory = peak > base ? peak - base : 0;
+
+    std::sort(speeds.begin(), speeds.end());
+    size_t middle = speeds.size() / 2;
+    statistics.median = speeds.size() % 2 ? speeds[middle] : (speeds[middle - 1] + speeds[middle]) / 2;
+    statistics.minimum = speeds.front();
+    statistics.maximum = speeds.back();
+
+    double mean = 0, variance = 0;
+    for (double speed : speeds)
+        mean += speed / speeds.size();
+    for (double speed : speeds)
+        variance += (speed - mean) * (speed - mean) / speeds.size();
+    statistics.deviation = 100 * std::sqrt(variance) / mean;
+    return statistics;
+}
+
+
+
+static void printStatistics(const std::string &name, const std::string &phase, const Statistics &statistics)
+{
+    std::cout << std::left << std::setw(20) << name << std::setw(11) << phase << std::right << std::fixed
+              << std::setprecision(1) << std::setw(9) << statistics.median << std::setw(9) << statistics.minimum
+              << std::setw(9) << statistics.maximum << std::setw(7) << statistics.deviation << "%"
+              << std::setw(12) << std::setprecision(0) << statistics.allocations << std::setw(12) << statistics.bytes / MB * 1024
+              << std::setw(10) << std::setprecision(1) << statistics.peakMemory / MB << "\n";
+}
+
+
+
+// Command line number of an option, exits on a bad one
+static int readCount(int argc, char* argv[], int &i)
+{
+    int count = i + 1 < argc ? atoi(argv[i + 1]) : 0;
+    if (count <= 0)
+    {
+        std::cerr << "Usage: " << argv[0] << " [--samples N] [--warmup N] [fileName]...\n";
+        exit(1);
+    }
+    i++;
+    return count;
+}
+
+
+
+int main(int argc, char* argv[])
+{
+    int samples = 15, warmup = 3;
+    std::vector <Document> corpus;
+
+    Random random(SEED);
+    corpus.push_back({"social", socialRecords(random, 15000)});
+    corpus.push_back({"coordinates", coordinates(random, 50, 3000)});
+    corpus.push_back({"catalog", catalog(random, 15000)});
+    corpus.push_back({"strings", strings(random, 6000)});
+    corpus.push_back({"nested", nested(random, 2000, 500)});
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--samples") == 0)
+            samples = readCount(argc, argv, i);
+        else if (strcmp(argv[i], "--warmup") == 0)
+            warmup = readCount(argc, argv, i);
+        else
+        {
+            std::ifstream file(argv[i], std::ios::binary);
+            if (!file)
+            {
+                std::cerr << "Error in opening file " << argv[i] << "\n";
+                continue;
+            }
+            std::stringstream contents;
+            contents << file.rdbuf();
+            corpus.push_back({argv[i], contents.str()});
+        }
+    }
+
+    std::cout << "Corpus seed " << SEED << ", " << warmup << " warm-up runs, " << samples << " samples per phase\n\n";
+    std::cout << std::left << std::setw(20) << "Input" << std::setw(11) << "Phase" << std::right << std::setw(9) << "MB/s"
+              << std::setw(9) << "min" << std::setw(9) << "max" << std::setw(8) << "stddev" << std::setw(12) << "allocs/run"
+              << std::setw(12) << "KB/run" << std::setw(10) << "peak MB" << "\n";
+
+    const char *phases[] = {"lex", "validate", "dom", "serialize"};
+    double totalBytes = 0, totalTime[4] = {0, 0, 0, 0};
+    for (const Document &document : corpus)
+    {
+        const std::string &text = document.text;
+        std::vector <Token> tokens;
+        ParseContext context;
+        if (!validateJson(text.data(), text.size(), tokens, context))
+        {
+            std::cout << std::left << std::setw(20) << document.name << "INVALID JSON at " << getErrorMessage(context) << "\n";
+            continue;
+        }
+
+        // The tree to serialize is built once, outside the timing
+        JsonDocument parsed;
+        parsed.parse(text.data(), text.size());
+
+        std::function <void()> runs[4] = {
+            [&] { std::vector <Token> lexed; lexer(text.data(), text.size(), lexed); },
+            [&] { std::vector <Token> lexed; ParseContext validation; validateJson(text.data(), text.size(), lexed, validation); },
+            [&] { JsonDocument tree; tree.parse(text.data(), text.size()); },
+            [&] { std::string output = serialize(parsed.root()); }
+        };
+
+        std::cout << "\n";
+        totalBytes += text.size();
+        for (int i = 0; i < 4; i++)
+        {
+            Statistics statistics = measure(runs[i], text.size(), warmup, samples);
+            printStatistics(i == 0 ? document.name + " (" + std::to_string((int)(text.size() / MB + 0.5)) + " MB)" : "",
+                            phases[i], statistics);
+            totalTime[i] += text.size() / MB / statistics.median;
+        }
+    }
+
+    std::cout << "\n";
+    for (int i = 0; i < 4; i++)
+        std::cout << std::left << std::setw(20) << (i == 0 ? "whole corpus" : "") << std::setw(11) << phases[i] << std::right
+                  << std::fixed << std::setprecision(1) << std::setw(9) << totalBytes / MB / totalTime[i] << "\n";
+    std::cout << "\nMB/s is the median of the samples, peak MB the resident memory above the start of the phase\n";
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,211 @@
+/*  Typed reading benchmark: time of filling a vector of structs straight from
+    the text with readJson(), against building the tree of the document then
+    copying its values into the same structs. Without files, an array of
+    generated records is used; a file is read as the statuses of a Twitter
+    search result (twitter.json), other documents are not mapped.
+
+    Build (from the JSON-Parser/C++ directory):
+        g++ -O2 -o typed_benchmark common.cpp inputBuffer.cpp numbers.cpp structural.cpp utf8.cpp lexer.cpp parser.cpp unescape.cpp arena.cpp dom.cpp keyTable.cpp typed.cpp benchmarks/typedBenchmark.cpp
+
+    Run:
+        ./typed_benchmark [twitter.json]
+*/
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <limits>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+
+#include "../common.h"
+#include "../arena.h"
+#include "../dom.h"
+#include "../typed.h"
+
+const double MB = 1024 * 1024;
+
+
+struct Record
+{
+    int64_t                     id;
+    std::string                 name;
+    bool                        active;
+    double                      balance;
+    std::vector <std::string>   tags;
+};
+
+JSON_FIELDS(Record, JSON_FIELD(id), JSON_FIELD(name), JSON_FIELD(active), JSON_FIELD(balance), JSON_FIELD(tags))
+
+
+struct User
+{
+    std::string     screen_name;
+    int64_t         followers_count;
+};
+
+JSON_FIELDS(User, JSON_FIELD(screen_name), JSON_FIELD(followers_count))
+
+struct Status
+{
+    int64_t                 id;
+    std::string             text;
+    User                    user;
+    std::optional <int64_t> in_reply_to_status_id;
+};
+
+JSON_FIELDS(Status, JSON_FIELD(id), JSON_FIELD(text), JSON_FIELD(user), JSON_FIELD(in_reply_to_status_id))
+
+struct SearchResult
+{
+    std::vector <Status>    statuses;
+};
+
+JSON_FIELDS(SearchResult, JSON_FIELD(statuses))
+
+
+
+// Run a function repeatedly for at least half a second, returns milliseconds per run
+template <typename Function>
+double measureTime(Function function)
+{
+    auto start = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed;
+    size_t runs = 0;
+    do
+    {
+        function();
+        runs++;
+        elapsed = std::chrono::steady_clock::now() - start;
+    } while (elapsed.count() < 0.5);
+
+    return elapsed.count() * 1000 / runs;
+}
+
+
+
+// Array of count records
+static std::string records(int count)
+{
+    std::string text = "[";
+    for (int i = 0; i < count; i++)
+    {
+        std::string id = std::to_string(i);
+        text += (i > 0 ? "," : "") + std::string("{\"id\":") + id + ",\"name\":\"name " + id + "\",\"email\":\"user" + id
+              + "@example.com\",\"active\":" + (i % 3 ? "true" : "false") + ",\"balance\":" + std::to_string(i * 0.25)
+              + ",\"tags\":[\"a\",\"b\"]}";
+    }
+    return text + "]";
+}
+
+
+
+// The records from the tree, as a program without typed reading would
+static void copyRecords(const JsonValue &root, std::vector <Record> &output)
+{
+    output.clear();
+    for (uint32_t i = 0; i < root.size; i++)
+    {
+        const JsonValue &item = root.items[i];
+        Record record;
+        const JsonValue *value;
+        if ((value = item.find("id")) != nullptr)
+            value->getInt64(record.id);
+        if ((value = item.find("name")) != nullptr)
+            record.name = value->getString();
+        if ((value = item.find("active")) != nullptr)
+            record.active = value->boolean;
+        if ((value = item.find("balance")) != nullptr)
+            value->getDouble(record.balance);
+        if ((value = item.find("tags")) != nullptr)
+        {
+            for (uint32_t j = 0; j < value->size; j++)
+                record.tags.push_back(value->items[j].getString());
+        }
+        output.push_back(std::move(record));
+    }
+}
+
+
+
+static void copyStatuses(const JsonValue &root, SearchResult &output)
+{
+    output.statuses.clear();
+    const JsonValue *statuses = root.find("statuses");
+    for (uint32_t i = 0; statuses != nullptr && i < statuses->size; i++)
+    {
+        const JsonValue &item = statuses->items[i];
+        Status status;
+        const JsonValue *value, *user;
+        if ((value = item.find("id")) != nullptr)
+            value->getInt64(status.id);
+        if ((value = item.find("text")) != nullptr)
+            status.text = value->getString();
+        if ((user = item.find("user")) != nullptr)
+        {
+            if ((value = user->find("screen_name")) != nullptr)
+                status.user.screen_name = value->getString();
+            if ((value = user->find("followers_count")) != nullptr)
+                value->getInt64(status.user.followers_count);
+        }
+        int64_t reply;
+        if ((value = item.find("in_reply_to_status_id")) != nullptr && value->getInt64(reply))
+            status.in_reply_to_status_id = reply;
+        output.statuses.push_back(std::move(status));
+    }
+}
+
+
+
+template <typename Type, typename Copy>
+static void measure(const std::string &name, const std::string &text, Copy copy)
+{
+    Type typed, copied;
+    ParseError error;
+    if (!readJson(text.data(), text.size(), typed, error))
+    {
+        std::cout << std::left << std::setw(24) << name << "INVALID JSON\n";
+        return;
+    }
+
+    double typedTime = measureTime([&] {
+        readJson(text.data(), text.size(), typed);
+    });
+
+    JsonDocument document;
+    double treeTime = measureTime([&] {
+        document.parse(text.data(), text.size());
+        copy(document.root(), copied);
+    });
+
+    std::cout << std::left << std::setw(24) << name << std::setw(10) << text.size() / MB
+              << std::setw(12) << typedTime << std::setw(12) << treeTime
+              << std::setw(12) << text.size() / MB / (typedTime / 1000) << std::setw(12) << text.size() / MB / (treeTime / 1000) << "\n";
+}
+
+
+
+int main(int argc, char* argv[])
+{
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << std::left << std::setw(24) << "Input" << std::setw(10) << "MB" << std::setw(12) << "Typed ms"
+              << std::setw(12) << "Tree ms" << std::setw(12) << "Typed MB/s" << std::setw(12) << "Tree MB/s" << "\n";
+
+    measure<std::vector <Record>>("records (200000)", records(200000), copyRecords);
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::ifstream file(argv[i], std::ios::binary);
+        std::stringstream contents;
+        contents << file.rdbuf();
+        measure<SearchResult>(argv[i], contents.str(), copyStatuses);
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,232 @@
+/*  UTF-8 benchmark: validates generated ASCII-heavy, CJK-heavy and escape-heavy
+    documents, and the files given on the command line, with each UTF-8
+    implementation (GB/s), then unescapes every string of them as the DOM does
+    (MB/s of string text).
+
+    The results are checked too: every implementation must agree on each input
+    (the generated ones are valid) and reject a set of malformed sequences, and
+    the unescaped strings must match a byte-at-a-time reference. A failed check
+    is reported and makes the benchmark exit with 1.
+
+    Build (from the JSON-Parser/C++ directory):
+        g++ -O2 -o utf8_benchmark common.cpp inputBuffer.cpp numbers.cpp structural.cpp utf8.cpp lexer.cpp unescape.cpp benchmarks/utf8Benchmark.cpp
+
+    Run:
+        ./utf8_benchmark [fileName]...
+*/
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cstdint>
+#include <cstddef>
+
+#include "../common.h"
+#include "../token.h"
+#include "../lexer.h"
+#include "../unescape.h"
+#include "../utf8.h"
+
+const char *IMPLEMENTATIONS[] = {"avx2", "ssse3", "scalar"};
+
+
+
+// Run a function repeatedly for at least half a second, returns the runs per second
+template <typename Function>
+double measureRate(Function function)
+{
+    auto start = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed;
+    size_t runs = 0;
+    do
+    {
+        function();
+        runs++;
+        elapsed = std::chrono::steady_clock::now() - start;
+    } while (elapsed.count() < 0.5);
+
+    return runs / elapsed.count();
+}
+
+
+
+// An array of count strings of 20 to 80 characters, each made by character()
+template <typename Character>
+static std::string generate(size_t count, Character character)
+{
+    std::mt19937 random(42);
+    std::string text = "[";
+    for (size_t i = 0; i < count; i++)
+    {
+        text += i > 0 ? ",\n\"" : "\"";
+        for (int j = 20 + random() % 61; j > 0; j--)
+            text += character(random);
+        text += "\"";
+    }
+    return text + "]";
+}
+
+
+
+// Select the fastest implementation the CPU supports
+static void selectFastest()
+{
+    setUtf8Implementation(IMPLEMENTATIONS[0]) || setUtf8Implementation(IMPLEMENTATIONS[1]) || setUtf8Implementation(IMPLEMENTATIONS[2]);
+}
+
+
+
+// Unescape one character at a time, to check unescapeString() against
+static size_t referenceUnescape(const char *pos, const char *end, char *out)
+{
+    char *start = out;
+    while (pos < end)
+    {
+        if (*pos != '\\')
+        {
+            *out++ = *pos++;
+            continue;
+        }
+
+        char escape = pos[1];
+        pos += 2;
+        if (escape != 'u')
+        {
+            const char *from = "\"\\/bfnrt", *to = "\"\\/\b\f\n\r\t";
+            *out++ = to[std::string(from).find(escape)];
+            continue;
+        }
+
+        uint32_t codePoint = std::stoul(std::string(pos, 4), nullptr, 16);
+        pos += 4;
+        if (codePoint >= 0xD800 && codePoint < 0xDC00 && pos + 6 <= end && pos[0] == '\\' && pos[1] == 'u')
+        {
+            codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (std::stoul(std::string(pos + 2, 4), nullptr, 16) - 0xDC00);
+            pos += 6;
+        }
+        out += encodeUtf8(codePoint, out);
+    }
+    return out - start;
+}
+
+
+
+// Every implementation must reject malformed sequences, placed among ASCII so the vector loops see them
+static bool checkMalformed()
+{
+    static const char *MALFORMED[] = {"\xC0\xAF", "\xE0\x80\xAF", "\xED\xA0\x80", "\xF4\x90\x80\x80", "\xE4\xB8", "\x80", "\xFF"};
+    bool passed = true;
+    for (const char *implementation : IMPLEMENTATIONS)
+    {
+        if (!setUtf8Implementation(implementation))
+            continue;
+        for (const char *sequence : MALFORMED)
+        {
+            std::string text = std::string(37, 'a') + sequence + std::string(70, 'b');
+            if (validateUtf8(text.data(), text.size()))
+            {
+                std::cout << implementation << " accepts a malformed sequence\n";
+                passed = false;
+            }
+        }
+    }
+    selectFastest();
+    return passed;
+}
+
+
+
+// Returns false if the implementations disagree (or find generated text invalid) or the unescaped strings are wrong
+static bool measure(const std::string &name, const std::string &text, bool mustBeValid)
+{
+    std::cout << std::left << std::setw(24) << name << std::setw(12) << std::fixed << std::setprecision(2)
+              << text.size() / (1024.0 * 1024.0);
+
+    bool passed = true;
+    int agreed = -1;                    // What the first implementation found, -1 before it ran
+    for (const char *implementation : IMPLEMENTATIONS)
+    {
+        if (!setUtf8Implementation(implementation))
+        {
+            std::cout << std::setw(14) << "-";
+            continue;
+        }
+
+        bool valid = true;
+        std::cout << std::setw(14) << measureRate([&] { valid = validateUtf8(text.data(), text.size()); }) * text.size() / 1e9;
+        if (!valid)
+            std::cout << "(INVALID UTF-8) ";
+        if (agreed == -1)
+            agreed = valid;
+        passed = passed && valid == (agreed == 1) && (valid || !mustBeValid);
+    }
+    selectFastest();
+
+    // Unescape every string into one buffer, as the DOM does into its arena
+    std::vector <Token> tokens;
+    lexer(text.data(), text.size(), tokens);
+    std::vector <char> buffer(text.size());
+    size_t stringBytes = 0;
+    for (const Token &token : tokens)
+        stringBytes += token.type == STRINGVALUE ? token.length - 2 : 0;
+
+    double rate = measureRate([&] {
+        char *out = buffer.data();
+        for (const Token &token : tokens)
+        {
+            if (token.type == STRINGVALUE)
+                out += unescapeString(text.data() + token.offset + 1, text.data() + token.offset + token.length - 1, out);
+        }
+    });
+
+    std::vector <char> expected(text.size());
+    char *out = buffer.data(), *expectedOut = expected.data();
+    for (const Token &token : tokens)
+    {
+        if (token.type == STRINGVALUE)
+        {
+            out += unescapeString(text.data() + token.offset + 1, text.data() + token.offset + token.length - 1, out);
+            expectedOut += referenceUnescape(text.data() + token.offset + 1, text.data() + token.offset + token.length - 1, expectedOut);
+        }
+    }
+    passed = passed && std::string(buffer.data(), out) == std::string(expected.data(), expectedOut);
+
+    std::cout << rate * stringBytes / (1024 * 1024) << (passed ? "" : "  (results differ)") << "\n";
+    return passed;
+}
+
+
+
+int main(int argc, char* argv[])
+{
+    std::cout << std::left << std::setw(24) << "Input" << std::setw(12) << "Size (MB)" << std::setw(14) << "avx2 (GB/s)"
+              << std::setw(14) << "ssse3 (GB/s)" << std::setw(14) << "scalar (GB/s)" << "Unescape (MB/s)\n";
+
+    bool passed = checkMalformed();
+    passed = measure("ASCII-heavy", generate(200000, [](std::mt19937 &random) {
+        return std::string(1, "abcdefghijklmnopqrstuvwxyz ABCDEFGHIJKLMNOPQRSTUVWXYZ 0123456789"[random() % 64]);
+    }), true) && passed;
+
+    passed = measure("CJK-heavy", generate(200000, [](std::mt19937 &random) {
+        char character[4];
+        return std::string(character, encodeUtf8(0x4E00 + random() % 0x5200, character));
+    }), true) && passed;
+
+    passed = measure("Escape-heavy", generate(200000, [](std::mt19937 &random) {
+        static const char *ESCAPES[] = {"\\n", "\\\"", "\\\\", "\\u00e9", "\\u4e2d", "\\ud83d\\ude00", "a", "b"};
+        return std::string(ESCAPES[random() % 8]);
+    }), true) && passed;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::ifstream file(argv[i], std::ios::binary);
+        std::stringstream contents;
+        contents << file.rdbuf();
+        passed = measure(argv[i], contents.str(), false) && passed;
+    }
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,138 @@
+/*  Writer benchmark: parses JSON files into a document, writes them back in
+    compact and pretty form and reports the output throughput in MB/s. Each
+    output is parsed again and written again to check that the round trip gives
+    the same text. The numbers of the files are also formatted as doubles, with
+    JsonWriter::number() and with snprintf("%.17g"), and read back with strtod().
+
+    Build (from the JSON-Parser/C++ directory):
+        g++ -O2 -o writer_benchmark common.cpp inputBuffer.cpp numbers.cpp structural.cpp utf8.cpp lexer.cpp parser.cpp unescape.cpp arena.cpp dom.cpp keyTable.cpp writer.cpp benchmarks/writerBenchmark.cpp
+
+    Run:
+        ./writer_benchmark twitter.json citm_catalog.json canada.json
+*/
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+
+#include "../common.h"
+#include "../inputBuffer.h"
+#include "../arena.h"
+#include "../dom.h"
+#include "../writer.h"
+
+const double MB = 1024 * 1024;
+
+
+
+// Run a function repeatedly for at least half a second, returns the runs per second
+template <typename Function>
+double measureRate(Function function)
+{
+    auto start = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed;
+    size_t runs = 0;
+    do
+    {
+        function();
+        runs++;
+        elapsed = std::chrono::steady_clock::now() - start;
+    } while (elapsed.count() < 0.5);
+
+    return runs / elapsed.count();
+}
+
+
+
+// Every number of a tree as a double
+static void collectNumbers(const JsonValue &value, std::vector <double> &numbers)
+{
+    double number;
+    if (value.getDouble(number))
+        numbers.push_back(number);
+    for (uint32_t i = 0; value.type == JSONARRAY && i < value.size; i++)
+        collectNumbers(value.items[i], numbers);
+    for (uint32_t i = 0; value.type == JSONOBJECT && i < value.size; i++)
+        collectNumbers(value.members[i].value, numbers);
+}
+
+
+
+// Parse a text and write it again, false if it is not valid JSON or the text changes
+static bool roundTrip(const std::string &text, int indent)
+{
+    JsonDocument document;
+    return document.parse(text.data(), text.size()) && serialize(document.root(), indent) == text;
+}
+
+
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <fileName>...\n";
+        return 1;
+    }
+
+    std::cout << std::left << std::setw(24) << "File" << std::setw(16) << "Compact (MB/s)" << std::setw(15) << "Pretty (MB/s)"
+              << std::setw(12) << "Round trip" << std::setw(10) << "Numbers" << std::setw(16) << "to_chars (M/s)"
+              << std::setw(14) << "%.17g (M/s)" << "Exact\n";
+
+    for (int i = 1; i < argc; i++)
+    {
+        InputBuffer input;
+        JsonDocument document;
+        if (!input.mapFile(argv[i]) || !document.parse(input))
+        {
+            std::cerr << "Error in opening or parsing file " << argv[i] << "\n";
+            continue;
+        }
+
+        JsonWriter compact, pretty(4);
+        double compactSpeed = measureRate([&] { compact.clear(); compact.value(document.root()); }) * compact.text().size() / MB;
+        double prettySpeed = measureRate([&] { pretty.clear(); pretty.value(document.root()); }) * pretty.text().size() / MB;
+        bool same = roundTrip(compact.text(), 0) && roundTrip(pretty.text(), 4);
+
+        // Shortest formatting against %.17g, both must read back as the same double
+        std::vector <double> numbers;
+        collectNumbers(document.root(), numbers);
+        JsonWriter writer;
+        double shortestRate = measureRate([&] {
+            writer.clear();
+            writer.startArray();
+            for (double number : numbers)
+                writer.number(number);
+            writer.endArray();
+        }) * numbers.size() / 1e6;
+
+        std::string printed;
+        double printfRate = measureRate([&] {
+            char buffer[32];
+            printed.clear();
+            for (double number : numbers)
+                printed.append(buffer, snprintf(buffer, sizeof(buffer), "%.17g,", number));
+        }) * numbers.size() / 1e6;
+
+        bool exact = true;
+        const char *pos = writer.text().c_str() + 1;
+        for (double number : numbers)
+        {
+            char *next;
+            exact = exact && strtod(pos, &next) == number;
+            pos = next + 1;
+        }
+
+        std::cout << std::left << std::setw(24) << argv[i] << std::fixed << std::setprecision(2) << std::setw(16)
+                  << compactSpeed << std::setw(15) << prettySpeed << std::setw(12) << (same ? "same" : "DIFFERENT")
+                  << std::setw(10) << numbers.size() << std::setw(16) << shortestRate << std::setw(14) << printfRate
+                  << (exact ? "yes" : "NO") << "\n";
+    }
+
+    return 0;
+}
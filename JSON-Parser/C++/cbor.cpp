@@ -0,0 +1,878 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+#include "common.h"
+#include "inputBuffer.h"
+#include "numbers.h"
+#include "utf8.h"
+#include "arena.h"
+#include "dom.h"
+#include "writer.h"
+#include "cbor.h"
+
+// Major types, in the 3 high bits of the first byte of a value
+const unsigned char CBOR_UNSIGNED   = 0;
+const unsigned char CBOR_NEGATIVE   = 1;
+const unsigned char CBOR_BYTES      = 2;
+const unsigned char CBOR_TEXT       = 3;
+const unsigned char CBOR_ARRAY      = 4;
+const unsigned char CBOR_MAP        = 5;
+const unsigned char CBOR_TAG        = 6;
+const unsigned char CBOR_SIMPLE     = 7;
+
+// Tags of the numbers that neither an integer nor a float holds exactly
+const uint64_t POSITIVE_BIGNUM      = 2;    // Byte string, big-endian magnitude n
+const uint64_t NEGATIVE_BIGNUM      = 3;    // The same for -1 - n
+const uint64_t DECIMAL_FRACTION     = 4;    // [exponent, mantissa]: mantissa * 10^exponent
+
+// Whole first bytes of the simple values and floats
+const unsigned char CBOR_FALSE      = 0xF4;
+const unsigned char CBOR_TRUE       = 0xF5;
+const unsigned char CBOR_NULL       = 0xF6;
+const unsigned char CBOR_HALF       = 0xF9;
+const unsigned char CBOR_FLOAT      = 0xFA;
+const unsigned char CBOR_DOUBLE     = 0xFB;
+
+
+
+/*  Append the head of a value: the major type and its argument (an integer,
+    a length or a count) in the fewest bytes, big-endian.
+    Example: writeHead(output, CBOR_TEXT, 300) appends 79 01 2C
+*/
+
+static void writeHead(std::string &output, unsigned char major, uint64_t argument)
+{
+    unsigned char type = major << 5;
+    if (argument < 24)
+    {
+        output += (char)(type | argument);
+        return;
+    }
+
+    int bytes = argument <= 0xFF ? 1 : argument <= 0xFFFF ? 2 : argument <= 0xFFFFFFFF ? 4 : 8;
+    output += (char)(type | (bytes == 1 ? 24 : bytes == 2 ? 25 : bytes == 4 ? 26 : 27));
+    for (int shift = (bytes - 1) * 8; shift >= 0; shift -= 8)
+        output += (char)(argument >> shift);
+}
+
+
+
+// Append an integer, major type 1 holds -1 - value for negative values
+
+static void writeInteger(std::string &output, int64_t value)
+{
+    if (value >= 0)
+        writeHead(output, CBOR_UNSIGNED, value);
+    else
+        writeHead(output, CBOR_NEGATIVE, ~(uint64_t)value);
+}
+
+
+
+/*  Significant digits and exponent of the text of a number: its value is
+    digits * 10^exponent, without leading or trailing zeroes (no digits for 0).
+    false if the exponent is written with more than 18 digits.
+    Example: "-12.50e3" gives negative, "125" and 2
+*/
+
+static bool getDecimal(const char *pos, const char *end, std::string &digits, int64_t &exponent, bool &negative)
+{
+    negative = pos < end && *pos == '-';
+    if (negative)
+        pos++;
+
+    digits.clear();
+    int64_t fractionDigits = 0;
+    for (; pos < end && *pos >= '0' && *pos <= '9'; pos++)
+        digits += *pos;
+    if (pos < end && *pos == '.')
+    {
+        for (pos++; pos < end && *pos >= '0' && *pos <= '9'; pos++, fractionDigits++)
+            digits += *pos;
+    }
+
+    exponent = 0;
+    if (pos < end && (*pos == 'e' || *pos == 'E'))
+    {
+        pos++;
+        bool negativeExponent = *pos == '-';
+        if (*pos == '-' || *pos == '+')
+            pos++;
+        while (end - pos > 1 && *pos == '0')
+            pos++;
+        if (end - pos > 18)
+            return false;
+        for (; pos < end; pos++)
+            exponent = exponent * 10 + (*pos - '0');
+        if (negativeExponent)
+            exponent = -exponent;
+    }
+    exponent -= fractionDigits;
+
+    size_t leadingZeroes = digits.find_first_not_of('0');
+    digits.erase(0, leadingZeroes == std::string::npos ? digits.size() : leadingZeroes);
+    while (!digits.empty() && digits.back() == '0')
+    {
+        digits.pop_back();
+        exponent++;
+    }
+    if (digits.empty())
+        exponent = 0;
+    return true;
+}
+
+
+
+/*  Append a mantissa of a decimal fraction: an integer when it fits, else a
+    bignum, whose bytes are the decimal digits converted to base 256.
+*/
+
+static void writeMantissa(std::string &output, const std::string &digits, bool negative)
+{
+    if (digits.size() <= 18)
+    {
+        int64_t mantissa = std::stoll(digits);
+        writeInteger(output, negative ? -mantissa : mantissa);
+        return;
+    }
+
+    // Big-endian magnitude, one digit multiplied in at a time
+    std::vector <unsigned char> bytes;
+    for (char digit : digits)
+    {
+        unsigned carry = digit - '0';
+        for (size_t i = bytes.size(); i-- > 0; )
+        {
+            carry += bytes[i] * 10;
+            bytes[i] = carry & 0xFF;
+            carry >>= 8;
+        }
+        if (carry > 0)
+            bytes.insert(bytes.begin(), carry);
+    }
+
+    // A negative bignum holds -1 - value, its magnitude minus one
+    if (negative)
+    {
+        size_t i = bytes.size();
+        while (bytes[--i] == 0)
+            bytes[i] = 0xFF;
+        bytes[i]--;
+    }
+
+    writeHead(output, CBOR_TAG, negative ? NEGATIVE_BIGNUM : POSITIVE_BIGNUM);
+    writeHead(output, CBOR_BYTES, bytes.size());
+    output.append((const char *)bytes.data(), bytes.size());
+}
+
+
+
+/*  Append a number without losing any digit: an integer if its text has no
+    fraction and no exponent and it fits in 64 bits, else a float (32-bit when
+    that keeps the same double) if the shortest text of the double has the
+    same value, else a decimal fraction, e.g. for 1e400 or 2^64.
+    -0 is the integer 0, as getInt64() reads it from a tree, -0.0 a float.
+*/
+
+static bool writeNumber(std::string &output, const JsonValue &value)
+{
+    const char *end = value.text + value.size;
+    int64_t integer;
+    if (parseInt64(value.text, end, integer))
+    {
+        writeInteger(output, integer);
+        return true;
+    }
+
+    std::string digits;
+    int64_t exponent;
+    bool negative;
+    if (!getDecimal(value.text, end, digits, exponent, negative))
+        return false;
+
+    double number;
+    if (parseDouble(value.text, end, number) && std::isfinite(number))
+    {
+        char buffer[32];
+        std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), number);
+        std::string shortestDigits;
+        int64_t shortestExponent;
+        bool shortestNegative;
+        getDecimal(buffer, result.ptr, shortestDigits, shortestExponent, shortestNegative);
+
+        if (shortestDigits == digits && shortestExponent == exponent)
+        {
+            float single = (float)number;
+            if ((double)single == number)
+            {
+                uint32_t bits;
+                memcpy(&bits, &single, sizeof(bits));
+                output += (char)CBOR_FLOAT;
+                for (int shift = 24; shift >= 0; shift -= 8)
+                    output += (char)(bits >> shift);
+            }
+            else
+            {
+                uint64_t bits;
+                memcpy(&bits, &number, sizeof(bits));
+                output += (char)CBOR_DOUBLE;
+                for (int shift = 56; shift >= 0; shift -= 8)
+                    output += (char)(bits >> shift);
+            }
+            return true;
+        }
+    }
+
+    writeHead(output, CBOR_TAG, DECIMAL_FRACTION);
+    writeHead(output, CBOR_ARRAY, 2);
+    writeInteger(output, exponent);
+    writeMantissa(output, digits, negative);
+    return true;
+}
+
+
+
+/*  Append a value of a document and its children to output. The lengths of the
+    strings and the counts of the containers are known from the tree, so every
+    head is written once, in its shortest form.
+    Returns false only for a number whose exponent does not fit in 64 bits.
+*/
+
+bool encodeCbor(const JsonValue &value, std::string &output)
+{
+    switch (value.type)
+    {
+        case JSONOBJECT:
+            writeHead(output, CBOR_MAP, value.size);
+            for (uint32_t i = 0; i < value.size; i++)
+            {
+                writeHead(output, CBOR_TEXT, value.members[i].keyLength);
+                output.append(value.members[i].key, value.members[i].keyLength);
+                if (!encodeCbor(value.members[i].value, output))
+                    return false;
+            }
+            return true;
+
+        case JSONARRAY:
+            writeHead(output, CBOR_ARRAY, value.size);
+            for (uint32_t i = 0; i < value.size; i++)
+            {
+                if (!encodeCbor(value.items[i], output))
+                    return false;
+            }
+            return true;
+
+        case JSONSTRING:
+            writeHead(output, CBOR_TEXT, value.size);
+            output.append(value.text, value.size);
+            return true;
+
+        case JSONNUMBER:
+            return writeNumber(output, value);
+
+        case JSONBOOLEAN:
+            output += (char)(value.boolean ? CBOR_TRUE : CBOR_FALSE);
+            return true;
+
+        case JSONNULL:
+            output += (char)CBOR_NULL;
+            return true;
+    }
+    return false;
+}
+
+
+
+// Argument of the head at pos, which moves past the head. For floats it is their bits
+
+static uint64_t readArgument(const unsigned char *&pos)
+{
+    unsigned char info = *pos++ & 0x1F;
+    if (info < 24)
+        return info;
+
+    uint64_t argument = 0;
+    for (int bytes = 1 << (info - 24); bytes > 0; bytes--)
+        argument = argument << 8 | *pos++;
+    return argument;
+}
+
+
+
+// Value of the bits of a half, single or double precision float, by its first byte
+
+static double floatValue(unsigned char head, uint64_t bits)
+{
+    if (head == CBOR_DOUBLE)
+    {
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    if (head == CBOR_FLOAT)
+    {
+        uint32_t singleBits = bits;
+        float value;
+        memcpy(&value, &singleBits, sizeof(value));
+        return value;
+    }
+
+    // Half: 1 sign bit, 5 exponent bits, 10 mantissa bits
+    int exponent = (bits >> 10) & 0x1F;
+    int mantissa = bits & 0x3FF;
+    double value = exponent == 0 ? std::ldexp(mantissa, -24)
+                 : exponent != 31 ? std::ldexp(mantissa + 1024, exponent - 25)
+                 : mantissa == 0 ? INFINITY : NAN;
+    return bits & 0x8000 ? -value : value;
+}
+
+
+
+// Position after the value at pos and its children, which load() checked
+
+static const unsigned char *skipValue(const unsigned char *pos)
+{
+    uint64_t remaining = 1;     // Values still to pass over
+    while (remaining > 0)
+    {
+        unsigned char major = *pos >> 5;
+        uint64_t argument = readArgument(pos);
+        remaining--;
+
+        if (major == CBOR_TEXT || major == CBOR_BYTES)
+            pos += argument;
+        else if (major == CBOR_ARRAY)
+            remaining += argument;
+        else if (major == CBOR_MAP)
+            remaining += 2 * argument;
+        else if (major == CBOR_TAG)
+            remaining++;
+    }
+    return pos;
+}
+
+
+
+jsonTypes CborValue::type() const
+{
+    if (!isValid())
+        return JSONNULL;
+
+    switch (*pos >> 5)
+    {
+        case CBOR_UNSIGNED:
+        case CBOR_NEGATIVE:
+        case CBOR_TAG:
+            return JSONNUMBER;
+        case CBOR_TEXT:
+            return JSONSTRING;
+        case CBOR_ARRAY:
+            return JSONARRAY;
+        case CBOR_MAP:
+            return JSONOBJECT;
+    }
+    return *pos == CBOR_FALSE || *pos == CBOR_TRUE ? JSONBOOLEAN : *pos == CBOR_NULL ? JSONNULL : JSONNUMBER;
+}
+
+
+
+uint32_t CborValue::size() const
+{
+    jsonTypes valueType = type();
+    if (valueType != JSONSTRING && valueType != JSONARRAY && valueType != JSONOBJECT)
+        return 0;
+
+    const unsigned char *head = pos;
+    return readArgument(head);
+}
+
+
+
+CborValue CborValue::first() const
+{
+    if (size() == 0 || type() == JSONSTRING)
+        return CborValue();
+
+    const unsigned char *child = pos;
+    readArgument(child);
+    return CborValue(document, child);
+}
+
+
+
+// The caller counts the children with size(): past the last one, next() is the
+// value that follows the container, or an invalid value at the end of the document
+
+CborValue CborValue::next() const
+{
+    if (!isValid())
+        return CborValue();
+
+    const unsigned char *after = skipValue(pos);
+    if (after == document->data + document->length)
+        return CborValue();
+    return CborValue(document, after);
+}
+
+
+
+CborValue CborValue::at(size_t index) const
+{
+    if (type() != JSONARRAY || index >= size())
+        return CborValue();
+
+    CborValue element = first();
+    for (; index > 0; index--)
+        element.pos = skipValue(element.pos);
+    return element;
+}
+
+
+
+// Keys are compared in place, the values of the other members are skipped
+
+CborValue CborValue::find(const std::string &key) const
+{
+    if (type() != JSONOBJECT)
+        return CborValue();
+
+    const unsigned char *member = pos;
+    uint32_t count = readArgument(member);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint64_t keyLength = readArgument(member);
+        const unsigned char *keyText = member;
+        member += keyLength;
+        if (keyLength == key.length() && memcmp(keyText, key.data(), keyLength) == 0)
+            return CborValue(document, member);
+        member = skipValue(member);
+    }
+    return CborValue();
+}
+
+
+
+const char *CborValue::text() const
+{
+    if (type() != JSONSTRING)
+        return nullptr;
+
+    const unsigned char *bytes = pos;
+    readArgument(bytes);
+    return (const char *)bytes;
+}
+
+
+
+// Decimal digits of the magnitude of a bignum, plus one for a negative bignum
+
+static std::string getBignumDigits(const unsigned char *bytes, size_t length, bool negative)
+{
+    std::vector <unsigned char> magnitude(bytes, bytes + length);
+    if (negative)
+    {
+        // Add one, carrying through the bytes at 0xFF
+        size_t i = magnitude.size();
+        while (i > 0 && magnitude[i - 1] == 0xFF)
+            magnitude[--i] = 0;
+        if (i > 0)
+            magnitude[i - 1]++;
+        else
+            magnitude.insert(magnitude.begin(), 1);
+    }
+
+    // Divide by 10 until nothing is left, the remainders are the digits from the last
+    std::string digits;
+    size_t first = 0;
+    while (first < magnitude.size())
+    {
+        unsigned remainder = 0;
+        for (size_t i = first; i < magnitude.size(); i++)
+        {
+            remainder = remainder << 8 | magnitude[i];
+            magnitude[i] = remainder / 10;
+            remainder %= 10;
+        }
+        digits += (char)('0' + remainder);
+        while (first < magnitude.size() && magnitude[first] == 0)
+            first++;
+    }
+    if (digits.empty())
+        digits = "0";
+    return std::string(digits.rbegin(), digits.rend());
+}
+
+
+
+// Text of a bignum or of an integer at pos, which moves past it
+
+static std::string readIntegerText(const unsigned char *&pos)
+{
+    unsigned char major = *pos >> 5;
+    uint64_t argument = readArgument(pos);
+    if (major == CBOR_TAG)
+    {
+        size_t length = readArgument(pos);
+        pos += length;
+        return (argument == NEGATIVE_BIGNUM ? "-" : "") + getBignumDigits(pos - length, length, argument == NEGATIVE_BIGNUM);
+    }
+
+    if (major == CBOR_UNSIGNED)
+        return std::to_string(argument);
+    if (argument == UINT64_MAX)
+        return "-18446744073709551616";
+    return "-" + std::to_string(argument + 1);
+}
+
+
+
+/*  Integers are written in full, floats as the shortest text that reads back
+    the same, decimal fractions as their mantissa and exponent.
+    Example: the decimal fraction [400, 1] is "1e400"
+*/
+
+std::string CborValue::getString() const
+{
+    jsonTypes valueType = type();
+    if (valueType == JSONSTRING)
+        return std::string(text(), size());
+    if (valueType != JSONNUMBER)
+        return "";
+
+    const unsigned char *bytes = pos;
+    if (*pos >> 5 == CBOR_UNSIGNED || *pos >> 5 == CBOR_NEGATIVE)
+        return readIntegerText(bytes);
+
+    if (*pos >> 5 == CBOR_TAG)
+    {
+        if (readArgument(bytes) != DECIMAL_FRACTION)
+            return readIntegerText(bytes = pos);
+
+        readArgument(bytes);    // [
+        std::string exponent = readIntegerText(bytes);
+        std::string mantissa = readIntegerText(bytes);
+        return exponent == "0" ? mantissa : mantissa + "e" + exponent;
+    }
+
+    double number;
+    getDouble(number);
+    char buffer[32];
+    std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), number);
+    return std::string(buffer, result.ptr - buffer);
+}
+
+
+
+bool CborValue::getInt64(int64_t &value) const
+{
+    if (type() != JSONNUMBER || (*pos >> 5 != CBOR_UNSIGNED && *pos >> 5 != CBOR_NEGATIVE))
+        return false;
+
+    const unsigned char *head = pos;
+    uint64_t argument = readArgument(head);
+    if (argument > INT64_MAX)
+        return false;
+    value = *pos >> 5 == CBOR_UNSIGNED ? (int64_t)argument : -1 - (int64_t)argument;
+    return true;
+}
+
+
+
+// Bignums and decimal fractions are converted from their text, as numbers of a tree
+
+bool CborValue::getDouble(double &value) const
+{
+    if (type() != JSONNUMBER)
+        return false;
+
+    const unsigned char *head = pos;
+    uint64_t argument = readArgument(head);
+    if (*pos >> 5 == CBOR_UNSIGNED)
+        value = (double)argument;
+    else if (*pos >> 5 == CBOR_NEGATIVE)
+        value = -1 - (double)argument;
+    else if (*pos >> 5 == CBOR_TAG)
+    {
+        std::string number = getString();
+        return parseDouble(number.data(), number.data() + number.size(), value);
+    }
+    else
+        value = floatValue(*pos, argument);
+    return true;
+}
+
+
+
+CborDocument::CborDocument() : data(nullptr), length(0), maxDepth(DEFAULT_MAX_DEPTH)
+{
+}
+
+
+
+// Read the head at pos into argument, false if it is reserved or runs past end
+
+static bool readHead(const unsigned char *&pos, const unsigned char *end, uint64_t &argument)
+{
+    if (pos == end || (*pos & 0x1F) > 27)
+        return false;
+
+    size_t bytes = (*pos & 0x1F) < 24 ? 0 : 1 << ((*pos & 0x1F) - 24);
+    if ((size_t)(end - pos - 1) < bytes)
+        return false;
+
+    argument = readArgument(pos);
+    return true;
+}
+
+
+
+// Check an integer at pos and move past it. Without bignums, it must fit in an int64_t
+
+static bool checkInteger(const unsigned char *&pos, const unsigned char *end, bool bignums)
+{
+    unsigned char major = pos < end ? *pos >> 5 : 0;
+    uint64_t argument, length;
+    if (!readHead(pos, end, argument))
+        return false;
+
+    if (major == CBOR_UNSIGNED)
+        return true;
+    if (major == CBOR_NEGATIVE)
+        return argument <= INT64_MAX || bignums;
+    if (major != CBOR_TAG || !bignums || (argument != POSITIVE_BIGNUM && argument != NEGATIVE_BIGNUM))
+        return false;
+
+    if (pos == end || *pos >> 5 != CBOR_BYTES || !readHead(pos, end, length) || length > (uint64_t)(end - pos) || length > UINT32_MAX)
+        return false;
+    pos += length;
+    return true;
+}
+
+
+
+// Check a tagged number at pos, a bignum or a decimal fraction [integer, integer or bignum]
+
+static bool checkTaggedNumber(const unsigned char *&pos, const unsigned char *end)
+{
+    const unsigned char *tag = pos;
+    uint64_t argument;
+    if (!readHead(tag, end, argument) || argument != DECIMAL_FRACTION)
+        return checkInteger(pos, end, true);
+
+    uint64_t count;
+    if (tag == end || *tag >> 5 != CBOR_ARRAY || !readHead(tag, end, count) || count != 2)
+        return false;
+
+    pos = tag;
+    return checkInteger(pos, end, false) && checkInteger(pos, end, true);
+}
+
+
+
+// Whether no byte has its high bit set, 8 bytes at a time: most strings need
+// no UTF-8 validation, which costs more to set up than they are long
+
+static bool isAscii(const unsigned char *pos, size_t length)
+{
+    uint64_t bits = 0;
+    for (; length >= 8; pos += 8, length -= 8)
+    {
+        uint64_t word;
+        memcpy(&word, pos, 8);
+        bits |= word;
+    }
+    for (; length > 0; pos++, length--)
+        bits |= *pos;
+    return (bits & 0x8080808080808080ULL) == 0;
+}
+
+
+
+/*  Check the bytes once, so that the values read later need no checks: one
+    value of the subset of cbor.h, every length and count within the bytes and
+    32-bit, text keys, UTF-8 strings, finite floats, only the tags of numbers,
+    and at most maxDepth nested containers, counted on an explicit stack as in
+    parser(). Nothing is copied.
+*/
+
+bool CborDocument::load(const char *bytes, size_t size)
+{
+    data = nullptr;
+    length = 0;
+
+    const unsigned char *pos = (const unsigned char *)bytes;
+    const unsigned char *end = pos + size;
+
+    // Values still to read in the current container (keys and values for maps),
+    // the enclosing containers are saved on an explicit stack as in parser()
+    uint64_t remaining = 1;             // The root
+    bool inMap = false;
+    std::vector <uint64_t> stack;       // remaining << 1 | inMap of each enclosing container
+    while (remaining > 0 || !stack.empty())
+    {
+        if (remaining == 0)
+        {
+            remaining = stack.back() >> 1;
+            inMap = stack.back() & 1;
+            stack.pop_back();
+            continue;
+        }
+
+        // The members of a map alternate key and value, from an even count
+        bool isKey = inMap && remaining % 2 == 0;
+        remaining--;
+
+        const unsigned char *start = pos;
+        unsigned char head = pos < end ? *pos : 0;
+        unsigned char major = head >> 5;
+        uint64_t argument;
+        if (!readHead(pos, end, argument) || (isKey && major != CBOR_TEXT))
+            return false;
+
+        // Sizes are 32-bit, as in the tree
+        if ((major == CBOR_TEXT || major == CBOR_ARRAY || major == CBOR_MAP) && argument > UINT32_MAX)
+            return false;
+
+        switch (major)
+        {
+            case CBOR_UNSIGNED:
+            case CBOR_NEGATIVE:
+                break;
+
+            case CBOR_TEXT:
+                if (argument > (uint64_t)(end - pos) || (!isAscii(pos, argument) && !validateUtf8((const char *)pos, argument)))
+                    return false;
+                pos += argument;
+                break;
+
+            case CBOR_ARRAY:
+            case CBOR_MAP:
+                // Every value takes at least one byte
+                if (stack.size() >= maxDepth || argument > (uint64_t)(end - pos) / (major == CBOR_MAP ? 2 : 1))
+                    return false;
+                stack.push_back(remaining << 1 | inMap);
+                remaining = major == CBOR_MAP ? 2 * argument : argument;
+                inMap = major == CBOR_MAP;
+                break;
+
+            case CBOR_SIMPLE:
+                if (head == CBOR_HALF || head == CBOR_FLOAT || head == CBOR_DOUBLE)
+                {
+                    if (!std::isfinite(floatValue(head, argument)))
+                        return false;
+                }
+                else if (head != CBOR_FALSE && head != CBOR_TRUE && head != CBOR_NULL)
+                    return false;
+                break;
+
+            case CBOR_TAG:
+                pos = start;
+                if (!checkTaggedNumber(pos, end))
+                    return false;
+                break;
+
+            default:
+                return false;   // Byte strings are only read in bignums
+        }
+    }
+
+    if (pos != end)
+        return false;
+
+    data = (const unsigned char *)bytes;
+    length = size;
+    return true;
+}
+
+
+
+bool CborDocument::load(const InputBuffer &input)
+{
+    return load(input.data(), input.size());
+}
+
+
+
+// The root value, invalid if nothing was loaded
+
+CborValue CborDocument::root() const
+{
+    if (data == nullptr)
+        return CborValue();
+    return CborValue(this, data);
+}
+
+
+
+// Write a value and its children, walking the bytes once with first() and next()
+
+static void writeValue(const CborValue &value, JsonWriter &writer)
+{
+    switch (value.type())
+    {
+        case JSONOBJECT:
+            {
+                writer.startObject();
+                CborValue key = value.first();
+                for (uint32_t i = 0; i < value.size(); i++)
+                {
+                    writer.key(key.text(), key.size());
+                    CborValue member = key.next();
+                    writeValue(member, writer);
+                    key = member.next();
+                }
+                writer.endObject();
+            }
+            break;
+
+        case JSONARRAY:
+            {
+                writer.startArray();
+                CborValue element = value.first();
+                for (uint32_t i = 0; i < value.size(); i++)
+                {
+                    writeValue(element, writer);
+                    element = element.next();
+                }
+                writer.endArray();
+            }
+            break;
+
+        case JSONSTRING:
+            writer.string(value.text(), value.size());
+            break;
+
+        case JSONNUMBER:
+            {
+                std::string number = value.getString();
+                writer.rawNumber(number.data(), number.size());
+            }
+            break;
+
+        case JSONBOOLEAN:
+            writer.boolean(value.getBoolean());
+            break;
+
+        case JSONNULL:
+            writer.null();
+            break;
+    }
+}
+
+
+
+// JSON text of a value of a CBOR document, as serialize() writes a value of a tree
+
+std::string serialize(const CborValue &value, int indent)
+{
+    JsonWriter writer(indent);
+    writeValue(value, writer);
+    return writer.text();
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+// Binary encoding of documents in CBOR (RFC 8949): a tree is converted once,
+// then read back in place, without lexing, copying or allocating.
+//
+// JSON maps to a subset of CBOR: objects are maps with text keys, arrays and
+// strings have definite lengths, integers that fit in 64 bits are integers,
+// other numbers are floats (32-bit when that is exact) when the float has the
+// value of their text, else decimal fractions with a bignum mantissa if
+// needed, so no digit is lost. false, true and null are the simple values.
+// The reader accepts the same subset, and also half-precision floats.
+
+class CborDocument;
+
+// A value read in place in the bytes of a document, invalid if it was not found
+
+class CborValue
+{
+public:
+    CborValue() : document(nullptr), pos(nullptr) {}
+    CborValue(const CborDocument *document, const unsigned char *pos) : document(document), pos(pos) {}
+
+    bool isValid() const { return document != nullptr; }
+    jsonTypes type() const;                                 // JSONNULL if invalid
+    uint32_t size() const;                                  // Bytes of a string, members of an object, elements of an array
+
+    CborValue find(const std::string &key) const;          // First member with the key
+    CborValue at(size_t index) const;                       // Element of an array
+    CborValue first() const;                                // First element, or key of the first member
+    CborValue next() const;                                 // The value after this one, its children skipped
+
+    const char *text() const;                               // Bytes of a string, in the document, not terminated
+    std::string getString() const;                          // Text of a string or number, empty otherwise
+    bool getInt64(int64_t &value) const;                    // false unless an integer that fits
+    bool getDouble(double &value) const;                    // false unless a number
+    bool getBoolean() const { return type() == JSONBOOLEAN && *pos == 0xF5; }
+
+private:
+    const CborDocument      *document;      // nullptr for an invalid value
+    const unsigned char     *pos;           // First byte of the value
+};
+
+
+class CborDocument
+{
+public:
+    CborDocument();
+
+    bool load(const char *data, size_t length);             // false unless one well-formed value of the subset
+    bool load(const InputBuffer &input);                    // The bytes must outlive the document
+
+    CborValue root() const;
+
+private:
+    friend class CborValue;
+
+    const unsigned char     *data;          // Bytes of the document
+    size_t                  length;
+    size_t                  maxDepth;       // Deepest nesting accepted
+};
+
+
+// Function declarations
+
+bool encodeCbor(const JsonValue &value, std::string &output);
+
+std::string serialize(const CborValue &value, int indent = 0);
\ No newline at end of file
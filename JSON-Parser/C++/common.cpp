@@ -1,12 +1,41 @@
-int parseIndex      = 0;
-int tokenSize       = 0;
-bool displayData    = false;
+#include <cstddef>
+#include <cstring>
 
 
 
 // Check whether the index is invalid
 
-bool isInvalidIndex(int index, int size)
+bool isInvalidIndex(size_t index, size_t size)
 {
     return index >= size;
+}
+
+
+
+/*  Line and column, both from 1, of a byte offset in a text. Only called to
+    report an error, so the parse itself never counts lines: the line feeds
+    before the offset are found with memchr, and the column counts characters,
+    the UTF-8 continuation bytes are skipped.
+    Example: offset 5 in "[1,\n 2x]" is line 2, column 2
+*/
+
+void getLineColumn(const char *data, size_t offset, size_t &line, size_t &column)
+{
+    const char *lineStart = data;
+    const char *end = data + offset;
+    line = 1;
+
+    const char *newline;
+    while ((newline = (const char *)memchr(lineStart, '\n', end - lineStart)) != nullptr)
+    {
+        lineStart = newline + 1;
+        line++;
+    }
+
+    column = 1;
+    for (const char *pos = lineStart; pos < end; pos++)
+    {
+        if (((unsigned char)*pos & 0xC0) != 0x80)
+            column++;
+    }
 }
\ No newline at end of file
@@ -1,8 +1,34 @@
-// Globally used fields
-extern int parseIndex;
-extern int tokenSize;
-extern bool displayData;
+// Deepest nesting of objects and arrays accepted by the parsers
+const size_t DEFAULT_MAX_DEPTH = 1024;
+
+
+// Where and why a parse failed, filled in only when it does. Lines and columns
+// are not counted during the parse, getLineColumn() finds them from the offset
+
+struct ParseError
+{
+    size_t          offset = 0;     // Byte of the input where the error is
+    std::string     expected;       // What the grammar allows there
+    std::string     found;          // What is there instead, "end of input" past the last byte
+};
+
+
+// State of one parse. Nothing is shared between contexts, so documents can be
+// parsed concurrently, each thread with its own context and tokens
+
+struct ParseContext
+{
+    size_t      parseIndex  = 0;                    // Next token to consume
+    size_t      tokenSize   = 0;                    // Number of tokens
+    bool        displayData = false;                // Display the tokens and the parsing phase
+    const char  *inputData  = nullptr;              // Text the tokens point into
+    size_t      inputLength = 0;                    // Its size in bytes
+    size_t      maxDepth    = DEFAULT_MAX_DEPTH;    // Deepest nesting accepted
+    ParseError  error;                              // Set when the parse fails, stale otherwise
+};
 
 
 // Function declarations for globally used functions
-extern bool isInvalidIndex(int index, int size);
\ No newline at end of file
+extern bool isInvalidIndex(size_t index, size_t size);
+
+extern void getLineColumn(const char *data, size_t offset, size_t &line, size_t &column);
@@ -0,0 +1,374 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <unordered_map>
+
+#include "common.h"
+#include "token.h"
+#include "inputBuffer.h"
+#include "numbers.h"
+#include "unescape.h"
+#include "lexer.h"
+#include "parser.h"
+#include "arena.h"
+#include "keyTable.h"
+#include "dom.h"
+#include "patch.h"
+
+// A container whose closing bracket is not reached yet
+struct BuildFrame
+{
+    size_t      firstChild;     // Index of its first child in the pending children
+    bool        isObject;       // { or [
+    const char  *key;           // Key of the container itself, if it is a member
+    uint32_t    keyLength;
+    uint32_t    keyId;
+};
+
+
+
+// Member of an object by key, the first one if the key is repeated
+
+const JsonValue *JsonValue::find(const std::string &key) const
+{
+    if (type != JSONOBJECT)
+        return nullptr;
+
+    for (uint32_t i = 0; i < size; i++)
+    {
+        if (members[i].keyLength == key.length() && memcmp(members[i].key, key.data(), key.length()) == 0)
+            return &members[i].value;
+    }
+    return nullptr;
+}
+
+
+
+// Member of an object by key id: an integer comparison per member
+
+const JsonValue *JsonValue::findKey(uint32_t keyId) const
+{
+    if (type != JSONOBJECT || keyId == NO_KEY)
+        return nullptr;
+
+    for (uint32_t i = 0; i < size; i++)
+    {
+        if (members[i].keyId == keyId)
+            return &members[i].value;
+    }
+    return nullptr;
+}
+
+
+
+// Element of an array by position
+
+const JsonValue *JsonValue::at(size_t index) const
+{
+    if (type != JSONARRAY || index >= size)
+        return nullptr;
+    return &items[index];
+}
+
+
+
+std::string JsonValue::getString() const
+{
+    if (type != JSONSTRING && type != JSONNUMBER)
+        return "";
+    return std::string(text, size);
+}
+
+
+
+bool JsonValue::getInt64(int64_t &value) const
+{
+    return type == JSONNUMBER && parseInt64(text, text + size, value);
+}
+
+
+
+bool JsonValue::getDouble(double &value) const
+{
+    return type == JSONNUMBER && parseDouble(text, text + size, value);
+}
+
+
+
+/*  Compare two values as JSON: numbers by value (1.0 equals 1), members of
+    objects whatever their order, elements of arrays in order.
+*/
+
+bool equalValues(const JsonValue &first, const JsonValue &second)
+{
+    if (first.type != second.type)
+        return false;
+
+    switch (first.type)
+    {
+        case JSONSTRING:
+            return first.size == second.size && memcmp(first.text, second.text, first.size) == 0;
+
+        case JSONNUMBER:
+        {
+            int64_t firstInteger, secondInteger;
+            if (first.getInt64(firstInteger) && second.getInt64(secondInteger))
+                return firstInteger == secondInteger;
+            double firstNumber = 0, secondNumber = 0;
+            first.getDouble(firstNumber);
+            second.getDouble(secondNumber);
+            return firstNumber == secondNumber;
+        }
+
+        case JSONBOOLEAN:
+            return first.boolean == second.boolean;
+
+        case JSONNULL:
+            return true;
+
+        case JSONARRAY:
+            if (first.size != second.size)
+                return false;
+            for (uint32_t i = 0; i < first.size; i++)
+            {
+                if (!equalValues(first.items[i], second.items[i]))
+                    return false;
+            }
+            return true;
+
+        case JSONOBJECT:
+            if (first.size != second.size)
+                return false;
+            for (uint32_t i = 0; i < first.size; i++)
+            {
+                // Members are usually in the same order, the key is searched for only when not
+                const JsonMember &member = first.members[i];
+                const JsonMember &same = second.members[i];
+                const JsonValue *other = same.keyLength == member.keyLength && memcmp(same.key, member.key, member.keyLength) == 0
+                                         ? &same.value : second.find(std::string(member.key, member.keyLength));
+                if (other == nullptr || !equalValues(member.value, *other))
+                    return false;
+            }
+            return true;
+    }
+    return false;
+}
+
+
+
+JsonDocument::JsonDocument() : keys(nullptr), ownKeys(nullptr), patchSpace(nullptr)
+{
+    rootValue.type = JSONNULL;
+    rootValue.size = 0;
+    rootValue.text = nullptr;
+}
+
+
+
+JsonDocument::~JsonDocument()
+{
+    delete ownKeys;
+    delete patchSpace;
+}
+
+
+
+/*  Intern the keys of the documents parsed from now on: each distinct key is
+    stored once in a KeyTable and members carry its id (JsonValue::findKey()).
+    With a table, it is shared with the other documents using it, which must
+    then not be parsed at the same time, and it must outlive their values.
+    Without, the document uses a table of its own, emptied at each parse.
+    Example:
+        KeyTable keys;
+        document.internKeys(&keys);
+        document.parse(text.data(), text.size());
+        uint32_t id = keys.find("name");
+        for (uint32_t i = 0; i < document.root().size; i++)
+            document.root().items[i].findKey(id);
+*/
+
+void JsonDocument::internKeys(KeyTable *table)
+{
+    if (table == nullptr && ownKeys == nullptr)
+        ownKeys = new KeyTable();
+    keys = table != nullptr ? table : ownKeys;
+}
+
+
+
+// Move the children of a closed container from the pending list into the arena
+
+static JsonValue closeContainer(const BuildFrame &frame, std::vector <JsonMember> &pending, Arena &arena)
+{
+    JsonValue value;
+    value.size = pending.size() - frame.firstChild;
+
+    if (frame.isObject)
+    {
+        JsonMember *members = (JsonMember *)arena.allocate(value.size * sizeof(JsonMember), alignof(JsonMember));
+        std::copy(pending.begin() + frame.firstChild, pending.end(), members);
+        value.type = JSONOBJECT;
+        value.members = members;
+    }
+    else
+    {
+        JsonValue *items = (JsonValue *)arena.allocate(value.size * sizeof(JsonValue), alignof(JsonValue));
+        for (size_t i = frame.firstChild; i < pending.size(); i++)
+            items[i - frame.firstChild] = pending[i].value;
+        value.type = JSONARRAY;
+        value.items = items;
+    }
+
+    pending.resize(frame.firstChild);
+    return value;
+}
+
+
+
+/*  Parse a document into a tree of values.
+    The text is tokenized and validated by the parser, then the tree is built
+    bottom-up in one pass over the tokens: the children of the open containers
+    wait in a list and are copied into one contiguous array of the arena when
+    their closing bracket is reached. The arena is sized from the text first, so
+    a document is usually one block.
+    Example:
+        JsonDocument document;
+        if (document.parse(text.data(), text.size()))
+            document.root().find("statuses")->at(0)->find("id")->getInt64(id);
+*/
+
+bool JsonDocument::parse(const char *data, size_t length)
+{
+    arena.clear();
+    if (keys != nullptr && keys == ownKeys)
+        ownKeys->clear();
+    if (patchSpace != nullptr)
+        patchSpace->capacities.clear();
+    rootValue.type = JSONNULL;
+    rootValue.size = 0;
+    rootValue.text = nullptr;
+
+    std::vector <Token> tokens;
+    ParseContext context;
+    if (!validateJson(data, length, tokens, context))
+        return false;
+
+    // Upper bound: every string and number copied, at most 12 bytes of values per token
+    arena.reserve(length + tokens.size() * 12 + 64);
+
+    std::vector <JsonMember> pending;   // Children of the open containers, innermost last
+    std::vector <BuildFrame> frames;    // Open containers, innermost last
+    const char *key = nullptr;          // Key of the next member
+    uint32_t keyLength = 0;
+    uint32_t keyId = NO_KEY;
+    std::string unescaped;              // Keys with escapes, before they are interned
+
+    for (size_t i = 0; i < tokens.size(); i++)
+    {
+        const Token &token = tokens[i];
+        const char *text = data + token.offset;
+        JsonValue value;
+
+        switch (token.type)
+        {
+            case LEFTCURLYBRACKET:
+            case LEFTSQUAREBRACKET:
+                frames.push_back(BuildFrame{pending.size(), token.type == LEFTCURLYBRACKET, key, keyLength, keyId});
+                key = nullptr;
+                continue;
+
+            case RIGHTCURLYBRACKET:
+            case RIGHTSQUAREBRACKET:
+                {
+                    BuildFrame frame = frames.back();
+                    frames.pop_back();
+                    value = closeContainer(frame, pending, arena);
+                    key = frame.key;
+                    keyLength = frame.keyLength;
+                    keyId = frame.keyId;
+                }
+                break;
+
+            case STRINGVALUE:
+                {
+                    // An interned key is looked up in the table, only a new key is copied
+                    bool isKey = i + 1 < tokens.size() && tokens[i + 1].type == COLON;
+                    if (isKey && keys != nullptr)
+                    {
+                        const char *start = text + 1;
+                        size_t size = token.length - 2;
+                        if (memchr(start, '\\', size) != nullptr)
+                        {
+                            unescaped.resize(size);
+                            size = unescapeString(start, start + size, &unescaped[0]);
+                            start = unescaped.data();
+                        }
+                        keyId = keys->intern(start, size);
+                        key = keys->text(keyId);
+                        keyLength = keys->length(keyId);
+                        continue;
+                    }
+
+                    // Unescaping never makes a string longer, the doublequotes leave room for '\0'
+                    char *copy = (char *)arena.allocate(token.length - 1, 1);
+                    uint32_t size = unescapeString(text + 1, text + token.length - 1, copy);
+                    copy[size] = '\0';
+
+                    // A string followed by : is a key
+                    if (isKey)
+                    {
+                        key = copy;
+                        keyLength = size;
+                        keyId = NO_KEY;
+                        continue;
+                    }
+
+                    value.type = JSONSTRING;
+                    value.size = size;
+                    value.text = copy;
+                }
+                break;
+
+            case NUMBER:
+                value.type = JSONNUMBER;
+                value.size = token.length;
+                value.text = arena.copyString(text, token.length);
+                break;
+
+            case BOOLEAN:
+                value.type = JSONBOOLEAN;
+                value.size = 0;
+                value.boolean = *text == 't';
+                break;
+
+            case NULLVALUE:
+                value.type = JSONNULL;
+                value.size = 0;
+                value.text = nullptr;
+                break;
+
+            default:    // : and ,
+                continue;
+        }
+
+        if (frames.empty())
+            rootValue = value;
+        else
+        {
+            pending.push_back(JsonMember{key, keyLength, keyId, value});
+            key = nullptr;
+        }
+    }
+    return true;
+}
+
+
+
+bool JsonDocument::parse(const InputBuffer &input)
+{
+    return parse(input.data(), input.size());
+}
@@ -0,0 +1,87 @@
+// Kinds of values of a document
+
+typedef enum {
+    JSONOBJECT,
+    JSONARRAY,
+    JSONSTRING,
+    JSONNUMBER,
+    JSONBOOLEAN,
+    JSONNULL
+} jsonTypes;
+
+
+struct JsonMember;
+
+// A value of a document. The children of an object or an array are stored
+// next to each other in the arena of the document.
+
+struct JsonValue
+{
+    jsonTypes   type;
+    uint32_t    size;       // Bytes of a string or number, members of an object, elements of an array
+    union
+    {
+        const char          *text;      // String (unescaped) or number, terminated by '\0'
+        bool                boolean;    // Value of true or false
+        const JsonValue     *items;     // Elements of an array
+        const JsonMember    *members;   // Members of an object, in document order
+    };
+
+    const JsonValue *find(const std::string &key) const;    // First member with the key, nullptr if absent or not an object
+    const JsonValue *findKey(uint32_t keyId) const;         // The same by id, for documents whose keys are interned
+    const JsonValue *at(size_t index) const;                // Element of an array, nullptr if out of range or not an array
+    std::string getString() const;                          // Text of a string or number, empty otherwise
+    bool getInt64(int64_t &value) const;                    // false unless an integer number that fits
+    bool getDouble(double &value) const;                    // false unless a number
+};
+
+
+struct JsonMember
+{
+    const char  *key;           // Unescaped key, terminated by '\0'
+    uint32_t    keyLength;      // Bytes of the key
+    uint32_t    keyId;          // Id in the key table of the document, NO_KEY if keys are not interned
+    JsonValue   value;
+};
+
+
+class InputBuffer;
+class KeyTable;
+class JsonEditor;
+struct PatchSpace;
+
+// A parsed document: every value, string and child array lives in its arena
+// and stays valid until the next parse() or the end of the document
+
+class JsonDocument
+{
+public:
+    JsonDocument();
+    ~JsonDocument();
+
+    JsonDocument(const JsonDocument&) = delete;
+    JsonDocument& operator=(const JsonDocument&) = delete;
+
+    bool parse(const char *data, size_t length);        // false if the text is not valid JSON
+    bool parse(const InputBuffer &input);
+
+    void internKeys(KeyTable *table = nullptr);         // Intern the keys from the next parse on, see dom.cpp
+    const KeyTable *keyTable() const { return keys; }   // nullptr if keys are not interned
+
+    const JsonValue &root() const { return rootValue; }
+    const Arena &memory() const { return arena; }
+
+private:
+    friend class JsonEditor;    // Patches change the tree in place, see patch.cpp
+
+    Arena       arena;          // Values, child arrays and strings
+    JsonValue   rootValue;      // Outermost object or array
+    KeyTable    *keys;          // Table the keys are interned in, nullptr if they are copied into the arena
+    KeyTable    *ownKeys;       // Table of the document itself, created by internKeys()
+    PatchSpace  *patchSpace;    // Room in the child arrays grown by patches, created by the first one
+};
+
+
+// Function declarations
+
+bool equalValues(const JsonValue &first, const JsonValue &second);
\ No newline at end of file
@@ -1,58 +1,440 @@
 #include <iostream>
 #include <fstream>
 #include <vector>
+#include <string>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <thread>
+#include <iomanip>
+#include <functional>
+#include <deque>
+#include <regex>
+#include <utility>
+#include <cstddef>
+#include <fcntl.h>
+#include <unistd.h>
 
 #include "common.h"
 #include "token.h"
+#include "inputBuffer.h"
 #include "lexer.h"
 #include "parser.h"
+#include "streamParser.h"
+#include "batch.h"
+#include "ndjson.h"
+#include "arena.h"
+#include "dom.h"
+#include "writer.h"
+#include "query.h"
+#include "schema.h"
+#include "cbor.h"
+#include "patch.h"
 
 
 
-int main(int argc, char* argv[])
+/*  Validate a file with the streaming parser, reading it in chunks of chunkSize
+    bytes, so memory does not grow with the file.
+*/
+
+int validateStream(const char *fileName, size_t chunkSize)
 {
-    if (argc < 2 || argc > 3)
+    int fd = open(fileName, O_RDONLY);
+    if (fd < 0)
     {
-        std::cerr << "Usage: " << argv[0] << " <fileName> [displayData]\n";
+        std::cerr << "Error in opening file " << fileName << "\n";
         return 1;
     }
 
-    std::ifstream inputFile(argv[1]);
+    // Only validates, every event is accepted
+    JsonHandler handler;
+    bool valid = parseStream(fd, handler, chunkSize);
+    close(fd);
+
+    std::cout << (valid ? "VALID JSON\n" : "INVALID JSON\n");
+    return 0;
+}
+
+
+
+/*  Validate files and directories on a pool of threads, print the files that
+    are not valid JSON and a report of the throughput.
+*/
+
+int validateBatch(const std::vector <std::string> &paths, unsigned threads)
+{
+    std::vector <std::string> fileNames = listFiles(paths);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector <BatchResult> results = validateFiles(fileNames, threads);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
 
-    if (!inputFile.is_open())
+    size_t valid = 0, unreadable = 0, bytes = 0;
+    for (const BatchResult &result : results)
     {
-        std::cerr << "Error in opening file " << argv[1] << "\n";
+        bytes += result.bytes;
+        if (!result.opened)
+        {
+            unreadable++;
+            std::cerr << "Error in opening file " << result.fileName << "\n";
+        }
+        else if (result.valid)
+            valid++;
+        else
+            std::cout << "INVALID JSON : " << result.fileName << "\n";
+    }
+
+    double MB = bytes / (1024.0 * 1024.0);
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Files      : " << results.size() << " (" << valid << " valid, "
+              << results.size() - valid - unreadable << " invalid, " << unreadable << " unreadable)\n";
+    std::cout << "Size       : " << MB << " MB\n";
+    std::cout << "Threads    : " << threads << "\n";
+    std::cout << "Time       : " << elapsed.count() * 1000 << " ms\n";
+    std::cout << "Throughput : " << (elapsed.count() > 0 ? MB / elapsed.count() : 0) << " MB/s, "
+              << (elapsed.count() > 0 ? results.size() / elapsed.count() : 0) << " files/s\n";
+    return 0;
+}
+
+
+
+/*  Validate a newline-delimited JSON file on a pool of threads and list the
+    lines that are not valid JSON. With emit the valid records are written to
+    the standard output in their original order instead, and everything else
+    goes to the standard error.
+*/
+
+int validateNdjson(const char *fileName, unsigned threads, bool emit)
+{
+    InputBuffer input;
+    if (!input.mapFile(fileName))
+    {
+        std::cerr << "Error in opening file " << fileName << "\n";
         return 1;
     }
 
-    // For displaying the tokens and parsing phase
-    if (argc == 3)
-        displayData = argv[2];
+    std::ostream &report = emit ? std::cerr : std::cout;
 
-    std::vector <Token> tokens;
+    auto start = std::chrono::steady_clock::now();
+    NdjsonSummary summary = processNdjson(input.data(), input.size(), threads, false, [&](const NdjsonRecord &record)
+    {
+        if (!record.valid)
+            report << "INVALID JSON : line " << record.line << "\n";
+        else if (emit)
+            std::cout.write(record.text, record.length) << "\n";
+    });
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
 
-    // Perform lexical analysis
-    lexer(inputFile, tokens);
+    double MB = input.size() / (1024.0 * 1024.0);
+    report << std::fixed << std::setprecision(2);
+    report << "Lines      : " << summary.lines << " (" << summary.records - summary.invalid << " valid, "
+           << summary.invalid << " invalid, " << summary.lines - summary.records << " blank)\n";
+    report << "Size       : " << MB << " MB\n";
+    report << "Threads    : " << threads << "\n";
+    report << "Time       : " << elapsed.count() * 1000 << " ms\n";
+    report << "Throughput : " << (elapsed.count() > 0 ? MB / elapsed.count() : 0) << " MB/s\n";
+    return 0;
+}
 
-    inputFile.close();
 
-    tokenSize = tokens.size();
 
-    displayTokens(tokens);
+/*  Print the matches of a JSONPath expression (starting with $) or of a JSON
+    Pointer, one per line in compact JSON. With stream the file is read in
+    chunks and only the matched values are kept, instead of building its tree.
+*/
+
+int runQuery(const char *expression, const char *fileName, bool stream)
+{
+    JsonQuery query;
+    bool compiled = expression[0] == '$' ? query.compilePath(expression) : query.compilePointer(expression);
+    if (!compiled)
+    {
+        std::cerr << "Invalid query " << expression << "\n";
+        return 1;
+    }
 
-    // Check if invalid JSON found in lexical analysis
-    if (tokenSize > 0 && tokens[tokenSize - 1].type == UNKNOWN)
+    bool valid;
+    if (stream)
+    {
+        int fd = open(fileName, O_RDONLY);
+        if (fd < 0)
+        {
+            std::cerr << "Error in opening file " << fileName << "\n";
+            return 1;
+        }
+        valid = queryStream(fd, query, [](const std::string &json) { std::cout << json << "\n"; });
+        close(fd);
+    }
+    else
     {
+        InputBuffer input;
+        if (!input.mapFile(fileName))
+        {
+            std::cerr << "Error in opening file " << fileName << "\n";
+            return 1;
+        }
+
+        JsonDocument document;
+        valid = document.parse(input);
+        for (const JsonValue *match : valid ? query.evaluate(document.root()) : std::vector <const JsonValue*>())
+            std::cout << serialize(*match) << "\n";
+    }
+
+    if (!valid)
         std::cout << "INVALID JSON\n";
+    return 0;
+}
+
+
+
+/*  Validate a file against a JSON Schema during a single streaming pass,
+    which stops at the first value that does not conform to the schema.
+*/
+
+int validateSchema(const char *schemaFileName, const char *fileName)
+{
+    InputBuffer schemaText;
+    JsonSchema schema;
+    if (!schemaText.mapFile(schemaFileName))
+    {
+        std::cerr << "Error in opening file " << schemaFileName << "\n";
+        return 1;
+    }
+    if (!schema.load(schemaText.data(), schemaText.size()))
+    {
+        std::cerr << "Invalid schema " << schemaFileName << "\n";
+        return 1;
     }
+
+    int fd = open(fileName, O_RDONLY);
+    if (fd < 0)
+    {
+        std::cerr << "Error in opening file " << fileName << "\n";
+        return 1;
+    }
+
+    SchemaValidator validator(schema);
+    bool valid = parseStream(fd, validator);
+    close(fd);
+
+    if (validator.hasError())
+        std::cout << "SCHEMA VIOLATION at \"" << validator.getError().path << "\" : " << validator.getError().message << "\n";
     else
+        std::cout << (valid ? "VALID JSON\n" : "INVALID JSON\n");
+    return 0;
+}
+
+
+
+/*  Convert a JSON file to CBOR, which is read back in place by CborDocument
+    without lexing. The text is validated by building its tree first.
+*/
+
+int convertToCbor(const char *fileName, const char *cborFileName)
+{
+    InputBuffer input;
+    if (!input.mapFile(fileName))
     {
-        // perform parsing
-        if (!parser(tokens))
-            std::cout << "INVALID JSON\n";
-        else
-            std::cout << "VALID JSON\n";
+        std::cerr << "Error in opening file " << fileName << "\n";
+        return 1;
+    }
+
+    JsonDocument document;
+    if (!document.parse(input))
+    {
+        std::cout << "INVALID JSON\n";
+        return 0;
+    }
+
+    std::string cbor;
+    if (!encodeCbor(document.root(), cbor))
+    {
+        std::cerr << "A number of " << fileName << " is too large for CBOR\n";
+        return 1;
+    }
+
+    std::ofstream output(cborFileName, std::ios::binary);
+    if (!output.write(cbor.data(), cbor.size()))
+    {
+        std::cerr << "Error in writing file " << cborFileName << "\n";
+        return 1;
+    }
+    std::cout << "VALID JSON, " << input.size() << " bytes written as " << cbor.size() << " bytes of CBOR\n";
+    return 0;
+}
+
+
+
+// Print a CBOR file (of the subset written by --to-cbor) as compact JSON
+
+int printCbor(const char *cborFileName)
+{
+    InputBuffer input;
+    if (!input.mapFile(cborFileName))
+    {
+        std::cerr << "Error in opening file " << cborFileName << "\n";
+        return 1;
+    }
+
+    CborDocument document;
+    if (!document.load(input))
+        std::cout << "INVALID CBOR\n";
+    else
+        std::cout << serialize(document.root()) << "\n";
+    return 0;
+}
+
+
+
+/*  Apply a JSON Patch, or with merge a JSON Merge Patch, to a file and print
+    the document as compact JSON. A JSON Patch is applied entirely or not at
+    all: when an operation fails, it is reported and the document is unchanged.
+*/
+
+int runPatch(const char *fileName, const char *patchFileName, bool merge)
+{
+    InputBuffer input, patchInput;
+    if (!input.mapFile(fileName))
+    {
+        std::cerr << "Error in opening file " << fileName << "\n";
+        return 1;
+    }
+    if (!patchInput.mapFile(patchFileName))
+    {
+        std::cerr << "Error in opening file " << patchFileName << "\n";
+        return 1;
     }
 
+    JsonDocument document, patch;
+    if (!document.parse(input) || !patch.parse(patchInput))
+    {
+        std::cout << "INVALID JSON\n";
+        return 0;
+    }
+
+    PatchError error;
+    if (merge)
+        applyMergePatch(document, patch.root());
+    else if (!applyPatch(document, patch.root(), error))
+        std::cout << "PATCH FAILED at operation " << error.operation << " : " << error.message << "\n";
+
+    std::cout << serialize(document.root()) << "\n";
+    return 0;
+}
+
+
+
+// Print the JSON Patch that turns the first file into the second
+int printDiff(const char *fileName, const char *targetFileName)
+{
+    InputBuffer input, targetInput;
+    if (!input.mapFile(fileName))
+    {
+        std::cerr << "Error in opening file " << fileName << "\n";
+        return 1;
+    }
+    if (!targetInput.mapFile(targetFileName))
+    {
+        std::cerr << "Error in opening file " << targetFileName << "\n";
+        return 1;
+    }
+
+    JsonDocument document, target;
+    if (!document.parse(input) || !target.parse(targetInput))
+        std::cout << "INVALID JSON\n";
+    else
+        std::cout << createPatch(document.root(), target.root()) << "\n";
+    return 0;
+}
+
+
+
+int main(int argc, char* argv[])
+{
+    // --patch <fileName> <patchFileName>, --merge-patch <fileName> <patchFileName>
+    if (argc == 4 && (strcmp(argv[1], "--patch") == 0 || strcmp(argv[1], "--merge-patch") == 0))
+        return runPatch(argv[2], argv[3], argv[1][2] == 'm');
+
+    // --diff <fileName> <targetFileName>
+    if (argc == 4 && strcmp(argv[1], "--diff") == 0)
+        return printDiff(argv[2], argv[3]);
+
+    // --to-cbor <fileName> <cborFileName>
+    if (argc == 4 && strcmp(argv[1], "--to-cbor") == 0)
+        return convertToCbor(argv[2], argv[3]);
+
+    // --from-cbor <cborFileName>
+    if (argc == 3 && strcmp(argv[1], "--from-cbor") == 0)
+        return printCbor(argv[2]);
+
+    // --schema <schemaFileName> <fileName>
+    if (argc == 4 && strcmp(argv[1], "--schema") == 0)
+        return validateSchema(argv[2], argv[3]);
+
+    // --query[=stream] <expression> <fileName>
+    if (argc == 4 && (strcmp(argv[1], "--query") == 0 || strcmp(argv[1], "--query=stream") == 0))
+        return runQuery(argv[2], argv[3], argv[1][7] == '=');
+
+    // --ndjson[=threads] <fileName> [--emit]
+    if ((argc == 3 || (argc == 4 && strcmp(argv[3], "--emit") == 0)) &&
+        strncmp(argv[1], "--ndjson", 8) == 0 && (argv[1][8] == '\0' || argv[1][8] == '='))
+    {
+        long threads = argv[1][8] == '=' ? atol(argv[1] + 9) : std::thread::hardware_concurrency();
+        return validateNdjson(argv[2], threads > 0 ? threads : 1, argc == 4);
+    }
+
+    // --batch[=threads] <fileOrDirectory>...
+    if (argc >= 3 && strncmp(argv[1], "--batch", 7) == 0 && (argv[1][7] == '\0' || argv[1][7] == '='))
+    {
+        long threads = argv[1][7] == '=' ? atol(argv[1] + 8) : std::thread::hardware_concurrency();
+        return validateBatch(std::vector <std::string>(argv + 2, argv + argc), threads > 0 ? threads : 1);
+    }
+
+    // --stream[=chunkSize] <fileName>
+    if (argc == 3 && strncmp(argv[1], "--stream", 8) == 0 && (argv[1][8] == '\0' || argv[1][8] == '='))
+    {
+        long chunkSize = argv[1][8] == '=' ? atol(argv[1] + 9) : 64 * 1024;
+        return validateStream(argv[2], chunkSize > 0 ? chunkSize : 1);
+    }
+
+    if (argc < 2 || argc > 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " <fileName> [displayData]\n";
+        std::cerr << "       " << argv[0] << " --stream[=chunkSize] <fileName>\n";
+        std::cerr << "       " << argv[0] << " --batch[=threads] <fileOrDirectory>...\n";
+        std::cerr << "       " << argv[0] << " --ndjson[=threads] <fileName> [--emit]\n";
+        std::cerr << "       " << argv[0] << " --query[=stream] <expression> <fileName>\n";
+        std::cerr << "       " << argv[0] << " --schema <schemaFileName> <fileName>\n";
+        std::cerr << "       " << argv[0] << " --to-cbor <fileName> <cborFileName>\n";
+        std::cerr << "       " << argv[0] << " --from-cbor <cborFileName>\n";
+        std::cerr << "       " << argv[0] << " --patch <fileName> <patchFileName>\n";
+        std::cerr << "       " << argv[0] << " --merge-patch <fileName> <patchFileName>\n";
+        std::cerr << "       " << argv[0] << " --diff <fileName> <targetFileName>\n";
+        return 1;
+    }
+
+    // The whole file is mapped and scanned as one buffer
+    InputBuffer input;
+
+    if (!input.mapFile(argv[1]))
+    {
+        std::cerr << "Error in opening file " << argv[1] << "\n";
+        return 1;
+    }
+
+    // For displaying the tokens and parsing phase
+    ParseContext context;
+    if (argc == 3)
+        context.displayData = argv[2];
+
+    std::vector <Token> tokens;
+
+    // Perform lexical analysis and parsing
+    if (!validateJson(input.data(), input.size(), tokens, context))
+        std::cout << "INVALID JSON at " << getErrorMessage(context) << "\n";
+    else
+        std::cout << "VALID JSON\n";
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,103 @@
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "inputBuffer.h"
+
+
+
+// Empty buffer
+
+InputBuffer::InputBuffer() : begin(""), length(0), mapping(nullptr)
+{
+}
+
+
+
+// Buffer over memory owned by the caller
+
+InputBuffer::InputBuffer(const char *data, size_t length) : begin(data), length(length), mapping(nullptr)
+{
+}
+
+
+
+InputBuffer::~InputBuffer()
+{
+    release();
+}
+
+
+
+// Unmap the file, if any, and become empty
+
+void InputBuffer::release()
+{
+    if (mapping != nullptr)
+        munmap(mapping, length);
+
+    mapping = nullptr;
+    contents.clear();
+    begin = "";
+    length = 0;
+}
+
+
+
+/*  Map a file into memory.
+    The whole file is then one contiguous buffer, so tokens are never split at a
+    line or chunk boundary and no byte is copied before the lexer reads it.
+    Files that cannot be mapped (pipes, /dev/stdin) are read into memory instead.
+*/
+
+bool InputBuffer::mapFile(const std::string &fileName)
+{
+    release();
+
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) == 0 && S_ISREG(fileStat.st_mode))
+    {
+        // mmap does not accept empty files, an empty buffer is the same thing
+        if (fileStat.st_size == 0)
+        {
+            close(fd);
+            return true;
+        }
+
+        void *address = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address != MAP_FAILED)
+        {
+            // The lexer reads the file once from start to end
+            madvise(address, fileStat.st_size, MADV_SEQUENTIAL);
+            close(fd);
+
+            mapping = address;
+            begin = (const char *)address;
+            length = fileStat.st_size;
+            return true;
+        }
+    }
+
+    // Read the file instead
+    char chunk[64 * 1024];
+    ssize_t bytesRead;
+    while ((bytesRead = read(fd, chunk, sizeof(chunk))) > 0)
+        contents.append(chunk, bytesRead);
+    close(fd);
+
+    if (bytesRead < 0)
+    {
+        contents.clear();
+        return false;
+    }
+
+    begin = contents.data();
+    length = contents.size();
+    return true;
+}
@@ -0,0 +1,26 @@
+// Contiguous JSON text the lexer scans with a pointer: a memory-mapped file
+// or a span of memory owned by the caller
+
+class InputBuffer
+{
+public:
+    InputBuffer();
+    InputBuffer(const char *data, size_t length);   // Caller-owned span, must outlive the buffer
+    ~InputBuffer();
+
+    InputBuffer(const InputBuffer&) = delete;
+    InputBuffer& operator=(const InputBuffer&) = delete;
+
+    bool mapFile(const std::string &fileName);      // Map a file, pipes and other non-mappable files are read instead
+
+    const char *data() const { return begin; }
+    size_t size() const { return length; }
+
+private:
+    const char  *begin;         // First byte of the text
+    size_t      length;         // Number of bytes of the text
+    void        *mapping;       // Address returned by mmap, nullptr if nothing is mapped
+    std::string contents;       // Holds the text of files that could not be mapped
+
+    void release();
+};
@@ -0,0 +1,112 @@
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+#include "arena.h"
+#include "keyTable.h"
+
+const size_t INITIAL_SLOTS = 64;
+
+
+
+KeyTable::KeyTable() : slots(INITIAL_SLOTS, Slot{0, NO_KEY}), strings(4096)
+{
+}
+
+
+
+// FNV-1a hash of a key, computed once per lookup and kept in the slot
+
+static uint32_t hashKey(const char *text, size_t length)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++)
+        hash = (hash ^ (unsigned char)text[i]) * 16777619u;
+    return hash;
+}
+
+
+
+// Slot holding the key, or the empty slot where it would go
+
+size_t KeyTable::locate(const char *text, size_t length, uint32_t hash) const
+{
+    size_t mask = slots.size() - 1;
+    for (size_t slot = hash & mask; ; slot = (slot + 1) & mask)
+    {
+        const Slot &entry = slots[slot];
+        if (entry.id == NO_KEY)
+            return slot;
+        if (entry.hash == hash && keys[entry.id].length == length && memcmp(keys[entry.id].text, text, length) == 0)
+            return slot;
+    }
+}
+
+
+
+// Double the slots, the stored hashes place the keys again without reading their text
+
+void KeyTable::grow()
+{
+    std::vector <Slot> old(slots.size() * 2, Slot{0, NO_KEY});
+    old.swap(slots);
+
+    size_t mask = slots.size() - 1;
+    for (const Slot &entry : old)
+    {
+        if (entry.id == NO_KEY)
+            continue;
+
+        size_t slot = entry.hash & mask;
+        while (slots[slot].id != NO_KEY)
+            slot = (slot + 1) & mask;
+        slots[slot] = entry;
+    }
+}
+
+
+
+uint32_t KeyTable::intern(const char *text, size_t length)
+{
+    uint32_t hash = hashKey(text, length);
+    size_t slot = locate(text, length, hash);
+    if (slots[slot].id != NO_KEY)
+        return slots[slot].id;
+
+    uint32_t id = keys.size();
+    keys.push_back(Key{strings.copyString(text, length), (uint32_t)length});
+    slots[slot] = Slot{hash, id};
+
+    if (keys.size() * 2 > slots.size())
+        grow();
+    return id;
+}
+
+
+
+uint32_t KeyTable::find(const char *text, size_t length) const
+{
+    return slots[locate(text, length, hashKey(text, length))].id;
+}
+
+
+
+// Bytes taken by the keys, their text and the slots
+
+size_t KeyTable::memoryUsed() const
+{
+    return keys.capacity() * sizeof(Key) + slots.capacity() * sizeof(Slot) + strings.bytesUsed();
+}
+
+
+
+// Forget every key, the ids and texts handed out become invalid
+
+void KeyTable::clear()
+{
+    keys.clear();
+    slots.assign(INITIAL_SLOTS, Slot{0, NO_KEY});
+    strings.clear();
+}
\ No newline at end of file
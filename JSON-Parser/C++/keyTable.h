@@ -0,0 +1,44 @@
+// Interning of object keys: each distinct key is stored once and gets a small
+// integer id, so the records of a document (or of several documents) share the
+// text of their keys and members can be matched by comparing ids.
+
+const uint32_t NO_KEY = 0xFFFFFFFF;     // Id of a key that is not in the table
+
+class KeyTable
+{
+public:
+    KeyTable();
+
+    KeyTable(const KeyTable&) = delete;
+    KeyTable& operator=(const KeyTable&) = delete;
+
+    uint32_t intern(const char *text, size_t length);       // Id of the key, added if new
+    uint32_t find(const char *text, size_t length) const;   // Id of the key, NO_KEY if absent
+    uint32_t find(const std::string &text) const { return find(text.data(), text.size()); }
+
+    const char *text(uint32_t id) const { return keys[id].text; }      // Terminated by '\0', valid until clear()
+    uint32_t length(uint32_t id) const { return keys[id].length; }
+    size_t size() const { return keys.size(); }
+    size_t memoryUsed() const;
+    void clear();
+
+private:
+    struct Key
+    {
+        const char  *text;      // Copy in the arena
+        uint32_t    length;
+    };
+
+    struct Slot
+    {
+        uint32_t    hash;       // Hash of the key, compared before the text
+        uint32_t    id;         // NO_KEY for an empty slot
+    };
+
+    std::vector <Key>   keys;       // Indexed by id
+    std::vector <Slot>  slots;      // Open addressing with linear probing, a power of 2 at most half full
+    Arena               strings;    // Text of the keys
+
+    size_t locate(const char *text, size_t length, uint32_t hash) const;
+    void grow();
+};
\ No newline at end of file
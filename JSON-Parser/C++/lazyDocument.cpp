@@ -0,0 +1,287 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+#include "common.h"
+#include "token.h"
+#include "numbers.h"
+#include "unescape.h"
+#include "structural.h"
+#include "utf8.h"
+#include "lexer.h"
+#include "parser.h"
+#include "arena.h"
+#include "dom.h"
+#include "lazyDocument.h"
+
+
+
+JsonLazyDocument::JsonLazyDocument() : data(""), length(0)
+{
+}
+
+
+
+/*  Index the text, nothing is validated or copied yet.
+    With fullValidation the whole text is also checked by the lexer and the
+    parser, as JsonDocument does, and load() fails for invalid JSON. Without it
+    only what the caller reads is checked.
+*/
+
+bool JsonLazyDocument::load(const char *data, size_t length, bool fullValidation)
+{
+    this->data = data;
+    this->length = length;
+
+    if (!findStructuralIndexes(data, length, indexes))
+    {
+        indexes.clear();
+        return false;
+    }
+
+    if (fullValidation)
+    {
+        std::vector <Token> tokens;
+        ParseContext context;
+        if (!validateJson(data, length, tokens, context))
+        {
+            indexes.clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+
+
+// The outermost value, which must be an object or an array
+
+JsonLazyValue JsonLazyDocument::root() const
+{
+    if (charAt(0) != '{' && charAt(0) != '[')
+        return JsonLazyValue();
+    return JsonLazyValue(this, 0);
+}
+
+
+
+// The value starting at index, invalid if a bracket, comma or colon is there instead
+
+JsonLazyValue JsonLazyDocument::valueAt(uint32_t index) const
+{
+    char ch = charAt(index);
+    if (ch == '\0' || ch == '}' || ch == ']' || ch == ',' || ch == ':')
+        return JsonLazyValue();
+    return JsonLazyValue(this, index);
+}
+
+
+
+/*  Position in the index after the value at index.
+    An object or array is skipped by counting brackets over the index alone:
+    strings hold no positions, so their content is never looked at.
+    Returns the size of the index if the brackets are not balanced.
+*/
+
+uint32_t JsonLazyDocument::skipValue(uint32_t index) const
+{
+    char ch = charAt(index);
+    if (ch != '{' && ch != '[')
+        return index + 1;
+
+    size_t depth = 0;
+    for (; index < indexes.size(); index++)
+    {
+        switch (data[indexes[index]])
+        {
+            case '{':
+            case '[':
+                depth++;
+                break;
+
+            case '}':
+            case ']':
+                if (--depth == 0)
+                    return index + 1;
+                break;
+        }
+    }
+    return indexes.size();
+}
+
+
+
+// Check that a token ending at pos is followed by whitespace, a comma, a closing bracket or the end of the text
+
+static bool endsToken(const char *pos, const char *end)
+{
+    return pos == end || isClosingBracketOrComma(*pos) || isWhitespace(*pos);
+}
+
+
+
+jsonTypes JsonLazyValue::type() const
+{
+    if (!isValid())
+        return JSONNULL;
+
+    switch (document->charAt(index))
+    {
+        case '{': return JSONOBJECT;
+        case '[': return JSONARRAY;
+        case '"': return JSONSTRING;
+        case 't':
+        case 'f': return JSONBOOLEAN;
+        case 'n': return JSONNULL;
+        default:  return JSONNUMBER;
+    }
+}
+
+
+
+/*  Member of an object by key.
+    The keys are checked and compared one after the other, the values of the
+    other members are skipped without being read.
+*/
+
+JsonLazyValue JsonLazyValue::find(const std::string &key) const
+{
+    if (!isValid() || document->charAt(index) != '{')
+        return JsonLazyValue();
+
+    const char *end = document->data + document->length;
+    uint32_t member = index + 1;
+    if (document->charAt(member) == '}')
+        return JsonLazyValue();
+
+    while (document->charAt(member) == '"')
+    {
+        const char *keyStart = document->data + document->indexes[member];
+        const char *keyEnd = keyStart;
+        if (!scanString(keyEnd, end) || document->charAt(member + 1) != ':')
+            return JsonLazyValue();
+
+        // Keys without escapes are compared in place
+        const char *text = keyStart + 1;
+        size_t textLength = keyEnd - keyStart - 2;
+        bool matches;
+        if (memchr(text, '\\', textLength) == nullptr)
+            matches = textLength == key.length() && memcmp(text, key.data(), textLength) == 0;
+        else
+            matches = unescapeString(text, text + textLength) == key;
+
+        uint32_t value = member + 2;
+        if (matches)
+            return document->valueAt(value);
+
+        uint32_t next = document->skipValue(value);
+        if (document->charAt(next) != ',')
+            return JsonLazyValue();
+        member = next + 1;
+    }
+    return JsonLazyValue();
+}
+
+
+
+// Element of an array by position, the elements before it are skipped
+
+JsonLazyValue JsonLazyValue::at(size_t position) const
+{
+    if (!isValid() || document->charAt(index) != '[')
+        return JsonLazyValue();
+
+    uint32_t element = index + 1;
+    for (size_t i = 0; i < position; i++)
+    {
+        element = document->skipValue(element);
+        if (document->charAt(element) != ',')
+            return JsonLazyValue();
+        element++;
+    }
+    return document->valueAt(element);
+}
+
+
+
+bool JsonLazyValue::getString(std::string &value) const
+{
+    if (!isValid() || document->charAt(index) != '"')
+        return false;
+
+    const char *end = document->data + document->length;
+    const char *start = document->data + document->indexes[index];
+    const char *pos = start;
+    if (!scanString(pos, end) || !endsToken(pos, end) || !validateUtf8(start + 1, pos - start - 2))
+        return false;
+
+    value = unescapeString(start + 1, pos - 1);
+    return true;
+}
+
+
+
+bool JsonLazyValue::getInt64(int64_t &value) const
+{
+    if (!isValid())
+        return false;
+
+    const char *end = document->data + document->length;
+    const char *start = document->data + document->indexes[index];
+    const char *pos = scanNumber(start, end);
+    return pos != nullptr && endsToken(pos, end) && parseInt64(start, pos, value);
+}
+
+
+
+bool JsonLazyValue::getDouble(double &value) const
+{
+    if (!isValid())
+        return false;
+
+    const char *end = document->data + document->length;
+    const char *start = document->data + document->indexes[index];
+    const char *pos = scanNumber(start, end);
+    return pos != nullptr && endsToken(pos, end) && parseDouble(start, pos, value);
+}
+
+
+
+// Type of the literal (true, false, null) at a position, UNKNOWN for anything else
+
+static tokenTypes getLiteralType(const char *start, const char *end)
+{
+    const char *pos = start;
+    while (pos < end && *pos >= 'a' && *pos <= 'z')
+        pos++;
+    if (!endsToken(pos, end))
+        return UNKNOWN;
+
+    tokenTypes type = getValueType(start, pos);
+    return type == BOOLEAN || type == NULLVALUE ? type : UNKNOWN;
+}
+
+
+
+bool JsonLazyValue::getBoolean(bool &value) const
+{
+    if (!isValid())
+        return false;
+
+    const char *start = document->data + document->indexes[index];
+    if (getLiteralType(start, document->data + document->length) != BOOLEAN)
+        return false;
+
+    value = *start == 't';
+    return true;
+}
+
+
+
+bool JsonLazyValue::isNull() const
+{
+    return isValid() && getLiteralType(document->data + document->indexes[index], document->data + document->length) == NULLVALUE;
+}
@@ -0,0 +1,51 @@
+// On-demand access: a document is only indexed when loaded (structural.cpp),
+// values are located and checked when the caller navigates to them, and the
+// subtrees passed over are skipped by matching brackets in the index.
+
+class JsonLazyDocument;
+
+// Position of a value in a lazy document, invalid if it was not found or is malformed
+
+class JsonLazyValue
+{
+public:
+    JsonLazyValue() : document(nullptr), index(0) {}
+    JsonLazyValue(const JsonLazyDocument *document, uint32_t index) : document(document), index(index) {}
+
+    bool isValid() const { return document != nullptr; }
+    jsonTypes type() const;                                 // From the first character, JSONNULL if invalid
+
+    JsonLazyValue find(const std::string &key) const;      // First member with the key
+    JsonLazyValue at(size_t index) const;                   // Element of an array
+
+    bool getString(std::string &value) const;               // Each getter checks the value it reads,
+    bool getInt64(int64_t &value) const;                    // false if it is malformed or of another type
+    bool getDouble(double &value) const;
+    bool getBoolean(bool &value) const;
+    bool isNull() const;
+
+private:
+    const JsonLazyDocument  *document;      // nullptr for an invalid value
+    uint32_t                index;          // Position of the value in the structural index
+};
+
+
+class JsonLazyDocument
+{
+public:
+    JsonLazyDocument();
+
+    bool load(const char *data, size_t length, bool fullValidation = false);   // The text must outlive the document
+    JsonLazyValue root() const;
+
+private:
+    friend class JsonLazyValue;
+
+    const char              *data;          // Text of the document
+    size_t                  length;         // Bytes of the text
+    std::vector <uint32_t>  indexes;        // Positions of the structural characters and token starts
+
+    char charAt(uint32_t index) const { return index < indexes.size() ? data[indexes[index]] : '\0'; }
+    JsonLazyValue valueAt(uint32_t index) const;
+    uint32_t skipValue(uint32_t index) const;
+};
@@ -1,10 +1,20 @@
 #include <iostream>
 #include <vector>
 #include <fstream>
-#include <regex>
+#include <cstring>
+#include <cstdint>
+#include <cstdio>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "common.h"
 #include "token.h"
+#include "inputBuffer.h"
+#include "numbers.h"
+#include "structural.h"
+#include "utf8.h"
 #include "lexer.h"
 
 
@@ -52,38 +62,48 @@ std::string getTokenType(tokenTypes option)
 
 // Add a token to the tokens vector
 
-void AddToken (std::vector <Token> &tokens, tokenTypes type, std::string value)
+void AddToken (std::vector <Token> &tokens, tokenTypes type, uint32_t offset, uint32_t length)
 {
-    Token token;
-    token.type = type;
-    token.value = value;
-    tokens.push_back(token);
+    tokens.push_back(Token{type, offset, length});
 }
 
 
 
-// Check whether the string is a valid number
+// Copy the characters of a token out of the input text
 
-bool isNumber(std::string input)
+std::string getTokenValue(const char *data, const Token &token)
 {
-    // Regular expression to match valid numbers
-    std::regex numberPattern("^[-+]?(0|([1-9]\\d*\\.?\\d*)|0?\\.\\d+)([eE][-+]?\\d+)?$");
+    return std::string(data + token.offset, token.length);
+}
+
+
+
+// Check whether the text is a valid number (RFC 8259)
+
+bool isNumber(const char *pos, const char *end)
+{
+    return scanNumber(pos, end) == end;
+}
 
-    // Check if the input matches the pattern
-    return std::regex_match(input, numberPattern);
+
+
+bool isNumber(std::string input)
+{
+    return isNumber(input.data(), input.data() + input.length());
 }
 
 
 
 // Check whether the value is a number, boolean, null
 
-tokenTypes getValueType(std::string str)
+tokenTypes getValueType(const char *pos, const char *end)
 {
-    if (str == "true" || str == "false")
+    size_t length = end - pos;
+    if ((length == 4 && memcmp(pos, "true", 4) == 0) || (length == 5 && memcmp(pos, "false", 5) == 0))
         return BOOLEAN;
-    else if (str == "null")
+    else if (length == 4 && memcmp(pos, "null", 4) == 0)
         return NULLVALUE;
-    else if (isNumber(str))
+    else if (isNumber(pos, end))
         return NUMBER;
     else
         return UNKNOWN;
@@ -91,6 +111,13 @@ tokenTypes getValueType(std::string str)
 
 
 
+tokenTypes getValueType(std::string str)
+{
+    return getValueType(str.data(), str.data() + str.length());
+}
+
+
+
 // Check whether the character is a closing bracket or a comma
 
 bool isClosingBracketOrComma(char ch)
@@ -139,16 +166,16 @@ bool isControlCharacter(char ch)
 
 //  Displaying the tokens created in lexical analysis
 
-void displayTokens(std::vector <Token> &tokens)
+void displayTokens(std::vector <Token> &tokens, ParseContext &context)
 {
-    if (!displayData)
+    if (!context.displayData)
         return;
 
     std::cout << "Tokenization:\n";
     std::cout << "-------------------------------\n";
     for (auto &token: tokens)
     {
-        std::cout << getTokenType(token.type) << " : " << token.value << "\n";
+        std::cout << getTokenType(token.type) << " : " << getTokenValue(context.inputData, token) << "\n";
     }
     std::cout << "-------------------------------\n\n";
 }
@@ -199,132 +226,314 @@ bool isValidString(std::string &str)
 }
 
 
-// Perform lexical analysis
+/*  Scan a string starting at its opening doublequote.
+    Moves pos after the closing doublequote and returns true, or stops at the
+    offending character and returns false if the string is not terminated,
+    contains a control character or an invalid escape.
+*/
 
-void lexer(std::ifstream &file, std::vector <Token> &tokens)
+bool scanString(const char *&pos, const char *end)
 {
-    std::string line;
-    while (getline(file, line))
+    pos++;  // skip "
+    while (pos < end)
     {
-        int index = 0;
-        while (index < line.length())
+#ifdef __SSE2__
+        // Skip 16 plain characters at a time, stop at the first ", \ or control character
+        if (end - pos >= 16)
         {
-            // Ignore white spaces at the beginining and end of th tokens
-            if (isspace(line[index]))
+            __m128i chunk = _mm_loadu_si128((const __m128i *)pos);
+            __m128i special = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('"')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\\'))),
+                _mm_or_si128(_mm_cmpeq_epi8(_mm_max_epu8(chunk, _mm_set1_epi8(0x1F)), _mm_set1_epi8(0x1F)),
+                             _mm_cmpeq_epi8(chunk, _mm_set1_epi8(0x7F))));
+            int mask = _mm_movemask_epi8(special);
+            if (mask == 0)
             {
-                index++;
+                pos += 16;
                 continue;
             }
+            pos += __builtin_ctz(mask);
+        }
+#endif
+        char ch = *pos;
+        if (ch == '"')
+        {
+            pos++;
+            return true;
+        }
+
+        if (ch == '\\')    // backslash
+        {
+            pos++;
+            if (pos == end)
+                return false;
+
+            if (*pos == 'u')
+            {
+                // Unicode escape sequence (\uXXXX)
+                for (int j = 0; j < 4; j++)
+                {
+                    pos++;
+                    if (pos == end || !isxdigit((unsigned char)*pos))
+                        return false;
+                }
+            }
+            else if (!isValidEscapeCharacterForJSON(*pos))
+                return false;
+        }
+        else if (isControlCharacter(ch))
+            return false;
+
+        pos++;
+    }
+    return false;
+}
+
+
+
+// Check whether the character is JSON whitespace (RFC 8259): space, tab, line feed, carriage return
+
+bool isWhitespace(char ch)
+{
+    return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r';
+}
+
+
+
+/*  Add the token that starts at pos.
+    Returns the position after the token, or nullptr once an UNKNOWN token
+    has been added.
+*/
+
+static const char *lexToken(const char *data, const char *pos, const char *end, std::vector <Token> &tokens)
+{
+    switch (*pos)
+    {
+        case '{':
+            AddToken(tokens, LEFTCURLYBRACKET, pos - data, 1);
+            break;
+
+        case '}':
+            AddToken(tokens, RIGHTCURLYBRACKET, pos - data, 1);
+            break;
+
+        case '[':
+            AddToken(tokens, LEFTSQUAREBRACKET, pos - data, 1);
+            break;
+
+        case ']':
+            AddToken(tokens, RIGHTSQUAREBRACKET, pos - data, 1);
+            break;
+
+        case '(':
+            AddToken(tokens, LEFTROUNDBRACKET, pos - data, 1);
+            break;
+
+        case ')':
+            AddToken(tokens, RIGHTROUNDBRACKET, pos - data, 1);
+            break;
+
+        case ':':
+            AddToken(tokens, COLON, pos - data, 1);
+            break;
+
+        case ',':
+            AddToken(tokens, COMMA, pos - data, 1);
+            break;
+
+        case '"':
+            {
+                // Check for String values
+                const char *stringStart = pos;
+                if (!scanString(pos, end))
+                {
+                    AddToken(tokens, UNKNOWN, stringStart - data, (pos < end ? pos + 1 : end) - stringStart);
+                    return nullptr;
+                }
+
+                AddToken(tokens, STRINGVALUE, stringStart - data, pos - stringStart);
+            }
+            return pos;
+
+        default:
+            {
+                // Numbers are scanned directly, they end at the first character
+                // that cannot continue them
+                const char *valueEnd = (*pos == '-' || isdigit((unsigned char)*pos)) ? scanNumber(pos, end) : nullptr;
+                if (valueEnd != nullptr && (valueEnd == end || isClosingBracketOrComma(*valueEnd) || isWhitespace(*valueEnd)))
+                {
+                    AddToken(tokens, NUMBER, pos - data, valueEnd - pos);
+                    return valueEnd;
+                }
+
+                // Check for Boolean and NULL values
+                valueEnd = pos;
+                while (valueEnd < end && !isClosingBracketOrComma(*valueEnd) && !isWhitespace(*valueEnd))
+                    valueEnd++;
+
+                // Check whether the value is a number, boolean, null
+                tokenTypes valueType = getValueType(pos, valueEnd);
+                AddToken(tokens, valueType, pos - data, valueEnd - pos);
+
+                if (valueType == UNKNOWN)
+                    return nullptr;
+                return valueEnd;
+            }
+    }
+    return pos + 1;    // read next character
+}
+
+
+
+/*  Perform lexical analysis of a contiguous buffer in two stages.
+    Stage 1 (structural.cpp) finds where the tokens start with SIMD instructions,
+    stage 2 jumps from one start to the next and records each token as an offset
+    and a length in the buffer, so whitespace is skipped 64 bytes at a time and
+    no characters are copied. The buffer must outlive the tokens.
+    Before both, the whole text is checked to be UTF-8 (utf8.cpp).
+*/
+
+void lexer(const char *data, size_t length, std::vector <Token> &tokens)
+{
+    const char *pos = data;
+    const char *end = data + length;
+
+    // Offsets are 32-bit, larger inputs are rejected, and the text must be UTF-8
+    std::vector <uint32_t> indexes;
+    if (!validateUtf8(data, length) || !findStructuralIndexes(data, length, indexes))
+    {
+        AddToken(tokens, UNKNOWN, 0, 0);
+        return;
+    }
+
+    tokens.reserve(tokens.size() + indexes.size());
+    for (uint32_t index : indexes)
+    {
+        // Positions inside the previous token, e.g. in invalid text, are skipped
+        if (data + index < pos)
+            continue;
 
-            switch(line[index])
+        pos = lexToken(data, data + index, end, tokens);
+        if (pos == nullptr)
+            return;
+    }
+}
+
+
+
+// Perform lexical analysis of a memory-mapped file or an in-memory span
+
+void lexer(const InputBuffer &input, std::vector <Token> &tokens)
+{
+    lexer(input.data(), input.size(), tokens);
+}
+
+
+
+/*  Text of the input as shown in an error message: in single quotes, cut
+    after 32 bytes, with control characters written as \xNN.
+    Example: describeText("tru ", 3) is 'tru'
+*/
+
+std::string describeText(const char *text, size_t length)
+{
+    const size_t MAX_SHOWN = 32;
+
+    std::string description = "'";
+    for (size_t i = 0; i < length && i < MAX_SHOWN; i++)
+    {
+        if (isControlCharacter(text[i]))
+        {
+            char hex[8];
+            snprintf(hex, sizeof(hex), "\\x%02X", (unsigned char)text[i]);
+            description += hex;
+        }
+        else
+            description += text[i];
+    }
+    return description + (length > MAX_SHOWN ? "...'" : "'");
+}
+
+
+
+// Number of bytes of the UTF-8 character starting with the byte given
+
+static size_t getCharacterLength(char ch)
+{
+    unsigned char byte = ch;
+    return byte >= 0xF0 ? 4 : byte >= 0xE0 ? 3 : byte >= 0xC0 ? 2 : 1;
+}
+
+
+
+/*  Locate and describe the error in an UNKNOWN token, after the lexer stopped
+    on it. A string is scanned again to find the character that ends it too
+    early, an empty token at offset 0 means the text as a whole was rejected
+    (not UTF-8, or too large for 32-bit offsets). Anything else is reported as
+    the whole token, error.expected is then left as the parser set it.
+*/
+
+void describeInvalidToken(const char *data, size_t length, const Token &token, ParseError &error)
+{
+    error.offset = token.offset;
+
+    if (token.length == 0)
+    {
+        size_t invalid = findInvalidUtf8(data, length);
+        if (invalid < length)
+        {
+            char byte[8];
+            snprintf(byte, sizeof(byte), "0x%02X", (unsigned char)data[invalid]);
+            error.offset = invalid;
+            error.expected = "UTF-8 text";
+            error.found = std::string("byte ") + byte;
+        }
+        else
+        {
+            error.expected = "at most 4 GB of text";
+            error.found = std::to_string(length) + " bytes";
+        }
+        return;
+    }
+
+    if (data[token.offset] != '"')
+    {
+        error.found = describeText(data + token.offset, token.length);
+        return;
+    }
+
+    const char *pos = data + token.offset + 1;
+    const char *end = data + length;
+    while (pos < end && *pos != '"')
+    {
+        if (*pos == '\\')
+        {
+            size_t escapeLength = pos + 1 < end && pos[1] == 'u' ? 6 : 2;
+            for (size_t i = 1; i < escapeLength && pos + i < end; i++)
             {
-                case '{':
-                    AddToken(tokens, LEFTCURLYBRACKET, "{");
-                    break;
-
-                case '}':
-                    AddToken(tokens, RIGHTCURLYBRACKET, "}");
-                    break;
-
-                case '[':
-                    AddToken(tokens, LEFTSQUAREBRACKET, "[");
-                    break;
-
-                case ']':
-                    AddToken(tokens, RIGHTSQUAREBRACKET, "]");
-                    break;
-
-                case '(':
-                    AddToken(tokens, LEFTROUNDBRACKET, "(");
-                    break;
-
-                case ')':
-                    AddToken(tokens, RIGHTROUNDBRACKET, ")");
-                    break;
-
-                case ':':
-                    AddToken(tokens, COLON, ":");
-                    break;
-
-                case ',':
-                    AddToken(tokens, COMMA, ",");
-                    break;
-
-                case '"':
-                    {
-                        // Check for String values
-                        std::string str = "";
-                        bool strEndsWithDoubleQuotes = false;
-
-                        str += line[index]; // adding " to str
-                        index++;
-
-                        while (index < line.length())
-                        {
-                            if (line[index] == '\\')    // backslash
-                            {
-                                str += line[index]; // adding backslash to str
-                                index++;
-                                if (index < line.length())
-                                {
-                                    str += line[index];
-                                    index++;
-                                }
-                                continue;
-                            }
-                            else if (isControlCharacter(line[index]))
-                            {
-                                str += line[index]; // add control character
-                                break;
-                            }
-
-                            if (line[index] == '"')
-                            {
-                                str += line[index]; // adding " to str
-                                // used to check whether the string
-                                // has ended with a doublequote
-                                strEndsWithDoubleQuotes = true;
-                                break;
-                            }
-                            str += line[index];
-                            index++;
-                        }
-
-                        if (isValidString(str) && strEndsWithDoubleQuotes)
-                            AddToken(tokens, STRINGVALUE, str);
-                        else
-                        {
-                            AddToken(tokens, UNKNOWN, str);
-                            return;
-                        }
-                    }
-                    break;
-
-                default:
-                    {
-                        // Check for Number, Boolean and NULL values
-                        std::string str = "";
-                        while (index < line.length() && !isClosingBracketOrComma(line[index]))
-                        {
-                            if (isspace(line[index]))
-                                break;
-
-                            str += line[index];
-                            index++;
-                        }
-                        
-                        // Check whether the value is a number, boolean, null
-                        tokenTypes valueType = getValueType(str);
-                        AddToken(tokens, valueType, str);
-
-                        if (valueType == UNKNOWN)
-                            return;
-
-                        if (index < line.length() && isClosingBracketOrComma(line[index]))
-                            index--;
-                    }
+                bool valid = i == 1 ? pos[1] == 'u' || isValidEscapeCharacterForJSON(pos[1]) : isxdigit((unsigned char)pos[i]);
+                if (!valid)
+                {
+                    error.offset = pos + i - data;
+                    error.expected = i == 1 ? "an escape character (\" \\ / b f n r t u)" : "a hexadecimal digit";
+                    error.found = describeText(pos + i, getCharacterLength(pos[i]));
+                    return;
+                }
             }
-            index++;    // read next character
+            pos += escapeLength;
         }
+        else if (isControlCharacter(*pos))
+        {
+            error.offset = pos - data;
+            error.expected = "a character of a string, control characters are escaped";
+            error.found = describeText(pos, 1);
+            return;
+        }
+        else
+            pos++;
     }
-}
\ No newline at end of file
+
+    error.offset = length;
+    error.expected = "'\"' to end the string";
+    error.found = "end of input";
+}
@@ -2,20 +2,40 @@
 
 std::string getTokenType(tokenTypes option);
 
-void AddToken (std::vector <Token> &tokens, tokenTypes type, std::string value);
+void AddToken (std::vector <Token> &tokens, tokenTypes type, uint32_t offset, uint32_t length);
+
+std::string getTokenValue(const char *data, const Token &token);
+
+bool isNumber(const char *pos, const char *end);
 
 bool isNumber(std::string input);
 
+tokenTypes getValueType(const char *pos, const char *end);
+
 tokenTypes getValueType(std::string str);
 
 bool isClosingBracketOrComma(char ch);
 
+bool isWhitespace(char ch);
+
 bool isValidEscapeCharacterForJSON(char ch);
 
 bool isControlCharacter(char ch);
 
-void displayTokens(std::vector <Token> &tokens);
+void displayTokens(std::vector <Token> &tokens, ParseContext &context);
 
 bool isValidString(std::string &str);
 
-void lexer(std::ifstream &file, std::vector <Token> &tokens);
\ No newline at end of file
+bool scanString(const char *&pos, const char *end);
+
+class InputBuffer;
+
+void lexer(const char *data, size_t length, std::vector <Token> &tokens);
+
+void lexer(const InputBuffer &input, std::vector <Token> &tokens);
+
+std::string describeText(const char *text, size_t length);
+
+struct ParseError;
+
+void describeInvalidToken(const char *data, size_t length, const Token &token, ParseError &error);
\ No newline at end of file
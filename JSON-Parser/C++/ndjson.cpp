@@ -0,0 +1,148 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <memory>
+#include <functional>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+#include "common.h"
+#include "token.h"
+#include "inputBuffer.h"
+#include "lexer.h"
+#include "parser.h"
+#include "arena.h"
+#include "dom.h"
+#include "batch.h"
+#include "ndjson.h"
+
+
+
+// Lines of the text given to one worker, always ending after a newline or at the end of the text
+
+struct NdjsonChunk
+{
+    const char                                  *begin;
+    const char                                  *end;
+    size_t                                      lines = 0;  // Lines in the chunk, blank ones included
+    std::vector <NdjsonRecord>                  records;    // Line numbers counted from 0 in the chunk
+    std::vector <std::unique_ptr <JsonDocument>> documents; // Values of the valid records, when built
+};
+
+
+
+// Check whether a line holds nothing but whitespace
+
+static bool isBlank(const char *pos, const char *end)
+{
+    for (; pos < end; pos++)
+    {
+        if (!isWhitespace(*pos))
+            return false;
+    }
+    return true;
+}
+
+
+
+/*  Parse each line of a chunk on its own: lexed and parsed with the tokens and
+    context of the worker, or built into a JsonDocument when values are asked for.
+    Each line has its own offsets, so a file larger than 4 GiB is no problem.
+*/
+
+static void processChunk(NdjsonChunk &chunk, bool buildValues, std::vector <Token> &tokens, ParseContext &context)
+{
+    size_t line = 0;
+    for (const char *pos = chunk.begin; pos < chunk.end; line++)
+    {
+        const char *newline = (const char *) memchr(pos, '\n', chunk.end - pos);
+        const char *lineEnd = newline != nullptr ? newline : chunk.end;
+
+        if (!isBlank(pos, lineEnd))
+        {
+            NdjsonRecord record = {line, pos, (size_t) (lineEnd - pos), false, nullptr};
+            if (buildValues)
+            {
+                std::unique_ptr <JsonDocument> document(new JsonDocument());
+                record.valid = document->parse(pos, record.length);
+                if (record.valid)
+                {
+                    record.value = &document->root();
+                    chunk.documents.push_back(std::move(document));
+                }
+            }
+            else
+                record.valid = validateJson(pos, record.length, tokens, context);
+
+            chunk.records.push_back(record);
+        }
+        pos = lineEnd + 1;
+    }
+    chunk.lines = line;
+}
+
+
+
+/*  Process newline-delimited JSON on a pool of threads.
+    The text is taken a window of threads * NDJSON_WINDOW chunks at a time: the
+    chunks are parsed in parallel, then their records are numbered and handed to
+    the callback in order before the next window starts. With buildValues each
+    valid record comes with its value, as JsonDocument::parse() builds it.
+
+    Example:
+        InputBuffer input;
+        input.mapFile("logs.ndjson");
+        NdjsonSummary summary = processNdjson(input.data(), input.size(), 8, false, [](const NdjsonRecord &record)
+        {
+            if (!record.valid)
+                std::cout << "INVALID JSON : line " << record.line << "\n";
+        });
+*/
+
+NdjsonSummary processNdjson(const char *data, size_t length, unsigned threads, bool buildValues, const NdjsonCallback &callback)
+{
+    NdjsonSummary summary;
+    threads = std::max(1u, threads);
+
+    const char *pos = data;
+    const char *end = data + length;
+    while (pos < end)
+    {
+        // Cut the window into chunks, each ending after the first newline past NDJSON_CHUNK_SIZE bytes
+        std::vector <NdjsonChunk> chunks;
+        while (chunks.size() < threads * NDJSON_WINDOW && pos < end)
+        {
+            NdjsonChunk chunk;
+            chunk.begin = pos;
+            chunk.end = pos + std::min(NDJSON_CHUNK_SIZE, (size_t) (end - pos));
+            if (chunk.end < end)
+            {
+                const char *newline = (const char *) memchr(chunk.end - 1, '\n', end - (chunk.end - 1));
+                chunk.end = newline != nullptr ? newline + 1 : end;
+            }
+            pos = chunk.end;
+            chunks.push_back(std::move(chunk));
+        }
+
+        runWorkers(chunks.size(), threads, [&](size_t i, std::vector <Token> &tokens, ParseContext &context)
+        {
+            processChunk(chunks[i], buildValues, tokens, context);
+        });
+
+        for (NdjsonChunk &chunk : chunks)
+        {
+            for (NdjsonRecord &record : chunk.records)
+            {
+                record.line += summary.lines + 1;
+                summary.records++;
+                if (!record.valid)
+                    summary.invalid++;
+                callback(record);
+            }
+            summary.lines += chunk.lines;
+        }
+    }
+    return summary;
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+// Newline-delimited JSON (JSON Lines): one document per line. The text is cut at
+// newlines into chunks that worker threads parse in parallel, then the records
+// are handed to the caller in the order of the text, one window of chunks at a
+// time, so memory stays bounded however large the file is.
+
+struct JsonValue;
+
+// A non-blank line
+
+struct NdjsonRecord
+{
+    size_t          line;       // Line number, from 1
+    const char      *text;      // The line, without its newline
+    size_t          length;     // Bytes of the line
+    bool            valid;      // VALID JSON
+    const JsonValue *value;     // Parsed value when values are built and the line is valid, else nullptr
+};
+
+// Totals over the whole text
+
+struct NdjsonSummary
+{
+    size_t lines    = 0;        // Lines, blank ones included
+    size_t records  = 0;        // Non-blank lines
+    size_t invalid  = 0;        // Records that are not valid JSON
+};
+
+// Called on the calling thread for each record, in the order of the text.
+// The record and its value are only valid during the call
+
+using NdjsonCallback = std::function<void(const NdjsonRecord &record)>;
+
+const size_t NDJSON_CHUNK_SIZE = 1024 * 1024;   // Bytes given to a worker at a time (rounded up to a newline)
+const size_t NDJSON_WINDOW = 4;                 // Chunks per thread parsed before the records are handed over
+
+
+// Function declarations
+
+NdjsonSummary processNdjson(const char *data, size_t length, unsigned threads, bool buildValues, const NdjsonCallback &callback);
\ No newline at end of file
@@ -0,0 +1,408 @@
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include "numbers.h"
+
+
+
+/*  Scan a number as defined by RFC 8259.
+    Format: -? (0 | [1-9][0-9]*) (.[0-9]+)? ([eE][+-]?[0-9]+)?
+
+    Returns the position after the number, or nullptr if the text at pos is not
+    a number. Leading zeroes, a leading +, a leading or trailing . are rejected.
+*/
+
+const char *scanNumber(const char *pos, const char *end)
+{
+    if (pos < end && *pos == '-')
+        pos++;
+
+    // Integer part
+    if (pos == end)
+        return nullptr;
+    if (*pos == '0')
+        pos++;
+    else if (*pos >= '1' && *pos <= '9')
+    {
+        while (pos < end && *pos >= '0' && *pos <= '9')
+            pos++;
+    }
+    else
+        return nullptr;
+
+    // Fraction
+    if (pos < end && *pos == '.')
+    {
+        pos++;
+        if (pos == end || *pos < '0' || *pos > '9')
+            return nullptr;
+        while (pos < end && *pos >= '0' && *pos <= '9')
+            pos++;
+    }
+
+    // Exponent
+    if (pos < end && (*pos == 'e' || *pos == 'E'))
+    {
+        pos++;
+        if (pos < end && (*pos == '+' || *pos == '-'))
+            pos++;
+        if (pos == end || *pos < '0' || *pos > '9')
+            return nullptr;
+        while (pos < end && *pos >= '0' && *pos <= '9')
+            pos++;
+    }
+
+    return pos;
+}
+
+
+
+// Convert an integer without fraction and exponent, false if it does not fit in an int64_t
+
+bool parseInt64(const char *pos, const char *end, int64_t &value)
+{
+    if (scanNumber(pos, end) != end)
+        return false;
+
+    bool negative = *pos == '-';
+    if (negative)
+        pos++;
+
+    // Accumulate as unsigned, -9223372036854775808 is one more than the largest positive value
+    uint64_t limit = negative ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX;
+    uint64_t result = 0;
+    for (; pos < end; pos++)
+    {
+        if (*pos < '0' || *pos > '9')
+            return false;   // fraction or exponent
+
+        uint64_t digit = *pos - '0';
+        if (result > (limit - digit) / 10)
+            return false;
+        result = result * 10 + digit;
+    }
+
+    value = negative ? (int64_t)(0 - result) : (int64_t)result;
+    return true;
+}
+
+
+
+/*  128-bit approximations of the powers of five 5^q for q in [-342, 308], the
+    table of the Eisel-Lemire algorithm. Each entry is normalized so its most
+    significant bit is set: 5^q is truncated for q >= 0; for q < 0, 2^b / 5^-q is
+    rounded up and truncated, so the product never underestimates.
+    The table is computed once with a small big integer instead of being stored.
+*/
+
+const int SMALLEST_POWER_OF_TEN = -342;
+const int LARGEST_POWER_OF_TEN  = 308;
+
+struct PowersOfFive
+{
+    uint64_t entries[2 * (LARGEST_POWER_OF_TEN - SMALLEST_POWER_OF_TEN + 1)];
+
+    PowersOfFive()
+    {
+        // Little endian 32-bit limbs
+        std::vector <uint32_t> number;
+
+        // Non-negative powers: 5^q shifted so its top bit is bit 127
+        number.assign(1, 1);
+        for (int q = 0; q <= LARGEST_POWER_OF_TEN; q++)
+        {
+            if (q > 0)
+                multiply(number, 5);
+            store(q, truncate(number, bitLength(number), false));
+        }
+
+        // Negative powers: floor(2^b / 5^k) + 1, where 2^z >= 5^k and b = z + 127 or 2z + 128
+        std::vector <uint32_t> power(1, 1);
+        for (int k = 1; k <= -SMALLEST_POWER_OF_TEN; k++)
+        {
+            multiply(power, 5);
+            int z = bitLength(power);   // 5^k is never a power of two
+            int b = k <= 27 ? z + 127 : 2 * z + 128;
+
+            number.assign(b / 32 + 1, 0);
+            number[b / 32] = 1u << (b % 32);
+            for (int i = 0; i < k; i++)
+                divide(number, 5);
+
+            store(-k, truncate(number, bitLength(number), true));
+        }
+    }
+
+    static void multiply(std::vector <uint32_t> &number, uint32_t factor)
+    {
+        uint64_t carry = 0;
+        for (uint32_t &limb : number)
+        {
+            uint64_t product = (uint64_t)limb * factor + carry;
+            limb = (uint32_t)product;
+            carry = product >> 32;
+        }
+        if (carry != 0)
+            number.push_back((uint32_t)carry);
+    }
+
+    static void divide(std::vector <uint32_t> &number, uint32_t divisor)
+    {
+        uint64_t remainder = 0;
+        for (size_t i = number.size(); i-- > 0;)
+        {
+            uint64_t current = (remainder << 32) | number[i];
+            number[i] = (uint32_t)(current / divisor);
+            remainder = current % divisor;
+        }
+        while (number.size() > 1 && number.back() == 0)
+            number.pop_back();
+    }
+
+    static int bitLength(const std::vector <uint32_t> &number)
+    {
+        return (int)(number.size() - 1) * 32 + (32 - __builtin_clz(number.back()));
+    }
+
+    static uint32_t bits(const std::vector <uint32_t> &number, int position, int count)
+    {
+        // count bits starting at position, positions below zero read as zero
+        uint32_t result = 0;
+        for (int i = count - 1; i >= 0; i--)
+        {
+            int bit = position + i;
+            result <<= 1;
+            if (bit >= 0 && bit / 32 < (int)number.size())
+                result |= (number[bit / 32] >> (bit % 32)) & 1;
+        }
+        return result;
+    }
+
+    // Top 128 bits of the number, (number + 1) when roundUp
+    struct Value128 { uint64_t high, low; };
+
+    static Value128 truncate(std::vector <uint32_t> number, int length, bool roundUp)
+    {
+        if (roundUp)
+        {
+            for (uint32_t &limb : number)
+            {
+                if (++limb != 0)
+                    break;
+            }
+            if (number.back() == 0)
+                number.push_back(1);
+            length = bitLength(number);
+        }
+
+        Value128 value;
+        int lowest = length - 128;
+        value.high = ((uint64_t)bits(number, lowest + 96, 32) << 32) | bits(number, lowest + 64, 32);
+        value.low  = ((uint64_t)bits(number, lowest + 32, 32) << 32) | bits(number, lowest, 32);
+        return value;
+    }
+
+    void store(int q, Value128 value)
+    {
+        entries[2 * (q - SMALLEST_POWER_OF_TEN)] = value.high;
+        entries[2 * (q - SMALLEST_POWER_OF_TEN) + 1] = value.low;
+    }
+};
+
+static const PowersOfFive &powersOfFive()
+{
+    static const PowersOfFive table;
+    return table;
+}
+
+
+
+// Exact powers of ten for the fast path
+static const double EXACT_POWERS_OF_TEN[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+
+
+/*  Eisel-Lemire: the double nearest to w * 10^q, for w != 0 with at most 19 digits.
+    The 64-bit w is multiplied by the 128-bit approximation of 5^q; the top bits of
+    the product give the mantissa and the binary exponent follows from q.
+    Returns the IEEE 754 bit pattern (without the sign).
+*/
+
+static uint64_t computeFloat(int64_t q, uint64_t w)
+{
+    const int MANTISSA_BITS  = 52;
+    const int MINIMUM_EXPONENT = -1023;
+    const int INFINITE_POWER = 0x7FF;
+
+    if (w == 0 || q < SMALLEST_POWER_OF_TEN)
+        return 0;
+    if (q > LARGEST_POWER_OF_TEN)
+        return (uint64_t)INFINITE_POWER << MANTISSA_BITS;
+
+    int leadingZeroes = __builtin_clzll(w);
+    w <<= leadingZeroes;
+
+    // Product with the first 64 bits of 5^q, the next 64 bits only matter when the
+    // bits below the mantissa (and rounding bit) are all ones
+    const uint64_t *power = &powersOfFive().entries[2 * (q - SMALLEST_POWER_OF_TEN)];
+    unsigned __int128 product = (unsigned __int128)w * power[0];
+    uint64_t high = (uint64_t)(product >> 64);
+    uint64_t low = (uint64_t)product;
+
+    const uint64_t PRECISION_MASK = UINT64_MAX >> (MANTISSA_BITS + 3);
+    if ((high & PRECISION_MASK) == PRECISION_MASK)
+    {
+        uint64_t secondHigh = (uint64_t)(((unsigned __int128)w * power[1]) >> 64);
+        low += secondHigh;
+        if (secondHigh > low)
+            high++;
+    }
+
+    int upperBit = (int)(high >> 63);
+    int shift = upperBit + 64 - MANTISSA_BITS - 3;
+    uint64_t mantissa = high >> shift;
+
+    // floor(log2(10^q)) + 63, exact over the supported range
+    int32_t power2 = (int32_t)((((152170 + 65536) * q) >> 16) + 63) + upperBit - leadingZeroes - MINIMUM_EXPONENT;
+
+    if (power2 <= 0)
+    {
+        // Subnormal
+        if (-power2 + 1 >= 64)
+            return 0;
+        mantissa >>= -power2 + 1;
+        mantissa += (mantissa & 1);
+        mantissa >>= 1;
+        power2 = mantissa < ((uint64_t)1 << MANTISSA_BITS) ? 0 : 1;
+        return (mantissa & ~((uint64_t)1 << MANTISSA_BITS)) | ((uint64_t)power2 << MANTISSA_BITS);
+    }
+
+    // Exactly halfway between two doubles: round to even (only possible for small q)
+    if (low <= 1 && q >= -4 && q <= 23 && (mantissa & 3) == 1 && (mantissa << shift) == high)
+        mantissa &= ~(uint64_t)1;
+
+    mantissa += (mantissa & 1);
+    mantissa >>= 1;
+    if (mantissa >= ((uint64_t)2 << MANTISSA_BITS))
+    {
+        mantissa = (uint64_t)1 << MANTISSA_BITS;
+        power2++;
+    }
+    mantissa &= ~((uint64_t)1 << MANTISSA_BITS);
+
+    if (power2 >= INFINITE_POWER)
+        return (uint64_t)INFINITE_POWER << MANTISSA_BITS;
+
+    return mantissa | ((uint64_t)power2 << MANTISSA_BITS);
+}
+
+
+
+/*  Convert a number to the nearest double.
+    The digits are read into a 64-bit integer w and an exponent q (value = w * 10^q):
+        - w < 2^53 and |q| <= 22: both are exact doubles, one multiplication or division
+          rounds correctly (Clinger's fast path)
+        - up to 19 significant digits: Eisel-Lemire
+        - more digits: strtod
+*/
+
+bool parseDouble(const char *pos, const char *end, double &value)
+{
+    if (scanNumber(pos, end) != end)
+        return false;
+
+    const char *start = pos;
+    bool negative = *pos == '-';
+    if (negative)
+        pos++;
+
+    uint64_t w = 0;
+    int digits = 0;
+    int64_t q = 0;
+
+    // Integer part, leading zeroes are not significant
+    for (; pos < end && *pos >= '0' && *pos <= '9'; pos++)
+    {
+        if (digits > 0 || *pos != '0')
+        {
+            w = w * 10 + (*pos - '0');
+            digits++;
+        }
+    }
+
+    // Fraction, every digit lowers the exponent
+    if (pos < end && *pos == '.')
+    {
+        for (pos++; pos < end && *pos >= '0' && *pos <= '9'; pos++)
+        {
+            if (digits > 0 || *pos != '0')
+            {
+                w = w * 10 + (*pos - '0');
+                digits++;
+            }
+            q--;
+        }
+    }
+
+    // Exponent, clamped: anything beyond the table is zero or infinity anyway
+    if (pos < end && (*pos == 'e' || *pos == 'E'))
+    {
+        pos++;
+        bool negativeExponent = *pos == '-';
+        if (*pos == '-' || *pos == '+')
+            pos++;
+
+        int64_t exponent = 0;
+        for (; pos < end; pos++)
+        {
+            if (exponent < 100000)
+                exponent = exponent * 10 + (*pos - '0');
+        }
+        q += negativeExponent ? -exponent : exponent;
+    }
+
+    if (digits > 19)
+    {
+        // w overflowed, the exact decimal is needed to round correctly
+        std::string number(start, end);
+        value = strtod(number.c_str(), nullptr);
+        return true;
+    }
+
+    if (w <= ((uint64_t)1 << 53) && q >= -22 && q <= 22)
+    {
+        double result = (double)w;
+        if (q < 0)
+            result /= EXACT_POWERS_OF_TEN[-q];
+        else
+            result *= EXACT_POWERS_OF_TEN[q];
+        value = negative ? -result : result;
+        return true;
+    }
+
+    uint64_t bits = computeFloat(q, w);
+    if (negative)
+        bits |= (uint64_t)1 << 63;
+    memcpy(&value, &bits, sizeof(value));
+    return true;
+}
+
+
+
+bool parseInt64(const std::string &number, int64_t &value)
+{
+    return parseInt64(number.data(), number.data() + number.length(), value);
+}
+
+
+
+bool parseDouble(const std::string &number, double &value)
+{
+    return parseDouble(number.data(), number.data() + number.length(), value);
+}
@@ -0,0 +1,11 @@
+// Function declarations
+
+const char *scanNumber(const char *pos, const char *end);
+
+bool parseInt64(const char *pos, const char *end, int64_t &value);
+
+bool parseDouble(const char *pos, const char *end, double &value);
+
+bool parseInt64(const std::string &number, int64_t &value);
+
+bool parseDouble(const std::string &number, double &value);
@@ -1,17 +1,22 @@
 #include <iostream>
 #include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
 
 #include "common.h"
 #include "token.h"
+#include "lexer.h"
 #include "parser.h"
 
 
 
 // Displaying the start of the parsing phase
 
-void displayParsingStart()
+void displayParsingStart(ParseContext &context)
 {
-    if (!displayData)
+    if (!context.displayData)
         return;
 
     std::cout << "Parsing:\n";
@@ -22,9 +27,9 @@ void displayParsingStart()
 
 // Displaying the end of the parsing phase
 
-void displayParsingEnd()
+void displayParsingEnd(ParseContext &context)
 {
-    if (!displayData)
+    if (!context.displayData)
         return;
 
     std::cout << "-------------------------------\n\n";
@@ -34,31 +39,12 @@ void displayParsingEnd()
 
 // Displaying the tokens consumed in the parsing phase
 
-void displayParsing(std::vector <Token> &tokens)
+void displayParsing(std::vector <Token> &tokens, ParseContext &context)
 {
-    if (!displayData)
+    if (!context.displayData)
         return;
 
-    std::cout << tokens[parseIndex].value << "\n";
-}
-
-
-
-// Consume a token (simply increment the index)
-
-void eat(std::vector <Token> &tokens)
-{
-    displayParsing(tokens);
-    parseIndex++;
-}
-
-
-
-// Check whether the token type is a closing tag
-
-bool isClosingToken(tokenTypes type)
-{
-    return type == RIGHTCURLYBRACKET || type == RIGHTSQUAREBRACKET;
+    std::cout << getTokenValue(context.inputData, tokens[context.parseIndex]) << "\n";
 }
 
 
@@ -75,229 +61,294 @@ bool isValidDataType(tokenTypes type)
 
 
 
-/*  Parse the left curly bracket.
-    Format: {}
+/*  The parser is a table-driven state machine: the state says what may come
+    next, the class of the token picks an action in the table, and the open
+    objects and arrays are kept on an explicit stack instead of the call stack,
+    so the nesting depth is bounded by maxDepth and never by the thread stack.
 
-            { "key" : value }
+    States and what they accept:
 
-            { "key1" : value, "key2" : value }
-
-            { "key1" : [...JSON...] }
-
-            { "key1" : {...JSON...} }
-
-
-                {
-               / \
-              /   \
-            Key     }
-             |
-             |
-             :
-             |
-             |
-       ---------------
-       |     |       |
-       |     |       |
-       {     [    DataType
-                    / \
-                   /   \
-                  ,     }
-                 / \
-                /   \
-               [     {
+        EXPECTROOT          {  [
+        EXPECTVALUE         {  [  value                 (after : and after , in an array)
+        EXPECTVALUEOREND    {  [  value  ]              (after [)
+        EXPECTKEY           "key"                       (after , in an object)
+        EXPECTKEYOREND      "key"  }                    (after {)
+        EXPECTCOLON         :
+        EXPECTCOMMAOREND    ,  }  ]                     (after a value)
+        EXPECTNOTHING                                   (after the root)
 */
 
-bool parseLeftCurlyBracket(std::vector <Token> &tokens)
+typedef enum {
+    EXPECTROOT,
+    EXPECTVALUE,
+    EXPECTVALUEOREND,
+    EXPECTKEY,
+    EXPECTKEYOREND,
+    EXPECTCOLON,
+    EXPECTCOMMAOREND,
+    EXPECTNOTHING,
+    PARSERSTATECOUNT
+} parserStates;
+
+typedef enum {
+    OPENOBJECTCLASS,        // {
+    CLOSEOBJECTCLASS,       // }
+    OPENARRAYCLASS,         // [
+    CLOSEARRAYCLASS,        // ]
+    COLONCLASS,             // :
+    COMMACLASS,             // ,
+    STRINGCLASS,            // string, a key or a value
+    SCALARCLASS,            // number, true, false, null
+    OTHERCLASS,             // anything else
+    TOKENCLASSCOUNT
+} tokenClasses;
+
+typedef enum {
+    REJECT,
+    OPENOBJECT,             // push an object, then expect a key or }
+    OPENARRAY,              // push an array, then expect a value or ]
+    CLOSEOBJECT,            // pop an object
+    CLOSEARRAY,             // pop an array
+    READKEY,                // then expect :
+    READCOLON,              // then expect a value
+    READVALUE,              // then expect , or a closing bracket
+    READCOMMA               // then expect a key or a value, depending on the container
+} parserActions;
+
+// Class of each token type, in the order of tokenTypes_et
+
+static const unsigned char TOKENCLASSES[] = {
+    OPENOBJECTCLASS, CLOSEOBJECTCLASS, OPENARRAYCLASS, CLOSEARRAYCLASS,
+    OTHERCLASS, OTHERCLASS, OTHERCLASS,                 // ( ) .
+    COLONCLASS, COMMACLASS,
+    OTHERCLASS,                                         // "
+    STRINGCLASS, SCALARCLASS, SCALARCLASS, SCALARCLASS,
+    OTHERCLASS                                          // UNKNOWN
+};
+
+// Action for each state and token class
+
+static const unsigned char ACTIONS[PARSERSTATECOUNT][TOKENCLASSCOUNT] = {
+    //                   {           }            [          ]           :          ,          string     scalar     other
+    /* ROOT        */ { OPENOBJECT, REJECT,      OPENARRAY, REJECT,     REJECT,    REJECT,    REJECT,    REJECT,    REJECT },
+    /* VALUE       */ { OPENOBJECT, REJECT,      OPENARRAY, REJECT,     REJECT,    REJECT,    READVALUE, READVALUE, REJECT },
+    /* VALUEOREND  */ { OPENOBJECT, REJECT,      OPENARRAY, CLOSEARRAY, REJECT,    REJECT,    READVALUE, READVALUE, REJECT },
+    /* KEY         */ { REJECT,     REJECT,      REJECT,    REJECT,     REJECT,    REJECT,    READKEY,   REJECT,    REJECT },
+    /* KEYOREND    */ { REJECT,     CLOSEOBJECT, REJECT,    REJECT,     REJECT,    REJECT,    READKEY,   REJECT,    REJECT },
+    /* COLON       */ { REJECT,     REJECT,      REJECT,    REJECT,     READCOLON, REJECT,    REJECT,    REJECT,    REJECT },
+    /* COMMAOREND  */ { REJECT,     CLOSEOBJECT, REJECT,    CLOSEARRAY, REJECT,    READCOMMA, REJECT,    REJECT,    REJECT },
+    /* NOTHING     */ { REJECT,     REJECT,      REJECT,    REJECT,     REJECT,    REJECT,    REJECT,    REJECT,    REJECT }
+};
+
+
+
+// Class of a token type, OTHERCLASS for values outside tokenTypes_et
+
+static tokenClasses getTokenClass(tokenTypes type)
 {
-    eat(tokens);    // eat {
+    if (type < 0 || type >= (tokenTypes) sizeof(TOKENCLASSES))
+        return OTHERCLASS;
 
-    if (isInvalidIndex(parseIndex, tokenSize))
-        return false;
+    return (tokenClasses) TOKENCLASSES[type];
+}
 
-    if (tokens[parseIndex].type == STRINGVALUE)
-    {
-        eat(tokens);    // eat key
 
-        if (isInvalidIndex(parseIndex, tokenSize))
-            return false;
 
-        if (tokens[parseIndex].type != COLON)
-            return false;
+/*  Fill in context.error after the parse stopped at token, or ran out of
+    tokens when token is end. The loop of parser() keeps nothing for it: the
+    state and the open containers tell what was expected, the action the table
+    gives for the token tells why it was not taken.
+*/
 
-        eat(tokens);    // eat :
+static void setParseError(const Token *token, const Token *end, parserStates state,
+                          const std::vector <tokenTypes> &stack, size_t depth, ParseContext &context)
+{
+    static const char *EXPECTED[PARSERSTATECOUNT] = {
+        "'{' or '['", "a value", "a value or ']'", "a key", "a key or '}'", "':'", "',' or a closing bracket", "end of input"
+    };
 
-        if (isInvalidIndex(parseIndex, tokenSize))
-            return false;
+    ParseError &error = context.error;
+    error.expected = EXPECTED[state];
+    if (state == EXPECTCOMMAOREND)
+        error.expected = stack[depth - 1] == RIGHTCURLYBRACKET ? "',' or '}'" : "',' or ']'";
 
-        // eat value
-        if (tokens[parseIndex].type == LEFTCURLYBRACKET)
-        {
-            if (!parseLeftCurlyBracket(tokens))
-                return false;
-        }
-        else if (tokens[parseIndex].type == LEFTSQUAREBRACKET)
+    if (token < end)
+    {
+        parserActions action = (parserActions) ACTIONS[state][getTokenClass(token->type)];
+        if (action == OPENOBJECT || action == OPENARRAY)
+            error.expected = "at most " + std::to_string(context.maxDepth) + " nested objects and arrays";
+        else if (action == READCOMMA)
         {
-            if (!parseLeftSquareBracket(tokens))
-                return false;
+            // Trailing comma: the error is the token after it
+            error.expected = stack[depth - 1] == RIGHTCURLYBRACKET ? "a key" : "a value";
+            token++;
         }
-        else if (isValidDataType(tokens[parseIndex].type))
-            eat(tokens);
-        else
-            return false;
-
-        if (isInvalidIndex(parseIndex, tokenSize))
-            return false;
-
-        if (tokens[parseIndex].type == COMMA)
-        {
-            if (parseIndex + 1 >= tokenSize)
-                return false;
-
-            if (isClosingToken(tokens[parseIndex + 1].type))
-                return false;
+    }
 
-            // parseLeftCurlyBracket will eat , thinking it's a {
-            if (!parseLeftCurlyBracket(tokens))
-                return false;
-        }
-        else if (tokens[parseIndex].type == RIGHTCURLYBRACKET)
-            eat(tokens);    // eat }
-        else
-            return false;
+    if (token == end)
+    {
+        error.offset = context.inputLength;
+        error.found = "end of input";
     }
-    else if (tokens[parseIndex].type == RIGHTCURLYBRACKET)
-        eat(tokens);    // eat }
+    else if (token->type == UNKNOWN)
+        describeInvalidToken(context.inputData, context.inputLength, *token, error);
     else
-        return false;
-
-    return true;    // VALID JSON
+    {
+        error.offset = token->offset;
+        error.found = describeText(context.inputData + token->offset, token->length);
+    }
 }
 
 
 
-/*  Parse the left square bracket.
-    Format: []
-
-            [ value ]
-
-            [value1, value2]
-
-            [[...JSON...]]
-
-            [{...JSON...}]
-
-
-                [
-                |
-                |
-       ----------------------
-       |     |       |      |
-       |     |       |      |
-       [     {     Value    ]
-                    / \
-                   /   \
-                  ,     }
-                 / \
-                /   \
-               [     {
-
+/*  Perform parsing of the tokens from context.parseIndex on.
+    Format: { "key" : value, ... }  or  [ value, ... ], nested at most
+    context.maxDepth objects and arrays deep. Each token is consumed (and
+    displayed) once, in order. All the state is in the context.
 */
 
-bool parseLeftSquareBracket(std::vector <Token> &tokens)
+bool parser(std::vector <Token> &tokens, ParseContext &context)
 {
-    eat(tokens);  // eat [
+    displayParsingStart(context);
 
-    if (isInvalidIndex(parseIndex, tokenSize))
+    // No JSON found
+    if (isInvalidIndex(context.parseIndex, context.tokenSize))
+    {
+        setParseError(nullptr, nullptr, EXPECTROOT, std::vector <tokenTypes>(), 0, context);
         return false;
+    }
+
+    // Closing bracket of each open container, preallocated for the deepest nesting possible
+    std::vector <tokenTypes> stack(std::min(context.maxDepth, context.tokenSize));
+    size_t depth = 0;
 
-    // eat value
-    if(tokens[parseIndex].type == LEFTSQUAREBRACKET ||
-        tokens[parseIndex].type == LEFTCURLYBRACKET ||
-        isValidDataType(tokens[parseIndex].type))
+    parserStates state = EXPECTROOT;
+    const Token *token = tokens.data() + context.parseIndex;
+    const Token *end = tokens.data() + context.tokenSize;
+    for (; token < end; token++)
     {
-        if (tokens[parseIndex].type == LEFTSQUAREBRACKET)
+        parserActions action = (parserActions) ACTIONS[state][getTokenClass(token->type)];
+
+        if (action == OPENOBJECT || action == OPENARRAY)
         {
-            if (!parseLeftSquareBracket(tokens))
-                return false;
+            if (depth >= stack.size())
+                break;
+
+            if (action == OPENOBJECT)
+            {
+                stack[depth++] = RIGHTCURLYBRACKET;
+                state = EXPECTKEYOREND;
+            }
+            else
+            {
+                stack[depth++] = RIGHTSQUAREBRACKET;
+                state = EXPECTVALUEOREND;
+            }
         }
-        else if (tokens[parseIndex].type == LEFTCURLYBRACKET)
+        else if (action == CLOSEOBJECT || action == CLOSEARRAY)
         {
-            if (!parseLeftCurlyBracket(tokens))
-                return false;
-        }
-        else if (isValidDataType(tokens[parseIndex].type))
-            eat(tokens);
+            if (stack[depth - 1] != token->type)
+                break;
 
-        if (isInvalidIndex(parseIndex, tokenSize))
-            return false;
-
-        if (tokens[parseIndex].type == COMMA)
+            depth--;
+            state = depth == 0 ? EXPECTNOTHING : EXPECTCOMMAOREND;
+        }
+        else if (action == READKEY)
+            state = EXPECTCOLON;
+        else if (action == READCOLON)
+            state = EXPECTVALUE;
+        else if (action == READVALUE)
+            state = EXPECTCOMMAOREND;
+        else if (action == READCOMMA)
         {
-            if (parseIndex + 1 >= tokenSize)
-                return false;
-
-            if (isClosingToken(tokens[parseIndex + 1].type))
-                return false;
+            // A trailing comma is rejected before it is consumed
+            if (token + 1 == end || token[1].type == RIGHTCURLYBRACKET || token[1].type == RIGHTSQUAREBRACKET)
+                break;
 
-            // parseLeftSquareBracket will eat , thinking it's a [
-            if (!parseLeftSquareBracket(tokens))
-                return false;
+            state = stack[depth - 1] == RIGHTCURLYBRACKET ? EXPECTKEY : EXPECTVALUE;
         }
-        else if (tokens[parseIndex].type == RIGHTSQUAREBRACKET)
-            eat(tokens);    // eat }
         else
-            return false;
+            break;
+
+        // Consume the token
+        if (context.displayData)
+        {
+            context.parseIndex = token - tokens.data();
+            displayParsing(tokens, context);
+        }
     }
-    else if (tokens[parseIndex].type == RIGHTSQUAREBRACKET)
-        eat(tokens);
-    else
+    context.parseIndex = token - tokens.data();
+
+    if (token < end || state != EXPECTNOTHING)
+    {
+        // Outside the root value the offending token is shown
+        if (token < end && (state == EXPECTROOT || state == EXPECTNOTHING))
+            displayParsing(tokens, context);
+        setParseError(token, end, state, stack, depth, context);
         return false;
+    }
+
+    displayParsingEnd(context);
 
-    return true;
+    return true;    // Valid JSON
 }
 
 
 
-// Perform parsing
+/*  Lex and parse a whole text with a context of its own: the tokens are kept in
+    the vector given (reused from one call to the next by batch callers), the
+    context is reset except for displayData and maxDepth. When false is
+    returned, context.error says where and why.
+*/
 
-bool parser(std::vector <Token> &tokens)
+bool validateJson(const char *data, size_t length, std::vector <Token> &tokens, ParseContext &context)
 {
-    displayParsingStart();
+    tokens.clear();
+    lexer(data, length, tokens);
 
-    // No JSON found
-    if (isInvalidIndex(parseIndex, tokenSize))
-        return false;
+    context.parseIndex = 0;
+    context.tokenSize = tokens.size();
+    context.inputData = data;
+    context.inputLength = length;
+
+    displayTokens(tokens, context);
 
-    switch (tokens[parseIndex].type)
+    // Check if invalid JSON found in lexical analysis. The tokens before it are
+    // still parsed, without display, for the error: one of them may be wrong
+    // already, or the state at the invalid token tells what was expected there
+    if (context.tokenSize > 0 && tokens[context.tokenSize - 1].type == UNKNOWN)
     {
-        case LEFTCURLYBRACKET:
-            if (!parseLeftCurlyBracket(tokens))
-                return false;
+        bool displayData = context.displayData;
+        context.displayData = false;
+        parser(tokens, context);
+        context.displayData = displayData;
+        return false;
+    }
 
-            if (!isInvalidIndex(parseIndex, tokenSize))
-            {
-                displayParsing(tokens);
-                return false;
-            }
-            break;
+    return parser(tokens, context);
+}
 
-        case LEFTSQUAREBRACKET:
-            if (!parseLeftSquareBracket(tokens))
-                return false;
-            if (!isInvalidIndex(parseIndex, tokenSize))
-            {
-                displayParsing(tokens);
-                return false;
-            }
-            break;
 
-        default:
-            displayParsing(tokens);
-            return false;
-    }
 
-    displayParsingEnd();
+/*  Message of a parse error in a text. The line and column are only computed
+    here, by scanning the text up to the offset again.
+    Example: line 2, column 7 (offset 12): expected ':', found '1'
+*/
 
-    return true;    // Valid JSON
+std::string getErrorMessage(const char *data, const ParseError &error)
+{
+    size_t line, column;
+    getLineColumn(data, error.offset, line, column);
+
+    return "line " + std::to_string(line) + ", column " + std::to_string(column) + " (offset " + std::to_string(error.offset)
+         + "): expected " + error.expected + ", found " + error.found;
+}
+
+
+
+// Message of the error of a failed validateJson()
+
+std::string getErrorMessage(const ParseContext &context)
+{
+    return getErrorMessage(context.inputData, context.error);
 }
\ No newline at end of file
@@ -1,19 +1,17 @@
 // Function declarations
 
-bool parseLeftCurlyBracket(std::vector <Token> &tokens);
+void displayParsingStart(ParseContext &context);
 
-bool parseLeftSquareBracket(std::vector <Token> &tokens);
+void displayParsingEnd(ParseContext &context);
 
-void displayParsingStart();
+void displayParsing(std::vector <Token> &tokens, ParseContext &context);
 
-void displayParsingEnd();
-
-void displayParsing(std::vector <Token> &tokens);
+bool isValidDataType(tokenTypes type);
 
-void eat(std::vector <Token> &tokens);
+bool parser(std::vector <Token> &tokens, ParseContext &context);
 
-bool isClosingToken(tokenTypes type);
+bool validateJson(const char *data, size_t length, std::vector <Token> &tokens, ParseContext &context);
 
-bool isValidDataType(tokenTypes type);
+std::string getErrorMessage(const char *data, const ParseError &error);
 
-bool parser(std::vector <Token> &tokens);
\ No newline at end of file
+std::string getErrorMessage(const ParseContext &context);
\ No newline at end of file
@@ -0,0 +1,921 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <unordered_map>
+#include <string_view>
+#include <initializer_list>
+
+#include "arena.h"
+#include "keyTable.h"
+#include "dom.h"
+#include "writer.h"
+#include "patch.h"
+
+// What undo() reverses
+
+typedef enum {
+    CHANGEDVALUE,       // A slot was overwritten
+    INSERTEDCHILD,      // A child was shifted into the array of a container
+    REMOVEDCHILD        // A child was shifted out of it
+} changeTypes;
+
+
+/*  Changes to the tree of a document, in its arena. The values of the tree are
+    const to its readers; the editor writes them through slot(), as they were
+    allocated writable. Each change is logged so that undo() puts the document
+    back as it was, the last change first: a slot gets its previous contents
+    back, a child inserted in place is shifted out again and a child removed is
+    shifted back in.
+*/
+
+class JsonEditor
+{
+public:
+    JsonEditor(JsonDocument &document);
+
+    JsonValue &root() { return document.rootValue; }
+    static JsonValue &slot(const JsonValue &value) { return const_cast<JsonValue &>(value); }
+
+    JsonValue copyValue(const JsonValue &value);
+    JsonValue *find(const std::vector <std::string> &tokens, size_t count);
+    bool add(const std::vector <std::string> &tokens, const JsonValue &value);
+    bool remove(const std::vector <std::string> &tokens, JsonValue &removed);
+    void change(JsonValue &target, const JsonValue &value);
+    void undo();
+    void merge(JsonValue &target, const JsonValue &patch);
+
+private:
+    struct Change
+    {
+        changeTypes     type;
+        JsonValue       *target;        // Slot changed, or container of the child
+        JsonValue       previous;       // Contents of the slot or container before
+        uint32_t        position;       // Of the child
+        JsonMember      removed;        // Child removed, only its value for an element
+    };
+
+    JsonDocument            &document;
+    PatchSpace              *space;         // Of the document
+    std::vector <Change>    changes;
+
+    const char *copyKey(const char *key, uint32_t keyLength, uint32_t &keyId);
+    void addMember(JsonValue &object, const char *key, uint32_t keyLength, const JsonValue &value);
+
+    template <typename Child>
+    Child *insertChild(JsonValue &container, const Child *children, uint32_t position);
+
+    template <typename Child>
+    void removeChild(JsonValue &container, const Child *children, uint32_t position);
+};
+
+
+
+JsonEditor::JsonEditor(JsonDocument &document) : document(document)
+{
+    if (document.patchSpace == nullptr)
+        document.patchSpace = new PatchSpace();
+    space = document.patchSpace;
+}
+
+
+
+// Copy of a value and its children into the arena of the document, nothing shared
+
+JsonValue JsonEditor::copyValue(const JsonValue &value)
+{
+    JsonValue copy = value;
+    Arena &arena = document.arena;
+    switch (value.type)
+    {
+        case JSONSTRING:
+        case JSONNUMBER:
+            copy.text = arena.copyString(value.text, value.size);
+            break;
+
+        case JSONARRAY:
+            {
+                JsonValue *items = (JsonValue *)arena.allocate(value.size * sizeof(JsonValue), alignof(JsonValue));
+                for (uint32_t i = 0; i < value.size; i++)
+                    items[i] = copyValue(value.items[i]);
+                copy.items = items;
+            }
+            break;
+
+        case JSONOBJECT:
+            {
+                JsonMember *members = (JsonMember *)arena.allocate(value.size * sizeof(JsonMember), alignof(JsonMember));
+                for (uint32_t i = 0; i < value.size; i++)
+                {
+                    const JsonMember &member = value.members[i];
+                    members[i].key = copyKey(member.key, member.keyLength, members[i].keyId);
+                    members[i].keyLength = member.keyLength;
+                    members[i].value = copyValue(member.value);
+                }
+                copy.members = members;
+            }
+            break;
+
+        default:
+            break;
+    }
+    return copy;
+}
+
+
+
+// Key of a new member: interned when the document interns its keys, else copied
+
+const char *JsonEditor::copyKey(const char *key, uint32_t keyLength, uint32_t &keyId)
+{
+    if (document.keys == nullptr)
+    {
+        keyId = NO_KEY;
+        return document.arena.copyString(key, keyLength);
+    }
+
+    keyId = document.keys->intern(key, keyLength);
+    return document.keys->text(keyId);
+}
+
+
+
+static void setChildren(JsonValue &container, JsonMember *members)
+{
+    container.members = members;
+}
+
+
+
+static void setChildren(JsonValue &container, JsonValue *items)
+{
+    container.items = items;
+}
+
+
+
+/*  Make room for a child of a container at position, returns its slot. The
+    children after it are shifted when the array has room, else they move to a
+    new array twice as large. An empty array is never known to have room: its
+    address can be that of the next array allocated.
+*/
+
+template <typename Child>
+Child *JsonEditor::insertChild(JsonValue &container, const Child *children, uint32_t position)
+{
+    JsonValue previous = container;
+    auto capacity = space->capacities.find(children);
+    Child *array = const_cast<Child *>(children);
+    if (container.size > 0 && capacity != space->capacities.end() && container.size < capacity->second)
+    {
+        std::copy_backward(array + position, array + container.size, array + container.size + 1);
+        changes.push_back(Change{INSERTEDCHILD, &container, previous, position, JsonMember()});
+    }
+    else
+    {
+        uint32_t size = std::max(container.size * 2, (uint32_t)4);
+        array = (Child *)document.arena.allocate(size * sizeof(Child), alignof(Child));
+        std::copy(children, children + position, array);
+        std::copy(children + position, children + container.size, array + position + 1);
+        space->capacities[array] = size;
+        setChildren(container, array);
+        changes.push_back(Change{CHANGEDVALUE, &container, previous, 0, JsonMember()});
+    }
+
+    container.size++;
+    return array + position;
+}
+
+
+
+static void setRemoved(JsonMember &removed, const JsonMember &member)
+{
+    removed = member;
+}
+
+
+
+static void setRemoved(JsonMember &removed, const JsonValue &item)
+{
+    removed.value = item;
+}
+
+
+
+// Remove the child of a container at position, by shifting the children after it
+
+template <typename Child>
+void JsonEditor::removeChild(JsonValue &container, const Child *children, uint32_t position)
+{
+    Change change{REMOVEDCHILD, &container, container, position, JsonMember()};
+    Child *array = const_cast<Child *>(children);
+    setRemoved(change.removed, array[position]);
+    space->capacities.emplace(children, container.size);
+
+    std::copy(array + position + 1, array + container.size, array + position);
+    container.size--;
+    changes.push_back(change);
+}
+
+
+
+void JsonEditor::addMember(JsonValue &object, const char *key, uint32_t keyLength, const JsonValue &value)
+{
+    JsonMember *member = insertChild(object, object.members, object.size);
+    member->key = copyKey(key, keyLength, member->keyId);
+    member->keyLength = keyLength;
+    member->value = value;
+}
+
+
+
+// Position of the first member with the key, -1 if there is none
+
+static int64_t findMember(const JsonValue &object, const char *key, size_t keyLength)
+{
+    for (uint32_t i = 0; i < object.size; i++)
+    {
+        if (object.members[i].keyLength == keyLength && memcmp(object.members[i].key, key, keyLength) == 0)
+            return i;
+    }
+    return -1;
+}
+
+
+
+/*  Index of an element from a pointer token: digits without a leading zero,
+    below size, or equal to it and "-" (past the last element) when orEnd.
+*/
+
+static bool readIndex(const std::string &token, uint32_t size, bool orEnd, uint32_t &index)
+{
+    if (orEnd && token == "-")
+    {
+        index = size;
+        return true;
+    }
+    if (token.empty() || token.size() > 10 || token.find_first_not_of("0123456789") != std::string::npos ||
+        (token[0] == '0' && token.size() > 1))
+        return false;
+
+    uint64_t value = std::stoull(token);
+    if (value > size || (value == size && !orEnd))
+        return false;
+    index = (uint32_t)value;
+    return true;
+}
+
+
+
+// Value at the first count tokens of a pointer, nullptr if there is none
+
+JsonValue *JsonEditor::find(const std::vector <std::string> &tokens, size_t count)
+{
+    JsonValue *value = &root();
+    for (size_t i = 0; i < count; i++)
+    {
+        const std::string &token = tokens[i];
+        uint32_t index;
+        if (value->type == JSONOBJECT)
+        {
+            int64_t position = findMember(*value, token.data(), token.size());
+            if (position < 0)
+                return nullptr;
+            value = &slot(value->members[position].value);
+        }
+        else if (value->type == JSONARRAY && readIndex(token, value->size, false, index))
+            value = &slot(value->items[index]);
+        else
+            return nullptr;
+    }
+    return value;
+}
+
+
+
+// Add a value where a pointer leads (the "add" of RFC 6902): the member of an
+// object is replaced if it exists, an element is inserted before the index
+
+bool JsonEditor::add(const std::vector <std::string> &tokens, const JsonValue &value)
+{
+    if (tokens.empty())
+    {
+        change(root(), value);
+        return true;
+    }
+
+    JsonValue *parent = find(tokens, tokens.size() - 1);
+    const std::string &token = tokens.back();
+    uint32_t index;
+    if (parent == nullptr)
+        return false;
+
+    if (parent->type == JSONOBJECT)
+    {
+        int64_t position = findMember(*parent, token.data(), token.size());
+        if (position >= 0)
+            change(slot(parent->members[position].value), value);
+        else
+            addMember(*parent, token.data(), token.size(), value);
+        return true;
+    }
+    if (parent->type == JSONARRAY && readIndex(token, parent->size, true, index))
+    {
+        *insertChild(*parent, parent->items, index) = value;
+        return true;
+    }
+    return false;
+}
+
+
+
+// Remove the member or element a pointer leads to, which is returned in removed
+
+bool JsonEditor::remove(const std::vector <std::string> &tokens, JsonValue &removed)
+{
+    if (tokens.empty())
+        return false;
+
+    JsonValue *parent = find(tokens, tokens.size() - 1);
+    const std::string &token = tokens.back();
+    uint32_t index;
+    if (parent == nullptr)
+        return false;
+
+    if (parent->type == JSONOBJECT)
+    {
+        int64_t position = findMember(*parent, token.data(), token.size());
+        if (position < 0)
+            return false;
+
+        removed = parent->members[position].value;
+        removeChild(*parent, parent->members, position);
+        return true;
+    }
+    if (parent->type == JSONARRAY && readIndex(token, parent->size, false, index))
+    {
+        removed = parent->items[index];
+        removeChild(*parent, parent->items, index);
+        return true;
+    }
+    return false;
+}
+
+
+
+void JsonEditor::change(JsonValue &target, const JsonValue &value)
+{
+    changes.push_back(Change{CHANGEDVALUE, &target, target, 0, JsonMember()});
+    target = value;
+}
+
+
+
+// Shift a child out of (inserted) or back into (removed) the array of a container of size children
+
+template <typename Child>
+static void undoChild(const Child *children, uint32_t size, changeTypes type, uint32_t position, const Child &removed)
+{
+    Child *array = const_cast<Child *>(children);
+    if (type == INSERTEDCHILD)
+        std::copy(array + position + 1, array + size, array + position);
+    else
+    {
+        std::copy_backward(array + position, array + size, array + size + 1);
+        array[position] = removed;
+    }
+}
+
+
+
+void JsonEditor::undo()
+{
+    for (size_t i = changes.size(); i > 0; i--)
+    {
+        const Change &change = changes[i - 1];
+        JsonValue &target = *change.target;
+        if (change.type != CHANGEDVALUE && target.type == JSONOBJECT)
+            undoChild(target.members, target.size, change.type, change.position, change.removed);
+        else if (change.type != CHANGEDVALUE)
+            undoChild(target.items, target.size, change.type, change.position, change.removed.value);
+        target = change.previous;
+    }
+    changes.clear();
+}
+
+
+
+/*  Merge a patch into a value (RFC 7386): an object patch merges its members
+    into the members of the same key, null removing them; any other patch
+    replaces the value.
+*/
+
+void JsonEditor::merge(JsonValue &target, const JsonValue &patch)
+{
+    if (patch.type != JSONOBJECT)
+    {
+        change(target, copyValue(patch));
+        return;
+    }
+
+    if (target.type != JSONOBJECT)
+    {
+        JsonValue object;
+        object.type = JSONOBJECT;
+        object.size = 0;
+        object.members = nullptr;
+        change(target, object);
+    }
+
+    JsonValue null;
+    null.type = JSONNULL;
+    null.size = 0;
+    null.text = nullptr;
+    for (uint32_t i = 0; i < patch.size; i++)
+    {
+        const JsonMember &member = patch.members[i];
+        int64_t position = findMember(target, member.key, member.keyLength);
+        if (member.value.type == JSONNULL)
+        {
+            if (position >= 0)
+                removeChild(target, target.members, position);
+        }
+        else if (position >= 0)
+            merge(slot(target.members[position].value), member.value);
+        else
+        {
+            addMember(target, member.key, member.keyLength, null);
+            merge(slot(target.members[target.size - 1].value), member.value);
+        }
+    }
+}
+
+
+
+// Tokens of a JSON Pointer (RFC 6901), with ~1 and ~0 turned back into '/' and '~'
+
+static bool parsePointer(const std::string &pointer, std::vector <std::string> &tokens)
+{
+    tokens.clear();
+    if (!pointer.empty() && pointer[0] != '/')
+        return false;
+
+    for (size_t pos = 0; pos < pointer.size(); )
+    {
+        std::string token;
+        for (pos++; pos < pointer.size() && pointer[pos] != '/'; pos++)
+        {
+            if (pointer[pos] != '~')
+                token += pointer[pos];
+            else if (pos + 1 < pointer.size() && (pointer[pos + 1] == '0' || pointer[pos + 1] == '1'))
+                token += pointer[++pos] == '0' ? '~' : '/';
+            else
+                return false;
+        }
+        tokens.push_back(token);
+    }
+    return true;
+}
+
+
+
+// A string member of an operation, false if it is missing or not a string
+
+static bool getText(const JsonValue &operation, const char *key, std::string &text)
+{
+    const JsonValue *value = operation.find(key);
+    if (value == nullptr || value->type != JSONSTRING)
+        return false;
+
+    text = value->getString();
+    return true;
+}
+
+
+
+// Whether a member that says what an operation does appears twice, as in
+// {"op": "add", "path": "/a", "value": 1, "op": "remove"}: which one applies
+// is not defined (RFC 6902 A.13), so the operation is rejected
+
+static bool hasRepeatedMember(const JsonValue &operation)
+{
+    for (const char *key : { "op", "path", "from", "value" })
+    {
+        size_t count = 0;
+        for (uint32_t i = 0; i < operation.size; i++)
+        {
+            if (operation.members[i].keyLength == strlen(key) && memcmp(operation.members[i].key, key, strlen(key)) == 0)
+                count++;
+        }
+        if (count > 1)
+            return true;
+    }
+    return false;
+}
+
+
+
+/*  Apply one operation of a JSON Patch: add, remove, replace, move, copy or
+    test. On failure message says why; the changes made so far are left to be
+    undone by the caller.
+*/
+
+static bool applyOperation(JsonEditor &editor, const JsonValue &operation, std::string &message)
+{
+    std::string name, path, from;
+    std::vector <std::string> tokens, fromTokens;
+    if (operation.type != JSONOBJECT || !getText(operation, "op", name) || !getText(operation, "path", path))
+    {
+        message = "an operation is an object with \"op\" and \"path\" strings";
+        return false;
+    }
+    if (hasRepeatedMember(operation))
+    {
+        message = "\"op\", \"path\", \"from\" and \"value\" can only appear once in an operation";
+        return false;
+    }
+    if (!parsePointer(path, tokens))
+    {
+        message = "invalid pointer '" + path + "'";
+        return false;
+    }
+
+    const JsonValue *value = operation.find("value");
+    if ((name == "add" || name == "replace" || name == "test") && value == nullptr)
+    {
+        message = "\"" + name + "\" without a \"value\"";
+        return false;
+    }
+    if (name == "move" || name == "copy")
+    {
+        if (!getText(operation, "from", from) || !parsePointer(from, fromTokens))
+        {
+            message = "\"" + name + "\" without a valid \"from\" pointer";
+            return false;
+        }
+    }
+
+    JsonValue *target;
+    JsonValue removed;
+    if (name == "add")
+    {
+        if (!editor.add(tokens, editor.copyValue(*value)))
+            message = "cannot add at '" + path + "'";
+    }
+    else if (name == "remove")
+    {
+        if (!editor.remove(tokens, removed))
+            message = "cannot remove '" + path + "': not found";
+    }
+    else if (name == "replace")
+    {
+        if ((target = editor.find(tokens, tokens.size())) != nullptr)
+            editor.change(*target, editor.copyValue(*value));
+        else
+            message = "cannot replace '" + path + "': not found";
+    }
+    else if (name == "move")
+    {
+        // The subtree moves as it is, nothing is copied
+        bool intoItself = fromTokens.size() < tokens.size() && std::equal(fromTokens.begin(), fromTokens.end(), tokens.begin());
+        if ((target = editor.find(fromTokens, fromTokens.size())) == nullptr)
+            message = "cannot move '" + from + "': not found";
+        else if (intoItself)
+            message = "cannot move '" + from + "' into itself";
+        else if (fromTokens != tokens && (!editor.remove(fromTokens, removed) || !editor.add(tokens, removed)))
+            message = "cannot move '" + from + "' to '" + path + "'";
+    }
+    else if (name == "copy")
+    {
+        // A copy, so that a later change to one of the two does not show in the other
+        if ((target = editor.find(fromTokens, fromTokens.size())) == nullptr)
+            message = "cannot copy '" + from + "': not found";
+        else if (!editor.add(tokens, editor.copyValue(*target)))
+            message = "cannot copy '" + from + "' to '" + path + "'";
+    }
+    else if (name == "test")
+    {
+        if ((target = editor.find(tokens, tokens.size())) == nullptr)
+            message = "cannot test '" + path + "': not found";
+        else if (!equalValues(*target, *value))
+            message = "test of '" + path + "' failed";
+    }
+    else
+        message = "unknown operation \"" + name + "\"";
+
+    return message.empty();
+}
+
+
+
+/*  Apply a JSON Patch (RFC 6902), an array of operations, to a document. Either
+    every operation is applied or none: on failure the document is restored and
+    error says which operation failed and why.
+    Example:
+        patch.parse(R"([{"op": "replace", "path": "/server/port", "value": 8080}])", ...);
+        if (!applyPatch(document, patch.root(), error))
+            std::cout << "operation " << error.operation << ": " << error.message << "\n";
+*/
+
+bool applyPatch(JsonDocument &document, const JsonValue &patch, PatchError &error)
+{
+    JsonEditor editor(document);
+    error.operation = 0;
+    error.message.clear();
+    if (patch.type != JSONARRAY)
+    {
+        error.message = "a patch is an array of operations";
+        return false;
+    }
+
+    for (uint32_t i = 0; i < patch.size; i++)
+    {
+        error.operation = i;
+        if (!applyOperation(editor, patch.items[i], error.message))
+        {
+            editor.undo();
+            return false;
+        }
+    }
+    return true;
+}
+
+
+
+bool applyPatch(JsonDocument &document, const JsonValue &patch)
+{
+    PatchError error;
+    return applyPatch(document, patch, error);
+}
+
+
+
+// Apply a JSON Merge Patch (RFC 7386) to a document, which never fails
+
+void applyMergePatch(JsonDocument &document, const JsonValue &patch)
+{
+    JsonEditor editor(document);
+    editor.merge(editor.root(), patch);
+}
+
+
+
+// Append a key to a pointer, with '~' and '/' escaped
+
+static void appendToken(std::string &path, const char *key, size_t keyLength)
+{
+    path += '/';
+    for (size_t i = 0; i < keyLength; i++)
+    {
+        if (key[i] == '~')
+            path += "~0";
+        else if (key[i] == '/')
+            path += "~1";
+        else
+            path += key[i];
+    }
+}
+
+
+
+static void writeOperation(JsonWriter &writer, const char *name, const std::string &path, const JsonValue *value)
+{
+    writer.startObject();
+    writer.key("op");
+    writer.string(name, strlen(name));
+    writer.key("path");
+    writer.string(path);
+    if (value != nullptr)
+    {
+        writer.key("value");
+        writer.value(*value);
+    }
+    writer.endObject();
+}
+
+
+
+// Position of the first member of each key of an object
+
+static void indexMembers(const JsonValue &object, std::unordered_map <std::string_view, uint32_t> &positions)
+{
+    positions.reserve(object.size);
+    for (uint32_t i = 0; i < object.size; i++)
+        positions.emplace(std::string_view(object.members[i].key, object.members[i].keyLength), i);
+}
+
+
+
+static void diffValues(const JsonValue &source, const JsonValue &target, std::string &path, JsonWriter &writer);
+
+
+
+/*  Pairs of positions of equal elements kept from source to target, as few
+    elements inserted or removed as possible (Myers' O(ND) difference
+    algorithm). Returns false past MAX_ALIGNED_EDITS insertions and removals:
+    the arrays are then too different for their alignment to be worth its cost.
+*/
+
+static bool alignElements(const JsonValue *source, uint32_t sourceSize, const JsonValue *target, uint32_t targetSize,
+                          std::vector <std::pair <uint32_t, uint32_t>> &kept)
+{
+    // furthest[offset + k]: furthest position in source reached on diagonal k (source - target positions)
+    int64_t maxEdits = std::min<int64_t>((int64_t)sourceSize + targetSize, MAX_ALIGNED_EDITS);
+    int64_t offset = maxEdits + 1;
+    std::vector <int64_t> furthest(2 * offset + 1, 0);
+    std::vector <std::vector <int64_t>> trace;
+
+    for (int64_t edits = 0; edits <= maxEdits; edits++)
+    {
+        trace.push_back(furthest);
+        for (int64_t k = -edits; k <= edits; k += 2)
+        {
+            // An element inserted from diagonal k + 1, or removed from diagonal k - 1
+            int64_t x = (k == -edits || (k != edits && furthest[offset + k - 1] < furthest[offset + k + 1]))
+                      ? furthest[offset + k + 1] : furthest[offset + k - 1] + 1;
+            int64_t y = x - k;
+            while (x < sourceSize && y < targetSize && equalValues(source[x], target[y]))
+            {
+                x++;
+                y++;
+            }
+            furthest[offset + k] = x;
+            if (x < sourceSize || y < targetSize)
+                continue;
+
+            // Walk the path back, the equal elements are those on the diagonals
+            for (int64_t step = edits; step >= 0; step--)
+            {
+                const std::vector <int64_t> &previous = trace[step];
+                k = x - y;
+                int64_t previousK = (k == -step || (k != step && previous[offset + k - 1] < previous[offset + k + 1])) ? k + 1 : k - 1;
+                int64_t previousX = previous[offset + previousK], previousY = previousX - previousK;
+                while (x > previousX && y > previousY)
+                {
+                    x--;
+                    y--;
+                    kept.emplace_back((uint32_t)x, (uint32_t)y);
+                }
+                x = previousX;
+                y = previousY;
+            }
+            std::reverse(kept.begin(), kept.end());
+            return true;
+        }
+    }
+    return false;
+}
+
+
+
+/*  Operations turning sourceCount elements of source from sourceStart into
+    targetCount elements of target from targetStart, which are at targetStart
+    in the document once the elements before them are patched: elements are
+    diffed pairwise, then the extra ones removed or added.
+*/
+
+static void diffElements(const JsonValue &source, const JsonValue &target, uint32_t sourceStart, uint32_t targetStart,
+                         uint32_t sourceCount, uint32_t targetCount, std::string &path, JsonWriter &writer)
+{
+    size_t pathLength = path.size();
+    uint32_t common = std::min(sourceCount, targetCount);
+    for (uint32_t i = 0; i < common; i++)
+    {
+        path += '/' + std::to_string(targetStart + i);
+        diffValues(source.items[sourceStart + i], target.items[targetStart + i], path, writer);
+        path.resize(pathLength);
+    }
+
+    // Each removal shifts the next extra element to the same index
+    path += '/' + std::to_string(targetStart + common);
+    for (uint32_t i = common; i < sourceCount; i++)
+        writeOperation(writer, "remove", path, nullptr);
+    path.resize(pathLength);
+
+    for (uint32_t i = common; i < targetCount; i++)
+    {
+        path += '/' + std::to_string(targetStart + i);
+        writeOperation(writer, "add", path, &target.items[targetStart + i]);
+        path.resize(pathLength);
+    }
+}
+
+
+
+/*  Operations turning source into target at path. Objects are compared member
+    by member. Arrays are compared past their equal first and last elements,
+    the elements in between are aligned so that an element inserted or removed
+    is added or removed without touching the ones after it. Anything else that
+    differs is replaced.
+*/
+
+static void diffValues(const JsonValue &source, const JsonValue &target, std::string &path, JsonWriter &writer)
+{
+    if (equalValues(source, target))
+        return;
+
+    size_t pathLength = path.size();
+    if (source.type == JSONOBJECT && target.type == JSONOBJECT)
+    {
+        // Only the first member of a repeated key counts, as for find()
+        std::unordered_map <std::string_view, uint32_t> sourceKeys, targetKeys;
+        indexMembers(source, sourceKeys);
+        indexMembers(target, targetKeys);
+
+        for (uint32_t i = 0; i < source.size; i++)
+        {
+            const JsonMember &member = source.members[i];
+            std::string_view key(member.key, member.keyLength);
+            if (sourceKeys[key] == i && targetKeys.count(key) == 0)
+            {
+                appendToken(path, member.key, member.keyLength);
+                writeOperation(writer, "remove", path, nullptr);
+                path.resize(pathLength);
+            }
+        }
+        for (uint32_t i = 0; i < target.size; i++)
+        {
+            const JsonMember &member = target.members[i];
+            std::string_view key(member.key, member.keyLength);
+            if (targetKeys[key] != i)
+                continue;
+
+            auto position = sourceKeys.find(key);
+            appendToken(path, member.key, member.keyLength);
+            if (position == sourceKeys.end())
+                writeOperation(writer, "add", path, &member.value);
+            else
+                diffValues(source.members[position->second].value, member.value, path, writer);
+            path.resize(pathLength);
+        }
+    }
+    else if (source.type == JSONARRAY && target.type == JSONARRAY)
+    {
+        uint32_t shorter = std::min(source.size, target.size);
+        uint32_t first = 0, last = 0;
+        while (first < shorter && equalValues(source.items[first], target.items[first]))
+            first++;
+        while (last < shorter - first && equalValues(source.items[source.size - 1 - last], target.items[target.size - 1 - last]))
+            last++;
+
+        // The elements in between are diffed in the gaps between the ones kept,
+        // unless comparing them by position takes fewer operations
+        uint32_t sourceCount = source.size - first - last, targetCount = target.size - first - last;
+        std::vector <std::pair <uint32_t, uint32_t>> kept;
+        if (alignElements(source.items + first, sourceCount, target.items + first, targetCount, kept))
+        {
+            uint32_t alignedCost = 0, sourceIndex = 0, targetIndex = 0;
+            for (const auto &element : kept)
+            {
+                alignedCost += std::max(element.first - sourceIndex, element.second - targetIndex);
+                sourceIndex = element.first + 1;
+                targetIndex = element.second + 1;
+            }
+            alignedCost += std::max(sourceCount - sourceIndex, targetCount - targetIndex);
+
+            uint32_t common = std::min(sourceCount, targetCount);
+            uint32_t positionCost = std::max(sourceCount, targetCount) - common;
+            for (uint32_t i = first; i < first + common && positionCost < alignedCost; i++)
+                positionCost += !equalValues(source.items[i], target.items[i]);
+            if (positionCost < alignedCost)
+                kept.clear();
+        }
+        else
+            kept.clear();
+        kept.emplace_back(sourceCount, targetCount);
+
+        uint32_t sourceIndex = 0, targetIndex = 0;
+        for (const auto &element : kept)
+        {
+            diffElements(source, target, first + sourceIndex, first + targetIndex, element.first - sourceIndex,
+                         element.second - targetIndex, path, writer);
+            sourceIndex = element.first + 1;
+            targetIndex = element.second + 1;
+        }
+    }
+    else
+        writeOperation(writer, "replace", path, &target);
+}
+
+
+
+/*  JSON Patch (RFC 6902) turning source into target, as text: applied to a
+    document equal to source, it makes it equal to target. Only the values that
+    differ are in it, replaced, or removed and added in objects and arrays.
+    Example:
+        createPatch(before.root(), after.root())
+        [{"op":"replace","path":"/server/port","value":8080},{"op":"remove","path":"/debug"}]
+*/
+
+std::string createPatch(const JsonValue &source, const JsonValue &target, int indent)
+{
+    JsonWriter writer(indent);
+    std::string path;
+    writer.startArray();
+    diffValues(source, target, path, writer);
+    writer.endArray();
+    return writer.text();
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+// Patches: JSON Patch (RFC 6902) and JSON Merge Patch (RFC 7386) applied to a
+// document in place, and the JSON Patch that turns one value into another.
+//
+// A patch changes only what it names: a replaced value is overwritten where it
+// is, and a child is inserted into or removed from the array of children of
+// its container by shifting the children after it, whose subtrees stay where
+// they are. An array that is full is replaced by one twice as large in the
+// arena of the document, so a patch costs the size of the containers it
+// changes, never a copy of the document. Replaced arrays stay in the arena
+// until the next parse().
+
+const uint32_t MAX_ALIGNED_EDITS = 128;     // Arrays more different than this are diffed element by element
+
+// Arrays of children allocated or shrunk by patches and the number of
+// children they have room for, by address; the other arrays are full
+
+struct PatchSpace
+{
+    std::unordered_map <const void *, uint32_t>     capacities;
+};
+
+
+// Why a JSON Patch was not applied
+
+struct PatchError
+{
+    size_t          operation;  // Index of the failed operation in the patch
+    std::string     message;
+};
+
+
+// Function declarations
+
+bool applyPatch(JsonDocument &document, const JsonValue &patch, PatchError &error);
+
+bool applyPatch(JsonDocument &document, const JsonValue &patch);
+
+void applyMergePatch(JsonDocument &document, const JsonValue &patch);
+
+std::string createPatch(const JsonValue &source, const JsonValue &target, int indent = 0);
\ No newline at end of file
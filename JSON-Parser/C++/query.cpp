@@ -0,0 +1,769 @@
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <string>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cctype>
+#include <algorithm>
+
+#include "common.h"
+#include "numbers.h"
+#include "arena.h"
+#include "dom.h"
+#include "writer.h"
+#include "streamParser.h"
+#include "query.h"
+
+// A query is run as a set of states: state i means that steps 0 to i-1 led to
+// the value and step i selects among its children. The states of a value are
+// a bit mask, so a query has at most MAX_QUERY_STEPS steps and bit stepCount()
+// marks a match.
+const size_t MAX_QUERY_STEPS = 63;
+
+
+
+JsonQuery::JsonQuery()
+{
+}
+
+
+
+// Step with the defaults of every field
+
+static QueryStep makeStep(queryStepTypes type, bool descendant)
+{
+    QueryStep step;
+    step.type = type;
+    step.descendant = descendant;
+    step.index = -1;
+    step.start = 0;
+    step.end = INT64_MAX;
+    step.step = 1;
+    step.filterOperator = FILTEREXISTS;
+    step.literalType = JSONNULL;
+    step.literalNumber = 0;
+    return step;
+}
+
+
+
+/*  Compile a JSON Pointer (RFC 6901): each token after a '/' is a key, or the
+    index of an element when it is digits without a leading zero. In a token
+    ~1 stands for '/' and ~0 for '~'.
+    Example:
+        "/statuses/0/user/name"
+        "/a~1b"     key "a/b" of the root
+*/
+
+bool JsonQuery::compilePointer(const std::string &pointer)
+{
+    steps.clear();
+    if (!pointer.empty() && pointer[0] != '/')
+        return false;
+
+    size_t pos = 0;
+    while (pos < pointer.size())
+    {
+        QueryStep step = makeStep(STEPNAME, false);
+        for (pos++; pos < pointer.size() && pointer[pos] != '/'; pos++)
+        {
+            if (pointer[pos] != '~')
+                step.name += pointer[pos];
+            else if (pos + 1 < pointer.size() && (pointer[pos + 1] == '0' || pointer[pos + 1] == '1'))
+                step.name += pointer[++pos] == '0' ? '~' : '/';
+            else
+            {
+                steps.clear();
+                return false;
+            }
+        }
+
+        // "0" or digits not starting with 0; "-" (after the last element) is never found
+        const std::string &name = step.name;
+        if (!name.empty() && name.size() <= 18 && name.find_first_not_of("0123456789") == std::string::npos &&
+            (name[0] != '0' || name.size() == 1))
+            step.index = std::stoll(name);
+
+        steps.push_back(step);
+        if (steps.size() > MAX_QUERY_STEPS)
+        {
+            steps.clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+
+
+static void skipSpaces(const char *&pos, const char *end)
+{
+    while (pos < end && *pos == ' ')
+        pos++;
+}
+
+
+
+// Key after a '.': letters, digits, '_', '-', '$' and any non-ASCII character
+
+static bool parseName(const char *&pos, const char *end, std::string &name)
+{
+    const char *start = pos;
+    while (pos < end && (isalnum((unsigned char)*pos) || *pos == '_' || *pos == '-' || *pos == '$' || (unsigned char)*pos >= 0x80))
+        pos++;
+    name.assign(start, pos);
+    return pos > start;
+}
+
+
+
+// Key between single or double quotes, a backslash takes the next character as is
+
+static bool parseQuoted(const char *&pos, const char *end, std::string &text)
+{
+    char quote = *pos++;
+    text.clear();
+    while (pos < end && *pos != quote)
+    {
+        if (*pos == '\\' && pos + 1 < end)
+            pos++;
+        text += *pos++;
+    }
+    if (pos == end)
+        return false;
+    pos++;
+    return true;
+}
+
+
+
+// Integer of an index or slice, at most 18 digits
+
+static bool parseInteger(const char *&pos, const char *end, int64_t &value)
+{
+    bool negative = pos < end && *pos == '-';
+    const char *digits = negative ? pos + 1 : pos;
+    const char *last = digits;
+    value = 0;
+    while (last < end && *last >= '0' && *last <= '9' && last - digits < 18)
+        value = value * 10 + (*last++ - '0');
+    if (last == digits || (last < end && *last >= '0' && *last <= '9'))
+        return false;
+
+    value = negative ? -value : value;
+    pos = last;
+    return true;
+}
+
+
+
+/*  Condition of a filter, after "[?(": @ followed by keys, then nothing (the
+    member exists) or a comparison with a literal.
+    Example:
+        @.price < 10)]
+        @['first name'] == 'Ann')]
+        @.isbn)]
+*/
+
+static bool parseFilter(const char *&pos, const char *end, QueryStep &step)
+{
+    skipSpaces(pos, end);
+    if (pos == end || *pos++ != '@')
+        return false;
+
+    while (pos < end && (*pos == '.' || *pos == '['))
+    {
+        std::string key;
+        if (*pos++ == '.')
+        {
+            if (!parseName(pos, end, key))
+                return false;
+        }
+        else if (pos == end || (*pos != '\'' && *pos != '"') || !parseQuoted(pos, end, key) || pos == end || *pos++ != ']')
+            return false;
+        step.filterPath.push_back(key);
+    }
+
+    skipSpaces(pos, end);
+    static const struct { const char *text; filterOperators type; } OPERATORS[] = {
+        {"==", FILTEREQUAL}, {"!=", FILTERNOTEQUAL}, {"<=", FILTERLESSEQUAL},
+        {">=", FILTERGREATEREQUAL}, {"<", FILTERLESS}, {">", FILTERGREATER}
+    };
+    step.filterOperator = FILTEREXISTS;
+    for (const auto &entry : OPERATORS)
+    {
+        size_t length = strlen(entry.text);
+        if ((size_t)(end - pos) >= length && memcmp(pos, entry.text, length) == 0)
+        {
+            step.filterOperator = entry.type;
+            pos += length;
+            break;
+        }
+    }
+
+    if (step.filterOperator != FILTEREXISTS)
+    {
+        skipSpaces(pos, end);
+        const char *numberEnd;
+        if (pos < end && (*pos == '\'' || *pos == '"'))
+        {
+            step.literalType = JSONSTRING;
+            if (!parseQuoted(pos, end, step.literalText))
+                return false;
+        }
+        else if ((numberEnd = scanNumber(pos, end)) != nullptr)
+        {
+            step.literalType = JSONNUMBER;
+            step.literalText.assign(pos, numberEnd);
+            parseDouble(pos, numberEnd, step.literalNumber);
+            pos = numberEnd;
+        }
+        else if (end - pos >= 4 && (memcmp(pos, "true", 4) == 0 || memcmp(pos, "null", 4) == 0))
+        {
+            step.literalType = *pos == 't' ? JSONBOOLEAN : JSONNULL;
+            step.literalText.assign(pos, 4);
+            pos += 4;
+        }
+        else if (end - pos >= 5 && memcmp(pos, "false", 5) == 0)
+        {
+            step.literalType = JSONBOOLEAN;
+            step.literalText = "false";
+            pos += 5;
+        }
+        else
+            return false;
+    }
+
+    skipSpaces(pos, end);
+    if (end - pos < 2 || pos[0] != ')' || pos[1] != ']')
+        return false;
+    pos += 2;
+    return true;
+}
+
+
+
+// Step between brackets, after the '[': a quoted key, an index, a slice, * or a filter
+
+static bool parseBracket(const char *&pos, const char *end, QueryStep &step)
+{
+    if (pos == end)
+        return false;
+
+    if (*pos == '\'' || *pos == '"')
+    {
+        step.type = STEPNAME;
+        if (!parseQuoted(pos, end, step.name))
+            return false;
+    }
+    else if (*pos == '*')
+    {
+        step.type = STEPWILDCARD;
+        pos++;
+    }
+    else if (*pos == '?')
+    {
+        step.type = STEPFILTER;
+        pos++;
+        return pos < end && *pos++ == '(' && parseFilter(pos, end, step);
+    }
+    else
+    {
+        // [index] or [start:end:step], each part of a slice may be omitted
+        int64_t value;
+        bool hasIndex = pos < end && *pos != ':' && parseInteger(pos, end, value);
+        if (pos < end && *pos == ':')
+        {
+            step.type = STEPSLICE;
+            step.start = hasIndex ? value : 0;
+            pos++;
+            if (pos < end && *pos != ':' && *pos != ']')
+            {
+                if (!parseInteger(pos, end, step.end))
+                    return false;
+            }
+            if (pos < end && *pos == ':')
+            {
+                pos++;
+                if (pos < end && *pos != ']' && (!parseInteger(pos, end, step.step) || step.step <= 0))
+                    return false;
+            }
+        }
+        else if (hasIndex)
+        {
+            step.type = STEPINDEX;
+            step.index = value;
+        }
+        else
+            return false;
+    }
+    return pos < end && *pos++ == ']';
+}
+
+
+
+/*  Compile a JSONPath expression. The subset supported is: the root $, keys
+    (.name or ['name']), indexes ([0], [-1] from the end), wildcards (.* or
+    [*]), recursive descent (..name, ..* or ..[...]), slices ([start:end:step]
+    with a positive step) and filters comparing a key path with a literal
+    ([?(@.price < 10)], [?(@.isbn)]).
+    Example:
+        $.store.book[*].author
+        $..book[?(@.price < 10)].title
+        $.statuses[0:10:2].user['screen_name']
+*/
+
+bool JsonQuery::compilePath(const std::string &path)
+{
+    steps.clear();
+    const char *pos = path.data();
+    const char *end = pos + path.size();
+    if (pos == end || *pos++ != '$')
+        return false;
+
+    while (pos < end)
+    {
+        bool descendant = false;
+        QueryStep step = makeStep(STEPWILDCARD, false);
+        bool valid;
+
+        if (*pos == '.')
+        {
+            pos++;
+            descendant = pos < end && *pos == '.';
+            pos += descendant;
+
+            if (pos < end && *pos == '*')
+            {
+                pos++;
+                valid = true;
+            }
+            else if (descendant && pos < end && *pos == '[')
+            {
+                pos++;
+                valid = parseBracket(pos, end, step);
+            }
+            else
+            {
+                step.type = STEPNAME;
+                valid = parseName(pos, end, step.name);
+            }
+        }
+        else if (*pos == '[')
+        {
+            pos++;
+            valid = parseBracket(pos, end, step);
+        }
+        else
+            valid = false;
+
+        step.descendant = descendant;
+        steps.push_back(step);
+        if (!valid || steps.size() > MAX_QUERY_STEPS)
+        {
+            steps.clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+
+
+// Filters and indexes from the end of an array need the value, the other steps only its key or index
+
+bool JsonQuery::isStreamable(size_t index) const
+{
+    const QueryStep &step = steps[index];
+    switch (step.type)
+    {
+        case STEPFILTER: return false;
+        case STEPINDEX:  return step.index >= 0;
+        case STEPSLICE:  return step.start >= 0 && step.end >= 0;
+        default:         return true;
+    }
+}
+
+
+
+// Compare a value with the literal of a filter, values of another type are only different
+
+static bool compareLiteral(const QueryStep &step, const JsonValue &value)
+{
+    int order;
+    if (value.type != step.literalType)
+        return step.filterOperator == FILTERNOTEQUAL;
+
+    if (value.type == JSONSTRING)
+    {
+        size_t length = step.literalText.size();
+        order = memcmp(value.text, step.literalText.data(), std::min<size_t>(value.size, length));
+        if (order == 0)
+            order = value.size < length ? -1 : value.size > length;
+    }
+    else if (value.type == JSONNUMBER)
+    {
+        double number;
+        value.getDouble(number);
+        order = number < step.literalNumber ? -1 : number > step.literalNumber;
+    }
+    else
+    {
+        // true, false or null: only equal or not
+        bool equal = value.type == JSONNULL || value.boolean == (step.literalText == "true");
+        if (step.filterOperator == FILTEREQUAL || step.filterOperator == FILTERNOTEQUAL)
+            return equal == (step.filterOperator == FILTEREQUAL);
+        return false;
+    }
+
+    switch (step.filterOperator)
+    {
+        case FILTEREQUAL:        return order == 0;
+        case FILTERNOTEQUAL:     return order != 0;
+        case FILTERLESS:         return order < 0;
+        case FILTERLESSEQUAL:    return order <= 0;
+        case FILTERGREATER:      return order > 0;
+        case FILTERGREATEREQUAL: return order >= 0;
+        default:                 return true;
+    }
+}
+
+
+
+// Check whether a member or element (key or index) is selected by a step
+
+static bool matchesStep(const QueryStep &step, const char *key, size_t keyLength, int64_t index,
+                        const JsonValue *child, int64_t parentSize)
+{
+    switch (step.type)
+    {
+        case STEPNAME:
+            if (key != nullptr)
+                return keyLength == step.name.size() && memcmp(key, step.name.data(), keyLength) == 0;
+            return step.index >= 0 && index == step.index;
+
+        case STEPINDEX:
+            return key == nullptr && index == (step.index >= 0 ? step.index : parentSize + step.index);
+
+        case STEPWILDCARD:
+            return true;
+
+        case STEPSLICE:
+        {
+            if (key != nullptr)
+                return false;
+            int64_t start = step.start >= 0 ? step.start : std::max<int64_t>(parentSize + step.start, 0);
+            int64_t end = step.end >= 0 ? step.end : parentSize + step.end;
+            return index >= start && index < end && (index - start) % step.step == 0;
+        }
+
+        case STEPFILTER:
+        {
+            if (child == nullptr)
+                return false;
+            const JsonValue *value = child;
+            for (size_t i = 0; i < step.filterPath.size() && value != nullptr; i++)
+                value = value->find(step.filterPath[i]);
+            return value != nullptr && (step.filterOperator == FILTEREXISTS || compareLiteral(step, *value));
+        }
+    }
+    return false;
+}
+
+
+
+/*  States of a member or element, from the states of its parent. key is
+    nullptr for an element. child and parentSize are only needed by the steps
+    that are not streamable: the streaming handler never passes them such steps.
+*/
+
+uint64_t JsonQuery::childStates(uint64_t states, const char *key, size_t keyLength, int64_t index,
+                                const JsonValue *child, int64_t parentSize) const
+{
+    uint64_t result = 0;
+    states &= (1ull << steps.size()) - 1;
+    while (states != 0)
+    {
+        size_t i = __builtin_ctzll(states);
+        states &= states - 1;
+
+        const QueryStep &step = steps[i];
+        if (step.descendant)
+            result |= 1ull << i;
+        if (matchesStep(step, key, keyLength, index, child, parentSize))
+            result |= 1ull << (i + 1);
+    }
+    return result;
+}
+
+
+
+// Walk a value and its children depth first, the subtrees without states are skipped
+
+bool JsonQuery::visit(const JsonValue &value, uint64_t states, std::vector <const JsonValue*> &matches, bool firstOnly) const
+{
+    if (states & (1ull << steps.size()))
+    {
+        matches.push_back(&value);
+        if (firstOnly)
+            return true;
+    }
+
+    if (value.type == JSONOBJECT)
+    {
+        for (uint32_t i = 0; i < value.size; i++)
+        {
+            const JsonMember &member = value.members[i];
+            uint64_t memberStates = childStates(states, member.key, member.keyLength, -1, &member.value, value.size);
+            if (memberStates != 0 && visit(member.value, memberStates, matches, firstOnly))
+                return true;
+        }
+    }
+    else if (value.type == JSONARRAY)
+    {
+        for (uint32_t i = 0; i < value.size; i++)
+        {
+            uint64_t itemStates = childStates(states, nullptr, 0, i, &value.items[i], value.size);
+            if (itemStates != 0 && visit(value.items[i], itemStates, matches, firstOnly))
+                return true;
+        }
+    }
+    return false;
+}
+
+
+
+std::vector <const JsonValue*> JsonQuery::evaluate(const JsonValue &root) const
+{
+    std::vector <const JsonValue*> matches;
+    visit(root, 1, matches, false);
+    return matches;
+}
+
+
+
+// The match of a pointer, which selects at most one value
+
+const JsonValue *JsonQuery::first(const JsonValue &root) const
+{
+    std::vector <const JsonValue*> matches;
+    visit(root, 1, matches, true);
+    return matches.empty() ? nullptr : matches[0];
+}
+
+
+
+JsonQueryHandler::JsonQueryHandler(const JsonQuery &query, QueryCallback callback) :
+    query(query), callback(callback), flushed(0), treeStates(0), matches(0)
+{
+    for (size_t i = 0; i < query.stepCount(); i++)
+    {
+        if (!query.isStreamable(i))
+            treeStates |= 1ull << i;
+    }
+}
+
+
+
+JsonQueryHandler::~JsonQueryHandler()
+{
+    for (Capture &capture : captures)
+        delete capture.writer;
+}
+
+
+
+/*  States of the value an event starts. A value that is a match, or that steps
+    which are not streamable apply to, is copied until it ends; those steps are
+    then run on its tree, and are not followed in its children here.
+*/
+
+uint64_t JsonQueryHandler::startValue()
+{
+    uint64_t states = 1;
+    if (!frames.empty())
+    {
+        Frame &parent = frames.back();
+        if (parent.states == 0)
+            return 0;
+        if (parent.isArray)
+            states = query.childStates(parent.states, nullptr, 0, parent.count++, nullptr, INT64_MAX);
+        else
+            states = query.childStates(parent.states, parent.key.data(), parent.key.size(), -1, nullptr, INT64_MAX);
+    }
+
+    uint64_t matchState = 1ull << query.stepCount();
+    uint64_t forTree = states & treeStates;
+    if ((states & matchState) != 0 || forTree != 0)
+    {
+        pending.push_back(Output{std::vector <std::string>(), false});
+        captures.push_back(Capture{new JsonWriter(), frames.size(), (states & matchState) != 0, forTree, flushed + pending.size() - 1});
+    }
+    return states & ~forTree & ~matchState;
+}
+
+
+
+// Complete the copy of the value that just ended, if it was copied
+
+void JsonQueryHandler::endValue()
+{
+    if (captures.empty() || captures.back().depth != frames.size())
+        return;
+
+    Capture capture = captures.back();
+    captures.pop_back();
+
+    Output &output = pending[capture.output - flushed];
+    const std::string &text = capture.writer->text();
+    if (capture.isMatch)
+        output.texts.push_back(text);
+
+    // Scalars have no children, filters and indexes select nothing in them
+    if (capture.states != 0 && (text[0] == '{' || text[0] == '['))
+    {
+        JsonDocument document;
+        std::vector <const JsonValue*> found;
+        if (document.parse(text.data(), text.size()))
+            query.visit(document.root(), capture.states, found, false);
+        for (const JsonValue *value : found)
+            output.texts.push_back(serialize(*value));
+    }
+
+    output.done = true;
+    delete capture.writer;
+    flush();
+}
+
+
+
+// Pass the matches in document order: an inner value may end before the outer one is complete
+
+void JsonQueryHandler::flush()
+{
+    while (!pending.empty() && pending.front().done)
+    {
+        for (const std::string &text : pending.front().texts)
+        {
+            matches++;
+            callback(text);
+        }
+        pending.pop_front();
+        flushed++;
+    }
+}
+
+
+
+template <typename Write>
+void JsonQueryHandler::writeAll(Write function)
+{
+    for (Capture &capture : captures)
+        function(*capture.writer);
+}
+
+
+
+bool JsonQueryHandler::startObject()
+{
+    uint64_t states = startValue();
+    writeAll([](JsonWriter &writer) { writer.startObject(); });
+    frames.push_back(Frame{states, false, 0, std::string()});
+    return true;
+}
+
+
+
+bool JsonQueryHandler::endObject()
+{
+    frames.pop_back();
+    writeAll([](JsonWriter &writer) { writer.endObject(); });
+    endValue();
+    return true;
+}
+
+
+
+bool JsonQueryHandler::startArray()
+{
+    uint64_t states = startValue();
+    writeAll([](JsonWriter &writer) { writer.startArray(); });
+    frames.push_back(Frame{states, true, 0, std::string()});
+    return true;
+}
+
+
+
+bool JsonQueryHandler::endArray()
+{
+    frames.pop_back();
+    writeAll([](JsonWriter &writer) { writer.endArray(); });
+    endValue();
+    return true;
+}
+
+
+
+bool JsonQueryHandler::key(const std::string &key)
+{
+    if (frames.back().states != 0)
+        frames.back().key = key;
+    writeAll([&](JsonWriter &writer) { writer.key(key); });
+    return true;
+}
+
+
+
+bool JsonQueryHandler::string(const std::string &value)
+{
+    startValue();
+    writeAll([&](JsonWriter &writer) { writer.string(value); });
+    endValue();
+    return true;
+}
+
+
+
+bool JsonQueryHandler::number(const std::string &text)
+{
+    startValue();
+    writeAll([&](JsonWriter &writer) { writer.rawNumber(text.data(), text.size()); });
+    endValue();
+    return true;
+}
+
+
+
+bool JsonQueryHandler::boolean(bool value)
+{
+    startValue();
+    writeAll([&](JsonWriter &writer) { writer.boolean(value); });
+    endValue();
+    return true;
+}
+
+
+
+bool JsonQueryHandler::null()
+{
+    startValue();
+    writeAll([](JsonWriter &writer) { writer.null(); });
+    endValue();
+    return true;
+}
+
+
+
+/*  Run a query on a file or pipe read in chunks, the callback gets each match
+    as it is complete. The matches found before an error in the text have
+    already been passed when false is returned.
+*/
+
+bool queryStream(int fd, const JsonQuery &query, QueryCallback callback, size_t chunkSize)
+{
+    JsonQueryHandler handler(query, callback);
+    return parseStream(fd, handler, chunkSize);
+}
\ No newline at end of file
@@ -0,0 +1,144 @@
+// Queries: a JSON Pointer (RFC 6901) or a JSONPath expression is compiled once
+// into a list of steps and run against a document tree (dom.cpp) or against the
+// events of the streaming parser (streamParser.cpp), which keeps only the
+// matched values and never builds the whole document.
+
+// Kinds of steps of a query
+
+typedef enum {
+    STEPNAME,           // Member by key; for a pointer, also the element when the token is an index
+    STEPINDEX,          // Element by index, negative from the end of the array
+    STEPWILDCARD,       // Every member or element
+    STEPSLICE,          // Elements from start to end (excluded) by step
+    STEPFILTER          // Members or elements for which a condition holds
+} queryStepTypes;
+
+// Comparisons of a filter
+
+typedef enum {
+    FILTEREXISTS,       // [?(@.key)]
+    FILTEREQUAL,        // ==
+    FILTERNOTEQUAL,     // !=
+    FILTERLESS,         // <
+    FILTERLESSEQUAL,    // <=
+    FILTERGREATER,      // >
+    FILTERGREATEREQUAL  // >=
+} filterOperators;
+
+
+struct QueryStep
+{
+    queryStepTypes              type;
+    bool                        descendant;     // Applies at any depth below the value (..), not only to its children
+    std::string                 name;           // Key of STEPNAME
+    int64_t                     index;          // Index of STEPINDEX or of a pointer STEPNAME (-1 if the token is not one)
+    int64_t                     start;          // Bounds of STEPSLICE, negative from the end of the array,
+    int64_t                     end;            // 0 and INT64_MAX when omitted
+    int64_t                     step;           // Positive
+    std::vector <std::string>   filterPath;     // Keys from the member or element to the value compared, [?(@.a.b ...)]
+    filterOperators             filterOperator;
+    jsonTypes                   literalType;    // Value compared with: a string, number, boolean or null
+    std::string                 literalText;
+    double                      literalNumber;
+};
+
+
+struct JsonValue;
+
+class JsonQuery
+{
+public:
+    JsonQuery();
+
+    bool compilePointer(const std::string &pointer);    // false if malformed, "" is the whole document
+    bool compilePath(const std::string &path);          // false if malformed or outside the subset of query.cpp
+
+    std::vector <const JsonValue*> evaluate(const JsonValue &root) const;  // Matches in document order
+    const JsonValue *first(const JsonValue &root) const;                    // First match, nullptr if none
+
+    size_t stepCount() const { return steps.size(); }
+    const QueryStep &getStep(size_t index) const { return steps[index]; }
+    bool isStreamable(size_t index) const;              // The step can be decided from keys and indexes alone
+
+private:
+    std::vector <QueryStep>     steps;
+
+    uint64_t childStates(uint64_t states, const char *key, size_t keyLength, int64_t index,
+                         const JsonValue *child, int64_t parentSize) const;
+    bool visit(const JsonValue &value, uint64_t states, std::vector <const JsonValue*> &matches, bool firstOnly) const;
+
+    friend class JsonQueryHandler;
+};
+
+
+// Called with the compact JSON text of each match of a streamed query
+
+using QueryCallback = std::function<void(const std::string &json)>;
+
+class JsonWriter;
+
+// Runs a query on the events of JsonSaxParser. A value is copied only while it
+// is a match, or when the rest of the query needs it whole (a filter, or an
+// index from the end of an array), in which case it is evaluated as a tree.
+
+class JsonQueryHandler : public JsonHandler
+{
+public:
+    JsonQueryHandler(const JsonQuery &query, QueryCallback callback);
+    ~JsonQueryHandler();
+
+    bool startObject() override;
+    bool endObject() override;
+    bool startArray() override;
+    bool endArray() override;
+    bool key(const std::string &key) override;
+    bool string(const std::string &value) override;
+    bool number(const std::string &text) override;
+    bool boolean(bool value) override;
+    bool null() override;
+
+    size_t matchCount() const { return matches; }
+
+private:
+    struct Frame
+    {
+        uint64_t        states;         // Steps of the query reached at this container
+        bool            isArray;
+        int64_t         count;          // Elements seen so far in an array
+        std::string     key;            // Key of the member being read in an object
+    };
+
+    struct Capture
+    {
+        JsonWriter      *writer;        // Text of the value
+        size_t          depth;          // Containers open when the value started
+        bool            isMatch;        // The value is a match itself
+        uint64_t        states;         // Steps left to run on the tree of the value
+        size_t          output;         // Entry of its matches in pending, counted from the first entry ever
+    };
+
+    struct Output
+    {
+        std::vector <std::string>   texts;      // Matches, in document order
+        bool                        done;       // No more matches will be added
+    };
+
+    const JsonQuery         &query;
+    QueryCallback           callback;
+    std::vector <Frame>     frames;         // Open containers, innermost last
+    std::vector <Capture>   captures;       // Values being copied, innermost last
+    std::deque <Output>     pending;        // Matches not yet passed to the callback, in document order
+    size_t                  flushed;        // Entries already passed and removed from pending
+    uint64_t                treeStates;     // Steps that need the whole value (isStreamable() is false)
+    size_t                  matches;        // Matches passed to the callback
+
+    uint64_t startValue();
+    void endValue();
+    void flush();
+    template <typename Write> void writeAll(Write function);
+};
+
+
+// Function declarations
+
+bool queryStream(int fd, const JsonQuery &query, QueryCallback callback, size_t chunkSize = 64 * 1024);
\ No newline at end of file
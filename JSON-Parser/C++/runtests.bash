@@ -21,20 +21,95 @@ correct_result=0
 incorrect_result=0
 
 
-# Loop through all files in the folder and execute 'json_parser' for each file
+# Loop through all files in the folder and execute 'json_parser' for each file,
+# once on the whole file and once with the streaming parser fed one byte at a time
+# (the whole file mode says where the error is after "INVALID JSON")
+for filename in "$folder"/*; do
+  if [ -f "$filename" ]; then
+    for mode in "" "--stream=1"; do
+      echo "Processing file: $filename $mode"
+      output=$(./json_parser $mode "$filename")
+      echo $output
+      ((total_cases++))
+      if [ "$output" == "VALID JSON" ] && [[ "$filename" == *pass* ]]; then
+        ((correct_result++))
+      elif [[ "$output" == "INVALID JSON"* ]] && [[ "$filename" == *fail* ]]; then
+        ((correct_result++))
+      fi
+    done
+  fi
+done
+
+# And once more with the whole folder validated by the batch mode on 4 threads,
+# which lists the files that are not valid JSON
+echo "Processing folder: $folder --batch=4"
+invalid_files=$(./json_parser --batch=4 "$folder" | grep "^INVALID JSON : ")
 for filename in "$folder"/*; do
   if [ -f "$filename" ]; then
-    echo "Processing file: $filename"
-    output=$(./json_parser "$filename")
-    echo $output
     ((total_cases++))
-    if [ "$output" == "VALID JSON" ] && [[ "$filename" == *pass* ]]; then
-      ((correct_result++))
-    elif [ "$output" == "INVALID JSON" ] && [[ "$filename" == *fail* ]]; then
+    if grep -q "/$(basename "$filename")$" <<< "$invalid_files"; then
+      [[ "$filename" == *fail* ]] && ((correct_result++))
+    else
+      [[ "$filename" == *pass* ]] && ((correct_result++))
+    fi
+  fi
+done
+
+# Run the driver on the cases in the subfolders: NAME.args lists its arguments,
+# one per line, and NAME.out holds the expected output. Queries run a second
+# time on the streaming parser, which must select the same values
+parser="$PWD/json_parser"
+for args_file in "$folder"/*/*.args; do
+  if [ -f "$args_file" ]; then
+    mapfile -t args < "$args_file"
+    modes=("${args[0]}")
+    [ "${args[0]}" == "--query" ] && modes+=("--query=stream")
+    for mode in "${modes[@]}"; do
+      echo "Processing case: $args_file $mode"
+      ((total_cases++))
+      if (cd "$(dirname "$args_file")" && "$parser" "$mode" "${args[@]:1}" 2>&1) | cmp -s - "${args_file%.args}.out"; then
+        echo "MATCH"
+        ((correct_result++))
+      else
+        echo "MISMATCH"
+      fi
+    done
+  fi
+done
+
+# Convert the documents in tests/cbor/ to CBOR, which must give the bytes of
+# the file of the same name checked against RFC 8949
+cbor_file=$(mktemp)
+for filename in "$folder"/cbor/*.json; do
+  if [ -f "${filename%.json}.cbor" ]; then
+    echo "Processing case: $filename --to-cbor"
+    ((total_cases++))
+    if ./json_parser --to-cbor "$filename" "$cbor_file" > /dev/null && cmp -s "$cbor_file" "${filename%.json}.cbor"; then
+      echo "MATCH"
       ((correct_result++))
+    else
+      echo "MISMATCH"
     fi
   fi
 done
+rm -f "$cbor_file"
+
+# Read the documents in tests/typed/ into structs with typed_test, when it is
+# built, and compare the members or the error it prints with NAME.out
+if [ -x ./typed_test ]; then
+  for filename in "$folder"/typed/*.json; do
+    echo "Processing case: $filename typed_test"
+    ((total_cases++))
+    if ./typed_test "$filename" | cmp -s - "${filename%.json}.out"; then
+      echo "MATCH"
+      ((correct_result++))
+    else
+      echo "MISMATCH"
+    fi
+  done
+else
+  echo "Skipping $folder/typed: 'typed_test' executable not found"
+fi
 
 ((incorrect_result = total_cases - correct_result))
 
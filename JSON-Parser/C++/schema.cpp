@@ -0,0 +1,822 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <regex>
+#include <utility>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+
+#include "common.h"
+#include "numbers.h"
+#include "arena.h"
+#include "dom.h"
+#include "writer.h"
+#include "streamParser.h"
+#include "schema.h"
+
+// Names of the types of the keyword "type", by bit of SchemaNode::types
+static const char *TYPENAMES[] = {"object", "array", "string", "number", "boolean", "null", "integer"};
+
+
+
+JsonSchema::JsonSchema() : root(ANY_SCHEMA)
+{
+}
+
+
+
+/*  Parse and compile a schema. Keywords outside the subset of schema.h are
+    ignored, as the specification asks for unknown keywords; a supported
+    keyword with a value of the wrong kind makes the schema invalid.
+    Example:
+        {"type": "object", "required": ["id"],
+         "properties": {"id": {"type": "integer", "minimum": 1},
+                        "tags": {"type": "array", "items": {"type": "string", "pattern": "^[a-z]+$"}}}}
+*/
+
+bool JsonSchema::load(const char *data, size_t length)
+{
+    nodes.clear();
+    root = ANY_SCHEMA;
+    if (!document.parse(data, length) || !compile(document.root(), root))
+    {
+        nodes.clear();
+        root = ANY_SCHEMA;
+        return false;
+    }
+    return true;
+}
+
+
+
+// Bit of a type name, 0 if it is not one
+
+static uint32_t getTypeBit(const JsonValue &name)
+{
+    for (uint32_t i = 0; i < sizeof(TYPENAMES) / sizeof(TYPENAMES[0]); i++)
+    {
+        if (name.type == JSONSTRING && strcmp(name.text, TYPENAMES[i]) == 0)
+            return 1 << i;
+    }
+    return 0;
+}
+
+
+
+/*  Find how a pattern can be matched. Without metacharacters it is plain text
+    searched in the string, anchored by a leading ^ or a trailing $; anything
+    else goes through std::regex.
+*/
+
+static patternKinds getPatternKind(const std::string &pattern, std::string &literal)
+{
+    size_t start = !pattern.empty() && pattern[0] == '^';
+    size_t end = pattern.size() - (pattern.size() > start && pattern.back() == '$');
+    literal = pattern.substr(start, end - start);
+    if (literal.find_first_of(".^$*+?()[]{}|\\") != std::string::npos)
+        return PATTERNREGEX;
+
+    bool atEnd = end < pattern.size();
+    if (start == 1)
+        return atEnd ? PATTERNEXACT : PATTERNPREFIX;
+    return atEnd ? PATTERNSUFFIX : PATTERNCONTAINS;
+}
+
+
+
+static bool matchesPattern(const SchemaNode &node, const char *text, size_t length)
+{
+    const std::string &literal = node.patternLiteral;
+    switch (node.patternKind)
+    {
+        case PATTERNCONTAINS:
+            return literal.empty() || memmem(text, length, literal.data(), literal.size()) != nullptr;
+        case PATTERNPREFIX:
+            return length >= literal.size() && memcmp(text, literal.data(), literal.size()) == 0;
+        case PATTERNSUFFIX:
+            return length >= literal.size() && memcmp(text + length - literal.size(), literal.data(), literal.size()) == 0;
+        case PATTERNEXACT:
+            return length == literal.size() && memcmp(text, literal.data(), length) == 0;
+        default:
+            return std::regex_search(text, text + length, node.pattern);
+    }
+}
+
+
+
+// Non-negative integer of a keyword such as minLength
+
+static bool getCount(const JsonValue &value, int64_t &count)
+{
+    return value.getInt64(count) && count >= 0;
+}
+
+
+
+// Compile a schema into a node, and its subschemas after it; index receives its position
+
+bool JsonSchema::compile(const JsonValue &schema, int32_t &index)
+{
+    index = nodes.size();
+    nodes.push_back(SchemaNode());
+    SchemaNode *node = &nodes[index];
+    node->allowsNothing = false;
+    node->types = 0;
+    node->additionalProperties = ANY_SCHEMA;
+    node->noAdditionalProperties = false;
+    node->items = ANY_SCHEMA;
+    node->enumValues = nullptr;
+    node->minimum = node->maximum = node->exclusiveMinimum = node->exclusiveMaximum = nullptr;
+    node->minLength = node->maxLength = node->minItems = node->maxItems = -1;
+    node->hasPattern = false;
+    node->patternKind = PATTERNREGEX;
+
+    // true allows everything, false nothing
+    if (schema.type == JSONBOOLEAN)
+    {
+        node->allowsNothing = !schema.boolean;
+        return true;
+    }
+    if (schema.type != JSONOBJECT)
+        return false;
+
+    for (uint32_t i = 0; i < schema.size; i++)
+    {
+        const std::string keyword = schema.members[i].key;
+        const JsonValue &value = schema.members[i].value;
+        int32_t child;
+
+        // Compiling a subschema adds nodes, which may move this one
+        node = &nodes[index];
+
+        if (keyword == "type")
+        {
+            for (uint32_t j = 0; j < (value.type == JSONARRAY ? value.size : 1); j++)
+            {
+                uint32_t bit = getTypeBit(value.type == JSONARRAY ? value.items[j] : value);
+                if (bit == 0)
+                    return false;
+                node->types |= bit;
+            }
+        }
+        else if (keyword == "properties")
+        {
+            if (value.type != JSONOBJECT)
+                return false;
+            for (uint32_t j = 0; j < value.size; j++)
+            {
+                if (!compile(value.members[j].value, child))
+                    return false;
+                nodes[index].properties.push_back(std::make_pair(std::string(value.members[j].key, value.members[j].keyLength), child));
+            }
+        }
+        else if (keyword == "additionalProperties")
+        {
+            if (value.type == JSONBOOLEAN)
+                node->noAdditionalProperties = !value.boolean;
+            else if (!compile(value, child))
+                return false;
+            else
+                nodes[index].additionalProperties = child;
+        }
+        else if (keyword == "required")
+        {
+            if (value.type != JSONARRAY)
+                return false;
+            for (uint32_t j = 0; j < value.size; j++)
+            {
+                if (value.items[j].type != JSONSTRING)
+                    return false;
+                std::string key = value.items[j].getString();
+                if (std::find(node->required.begin(), node->required.end(), key) == node->required.end())
+                    node->required.push_back(key);
+            }
+        }
+        else if (keyword == "items")
+        {
+            if (value.type != JSONARRAY)
+            {
+                if (!compile(value, child))
+                    return false;
+                nodes[index].items = child;
+            }
+            for (uint32_t j = 0; value.type == JSONARRAY && j < value.size; j++)
+            {
+                if (!compile(value.items[j], child))
+                    return false;
+                nodes[index].tupleItems.push_back(child);
+            }
+        }
+        else if (keyword == "enum")
+        {
+            if (value.type != JSONARRAY)
+                return false;
+            node->enumValues = &value;
+        }
+        else if (keyword == "minimum" || keyword == "maximum" || keyword == "exclusiveMinimum" || keyword == "exclusiveMaximum")
+        {
+            if (value.type != JSONNUMBER)
+                return false;
+            const JsonValue **bound = keyword == "minimum" ? &node->minimum : keyword == "maximum" ? &node->maximum :
+                                      keyword == "exclusiveMinimum" ? &node->exclusiveMinimum : &node->exclusiveMaximum;
+            *bound = &value;
+        }
+        else if (keyword == "minLength" || keyword == "maxLength" || keyword == "minItems" || keyword == "maxItems")
+        {
+            int64_t &count = keyword == "minLength" ? node->minLength : keyword == "maxLength" ? node->maxLength :
+                             keyword == "minItems" ? node->minItems : node->maxItems;
+            if (!getCount(value, count))
+                return false;
+        }
+        else if (keyword == "pattern")
+        {
+            if (value.type != JSONSTRING)
+                return false;
+            try
+            {
+                node->pattern = std::regex(value.text, value.size, std::regex::ECMAScript);
+            }
+            catch (const std::regex_error &)
+            {
+                return false;
+            }
+            node->hasPattern = true;
+            node->patternText = value.getString();
+            node->patternKind = getPatternKind(node->patternText, node->patternLiteral);
+        }
+    }
+
+    // Bounds as doubles, and the required keys that have a schema, found by the same search
+    node = &nodes[index];
+    const JsonValue *bounds[] = {node->minimum, node->maximum, node->exclusiveMinimum, node->exclusiveMaximum};
+    for (int i = 0; i < 4; i++)
+    {
+        node->bounds[i] = 0;
+        if (bounds[i] != nullptr)
+            bounds[i]->getDouble(node->bounds[i]);
+    }
+    for (const auto &property : node->properties)
+    {
+        size_t position = 0;
+        while (position < node->required.size() && node->required[position] != property.first)
+            position++;
+        node->requiredIndex.push_back(position < node->required.size() ? (int32_t)position : -1);
+    }
+    return true;
+}
+
+
+
+/*  Schema of a member; allowed is false if additionalProperties forbids the
+    key, and required receives the position of the key in required, or -1.
+*/
+
+int32_t JsonSchema::memberSchema(const SchemaNode &node, const char *key, size_t keyLength, bool &allowed, int32_t &required) const
+{
+    allowed = true;
+    for (size_t i = 0; i < node.properties.size(); i++)
+    {
+        const std::string &name = node.properties[i].first;
+        if (name.size() == keyLength && memcmp(name.data(), key, keyLength) == 0)
+        {
+            required = node.requiredIndex[i];
+            return node.properties[i].second;
+        }
+    }
+
+    required = -1;
+    for (size_t i = 0; i < node.required.size(); i++)
+    {
+        if (node.required[i].size() == keyLength && memcmp(node.required[i].data(), key, keyLength) == 0)
+            required = i;
+    }
+    allowed = !node.noAdditionalProperties;
+    return node.additionalProperties;
+}
+
+
+
+// Schema of an element, the elements after the tuple are unconstrained
+
+int32_t JsonSchema::itemSchema(const SchemaNode &node, size_t index) const
+{
+    if (node.tupleItems.empty())
+        return node.items;
+    return index < node.tupleItems.size() ? node.tupleItems[index] : ANY_SCHEMA;
+}
+
+
+
+// Number without a fractional part, 1.0 included
+
+static bool isInteger(const JsonValue &value)
+{
+    int64_t integer;
+    double number;
+    if (value.getInt64(integer))
+        return true;
+    return value.getDouble(number) && std::isfinite(number) && std::floor(number) == number;
+}
+
+
+
+// Names of the types of a mask, "string or null"
+
+static std::string describeTypes(uint32_t types)
+{
+    std::string names;
+    for (uint32_t i = 0; i < sizeof(TYPENAMES) / sizeof(TYPENAMES[0]); i++)
+    {
+        if (types & (1 << i))
+            names += (names.empty() ? "" : " or ") + std::string(TYPENAMES[i]);
+    }
+    return names;
+}
+
+
+
+// Check a number against a bound, less or not greater than it depending on the keyword
+
+static bool checkBound(const JsonValue &value, const JsonValue *bound, double limit, bool below, bool exclusive,
+                       const char *keyword, std::string &message)
+{
+    double number = 0;
+    if (bound == nullptr || !value.getDouble(number))
+        return true;
+
+    bool valid = below ? (exclusive ? number < limit : number <= limit) : (exclusive ? number > limit : number >= limit);
+    if (!valid)
+        message = std::string(value.text, value.size) + " is " + (below ? "greater than " : "less than ") +
+                  (exclusive ? "or equal to " : "") + "the " + keyword + " " + std::string(bound->text, bound->size);
+    return valid;
+}
+
+
+
+/*  Checks of a value that do not need its children: type, and for scalars
+    enum, bounds, length and pattern. The message says what failed.
+*/
+
+bool JsonSchema::checkStart(const SchemaNode &node, const JsonValue &value, std::string &message) const
+{
+    if (node.allowsNothing)
+    {
+        message = "no value is allowed here";
+        return false;
+    }
+
+    if (node.types != 0 && (node.types & (1 << value.type)) == 0 &&
+        !((node.types & INTEGER_TYPE) && value.type == JSONNUMBER && isInteger(value)))
+    {
+        message = "expected " + describeTypes(node.types) + ", found " + TYPENAMES[value.type];
+        return false;
+    }
+
+    if (value.type == JSONNUMBER)
+    {
+        if (!checkBound(value, node.minimum, node.bounds[0], false, false, "minimum", message) ||
+            !checkBound(value, node.maximum, node.bounds[1], true, false, "maximum", message) ||
+            !checkBound(value, node.exclusiveMinimum, node.bounds[2], false, true, "exclusiveMinimum", message) ||
+            !checkBound(value, node.exclusiveMaximum, node.bounds[3], true, true, "exclusiveMaximum", message))
+            return false;
+    }
+    else if (value.type == JSONSTRING)
+    {
+        // Lengths are in characters: the bytes that do not continue a UTF-8 sequence
+        if (node.minLength >= 0 || node.maxLength >= 0)
+        {
+            int64_t length = 0;
+            for (uint32_t i = 0; i < value.size; i++)
+                length += ((unsigned char)value.text[i] & 0xC0) != 0x80;
+            if (length < node.minLength)
+            {
+                message = "string of " + std::to_string(length) + " characters is shorter than the minLength " + std::to_string(node.minLength);
+                return false;
+            }
+            if (node.maxLength >= 0 && length > node.maxLength)
+            {
+                message = "string of " + std::to_string(length) + " characters is longer than the maxLength " + std::to_string(node.maxLength);
+                return false;
+            }
+        }
+        if (node.hasPattern && !matchesPattern(node, value.text, value.size))
+        {
+            message = "string does not match the pattern " + node.patternText;
+            return false;
+        }
+    }
+
+    if (value.type != JSONOBJECT && value.type != JSONARRAY)
+        return checkEnum(node, value, message);
+    return true;
+}
+
+
+
+// Number of elements of an array against minItems and maxItems
+
+bool JsonSchema::checkCount(const SchemaNode &node, bool isArray, size_t count, std::string &message) const
+{
+    if (!isArray)
+        return true;
+    if ((int64_t)count < node.minItems)
+    {
+        message = "array of " + std::to_string(count) + " items is shorter than the minItems " + std::to_string(node.minItems);
+        return false;
+    }
+    if (node.maxItems >= 0 && (int64_t)count > node.maxItems)
+    {
+        message = "array of " + std::to_string(count) + " items is longer than the maxItems " + std::to_string(node.maxItems);
+        return false;
+    }
+    return true;
+}
+
+
+
+bool JsonSchema::checkEnum(const SchemaNode &node, const JsonValue &value, std::string &message) const
+{
+    if (node.enumValues == nullptr)
+        return true;
+
+    for (uint32_t i = 0; i < node.enumValues->size; i++)
+    {
+        if (equalValues(value, node.enumValues->items[i]))
+            return true;
+    }
+    message = "value is not one of the enum values";
+    return false;
+}
+
+
+
+// Key of a member as a token of a JSON Pointer: ~ becomes ~0 and / becomes ~1
+
+static std::string escapePointer(const char *key, size_t length)
+{
+    std::string token;
+    for (size_t i = 0; i < length; i++)
+    {
+        if (key[i] == '~')
+            token += "~0";
+        else if (key[i] == '/')
+            token += "~1";
+        else
+            token += key[i];
+    }
+    return token;
+}
+
+
+
+// Check a value and its children depth first, in the order the streaming validator meets them
+
+bool JsonSchema::validateValue(int32_t index, const JsonValue &value, std::string &path, SchemaError &error) const
+{
+    if (index == ANY_SCHEMA)
+        return true;
+
+    const SchemaNode &node = nodes[index];
+    std::string message;
+    if (!checkStart(node, value, message))
+    {
+        error = SchemaError{path, message};
+        return false;
+    }
+
+    size_t length = path.size();
+    if (value.type == JSONOBJECT)
+    {
+        for (uint32_t i = 0; i < value.size; i++)
+        {
+            const JsonMember &member = value.members[i];
+            bool allowed;
+            int32_t required;
+            int32_t child = memberSchema(node, member.key, member.keyLength, allowed, required);
+            path += "/" + escapePointer(member.key, member.keyLength);
+            if (!allowed)
+            {
+                error = SchemaError{path, "property is not allowed by additionalProperties"};
+                return false;
+            }
+            if (!validateValue(child, member.value, path, error))
+                return false;
+            path.resize(length);
+        }
+
+        for (const std::string &key : node.required)
+        {
+            if (value.find(key) == nullptr)
+            {
+                error = SchemaError{path, "required property \"" + key + "\" is missing"};
+                return false;
+            }
+        }
+    }
+    else if (value.type == JSONARRAY)
+    {
+        for (uint32_t i = 0; i < value.size; i++)
+        {
+            path += "/" + std::to_string(i);
+            if (!validateValue(itemSchema(node, i), value.items[i], path, error))
+                return false;
+            path.resize(length);
+        }
+
+        if (!checkCount(node, true, value.size, message))
+        {
+            error = SchemaError{path, message};
+            return false;
+        }
+    }
+    else
+        return true;
+
+    if (!checkEnum(node, value, message))
+    {
+        error = SchemaError{path, message};
+        return false;
+    }
+    return true;
+}
+
+
+
+/*  Check a document tree, the parse-then-validate way. Returns false and
+    the first violation, in document order, if it does not conform.
+*/
+
+bool JsonSchema::validate(const JsonValue &value, SchemaError &error) const
+{
+    std::string path;
+    return validateValue(root, value, path, error);
+}
+
+
+
+SchemaValidator::SchemaValidator(const JsonSchema &schema, JsonHandler *next) :
+    schema(schema), next(next), failed(false)
+{
+}
+
+
+
+SchemaValidator::~SchemaValidator()
+{
+    for (Capture &capture : captures)
+        delete capture.writer;
+}
+
+
+
+// JSON Pointer to the member or element being read in the first depth containers
+
+std::string SchemaValidator::pointer(size_t depth) const
+{
+    std::string path;
+    for (size_t i = 0; i < depth; i++)
+    {
+        if (frames[i].isArray)
+            path += "/" + std::to_string(frames[i].count - 1);
+        else
+            path += "/" + escapePointer(frames[i].key.data(), frames[i].key.size());
+    }
+    return path;
+}
+
+
+
+// Record the violation, returning false stops the parser
+
+bool SchemaValidator::fail(size_t depth, const std::string &message)
+{
+    error = SchemaError{pointer(depth), message};
+    failed = true;
+    return false;
+}
+
+
+
+/*  Find the schema of the value an event starts and check what can be
+    checked before its children. A container without a schema makes all of
+    its content unconstrained, so nothing is tracked inside it.
+*/
+
+bool SchemaValidator::startValue(const JsonValue &value, int32_t &node)
+{
+    node = schema.root;
+    if (!frames.empty())
+    {
+        Frame &parent = frames.back();
+        if (parent.node == ANY_SCHEMA)
+        {
+            node = ANY_SCHEMA;
+            return true;
+        }
+        node = parent.isArray ? schema.itemSchema(schema.nodes[parent.node], parent.count++) : parent.child;
+    }
+    if (node == ANY_SCHEMA)
+        return true;
+
+    std::string message;
+    if (!schema.checkStart(schema.nodes[node], value, message))
+        return fail(frames.size(), message);
+
+    // The enum of a container is checked on its text once it is complete
+    if ((value.type == JSONOBJECT || value.type == JSONARRAY) && schema.nodes[node].enumValues != nullptr)
+        captures.push_back(Capture{new JsonWriter(), frames.size(), node});
+    return true;
+}
+
+
+
+// Checks of the innermost container, which just ended
+
+bool SchemaValidator::endContainer()
+{
+    Frame &frame = frames.back();
+    std::string message;
+    if (frame.node != ANY_SCHEMA)
+    {
+        const SchemaNode &node = schema.nodes[frame.node];
+        for (size_t i = 0; !frame.isArray && i < node.required.size(); i++)
+        {
+            if (!seenKeys[frame.seen + i])
+                return fail(frames.size() - 1, "required property \"" + node.required[i] + "\" is missing");
+        }
+        seenKeys.resize(frame.seen);
+        if (!schema.checkCount(node, frame.isArray, frame.count, message))
+            return fail(frames.size() - 1, message);
+    }
+    frames.pop_back();
+
+    if (!captures.empty() && captures.back().depth == frames.size())
+    {
+        Capture capture = captures.back();
+        captures.pop_back();
+
+        JsonDocument document;
+        const std::string &text = capture.writer->text();
+        bool valid = document.parse(text.data(), text.size()) && schema.checkEnum(schema.nodes[capture.node], document.root(), message);
+        delete capture.writer;
+        if (!valid)
+            return fail(frames.size(), message);
+    }
+    return true;
+}
+
+
+
+template <typename Write>
+void SchemaValidator::writeAll(Write function)
+{
+    for (Capture &capture : captures)
+        function(*capture.writer);
+}
+
+
+
+bool SchemaValidator::startObject()
+{
+    JsonValue value;
+    value.type = JSONOBJECT;
+    value.size = 0;
+    value.members = nullptr;
+
+    int32_t node;
+    if (!startValue(value, node))
+        return false;
+    writeAll([](JsonWriter &writer) { writer.startObject(); });
+
+    size_t seen = seenKeys.size();
+    if (node != ANY_SCHEMA)
+        seenKeys.resize(seen + schema.nodes[node].required.size(), 0);
+    frames.push_back(Frame{node, false, 0, std::string(), ANY_SCHEMA, seen});
+    return next == nullptr || next->startObject();
+}
+
+
+
+bool SchemaValidator::endObject()
+{
+    writeAll([](JsonWriter &writer) { writer.endObject(); });
+    return endContainer() && (next == nullptr || next->endObject());
+}
+
+
+
+bool SchemaValidator::startArray()
+{
+    JsonValue value;
+    value.type = JSONARRAY;
+    value.size = 0;
+    value.items = nullptr;
+
+    int32_t node;
+    if (!startValue(value, node))
+        return false;
+    writeAll([](JsonWriter &writer) { writer.startArray(); });
+
+    frames.push_back(Frame{node, true, 0, std::string(), ANY_SCHEMA, seenKeys.size()});
+    return next == nullptr || next->startArray();
+}
+
+
+
+bool SchemaValidator::endArray()
+{
+    writeAll([](JsonWriter &writer) { writer.endArray(); });
+    return endContainer() && (next == nullptr || next->endArray());
+}
+
+
+
+// A key selects the schema of the member that follows and marks a required key as found
+
+bool SchemaValidator::key(const std::string &key)
+{
+    Frame &frame = frames.back();
+    if (frame.node != ANY_SCHEMA)
+    {
+        const SchemaNode &node = schema.nodes[frame.node];
+        frame.key = key;
+        frame.count++;
+
+        bool allowed;
+        int32_t required;
+        frame.child = schema.memberSchema(node, key.data(), key.size(), allowed, required);
+        if (required >= 0)
+            seenKeys[frame.seen + required] = 1;
+        if (!allowed)
+            return fail(frames.size(), "property is not allowed by additionalProperties");
+    }
+    writeAll([&](JsonWriter &writer) { writer.key(key); });
+    return next == nullptr || next->key(key);
+}
+
+
+
+bool SchemaValidator::string(const std::string &value)
+{
+    JsonValue scalar;
+    scalar.type = JSONSTRING;
+    scalar.size = value.size();
+    scalar.text = value.c_str();
+
+    int32_t node;
+    if (!startValue(scalar, node))
+        return false;
+    writeAll([&](JsonWriter &writer) { writer.string(value); });
+    return next == nullptr || next->string(value);
+}
+
+
+
+bool SchemaValidator::number(const std::string &text)
+{
+    JsonValue scalar;
+    scalar.type = JSONNUMBER;
+    scalar.size = text.size();
+    scalar.text = text.c_str();
+
+    int32_t node;
+    if (!startValue(scalar, node))
+        return false;
+    writeAll([&](JsonWriter &writer) { writer.rawNumber(text.data(), text.size()); });
+    return next == nullptr || next->number(text);
+}
+
+
+
+bool SchemaValidator::boolean(bool value)
+{
+    JsonValue scalar;
+    scalar.type = JSONBOOLEAN;
+    scalar.size = 0;
+    scalar.boolean = value;
+
+    int32_t node;
+    if (!startValue(scalar, node))
+        return false;
+    writeAll([&](JsonWriter &writer) { writer.boolean(value); });
+    return next == nullptr || next->boolean(value);
+}
+
+
+
+bool SchemaValidator::null()
+{
+    JsonValue scalar;
+    scalar.type = JSONNULL;
+    scalar.size = 0;
+    scalar.text = nullptr;
+
+    int32_t node;
+    if (!startValue(scalar, node))
+        return false;
+    writeAll([](JsonWriter &writer) { writer.null(); });
+    return next == nullptr || next->null();
+}
\ No newline at end of file
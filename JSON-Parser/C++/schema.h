@@ -0,0 +1,144 @@
+// JSON Schema validation: a schema (draft-07 keywords type, properties,
+// additionalProperties, required, items, enum, minimum, maximum, exclusiveMinimum,
+// exclusiveMaximum, minLength, maxLength, minItems, maxItems and pattern) is
+// compiled once, then checked against a document tree or during the parse itself
+// by a handler of the streaming parser, which stops at the first violation.
+
+const int32_t ANY_SCHEMA = -1;      // Index of the schema of a value nothing is required from
+
+// Bit of the "integer" type in SchemaNode::types, the others are 1 << jsonTypes
+const uint32_t INTEGER_TYPE = 1 << 6;
+
+// How a pattern is matched: most patterns are plain text, which needs no regex
+
+typedef enum {
+    PATTERNREGEX,       // std::regex
+    PATTERNCONTAINS,    // abc
+    PATTERNPREFIX,      // ^abc
+    PATTERNSUFFIX,      // abc$
+    PATTERNEXACT        // ^abc$
+} patternKinds;
+
+
+struct SchemaNode
+{
+    bool                        allowsNothing;          // The schema false
+    uint32_t                    types;                  // Types allowed, 0 for any
+    std::vector <std::pair <std::string, int32_t>> properties;  // Schemas of members by key
+    std::vector <int32_t>       requiredIndex;          // For each property, its position in required, -1 if optional
+    int32_t                     additionalProperties;   // Schema of the other members
+    bool                        noAdditionalProperties; // additionalProperties is false
+    std::vector <std::string>   required;               // Keys that must be present
+    int32_t                     items;                  // Schema of every element
+    std::vector <int32_t>       tupleItems;             // Schemas of the first elements, when items is an array
+    const JsonValue             *enumValues;            // Array of the values allowed, nullptr if any
+    const JsonValue             *minimum;               // Numbers of the schema, nullptr when absent
+    const JsonValue             *maximum;
+    const JsonValue             *exclusiveMinimum;
+    const JsonValue             *exclusiveMaximum;
+    double                      bounds[4];              // Their values, in the same order
+    int64_t                     minLength;              // -1 when absent
+    int64_t                     maxLength;
+    int64_t                     minItems;
+    int64_t                     maxItems;
+    bool                        hasPattern;
+    patternKinds                patternKind;
+    std::regex                  pattern;                // ECMAScript, matched anywhere in the string
+    std::string                 patternText;
+    std::string                 patternLiteral;         // Text of a pattern that is not PATTERNREGEX
+};
+
+
+// First violation found: where and why
+
+struct SchemaError
+{
+    std::string     path;       // JSON Pointer to the value, "" for the root
+    std::string     message;
+};
+
+
+class JsonSchema
+{
+public:
+    JsonSchema();
+
+    JsonSchema(const JsonSchema&) = delete;
+    JsonSchema& operator=(const JsonSchema&) = delete;
+
+    bool load(const char *data, size_t length);     // false if not valid JSON or not a schema of this subset
+    bool validate(const JsonValue &value, SchemaError &error) const;   // false at the first violation
+
+private:
+    friend class SchemaValidator;
+
+    JsonDocument                document;       // Text of the schema, enum values and bounds point in it
+    std::vector <SchemaNode>    nodes;          // The root first
+    int32_t                     root;
+
+    bool compile(const JsonValue &schema, int32_t &index);
+    int32_t memberSchema(const SchemaNode &node, const char *key, size_t keyLength, bool &allowed, int32_t &required) const;
+    int32_t itemSchema(const SchemaNode &node, size_t index) const;
+    bool checkStart(const SchemaNode &node, const JsonValue &value, std::string &message) const;
+    bool checkCount(const SchemaNode &node, bool isArray, size_t count, std::string &message) const;
+    bool checkEnum(const SchemaNode &node, const JsonValue &value, std::string &message) const;
+    bool validateValue(int32_t index, const JsonValue &value, std::string &path, SchemaError &error) const;
+};
+
+
+class JsonWriter;
+
+// Checks the events of the streaming parser against a schema, and passes them
+// on to the next handler, if any, as long as the document conforms
+
+class SchemaValidator : public JsonHandler
+{
+public:
+    SchemaValidator(const JsonSchema &schema, JsonHandler *next = nullptr);
+    ~SchemaValidator();
+
+    bool startObject() override;
+    bool endObject() override;
+    bool startArray() override;
+    bool endArray() override;
+    bool key(const std::string &key) override;
+    bool string(const std::string &value) override;
+    bool number(const std::string &text) override;
+    bool boolean(bool value) override;
+    bool null() override;
+
+    bool hasError() const { return failed; }
+    const SchemaError &getError() const { return error; }
+
+private:
+    struct Frame
+    {
+        int32_t             node;       // Schema of the container, ANY_SCHEMA if unconstrained
+        bool                isArray;
+        size_t              count;      // Elements or members seen so far
+        std::string         key;        // Key of the member being read
+        int32_t             child;      // Schema of the member being read
+        size_t              seen;       // Position in seenKeys of the flags of its required keys
+    };
+
+    struct Capture
+    {
+        JsonWriter          *writer;    // Text of a container whose schema has an enum
+        size_t              depth;      // Containers open when it started
+        int32_t             node;
+    };
+
+    const JsonSchema        &schema;
+    JsonHandler             *next;
+    std::vector <Frame>     frames;         // Open containers, innermost last
+    std::vector <Capture>   captures;
+    std::vector <char>      seenKeys;       // For each required key of the open objects, whether it was found
+    SchemaError             error;
+    bool                    failed;
+
+    std::string pointer(size_t depth) const;
+    bool fail(size_t depth, const std::string &message);
+    bool startValue(const JsonValue &value, int32_t &node);
+    bool endContainer();
+    template <typename Write> void writeAll(Write function);
+};
\ No newline at end of file
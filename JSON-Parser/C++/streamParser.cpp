@@ -0,0 +1,361 @@
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <cctype>
+#include <unistd.h>
+
+#include "common.h"
+#include "token.h"
+#include "numbers.h"
+#include "unescape.h"
+#include "utf8.h"
+#include "lexer.h"
+#include "streamParser.h"
+
+// What the pull parser accepts next
+typedef enum {
+    EXPECTROOT,         // The outermost { or [
+    EXPECTVALUE,        // A value, after : or after , in an array
+    EXPECTVALUEOREND,   // A value or ], after [
+    EXPECTKEY,          // A key, after , in an object
+    EXPECTKEYOREND,     // A key or }, after {
+    EXPECTCOLON,        // :, after a key
+    EXPECTCOMMAOREND,   // , or the closing bracket, after a value
+    EXPECTDONE          // Nothing but whitespace, after the outermost value
+} parserStates;
+
+// Drop the consumed text from the buffer once it is this large
+const size_t COMPACT_THRESHOLD = 64 * 1024;
+
+
+
+JsonPullParser::JsonPullParser(size_t maxDepth) : pos(0), consumed(0), scanned(0), maxDepth(maxDepth),
+                                                  finished(false), failed(false), expect(EXPECTROOT)
+{
+}
+
+
+
+void JsonPullParser::feed(const char *data, size_t length)
+{
+    // Keep only the unconsumed text, so the buffer stays the size of a chunk plus a token
+    if (pos == buffer.size() || pos >= COMPACT_THRESHOLD)
+    {
+        buffer.erase(0, pos);
+        consumed += pos;
+        pos = 0;
+    }
+    buffer.append(data, length);
+}
+
+
+
+void JsonPullParser::finish()
+{
+    finished = true;
+}
+
+
+
+pullStatus JsonPullParser::fail()
+{
+    failed = true;
+    return PULLERROR;
+}
+
+
+
+// A value is complete: the parent expects a comma or its end, or the document is over
+
+void JsonPullParser::valueDone()
+{
+    expect = containers.empty() ? EXPECTDONE : EXPECTCOMMAOREND;
+}
+
+
+
+/*  Check a string starting at its opening doublequote, from pos onwards.
+    Returns 1 and moves pos after the closing doublequote, 0 if the text ends
+    inside the string (pos is left where checking can resume, never inside an
+    escape) or -1 if the string has a control character or an invalid escape.
+*/
+
+static int scanStreamString(const char *&pos, const char *end)
+{
+    while (pos < end)
+    {
+        char ch = *pos;
+        if (ch == '"')
+        {
+            pos++;
+            return 1;
+        }
+
+        if (ch == '\\')
+        {
+            if (end - pos < 2)
+                return 0;
+
+            if (pos[1] == 'u')
+            {
+                // Unicode escape sequence (\uXXXX)
+                if (end - pos < 6)
+                    return 0;
+                for (int j = 2; j < 6; j++)
+                {
+                    if (!isxdigit((unsigned char)pos[j]))
+                        return -1;
+                }
+                pos += 6;
+                continue;
+            }
+            if (!isValidEscapeCharacterForJSON(pos[1]))
+                return -1;
+            pos += 2;
+            continue;
+        }
+
+        if (isControlCharacter(ch))
+            return -1;
+        pos++;
+    }
+    return 0;
+}
+
+
+
+/*  Return the next event.
+    Whitespace, colons and commas are consumed without an event. A token cut by
+    the end of the buffered text is left in the buffer and PULLNEEDINPUT is
+    returned, the same call succeeds once the rest has been fed.
+    Example:
+        {"a": [1, true]}  ->  STARTOBJECT, KEYEVENT a, STARTARRAY, NUMBEREVENT 1,
+                              BOOLEANEVENT true, ENDARRAY, ENDOBJECT, then PULLEND
+*/
+
+pullStatus JsonPullParser::next(JsonEvent &event)
+{
+    if (failed)
+        return PULLERROR;
+
+    while (true)
+    {
+        while (pos < buffer.size() && isWhitespace(buffer[pos]))
+            pos++;
+
+        if (pos == buffer.size())
+        {
+            if (!finished)
+                return PULLNEEDINPUT;
+            return expect == EXPECTDONE ? PULLEND : fail();
+        }
+
+        // Text after the outermost value
+        if (expect == EXPECTDONE)
+            return fail();
+
+        const char *start = buffer.data() + pos;
+        const char *end = buffer.data() + buffer.size();
+
+        switch (*start)
+        {
+            case '{':
+            case '[':
+                if (expect != EXPECTROOT && expect != EXPECTVALUE && expect != EXPECTVALUEOREND)
+                    return fail();
+                if (containers.size() >= maxDepth)
+                    return fail();
+
+                containers.push_back(*start);
+                expect = *start == '{' ? EXPECTKEYOREND : EXPECTVALUEOREND;
+                event.type = *start == '{' ? STARTOBJECT : STARTARRAY;
+                pos++;
+                return PULLEVENT;
+
+            case '}':
+            case ']':
+                {
+                    bool object = *start == '}';
+                    if (containers.empty() || containers.back() != (object ? '{' : '['))
+                        return fail();
+                    if (expect != EXPECTCOMMAOREND && expect != (object ? EXPECTKEYOREND : EXPECTVALUEOREND))
+                        return fail();
+
+                    containers.pop_back();
+                    valueDone();
+                    event.type = object ? ENDOBJECT : ENDARRAY;
+                    pos++;
+                    return PULLEVENT;
+                }
+
+            case ':':
+                if (expect != EXPECTCOLON)
+                    return fail();
+                expect = EXPECTVALUE;
+                pos++;
+                continue;
+
+            case ',':
+                if (expect != EXPECTCOMMAOREND)
+                    return fail();
+                expect = containers.back() == '{' ? EXPECTKEY : EXPECTVALUE;
+                pos++;
+                continue;
+
+            case '"':
+                {
+                    bool isKey = expect == EXPECTKEY || expect == EXPECTKEYOREND;
+                    if (!isKey && expect != EXPECTVALUE && expect != EXPECTVALUEOREND)
+                        return fail();
+
+                    // Resume where the previous call stopped inside the same string
+                    const char *stringEnd = start + (scanned > 0 ? scanned : 1);
+                    int result = scanStreamString(stringEnd, end);
+                    if (result < 0)
+                        return fail();
+                    if (result == 0)
+                    {
+                        if (finished)
+                            return fail();
+                        scanned = stringEnd - start;
+                        return PULLNEEDINPUT;
+                    }
+                    scanned = 0;
+
+                    // The whole string is buffered, so a character is never cut by a chunk boundary here
+                    if (!validateUtf8(start + 1, stringEnd - start - 2))
+                        return fail();
+
+                    event.text = unescapeString(start + 1, stringEnd - 1);
+                    pos = stringEnd - buffer.data();
+                    if (isKey)
+                    {
+                        event.type = KEYEVENT;
+                        expect = EXPECTCOLON;
+                    }
+                    else
+                    {
+                        event.type = STRINGEVENT;
+                        valueDone();
+                    }
+                    return PULLEVENT;
+                }
+
+            default:
+                {
+                    if (expect != EXPECTVALUE && expect != EXPECTVALUEOREND)
+                        return fail();
+
+                    // Numbers and literals end where the lexer ends them
+                    const char *valueEnd = start;
+                    while (valueEnd < end && !isClosingBracketOrComma(*valueEnd) && !isWhitespace(*valueEnd))
+                        valueEnd++;
+                    if (valueEnd == end && !finished)
+                        return PULLNEEDINPUT;
+
+                    tokenTypes valueType = getValueType(start, valueEnd);
+                    if (valueType == NUMBER)
+                    {
+                        event.type = NUMBEREVENT;
+                        event.text.assign(start, valueEnd);
+                    }
+                    else if (valueType == BOOLEAN)
+                    {
+                        event.type = BOOLEANEVENT;
+                        event.boolean = *start == 't';
+                    }
+                    else if (valueType == NULLVALUE)
+                        event.type = NULLEVENT;
+                    else
+                        return fail();
+
+                    pos = valueEnd - buffer.data();
+                    valueDone();
+                    return PULLEVENT;
+                }
+        }
+    }
+}
+
+
+
+JsonSaxParser::JsonSaxParser(JsonHandler &handler, size_t maxDepth) : pull(maxDepth), handler(handler), stopped(false)
+{
+}
+
+
+
+// Hand every complete event to the handler
+
+bool JsonSaxParser::dispatchEvents()
+{
+    pullStatus status;
+    while ((status = pull.next(event)) == PULLEVENT)
+    {
+        bool proceed = true;
+        switch (event.type)
+        {
+            case STARTOBJECT:   proceed = handler.startObject(); break;
+            case ENDOBJECT:     proceed = handler.endObject(); break;
+            case STARTARRAY:    proceed = handler.startArray(); break;
+            case ENDARRAY:      proceed = handler.endArray(); break;
+            case KEYEVENT:      proceed = handler.key(event.text); break;
+            case STRINGEVENT:   proceed = handler.string(event.text); break;
+            case NUMBEREVENT:   proceed = handler.number(event.text); break;
+            case BOOLEANEVENT:  proceed = handler.boolean(event.boolean); break;
+            case NULLEVENT:     proceed = handler.null(); break;
+        }
+        if (!proceed)
+            return false;
+    }
+    return status != PULLERROR;
+}
+
+
+
+bool JsonSaxParser::feed(const char *data, size_t length)
+{
+    if (stopped)
+        return false;
+
+    pull.feed(data, length);
+    stopped = !dispatchEvents();
+    return !stopped;
+}
+
+
+
+bool JsonSaxParser::finish()
+{
+    if (stopped)
+        return false;
+
+    pull.finish();
+    stopped = !dispatchEvents();
+    return !stopped && pull.next(event) == PULLEND;
+}
+
+
+
+/*  Parse the text read from a file descriptor (file, pipe or socket) in chunks
+    of chunkSize bytes. Returns true if it is a complete valid document and the
+    handler never stopped the parse.
+*/
+
+bool parseStream(int fd, JsonHandler &handler, size_t chunkSize)
+{
+    JsonSaxParser parser(handler);
+    std::vector <char> chunk(chunkSize);
+
+    ssize_t bytesRead;
+    while ((bytesRead = read(fd, chunk.data(), chunk.size())) > 0)
+    {
+        if (!parser.feed(chunk.data(), bytesRead))
+            return false;
+    }
+    if (bytesRead < 0)
+        return false;
+
+    return parser.finish();
+}
@@ -0,0 +1,106 @@
+// Incremental parsing of text that arrives in chunks (file, pipe, socket).
+// Memory is the nesting depth plus the token being read, never the document.
+
+// Events of the pull parser
+
+typedef enum {
+    STARTOBJECT,        // {
+    ENDOBJECT,          // }
+    STARTARRAY,         // [
+    ENDARRAY,           // ]
+    KEYEVENT,           // Key of an object member, text holds it unescaped
+    STRINGEVENT,        // String value, text holds it unescaped
+    NUMBEREVENT,        // Number, text holds it as written
+    BOOLEANEVENT,       // true or false, see boolean
+    NULLEVENT           // null
+} jsonEvents;
+
+// Results of JsonPullParser::next()
+
+typedef enum {
+    PULLEVENT,          // An event was returned
+    PULLNEEDINPUT,      // The buffered text ends inside a token, feed() more
+    PULLEND,            // The document is complete (after finish())
+    PULLERROR           // The text is not valid JSON
+} pullStatus;
+
+
+struct JsonEvent
+{
+    jsonEvents  type;
+    std::string text;       // Key, string or number
+    bool        boolean;    // Value of true or false
+};
+
+
+// Pull parser: the caller feeds chunks and asks for the next event
+
+class JsonPullParser
+{
+public:
+    JsonPullParser(size_t maxDepth = DEFAULT_MAX_DEPTH);
+
+    void feed(const char *data, size_t length);     // Append the next chunk
+    void finish();                                  // No more chunks will come
+    pullStatus next(JsonEvent &event);
+
+    size_t depth() const { return containers.size(); }
+    size_t offset() const { return consumed + pos; }    // Bytes of the text consumed so far
+
+private:
+    std::string         buffer;         // Unconsumed text, the token being read and the last chunk
+    size_t              pos;            // Start of the unconsumed text in the buffer
+    size_t              consumed;       // Bytes dropped from the front of the buffer
+    size_t              scanned;        // Bytes of an incomplete string already checked
+    size_t              maxDepth;       // More nested containers are an error
+    bool                finished;       // finish() was called
+    bool                failed;         // An error was returned
+    int                 expect;         // What may come next (parserStates in streamParser.cpp)
+    std::vector <char>  containers;     // { or [ of the open containers, innermost last
+
+    pullStatus fail();
+    void valueDone();
+};
+
+
+// Receives the events of JsonSaxParser, a handler returns false to stop parsing
+
+class JsonHandler
+{
+public:
+    virtual ~JsonHandler() {}
+    virtual bool startObject() { return true; }
+    virtual bool endObject() { return true; }
+    virtual bool startArray() { return true; }
+    virtual bool endArray() { return true; }
+    virtual bool key(const std::string &/*key*/) { return true; }
+    virtual bool string(const std::string &/*value*/) { return true; }
+    virtual bool number(const std::string &/*text*/) { return true; }
+    virtual bool boolean(bool /*value*/) { return true; }
+    virtual bool null() { return true; }
+};
+
+
+// Event-driven parser: chunks are fed as they are read, events go to the handler
+
+class JsonSaxParser
+{
+public:
+    JsonSaxParser(JsonHandler &handler, size_t maxDepth = DEFAULT_MAX_DEPTH);
+
+    bool feed(const char *data, size_t length);     // false once the text is invalid or the handler stopped
+    bool finish();                                  // true if a complete valid document was read
+
+private:
+    JsonPullParser  pull;
+    JsonHandler     &handler;
+    JsonEvent       event;          // Reused, so its text keeps its capacity
+    bool            stopped;        // Invalid text or a handler returned false
+
+    bool dispatchEvents();
+};
+
+
+// Function declarations
+
+bool parseStream(int fd, JsonHandler &handler, size_t chunkSize = 64 * 1024);
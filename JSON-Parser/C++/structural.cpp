@@ -0,0 +1,321 @@
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "structural.h"
+
+// Bit masks of one 64-byte block, bit i is set when byte i is of the class
+struct BlockMasks
+{
+    uint64_t quote;         // "
+    uint64_t backslash;     // '\'
+    uint64_t structural;    // { } [ ] ( ) : ,
+    uint64_t whitespace;    // space, tab, line feed, carriage return
+};
+
+typedef void (*ClassifyFunction)(const char *block, BlockMasks &masks);
+
+struct StructuralImplementation
+{
+    const char          *name;          // "avx2", "sse2" or "scalar"
+    ClassifyFunction    classify;       // Fills the masks of a 64-byte block
+    bool                (*supported)(); // Whether the CPU can run it
+};
+
+const size_t BLOCK_SIZE = 64;
+
+
+
+// Classify a block one byte at a time, works on any CPU
+
+static void classifyScalar(const char *block, BlockMasks &masks)
+{
+    masks = BlockMasks{0, 0, 0, 0};
+    for (size_t i = 0; i < BLOCK_SIZE; i++)
+    {
+        uint64_t bit = uint64_t(1) << i;
+        switch (block[i])
+        {
+            case '"':
+                masks.quote |= bit;
+                break;
+
+            case '\\':
+                masks.backslash |= bit;
+                break;
+
+            case '{': case '}': case '[': case ']': case '(': case ')': case ':': case ',':
+                masks.structural |= bit;
+                break;
+
+            case ' ': case '\t': case '\n': case '\r':
+                masks.whitespace |= bit;
+                break;
+        }
+    }
+}
+
+
+
+static bool alwaysSupported()
+{
+    return true;
+}
+
+
+
+#if defined(__x86_64__) || defined(__i386__)
+
+/*  Classify a block 16 bytes at a time.
+    The brackets are matched with one comparison per pair: setting bit 0x20 maps
+    '[' to '{' and ']' to '}', clearing bit 0x01 maps ')' to '('.
+*/
+
+__attribute__((target("sse2")))
+static void classifySse2(const char *block, BlockMasks &masks)
+{
+    masks = BlockMasks{0, 0, 0, 0};
+    for (size_t i = 0; i < BLOCK_SIZE; i += 16)
+    {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(block + i));
+        __m128i lower = _mm_or_si128(chunk, _mm_set1_epi8(0x20));
+        __m128i round = _mm_and_si128(chunk, _mm_set1_epi8((char)0xFE));
+
+        __m128i structural = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(lower, _mm_set1_epi8('{')), _mm_cmpeq_epi8(lower, _mm_set1_epi8('}'))),
+            _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(':')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8(','))),
+                         _mm_cmpeq_epi8(round, _mm_set1_epi8('('))));
+        __m128i whitespace = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\t'))),
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r'))));
+
+        masks.quote      |= uint64_t((uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('"')))) << i;
+        masks.backslash  |= uint64_t((uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\\')))) << i;
+        masks.structural |= uint64_t((uint16_t)_mm_movemask_epi8(structural)) << i;
+        masks.whitespace |= uint64_t((uint16_t)_mm_movemask_epi8(whitespace)) << i;
+    }
+}
+
+
+
+// Classify a block 32 bytes at a time, same comparisons as classifySse2()
+
+__attribute__((target("avx2")))
+static void classifyAvx2(const char *block, BlockMasks &masks)
+{
+    masks = BlockMasks{0, 0, 0, 0};
+    for (size_t i = 0; i < BLOCK_SIZE; i += 32)
+    {
+        __m256i chunk = _mm256_loadu_si256((const __m256i *)(block + i));
+        __m256i lower = _mm256_or_si256(chunk, _mm256_set1_epi8(0x20));
+        __m256i round = _mm256_and_si256(chunk, _mm256_set1_epi8((char)0xFE));
+
+        __m256i structural = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(lower, _mm256_set1_epi8('{')), _mm256_cmpeq_epi8(lower, _mm256_set1_epi8('}'))),
+            _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(':')), _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(','))),
+                            _mm256_cmpeq_epi8(round, _mm256_set1_epi8('('))));
+        __m256i whitespace = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\t'))),
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\r'))));
+
+        masks.quote      |= uint64_t((uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('"')))) << i;
+        masks.backslash  |= uint64_t((uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\\')))) << i;
+        masks.structural |= uint64_t((uint32_t)_mm256_movemask_epi8(structural)) << i;
+        masks.whitespace |= uint64_t((uint32_t)_mm256_movemask_epi8(whitespace)) << i;
+    }
+}
+
+
+
+static bool sse2Supported()
+{
+    return __builtin_cpu_supports("sse2");
+}
+
+
+
+static bool avx2Supported()
+{
+    return __builtin_cpu_supports("avx2");
+}
+
+#endif
+
+// Fastest first
+static const StructuralImplementation IMPLEMENTATIONS[] = {
+#if defined(__x86_64__) || defined(__i386__)
+    {"avx2", classifyAvx2, avx2Supported},
+    {"sse2", classifySse2, sse2Supported},
+#endif
+    {"scalar", classifyScalar, alwaysSupported}
+};
+
+
+
+// The first implementation the CPU supports
+
+static const StructuralImplementation *bestImplementation()
+{
+    for (const StructuralImplementation &implementation : IMPLEMENTATIONS)
+    {
+        if (implementation.supported())
+            return &implementation;
+    }
+    return &IMPLEMENTATIONS[sizeof(IMPLEMENTATIONS) / sizeof(IMPLEMENTATIONS[0]) - 1];
+}
+
+
+
+// Picked once, on first use (a function-local static is initialized once even with several threads)
+
+static const StructuralImplementation *&selectedImplementation()
+{
+    static const StructuralImplementation *selected = bestImplementation();
+    return selected;
+}
+
+
+
+// Name of the implementation in use, picked for the CPU on first use
+
+const char *getStructuralImplementation()
+{
+    return selectedImplementation()->name;
+}
+
+
+
+// Force an implementation ("avx2", "sse2" or "scalar"), false if the CPU cannot run it.
+// Not to be called while other threads are parsing
+
+bool setStructuralImplementation(const std::string &name)
+{
+    for (const StructuralImplementation &implementation : IMPLEMENTATIONS)
+    {
+        if (name == implementation.name && implementation.supported())
+        {
+            selectedImplementation() = &implementation;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+
+/*  Characters escaped by a backslash.
+    A backslash escapes the next character unless it is escaped itself, so in
+    \\\" the first and third backslashes escape. escapedFirst carries an escape
+    from the last byte of the previous block into bit 0.
+*/
+
+static uint64_t findEscaped(uint64_t backslash, uint64_t &escapedFirst)
+{
+    uint64_t escaped = escapedFirst;
+    escapedFirst = 0;
+    if (backslash == 0)
+        return escaped;
+
+    backslash &= ~escaped;
+    while (backslash != 0)
+    {
+        int bit = __builtin_ctzll(backslash);
+        if (bit == 63)
+        {
+            escapedFirst = 1;
+            break;
+        }
+
+        escaped |= uint64_t(1) << (bit + 1);
+        backslash = bit == 62 ? 0 : backslash & (~uint64_t(0) << (bit + 2));
+    }
+    return escaped;
+}
+
+
+
+/*  Prefix XOR: bit i is the parity of the quotes up to and including byte i,
+    which sets the bits from an opening doublequote up to its closing one.
+    Example:
+        quotes : __"___"__"_"__
+        result : __11110__110__
+*/
+
+static uint64_t prefixXor(uint64_t bits)
+{
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+
+
+/*  Find the positions where tokens start, 64 bytes at a time.
+    The index holds every structural character outside strings, every opening
+    doublequote and the first character of each run of other non-whitespace
+    characters outside strings (numbers, true, false, null or invalid text).
+    The lexer jumps from one position to the next and never looks at whitespace.
+
+    Validation is left to the lexer: a string that is not terminated simply has
+    no more positions after its opening doublequote.
+    Returns false for inputs of 4 GiB or more, whose positions do not fit.
+*/
+
+bool findStructuralIndexes(const char *data, size_t length, std::vector <uint32_t> &indexes)
+{
+    indexes.clear();
+    if (length > UINT32_MAX)
+        return false;
+
+    ClassifyFunction classify = selectedImplementation()->classify;
+    uint64_t escapedFirst = 0;      // The first byte of the block is escaped
+    uint64_t inStringBefore = 0;    // All ones if the previous block ended inside a string
+    uint64_t scalarBefore = 0;      // 1 if the previous block ended inside a number or literal
+
+    for (size_t blockStart = 0; blockStart < length; blockStart += BLOCK_SIZE)
+    {
+        BlockMasks masks;
+        if (length - blockStart >= BLOCK_SIZE)
+            classify(data + blockStart, masks);
+        else
+        {
+            // Pad the last block with whitespace
+            char block[BLOCK_SIZE];
+            memset(block, ' ', BLOCK_SIZE);
+            memcpy(block, data + blockStart, length - blockStart);
+            classify(block, masks);
+        }
+
+        uint64_t escaped = findEscaped(masks.backslash, escapedFirst);
+        uint64_t quotes = masks.quote & ~escaped;
+        uint64_t inString = prefixXor(quotes) ^ inStringBefore;
+        inStringBefore = uint64_t(int64_t(inString) >> 63);
+
+        uint64_t scalar = ~(masks.structural | masks.whitespace | quotes | inString);
+        uint64_t scalarStarts = scalar & ~((scalar << 1) | scalarBefore);
+        scalarBefore = scalar >> 63;
+
+        uint64_t positions = (masks.structural & ~inString) | (quotes & inString) | scalarStarts;
+        if (positions == 0)
+            continue;
+
+        size_t count = indexes.size();
+        indexes.resize(count + __builtin_popcountll(positions));
+        uint32_t *out = indexes.data() + count;
+        while (positions != 0)
+        {
+            *out++ = uint32_t(blockStart + __builtin_ctzll(positions));
+            positions &= positions - 1;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,10 @@
+// Stage 1 of the lexer: positions of the structural characters, the opening
+// doublequotes of strings and the first character of numbers and literals
+
+// Function declarations
+
+bool findStructuralIndexes(const char *data, size_t length, std::vector <uint32_t> &indexes);
+
+const char *getStructuralImplementation();
+
+bool setStructuralImplementation(const std::string &name);
@@ -0,0 +1,102 @@
+/*  Typed reading test: reads a file into the structs below with readJson()
+    and prints every member, one per line, or the error message. runtests.bash
+    compares the output for each tests/typed/NAME.json with NAME.out.
+
+    Build (from the JSON-Parser/C++ directory):
+        g++ -o typed_test common.cpp numbers.cpp structural.cpp utf8.cpp lexer.cpp parser.cpp unescape.cpp typed.cpp tests/typed/typedTest.cpp
+
+    Run:
+        ./typed_test <fileName>
+*/
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <limits>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+
+#include "../../common.h"
+#include "../../token.h"
+#include "../../parser.h"
+#include "../../typed.h"
+
+
+struct Item
+{
+    std::string             sku;
+    uint16_t                quantity = 0;
+    float                   weight = 0;
+};
+
+JSON_FIELDS(Item, JSON_FIELD(sku), JSON_FIELD(quantity), JSON_FIELD(weight))
+
+struct Order
+{
+    int64_t                 id = 0;
+    int8_t                  priority = 0;
+    bool                    paid = false;
+    double                  total = 0;
+    std::string             customer;
+    std::vector <Item>      items;
+    std::vector <int32_t>   codes;
+    std::optional <int64_t> parent;
+    std::string             note = "unchanged";
+};
+
+JSON_FIELDS(Order, JSON_FIELD(id), JSON_FIELD(priority), JSON_FIELD(paid), JSON_FIELD(total),
+            JSON_FIELD_AS("customer_name", customer), JSON_FIELD(items), JSON_FIELD(codes),
+            JSON_FIELD(parent), JSON_FIELD(note))
+
+
+
+// Print the members of an order, with the optional ones marked when empty
+static void printOrder(const Order &order)
+{
+    std::cout << "id = " << order.id << "\n";
+    std::cout << "priority = " << (int) order.priority << "\n";
+    std::cout << "paid = " << (order.paid ? "true" : "false") << "\n";
+    std::cout << "total = " << order.total << "\n";
+    std::cout << "customer = " << order.customer << "\n";
+    for (size_t i = 0; i < order.items.size(); i++)
+        std::cout << "items[" << i << "] = " << order.items[i].sku << ", " << order.items[i].quantity
+                  << ", " << order.items[i].weight << "\n";
+    for (size_t i = 0; i < order.codes.size(); i++)
+        std::cout << "codes[" << i << "] = " << order.codes[i] << "\n";
+    std::cout << "parent = " << (order.parent ? std::to_string(*order.parent) : "(none)") << "\n";
+    std::cout << "note = " << order.note << "\n";
+}
+
+
+
+int main(int argc, char* argv[])
+{
+    if (argc != 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <fileName>\n";
+        return 1;
+    }
+
+    std::ifstream inputFile(argv[1], std::ios::binary);
+    if (!inputFile.is_open())
+    {
+        std::cerr << "Error in opening file " << argv[1] << "\n";
+        return 1;
+    }
+    std::stringstream buffer;
+    buffer << inputFile.rdbuf();
+    std::string text = buffer.str();
+
+    Order order;
+    ParseError error;
+    if (readJson(text.data(), text.size(), order, error))
+        printOrder(order);
+    else
+        std::cout << getErrorMessage(text.data(), error) << "\n";
+    return 0;
+}
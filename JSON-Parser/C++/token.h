@@ -21,10 +21,12 @@ typedef enum {
 typedef int tokenTypes;
 
 
-// Define a token data type
+// Define a token data type: a 12-byte record pointing into the input text,
+// the characters are copied out only when asked for (getTokenValue())
 
 struct Token
 {
     tokenTypes  type;
-    std::string value;
+    uint32_t    offset;     // Position of the first character in the input
+    uint32_t    length;     // Number of characters, doublequotes of strings included
 };
\ No newline at end of file
@@ -0,0 +1,389 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <limits>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+#include "common.h"
+#include "token.h"
+#include "lexer.h"
+#include "numbers.h"
+#include "unescape.h"
+#include "utf8.h"
+#include "typed.h"
+
+
+
+JsonReader::JsonReader(const char *data, size_t length, size_t maxDepth)
+    : data(data), pos(data), end(data + length), depth(0), maxDepth(maxDepth), failed(false)
+{
+}
+
+
+
+// The whole text is checked to be UTF-8 first, as by the lexer, so that the
+// strings need no other check than their escapes and control characters
+
+bool JsonReader::start()
+{
+    if (!validateUtf8(data, end - data))
+    {
+        describeInvalidToken(data, end - data, Token{UNKNOWN, 0, 0}, error);
+        failed = true;
+        return false;
+    }
+
+    skipWhitespace();
+    if (pos == end || (*pos != '{' && *pos != '['))
+        return fail("'{' or '['");
+    return true;
+}
+
+
+
+bool JsonReader::finish()
+{
+    skipWhitespace();
+    return pos == end || fail("end of input");
+}
+
+
+
+/*  Record what was expected at the current position and what is there: the
+    next character if it is structural, else the text up to the next one.
+*/
+
+bool JsonReader::fail(const char *expected)
+{
+    if (failed)
+        return false;   // The first error is kept
+
+    failed = true;
+    error.offset = pos - data;
+    error.expected = expected;
+    if (pos == end)
+    {
+        error.found = "end of input";
+        return false;
+    }
+
+    const char *tokenEnd = pos + 1;
+    if (*pos != '{' && *pos != '}' && *pos != '[' && *pos != ']' && *pos != ':' && *pos != ',')
+    {
+        const char *start = pos;
+        if (*pos == '"' && findString(start, tokenEnd))
+            tokenEnd++;
+        while (tokenEnd < end && !isClosingBracketOrComma(*tokenEnd) && !isWhitespace(*tokenEnd) && *tokenEnd != ':')
+            tokenEnd++;
+    }
+    error.found = describeText(pos, tokenEnd - pos);
+    return false;
+}
+
+
+
+void JsonReader::skipWhitespace()
+{
+    while (pos < end && isWhitespace(*pos))
+        pos++;
+}
+
+
+
+bool JsonReader::startContainer(char opening, const char *expected)
+{
+    skipWhitespace();
+    if (pos == end || *pos != opening)
+        return fail(expected);
+    if (depth >= maxDepth)
+        return fail(("at most " + std::to_string(maxDepth) + " nested objects and arrays").c_str());
+
+    pos++;
+    depth++;
+    return true;
+}
+
+
+
+/*  Called before each item of the open container: consumes the comma before
+    the item, or the closing bracket after the last one. A trailing comma is
+    left to the item, which finds the closing bracket instead of a value.
+*/
+
+bool JsonReader::nextItem(char closing, size_t index)
+{
+    if (failed)
+        return false;
+
+    skipWhitespace();
+    if (pos < end && *pos == closing)
+    {
+        pos++;
+        depth--;
+        return false;
+    }
+
+    if (index == 0)
+        return true;
+    if (pos < end && *pos == ',')
+    {
+        pos++;
+        return true;
+    }
+    return fail(closing == '}' ? "',' or '}'" : "',' or ']'");
+}
+
+
+
+// Find the string starting at pos with the scanner of the lexer: start and
+// stringEnd are then its first character and its closing doublequote
+
+bool JsonReader::findString(const char *&start, const char *&stringEnd)
+{
+    const char *scan = start;
+    if (!scanString(scan, end))
+        return false;
+
+    stringEnd = scan - 1;
+    start++;
+    return true;
+}
+
+
+
+bool JsonReader::readKey(const char *&key, size_t &keyLength)
+{
+    skipWhitespace();
+    const char *start = pos, *stringEnd;
+    if (pos == end || *pos != '"')
+        return fail("a key");
+    if (!findString(start, stringEnd))
+    {
+        describeInvalidToken(data, end - data, Token{UNKNOWN, (uint32_t)(pos - data), (uint32_t)(end - pos)}, error);
+        failed = true;
+        return false;
+    }
+
+    // Most keys have no escapes and are compared in place
+    key = start;
+    keyLength = stringEnd - start;
+    if (memchr(start, '\\', keyLength) != nullptr)
+    {
+        keyBuffer = unescapeString(start, stringEnd);
+        key = keyBuffer.data();
+        keyLength = keyBuffer.size();
+    }
+
+    pos = stringEnd + 1;
+    skipWhitespace();
+    if (pos == end || *pos != ':')
+        return fail("':'");
+    pos++;
+    return true;
+}
+
+
+
+bool JsonReader::readString(std::string &value)
+{
+    skipWhitespace();
+    const char *start = pos, *stringEnd;
+    if (pos == end || *pos != '"')
+        return fail("a string");
+    if (!findString(start, stringEnd))
+    {
+        describeInvalidToken(data, end - data, Token{UNKNOWN, (uint32_t)(pos - data), (uint32_t)(end - pos)}, error);
+        failed = true;
+        return false;
+    }
+
+    if (memchr(start, '\\', stringEnd - start) == nullptr)
+        value.assign(start, stringEnd);
+    else
+        value = unescapeString(start, stringEnd);
+    pos = stringEnd + 1;
+    return true;
+}
+
+
+
+// Find the number at pos, which must end where a token can end, as in the lexer
+
+bool JsonReader::findNumber(const char *&start)
+{
+    skipWhitespace();
+    start = pos;
+    const char *numberEnd = pos < end ? scanNumber(pos, end) : nullptr;
+    if (numberEnd == nullptr || (numberEnd < end && !isClosingBracketOrComma(*numberEnd) && !isWhitespace(*numberEnd)))
+        return false;
+
+    pos = numberEnd;
+    return true;
+}
+
+
+
+bool JsonReader::readInteger(int64_t &value, int64_t minimum, int64_t maximum)
+{
+    const char *start;
+    if (!findNumber(start) || !parseInt64(start, pos, value) || value < minimum || value > maximum)
+    {
+        pos = start;
+        return fail(("an integer from " + std::to_string(minimum) + " to " + std::to_string(maximum)).c_str());
+    }
+    return true;
+}
+
+
+
+bool JsonReader::readDouble(double &value)
+{
+    const char *start;
+    if (!findNumber(start) || !parseDouble(start, pos, value))
+    {
+        pos = start;
+        return fail("a number");
+    }
+    return true;
+}
+
+
+
+// Whether the literal is at pos, followed by a character that can end a token
+
+static bool isLiteral(const char *pos, const char *end, const char *literal, size_t length)
+{
+    return (size_t)(end - pos) >= length && memcmp(pos, literal, length) == 0
+        && (pos + length == end || isClosingBracketOrComma(pos[length]) || isWhitespace(pos[length]));
+}
+
+
+
+bool JsonReader::readBoolean(bool &value)
+{
+    skipWhitespace();
+    if (isLiteral(pos, end, "true", 4))
+    {
+        value = true;
+        pos += 4;
+        return true;
+    }
+    if (isLiteral(pos, end, "false", 5))
+    {
+        value = false;
+        pos += 5;
+        return true;
+    }
+    return fail("true or false");
+}
+
+
+
+bool JsonReader::readNull()
+{
+    skipWhitespace();
+    if (!isLiteral(pos, end, "null", 4))
+        return false;
+
+    pos += 4;
+    return true;
+}
+
+
+
+/*  Check and pass over a value nothing is read from, the member of a key
+    without a field. Containers recurse, at most maxDepth deep.
+*/
+
+bool JsonReader::skipValue()
+{
+    skipWhitespace();
+    if (pos == end)
+        return fail("a value");
+
+    const char *start;
+    bool boolean;
+    switch (*pos)
+    {
+        case '{':
+            if (!startObject())
+                return false;
+            for (size_t i = 0; nextItem('}', i); i++)
+            {
+                const char *key;
+                size_t keyLength;
+                if (!readKey(key, keyLength) || !skipValue())
+                    return false;
+            }
+            return !failed;
+
+        case '[':
+            if (!startArray())
+                return false;
+            for (size_t i = 0; nextItem(']', i); i++)
+            {
+                if (!skipValue())
+                    return false;
+            }
+            return !failed;
+
+        case '"':
+            {
+                const char *stringEnd;
+                start = pos;
+                if (!findString(start, stringEnd))
+                    return readString(keyBuffer);   // Reports the error
+                pos = stringEnd + 1;
+            }
+            return true;
+
+        case 't':
+        case 'f':
+            return readBoolean(boolean);
+
+        case 'n':
+            return readNull() || fail("a value");
+    }
+
+    if (findNumber(start))
+        return true;
+    return fail("a value");
+}
+
+
+
+bool readValue(JsonReader &reader, bool &value)
+{
+    return reader.readBoolean(value);
+}
+
+
+
+bool readValue(JsonReader &reader, double &value)
+{
+    return reader.readDouble(value);
+}
+
+
+
+bool readValue(JsonReader &reader, float &value)
+{
+    double number;
+    if (!reader.readDouble(number))
+        return false;
+
+    value = (float)number;
+    return true;
+}
+
+
+
+bool readValue(JsonReader &reader, std::string &value)
+{
+    return reader.readString(value);
+}
\ No newline at end of file
@@ -0,0 +1,228 @@
+// Typed reading: the fields of a struct are declared once, and readJson()
+// fills the struct straight from the text, without tokens or a tree. The
+// parser of each struct is generated at compile time: its keys are compared
+// in a chain unrolled by the templates below, and each field is read by the
+// function of its type (bool, integers, float, double, std::string,
+// std::vector, std::optional or another declared struct).
+//
+// Example:
+//     struct User { int64_t id; std::string name; std::vector <std::string> tags; };
+//     JSON_FIELDS(User, JSON_FIELD(id), JSON_FIELD(name), JSON_FIELD(tags))
+//
+//     User user;
+//     ParseError error;
+//     if (!readJson(text.data(), text.size(), user, error)) ...
+//
+// Members without a field keep their value, keys without a field are checked
+// and skipped. A value of the wrong type is an error, as is invalid JSON.
+
+
+// Cursor over the text, shared by the functions of every type
+
+class JsonReader
+{
+public:
+    JsonReader(const char *data, size_t length, size_t maxDepth = DEFAULT_MAX_DEPTH);
+
+    bool start();                                           // false unless the text is UTF-8 and starts with { or [
+    bool finish();                                          // false unless only whitespace is left
+
+    bool startObject() { return startContainer('{', "an object"); }
+    bool startArray() { return startContainer('[', "an array"); }
+    bool nextItem(char closing, size_t index);              // true if item index follows, false at the end or on error
+    bool readKey(const char *&key, size_t &keyLength);      // Unescaped key and its colon, valid until the next key
+
+    bool readString(std::string &value);
+    bool readInteger(int64_t &value, int64_t minimum, int64_t maximum);
+    bool readDouble(double &value);
+    bool readBoolean(bool &value);
+    bool readNull();                                        // true if null was read, nothing is read otherwise
+    bool skipValue();                                       // A value of any type, checked
+
+    bool hasFailed() const { return failed; }
+    const ParseError &getError() const { return error; }
+    bool fail(const char *expected);                        // Records the error at the current position, returns false
+
+private:
+    const char      *data;          // Text being read
+    const char      *pos;           // Next character
+    const char      *end;
+    size_t          depth;          // Containers open
+    size_t          maxDepth;       // More nested containers are an error
+    std::string     keyBuffer;      // Unescaped key, when it has escapes
+    ParseError      error;
+    bool            failed;
+
+    void skipWhitespace();
+    bool startContainer(char opening, const char *expected);
+    bool findString(const char *&start, const char *&stringEnd);
+    bool findNumber(const char *&start);
+};
+
+
+// A field: its key and the member it is read into
+
+template <typename Type, typename Member>
+struct JsonField
+{
+    const char      *key;
+    size_t          keyLength;
+    Member Type::*  member;
+};
+
+template <typename Type, typename Member, size_t N>
+constexpr JsonField<Type, Member> makeJsonField(const char (&key)[N], Member Type::*member)
+{
+    return JsonField<Type, Member>{key, N - 1, member};
+}
+
+// Fields of a struct, declared by JSON_FIELDS
+template <typename Type> struct JsonFields;
+
+#define JSON_FIELD(member) makeJsonField(#member, &Self::member)
+#define JSON_FIELD_AS(key, member) makeJsonField(key, &Self::member)
+#define JSON_FIELDS(Type, ...)                                              \
+    template <> struct JsonFields<Type>                                     \
+    {                                                                       \
+        typedef Type Self;                                                  \
+        static constexpr auto fields = std::make_tuple(__VA_ARGS__);        \
+    };
+
+
+// Function declarations
+
+bool readValue(JsonReader &reader, bool &value);
+
+bool readValue(JsonReader &reader, double &value);
+
+bool readValue(JsonReader &reader, float &value);
+
+bool readValue(JsonReader &reader, std::string &value);
+
+template <typename Type>
+typename std::enable_if <std::is_integral <Type>::value, bool>::type readValue(JsonReader &reader, Type &value);
+
+template <typename Type>
+bool readValue(JsonReader &reader, std::vector <Type> &value);
+
+template <typename Type>
+bool readValue(JsonReader &reader, std::optional <Type> &value);
+
+template <typename Type>
+typename std::enable_if <std::is_class <Type>::value, bool>::type readValue(JsonReader &reader, Type &value);
+
+
+
+// Integers of any size, out of its range is an error (at most that of int64_t)
+
+template <typename Type>
+typename std::enable_if <std::is_integral <Type>::value, bool>::type readValue(JsonReader &reader, Type &value)
+{
+    int64_t maximum = (uint64_t)std::numeric_limits <Type>::max() > (uint64_t)INT64_MAX ? INT64_MAX : (int64_t)std::numeric_limits <Type>::max();
+    int64_t number;
+    if (!reader.readInteger(number, (int64_t)std::numeric_limits <Type>::min(), maximum))
+        return false;
+
+    value = (Type)number;
+    return true;
+}
+
+
+
+template <typename Type>
+bool readValue(JsonReader &reader, std::vector <Type> &value)
+{
+    value.clear();
+    if (!reader.startArray())
+        return false;
+
+    for (size_t i = 0; reader.nextItem(']', i); i++)
+    {
+        value.emplace_back();
+        if (!readValue(reader, value.back()))
+            return false;
+    }
+    return !reader.hasFailed();
+}
+
+
+
+// null leaves the optional empty
+
+template <typename Type>
+bool readValue(JsonReader &reader, std::optional <Type> &value)
+{
+    if (reader.readNull())
+    {
+        value.reset();
+        return true;
+    }
+
+    value.emplace();
+    return readValue(reader, *value);
+}
+
+
+
+// Read the value of the member with the key, by comparing it with the key of
+// each field from the Index-th on: the recursion is unrolled at compile time
+
+template <typename Type, size_t Index = 0>
+bool readField(JsonReader &reader, Type &value, const char *key, size_t keyLength)
+{
+    constexpr auto &fields = JsonFields <Type>::fields;
+    if constexpr (Index == std::tuple_size <typename std::decay <decltype(fields)>::type>::value)
+        return reader.skipValue();
+    else
+    {
+        constexpr auto &field = std::get <Index>(fields);
+        if (field.keyLength == keyLength && memcmp(field.key, key, keyLength) == 0)
+            return readValue(reader, value.*field.member);
+        return readField <Type, Index + 1>(reader, value, key, keyLength);
+    }
+}
+
+
+
+// A struct declared with JSON_FIELDS, from an object
+
+template <typename Type>
+typename std::enable_if <std::is_class <Type>::value, bool>::type readValue(JsonReader &reader, Type &value)
+{
+    if (!reader.startObject())
+        return false;
+
+    const char *key;
+    size_t keyLength;
+    for (size_t i = 0; reader.nextItem('}', i); i++)
+    {
+        if (!reader.readKey(key, keyLength) || !readField(reader, value, key, keyLength))
+            return false;
+    }
+    return !reader.hasFailed();
+}
+
+
+
+// Fill value from a whole text, whose root must be an object or an array as for
+// validateJson(). On failure error says where and why (see getErrorMessage())
+
+template <typename Type>
+bool readJson(const char *data, size_t length, Type &value, ParseError &error)
+{
+    JsonReader reader(data, length);
+    if (reader.start() && readValue(reader, value) && reader.finish())
+        return true;
+
+    error = reader.getError();
+    return false;
+}
+
+
+
+template <typename Type>
+bool readJson(const char *data, size_t length, Type &value)
+{
+    ParseError error;
+    return readJson(data, length, value, error);
+}
\ No newline at end of file
@@ -0,0 +1,145 @@
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "unescape.h"
+
+
+
+// Write a code point as UTF-8, returns the number of bytes (1 to 4)
+
+size_t encodeUtf8(uint32_t codePoint, char *out)
+{
+    if (codePoint < 0x80)
+    {
+        out[0] = (char)codePoint;
+        return 1;
+    }
+    if (codePoint < 0x800)
+    {
+        out[0] = (char)(0xC0 | (codePoint >> 6));
+        out[1] = (char)(0x80 | (codePoint & 0x3F));
+        return 2;
+    }
+    if (codePoint < 0x10000)
+    {
+        out[0] = (char)(0xE0 | (codePoint >> 12));
+        out[1] = (char)(0x80 | ((codePoint >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (codePoint & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | (codePoint >> 18));
+    out[1] = (char)(0x80 | ((codePoint >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((codePoint >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (codePoint & 0x3F));
+    return 4;
+}
+
+
+
+// Value of the 4 hexadecimal digits at pos
+
+static uint32_t readHex4(const char *pos)
+{
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        char ch = pos[i];
+        value <<= 4;
+        if (ch >= '0' && ch <= '9')
+            value |= ch - '0';
+        else if (ch >= 'a' && ch <= 'f')
+            value |= ch - 'a' + 10;
+        else
+            value |= ch - 'A' + 10;
+    }
+    return value;
+}
+
+
+
+/*  Replace the escape sequences of a string the lexer accepted (without its
+    doublequotes) by the characters they stand for.
+    Example:
+        Tab\there \u00e9 \ud83d\ude00  ->  Tab<09>here <C3 A9> <F0 9F 98 80>
+
+    \uXXXX escapes are written as UTF-8, a surrogate pair as one 4-byte
+    character and a lone surrogate as U+FFFD. The result is never longer than
+    the input, so out needs end - pos bytes. Returns the length written.
+    Runs without escapes are copied 16 bytes at a time.
+*/
+
+size_t unescapeString(const char *pos, const char *end, char *out)
+{
+    char *start = out;
+    while (pos < end)
+    {
+#ifdef __SSE2__
+        // Copy 16 bytes at a time up to the next backslash. out is never ahead of
+        // pos, so there is room for the 16 bytes stored even past the backslash
+        if (end - pos >= 16)
+        {
+            __m128i chunk = _mm_loadu_si128((const __m128i *)pos);
+            _mm_storeu_si128((__m128i *)out, chunk);
+            int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\\')));
+            if (mask == 0)
+            {
+                pos += 16;
+                out += 16;
+                continue;
+            }
+            pos += __builtin_ctz(mask);
+            out += __builtin_ctz(mask);
+        }
+#endif
+        if (*pos != '\\')
+        {
+            *out++ = *pos++;
+            continue;
+        }
+
+        pos++;
+        switch (*pos++)
+        {
+            case 'b': *out++ = '\b'; break;
+            case 'f': *out++ = '\f'; break;
+            case 'n': *out++ = '\n'; break;
+            case 'r': *out++ = '\r'; break;
+            case 't': *out++ = '\t'; break;
+            case 'u':
+                {
+                    uint32_t codePoint = readHex4(pos);
+                    pos += 4;
+                    if (codePoint >= 0xD800 && codePoint <= 0xDBFF && end - pos >= 6 && pos[0] == '\\' && pos[1] == 'u')
+                    {
+                        uint32_t low = readHex4(pos + 2);
+                        if (low >= 0xDC00 && low <= 0xDFFF)
+                        {
+                            codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                            pos += 6;
+                        }
+                    }
+                    if (codePoint >= 0xD800 && codePoint <= 0xDFFF)
+                        codePoint = 0xFFFD;
+                    out += encodeUtf8(codePoint, out);
+                }
+                break;
+            default:    // \" \\ \/
+                *out++ = pos[-1];
+        }
+    }
+    return out - start;
+}
+
+
+
+std::string unescapeString(const char *pos, const char *end)
+{
+    std::string result(end - pos, '\0');
+    result.resize(unescapeString(pos, end, &result[0]));
+    return result;
+}
@@ -0,0 +1,7 @@
+// Function declarations
+
+size_t encodeUtf8(uint32_t codePoint, char *out);
+
+size_t unescapeString(const char *pos, const char *end, char *out);
+
+std::string unescapeString(const char *pos, const char *end);
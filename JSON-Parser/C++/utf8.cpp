@@ -0,0 +1,385 @@
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "utf8.h"
+
+typedef bool (*ValidateFunction)(const char *data, size_t length);
+
+struct Utf8Implementation
+{
+    const char          *name;          // "avx2", "ssse3" or "scalar"
+    ValidateFunction    validate;       // Checks a whole text
+    bool                (*supported)(); // Whether the CPU can run it
+};
+
+
+
+/*  Check the text one character at a time, skipping 8 ASCII bytes at a time.
+    The second byte of a sequence has a narrower range after E0 (no overlong),
+    ED (no surrogate), F0 (no overlong) and F4 (nothing above U+10FFFF).
+    Returns the offset of the first byte of the first invalid sequence, or
+    length if the whole text is valid; errors are located this way, the SIMD
+    implementations only say whether there is one.
+*/
+
+size_t findInvalidUtf8(const char *data, size_t length)
+{
+    const unsigned char *pos = (const unsigned char *)data;
+    const unsigned char *end = pos + length;
+    while (pos < end)
+    {
+        if (end - pos >= 8)
+        {
+            uint64_t word;
+            memcpy(&word, pos, 8);
+            if ((word & 0x8080808080808080ULL) == 0)
+            {
+                pos += 8;
+                continue;
+            }
+        }
+
+        unsigned char ch = *pos;
+        if (ch < 0x80)
+        {
+            pos++;
+            continue;
+        }
+
+        size_t size;
+        unsigned char low = 0x80, high = 0xBF;     // Range of the second byte
+        if (ch >= 0xC2 && ch <= 0xDF)
+            size = 2;
+        else if (ch >= 0xE0 && ch <= 0xEF)
+        {
+            size = 3;
+            if (ch == 0xE0)
+                low = 0xA0;
+            else if (ch == 0xED)
+                high = 0x9F;
+        }
+        else if (ch >= 0xF0 && ch <= 0xF4)
+        {
+            size = 4;
+            if (ch == 0xF0)
+                low = 0x90;
+            else if (ch == 0xF4)
+                high = 0x8F;
+        }
+        else
+            return (const char *)pos - data;
+
+        if ((size_t)(end - pos) < size || pos[1] < low || pos[1] > high)
+            return (const char *)pos - data;
+        for (size_t i = 2; i < size; i++)
+        {
+            if ((pos[i] & 0xC0) != 0x80)
+                return (const char *)pos - data;
+        }
+        pos += size;
+    }
+    return length;
+}
+
+
+
+// Scalar implementation, for processors without SSSE3
+
+static bool validateScalar(const char *data, size_t length)
+{
+    return findInvalidUtf8(data, length) == length;
+}
+
+
+
+static bool alwaysSupported()
+{
+    return true;
+}
+
+
+
+#if defined(__x86_64__) || defined(__i386__)
+
+/*  The SIMD implementations use the lookup algorithm of Keiser and Lemire
+    ("Validating UTF-8 In Less Than One Instruction Per Byte", 2021): each byte
+    and the byte before it index three 16-entry tables (high nibble of the
+    previous byte, its low nibble, high nibble of the byte) whose entries are
+    bit sets of the errors the pair can be part of. The AND of the three is zero
+    for every valid pair; the third and fourth bytes of a sequence are then
+    checked against the bytes two and three positions earlier.
+*/
+
+const uint8_t TOO_SHORT     = 1 << 0;   // Lead byte followed by a lead byte or ASCII
+const uint8_t TOO_LONG      = 1 << 1;   // ASCII followed by a continuation byte
+const uint8_t OVERLONG_3    = 1 << 2;   // E0 80..9F
+const uint8_t TOO_LARGE     = 1 << 3;   // F4 90..BF, F5..FF
+const uint8_t SURROGATE     = 1 << 4;   // ED A0..BF
+const uint8_t OVERLONG_2    = 1 << 5;   // C0, C1
+const uint8_t TOO_LARGE_1000 = 1 << 6;  // F5..FF 80..8F
+const uint8_t OVERLONG_4    = 1 << 6;   // F0 80..8F
+const uint8_t TWO_CONTS     = 1 << 7;   // Two continuation bytes, an error unless in a 3 or 4-byte sequence
+const uint8_t CARRY         = TOO_SHORT | TOO_LONG | TWO_CONTS;
+
+// Indexed by the high nibble of the previous byte
+static const uint8_t BYTE_1_HIGH[16] = {
+    TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+    TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+    TOO_SHORT | OVERLONG_2,
+    TOO_SHORT,
+    TOO_SHORT | OVERLONG_3 | SURROGATE,
+    TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4
+};
+
+// Indexed by the low nibble of the previous byte
+static const uint8_t BYTE_1_LOW[16] = {
+    CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,
+    CARRY | OVERLONG_2,
+    CARRY,
+    CARRY,
+    CARRY | TOO_LARGE,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000
+};
+
+// Indexed by the high nibble of the byte
+static const uint8_t BYTE_2_HIGH[16] = {
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT
+};
+
+// The last bytes of a block above these start a sequence that goes on in the next block
+static const uint8_t INCOMPLETE_BELOW[32] = {
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 0xF0 - 1, 0xE0 - 1, 0xC0 - 1
+};
+
+
+
+// Errors of 16 bytes, given the 16 bytes before them
+
+__attribute__((target("ssse3")))
+static __m128i checkBlockSsse3(__m128i input, __m128i previous)
+{
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    __m128i prev1 = _mm_alignr_epi8(input, previous, 16 - 1);
+    __m128i byte1High = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)BYTE_1_HIGH), _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble));
+    __m128i byte1Low = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)BYTE_1_LOW), _mm_and_si128(prev1, nibble));
+    __m128i byte2High = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)BYTE_2_HIGH), _mm_and_si128(_mm_srli_epi16(input, 4), nibble));
+    __m128i special = _mm_and_si128(_mm_and_si128(byte1High, byte1Low), byte2High);
+
+    // A byte 2 or 3 positions after E0..FF must be a continuation, which the tables flag as TWO_CONTS
+    __m128i prev2 = _mm_alignr_epi8(input, previous, 16 - 2);
+    __m128i prev3 = _mm_alignr_epi8(input, previous, 16 - 3);
+    __m128i third = _mm_subs_epu8(prev2, _mm_set1_epi8((char)(0xE0 - 0x80)));
+    __m128i fourth = _mm_subs_epu8(prev3, _mm_set1_epi8((char)(0xF0 - 0x80)));
+    __m128i must23 = _mm_and_si128(_mm_or_si128(third, fourth), _mm_set1_epi8((char)0x80));
+    return _mm_xor_si128(must23, special);
+}
+
+
+
+// Check 16 bytes at a time, ASCII blocks only check that no sequence was left open
+
+__attribute__((target("ssse3")))
+static bool validateSsse3(const char *data, size_t length)
+{
+    __m128i error = _mm_setzero_si128();
+    __m128i previous = _mm_setzero_si128();
+    __m128i incomplete = _mm_setzero_si128();
+    const __m128i incompleteBelow = _mm_loadu_si128((const __m128i *)(INCOMPLETE_BELOW + 16));
+
+    for (size_t i = 0; i < length; i += 16)
+    {
+        __m128i input;
+        if (length - i >= 16)
+            input = _mm_loadu_si128((const __m128i *)(data + i));
+        else
+        {
+            // The last bytes, padded with spaces
+            char block[16];
+            memset(block, ' ', sizeof(block));
+            memcpy(block, data + i, length - i);
+            input = _mm_loadu_si128((const __m128i *)block);
+        }
+
+        if (_mm_movemask_epi8(input) == 0)
+            error = _mm_or_si128(error, incomplete);
+        else
+        {
+            error = _mm_or_si128(error, checkBlockSsse3(input, previous));
+            incomplete = _mm_subs_epu8(input, incompleteBelow);
+        }
+        previous = input;
+    }
+    error = _mm_or_si128(error, incomplete);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) == 0xFFFF;
+}
+
+
+
+// Errors of 32 bytes, same computation as checkBlockSsse3()
+
+__attribute__((target("avx2")))
+static __m256i checkBlockAvx2(__m256i input, __m256i previous)
+{
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    __m256i shifted = _mm256_permute2x128_si256(previous, input, 0x21);     // Upper half of previous, lower half of input
+    __m256i prev1 = _mm256_alignr_epi8(input, shifted, 16 - 1);
+    __m256i byte1High = _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)BYTE_1_HIGH)),
+                                            _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble));
+    __m256i byte1Low = _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)BYTE_1_LOW)),
+                                           _mm256_and_si256(prev1, nibble));
+    __m256i byte2High = _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)BYTE_2_HIGH)),
+                                            _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble));
+    __m256i special = _mm256_and_si256(_mm256_and_si256(byte1High, byte1Low), byte2High);
+
+    __m256i prev2 = _mm256_alignr_epi8(input, shifted, 16 - 2);
+    __m256i prev3 = _mm256_alignr_epi8(input, shifted, 16 - 3);
+    __m256i third = _mm256_subs_epu8(prev2, _mm256_set1_epi8((char)(0xE0 - 0x80)));
+    __m256i fourth = _mm256_subs_epu8(prev3, _mm256_set1_epi8((char)(0xF0 - 0x80)));
+    __m256i must23 = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8((char)0x80));
+    return _mm256_xor_si256(must23, special);
+}
+
+
+
+// Check 32 bytes at a time, same structure as validateSsse3()
+
+__attribute__((target("avx2")))
+static bool validateAvx2(const char *data, size_t length)
+{
+    __m256i error = _mm256_setzero_si256();
+    __m256i previous = _mm256_setzero_si256();
+    __m256i incomplete = _mm256_setzero_si256();
+    const __m256i incompleteBelow = _mm256_loadu_si256((const __m256i *)INCOMPLETE_BELOW);
+
+    for (size_t i = 0; i < length; i += 32)
+    {
+        __m256i input;
+        if (length - i >= 32)
+            input = _mm256_loadu_si256((const __m256i *)(data + i));
+        else
+        {
+            char block[32];
+            memset(block, ' ', sizeof(block));
+            memcpy(block, data + i, length - i);
+            input = _mm256_loadu_si256((const __m256i *)block);
+        }
+
+        if (_mm256_movemask_epi8(input) == 0)
+            error = _mm256_or_si256(error, incomplete);
+        else
+        {
+            error = _mm256_or_si256(error, checkBlockAvx2(input, previous));
+            incomplete = _mm256_subs_epu8(input, incompleteBelow);
+        }
+        previous = input;
+    }
+    error = _mm256_or_si256(error, incomplete);
+    return _mm256_testz_si256(error, error);
+}
+
+
+
+static bool ssse3Supported()
+{
+    return __builtin_cpu_supports("ssse3");
+}
+
+
+
+static bool avx2Supported()
+{
+    return __builtin_cpu_supports("avx2");
+}
+
+#endif
+
+// Fastest first
+static const Utf8Implementation IMPLEMENTATIONS[] = {
+#if defined(__x86_64__) || defined(__i386__)
+    {"avx2", validateAvx2, avx2Supported},
+    {"ssse3", validateSsse3, ssse3Supported},
+#endif
+    {"scalar", validateScalar, alwaysSupported}
+};
+
+
+
+// The first implementation the CPU supports
+
+static const Utf8Implementation *bestImplementation()
+{
+    for (const Utf8Implementation &implementation : IMPLEMENTATIONS)
+    {
+        if (implementation.supported())
+            return &implementation;
+    }
+    return &IMPLEMENTATIONS[sizeof(IMPLEMENTATIONS) / sizeof(IMPLEMENTATIONS[0]) - 1];
+}
+
+
+
+// Picked once, on first use (a function-local static is initialized once even with several threads)
+
+static const Utf8Implementation *&selectedImplementation()
+{
+    static const Utf8Implementation *selected = bestImplementation();
+    return selected;
+}
+
+
+
+// Name of the implementation in use, picked for the CPU on first use
+
+const char *getUtf8Implementation()
+{
+    return selectedImplementation()->name;
+}
+
+
+
+// Force an implementation ("avx2", "ssse3" or "scalar"), false if the CPU cannot run it.
+// Not to be called while other threads are validating
+
+bool setUtf8Implementation(const std::string &name)
+{
+    for (const Utf8Implementation &implementation : IMPLEMENTATIONS)
+    {
+        if (name == implementation.name && implementation.supported())
+        {
+            selectedImplementation() = &implementation;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+
+// Check that a text is valid UTF-8
+
+bool validateUtf8(const char *data, size_t length)
+{
+    return selectedImplementation()->validate(data, length);
+}
\ No newline at end of file
@@ -0,0 +1,12 @@
+// UTF-8 validation of a whole text (RFC 3629): no truncated sequences, no
+// overlong forms, no surrogates (U+D800 to U+DFFF), nothing above U+10FFFF
+
+// Function declarations
+
+bool validateUtf8(const char *data, size_t length);
+
+size_t findInvalidUtf8(const char *data, size_t length);
+
+const char *getUtf8Implementation();
+
+bool setUtf8Implementation(const std::string &name);
\ No newline at end of file
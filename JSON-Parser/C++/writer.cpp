@@ -0,0 +1,301 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "arena.h"
+#include "dom.h"
+#include "writer.h"
+
+
+
+JsonWriter::JsonWriter(int indent) : indent(indent), afterKey(false)
+{
+}
+
+
+
+// Start again with an empty text, the memory of the buffer is kept
+
+void JsonWriter::clear()
+{
+    output.clear();
+    hasItems.clear();
+    afterKey = false;
+}
+
+
+
+// Line break followed by the indentation of a depth, in pretty mode only
+
+void JsonWriter::newLine(size_t depth)
+{
+    if (indent <= 0)
+        return;
+
+    output += '\n';
+    output.append(depth * indent, ' ');
+}
+
+
+
+// Separate a value from the one before it: nothing after a key, else a comma if needed and the indentation
+
+void JsonWriter::startValue()
+{
+    if (afterKey)
+    {
+        afterKey = false;
+        return;
+    }
+
+    if (hasItems.empty())
+        return;
+
+    if (hasItems.back())
+        output += ',';
+    hasItems.back() = true;
+    newLine(hasItems.size());
+}
+
+
+
+void JsonWriter::startObject()
+{
+    startValue();
+    output += '{';
+    hasItems.push_back(false);
+}
+
+
+
+void JsonWriter::endObject()
+{
+    bool empty = !hasItems.back();
+    hasItems.pop_back();
+    if (!empty)
+        newLine(hasItems.size());
+    output += '}';
+}
+
+
+
+void JsonWriter::startArray()
+{
+    startValue();
+    output += '[';
+    hasItems.push_back(false);
+}
+
+
+
+void JsonWriter::endArray()
+{
+    bool empty = !hasItems.back();
+    hasItems.pop_back();
+    if (!empty)
+        newLine(hasItems.size());
+    output += ']';
+}
+
+
+
+void JsonWriter::key(const char *text, size_t length)
+{
+    startValue();
+    writeEscaped(text, length);
+    output += indent > 0 ? ": " : ":";
+    afterKey = true;
+}
+
+
+
+void JsonWriter::string(const char *text, size_t length)
+{
+    startValue();
+    writeEscaped(text, length);
+}
+
+
+
+/*  Shortest round-trip formatting: std::to_chars writes the fewest digits that
+    read back as the same double (Ryu in libstdc++), e.g. 0.1 and not
+    0.10000000000000001. JSON has no NaN or infinity, they are written as null.
+*/
+
+void JsonWriter::number(double value)
+{
+    if (!std::isfinite(value))
+    {
+        null();
+        return;
+    }
+
+    char buffer[32];
+    std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    startValue();
+    output.append(buffer, result.ptr - buffer);
+}
+
+
+
+void JsonWriter::number(int64_t value)
+{
+    char buffer[24];
+    std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    startValue();
+    output.append(buffer, result.ptr - buffer);
+}
+
+
+
+void JsonWriter::rawNumber(const char *text, size_t length)
+{
+    startValue();
+    output.append(text, length);
+}
+
+
+
+void JsonWriter::boolean(bool value)
+{
+    startValue();
+    output += value ? "true" : "false";
+}
+
+
+
+void JsonWriter::null()
+{
+    startValue();
+    output += "null";
+}
+
+
+
+/*  Write a value of a document. Numbers keep the text they were parsed from.
+    The recursion is bounded by the nesting the parser accepts (maxDepth).
+*/
+
+void JsonWriter::value(const JsonValue &value)
+{
+    switch (value.type)
+    {
+        case JSONOBJECT:
+            startObject();
+            for (uint32_t i = 0; i < value.size; i++)
+            {
+                key(value.members[i].key, value.members[i].keyLength);
+                this->value(value.members[i].value);
+            }
+            endObject();
+            break;
+
+        case JSONARRAY:
+            startArray();
+            for (uint32_t i = 0; i < value.size; i++)
+                this->value(value.items[i]);
+            endArray();
+            break;
+
+        case JSONSTRING:
+            string(value.text, value.size);
+            break;
+
+        case JSONNUMBER:
+            rawNumber(value.text, value.size);
+            break;
+
+        case JSONBOOLEAN:
+            boolean(value.boolean);
+            break;
+
+        case JSONNULL:
+            null();
+            break;
+    }
+}
+
+
+
+/*  Write a string between doublequotes, escaping ", \ and the control characters
+    (DEL included, which the lexer rejects unescaped). The characters that need
+    no escape are found 16 at a time and copied in runs.
+*/
+
+void JsonWriter::writeEscaped(const char *text, size_t length)
+{
+    static const char HEX[] = "0123456789abcdef";
+
+    const char *pos = text;
+    const char *end = text + length;
+    const char *run = text;     // Start of the characters not copied yet
+
+    output += '"';
+    while (pos < end)
+    {
+#ifdef __SSE2__
+        if (end - pos >= 16)
+        {
+            __m128i chunk = _mm_loadu_si128((const __m128i *)pos);
+            __m128i special = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('"')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\\'))),
+                _mm_or_si128(_mm_cmpeq_epi8(_mm_max_epu8(chunk, _mm_set1_epi8(0x1F)), _mm_set1_epi8(0x1F)),
+                             _mm_cmpeq_epi8(chunk, _mm_set1_epi8(0x7F))));
+            int mask = _mm_movemask_epi8(special);
+            if (mask == 0)
+            {
+                pos += 16;
+                continue;
+            }
+            pos += __builtin_ctz(mask);
+        }
+#endif
+        unsigned char ch = *pos;
+        if (ch == '"' || ch == '\\' || ch < 0x20 || ch == 0x7F)
+        {
+            output.append(run, pos - run);
+            switch (ch)
+            {
+                case '"':   output += "\\\""; break;
+                case '\\':  output += "\\\\"; break;
+                case '\b':  output += "\\b"; break;
+                case '\f':  output += "\\f"; break;
+                case '\n':  output += "\\n"; break;
+                case '\r':  output += "\\r"; break;
+                case '\t':  output += "\\t"; break;
+                default:
+                    output += "\\u00";
+                    output += HEX[ch >> 4];
+                    output += HEX[ch & 0xF];
+            }
+            run = pos + 1;
+        }
+        pos++;
+    }
+    output.append(run, end - run);
+    output += '"';
+}
+
+
+
+/*  Text of a value of a document, compact or indented.
+    Example:
+        JsonDocument document;
+        document.parse(text.data(), text.size());
+        std::cout << serialize(document.root(), 4) << "\n";
+*/
+
+std::string serialize(const JsonValue &value, int indent)
+{
+    JsonWriter writer(indent);
+    writer.value(value);
+    return writer.text();
+}
\ No newline at end of file
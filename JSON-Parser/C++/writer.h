@@ -0,0 +1,44 @@
+// Output of JSON text: a JsonWriter appends values to a growable buffer and
+// places the commas, colons and, in pretty mode, the newlines and indentation.
+
+struct JsonValue;
+
+class JsonWriter
+{
+public:
+    JsonWriter(int indent = 0);                         // Spaces per level, 0 for compact output
+
+    void startObject();                                 // The caller keeps the calls balanced and
+    void endObject();                                   // gives a key before each value of an object
+    void startArray();
+    void endArray();
+    void key(const char *text, size_t length);
+    void key(const std::string &text) { key(text.data(), text.size()); }
+
+    void string(const char *text, size_t length);       // Escaped as needed, UTF-8 is written as is
+    void string(const std::string &text) { string(text.data(), text.size()); }
+    void number(double value);                          // Shortest text that reads back as the same double
+    void number(int64_t value);
+    void rawNumber(const char *text, size_t length);    // Text of a valid JSON number, written unchanged
+    void boolean(bool value);
+    void null();
+    void value(const JsonValue &value);                 // A value of a document with its children
+
+    const std::string &text() const { return output; }
+    void clear();
+
+private:
+    std::string         output;         // Text written so far
+    int                 indent;         // Spaces per level, 0 for compact output
+    std::vector <char>  hasItems;       // For each open container, whether something was written in it
+    bool                afterKey;       // A key was just written, the value follows the colon
+
+    void startValue();
+    void newLine(size_t depth);
+    void writeEscaped(const char *text, size_t length);
+};
+
+
+// Function declarations
+
+std::string serialize(const JsonValue &value, int indent = 0);
\ No newline at end of file
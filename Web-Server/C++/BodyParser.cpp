@@ -0,0 +1,504 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cctype>
+#include <unistd.h>
+
+#include "BodyParser.h"
+
+// Limit on the size of the headers of a single multipart part
+const size_t MAX_PART_HEADER_SIZE = 8 * 1024;
+// Limit on the length of a url-encoded field name
+const size_t MAX_FIELD_NAME_SIZE = 1024;
+
+// Template of the temporary files large parts are spooled to
+const char* const SPOOL_TEMPLATE = "/tmp/upload-XXXXXX";
+
+
+
+// Case-insensitive comparison of an ASCII string with a prefix of another
+static bool startsWithIgnoreCase(const std::string& str, size_t pos, const std::string& prefix)
+{
+    if (str.length() - pos < prefix.length())
+        return false;
+
+    for (size_t i = 0; i < prefix.length(); i++)
+    {
+        if (std::tolower((unsigned char)str[pos + i]) != std::tolower((unsigned char)prefix[i]))
+            return false;
+    }
+    return true;
+}
+
+
+
+// Remove the surrounding whitespace of a string
+static std::string trim(const std::string& str)
+{
+    size_t start = str.find_first_not_of(" \t");
+    if (start == std::string::npos)
+        return "";
+
+    size_t end = str.find_last_not_of(" \t");
+    return str.substr(start, end - start + 1);
+}
+
+
+
+/*  Extract a parameter from a header value.
+    Example: getHeaderParameter("form-data; name=\"file\"; filename=\"a.txt\"", "filename") returns a.txt
+*/
+std::string getHeaderParameter(const std::string& headerValue, const std::string& parameter)
+{
+    size_t pos = headerValue.find(';');
+    while (pos != std::string::npos)
+    {
+        pos = headerValue.find_first_not_of(" \t", pos + 1);
+        if (pos == std::string::npos)
+            break;
+
+        if (startsWithIgnoreCase(headerValue, pos, parameter + "="))
+        {
+            pos += parameter.length() + 1;
+
+            // Quoted value, may contain ';'
+            if (pos < headerValue.length() && headerValue[pos] == '"')
+            {
+                size_t end = headerValue.find('"', pos + 1);
+                if (end == std::string::npos)
+                    return headerValue.substr(pos + 1);
+                return headerValue.substr(pos + 1, end - pos - 1);
+            }
+
+            size_t end = headerValue.find(';', pos);
+            return trim(headerValue.substr(pos, end == std::string::npos ? std::string::npos : end - pos));
+        }
+
+        pos = headerValue.find(';', pos);
+    }
+    return "";
+}
+
+
+
+// Constructor of the common parser state
+FormParser::FormParser(PartCallback callback, size_t spoolThreshold)
+    : onPart(std::move(callback)), spoolThreshold(spoolThreshold), spoolFd(-1)
+{
+}
+
+
+
+// Destructor removes a part left incomplete by a failed upload
+FormParser::~FormParser()
+{
+    discardPart();
+}
+
+
+
+// Write a whole buffer to a file descriptor
+static bool writeAll(int fd, const char* data, size_t length)
+{
+    while (length > 0)
+    {
+        ssize_t written = write(fd, data, length);
+        if (written < 0)
+            return false;
+        data += written;
+        length -= written;
+    }
+    return true;
+}
+
+
+
+// Add data to the current part, moving it to a spool file once it grows beyond the threshold
+bool FormParser::appendToPart(const char* data, size_t length)
+{
+    part.size += length;
+
+    if (spoolFd < 0 && part.value.length() + length <= spoolThreshold)
+    {
+        part.value.append(data, length);
+        return true;
+    }
+
+    if (spoolFd < 0)
+    {
+        char path[64];
+        snprintf(path, sizeof(path), "%s", SPOOL_TEMPLATE);
+        spoolFd = mkstemp(path);
+        if (spoolFd < 0)
+        {
+            std::cerr << "Failure in creating the spool file\n";
+            return false;
+        }
+        part.spoolPath = path;
+
+        // Move what was buffered so far to the file
+        if (!writeAll(spoolFd, part.value.data(), part.value.length()))
+        {
+            std::cerr << "Failure in writing to the spool file\n";
+            return false;
+        }
+        std::string().swap(part.value);
+    }
+
+    if (!writeAll(spoolFd, data, length))
+    {
+        std::cerr << "Failure in writing to the spool file\n";
+        return false;
+    }
+    return true;
+}
+
+
+
+// Hand the completed part to the callback and get ready for the next one
+bool FormParser::completePart()
+{
+    if (spoolFd >= 0)
+    {
+        close(spoolFd);
+        spoolFd = -1;
+    }
+
+    if (onPart)
+        onPart(part);
+
+    discardPart();
+    return true;
+}
+
+
+
+// Drop the current part, removing its spool file if any
+void FormParser::discardPart()
+{
+    if (spoolFd >= 0)
+    {
+        close(spoolFd);
+        spoolFd = -1;
+    }
+
+    // Unlinking fails harmlessly if the handler renamed the file
+    if (!part.spoolPath.empty())
+        unlink(part.spoolPath.c_str());
+
+    part = FormPart();
+}
+
+
+
+// Constructor of the url-encoded parser
+UrlEncodedParser::UrlEncodedParser(PartCallback callback, size_t spoolThreshold)
+    : FormParser(std::move(callback), spoolThreshold), inValue(false), pendingHexDigits(0), pendingByte(0)
+{
+}
+
+
+
+// Append a decoded byte to the name or the value of the current field
+bool UrlEncodedParser::appendDecoded(char ch)
+{
+    if (inValue)
+        return appendToPart(&ch, 1);
+
+    if (part.name.length() >= MAX_FIELD_NAME_SIZE)
+        return false;
+
+    part.name += ch;
+    return true;
+}
+
+
+
+/*  Decode the next chunk of a url-encoded body.
+    Format: name1=value1&name2=value2
+    '+' stands for a space and %XX for an escaped byte, which may be split across chunks.
+*/
+bool UrlEncodedParser::feed(const char* data, size_t length)
+{
+    for (size_t i = 0; i < length; i++)
+    {
+        char ch = data[i];
+
+        if (pendingHexDigits > 0)
+        {
+            if (!isxdigit((unsigned char)ch))
+                return false;
+
+            int digit = isdigit((unsigned char)ch) ? ch - '0' : std::tolower((unsigned char)ch) - 'a' + 10;
+            pendingByte = pendingByte * 16 + digit;
+
+            if (--pendingHexDigits == 0 && !appendDecoded((char)pendingByte))
+                return false;
+            continue;
+        }
+
+        switch (ch)
+        {
+            case '&':
+                if ((!part.name.empty() || part.size > 0) && !completePart())
+                    return false;
+                inValue = false;
+                break;
+
+            case '=':
+                if (inValue)
+                {
+                    if (!appendDecoded(ch))
+                        return false;
+                }
+                else
+                    inValue = true;
+                break;
+
+            case '%':
+                pendingHexDigits = 2;
+                pendingByte = 0;
+                break;
+
+            case '+':
+                if (!appendDecoded(' '))
+                    return false;
+                break;
+
+            default:
+                if (inValue)
+                {
+                    // Copy a run of plain characters in one go
+                    size_t runEnd = i + 1;
+                    while (runEnd < length && data[runEnd] != '&' && data[runEnd] != '=' &&
+                           data[runEnd] != '%' && data[runEnd] != '+')
+                        runEnd++;
+
+                    if (!appendToPart(data + i, runEnd - i))
+                        return false;
+                    i = runEnd - 1;
+                }
+                else if (!appendDecoded(ch))
+                    return false;
+        }
+    }
+    return true;
+}
+
+
+
+// Emit the last field of the body
+bool UrlEncodedParser::finish()
+{
+    if (pendingHexDigits > 0)
+        return false;
+
+    if (!part.name.empty() || part.size > 0)
+        return completePart();
+    return true;
+}
+
+
+
+// Constructor of the multipart parser
+MultipartParser::MultipartParser(const std::string& boundary, PartCallback callback, size_t spoolThreshold)
+    : FormParser(std::move(callback), spoolThreshold), state(State::PREAMBLE), delimiter("\r\n--" + boundary)
+{
+    // The first boundary is not preceded by a line break, pretend it is
+    buffer = "\r\n";
+}
+
+
+
+/*  Parse the headers of a part.
+    Example:
+        Content-Disposition: form-data; name="file"; filename="a.txt"
+        Content-Type: text/plain
+*/
+bool MultipartParser::parsePartHeaders(const std::string& headers)
+{
+    size_t lineStart = 0;
+    while (lineStart < headers.length())
+    {
+        size_t lineEnd = headers.find("\r\n", lineStart);
+        if (lineEnd == std::string::npos)
+            lineEnd = headers.length();
+
+        std::string line = headers.substr(lineStart, lineEnd - lineStart);
+        size_t colon = line.find(':');
+        if (colon != std::string::npos)
+        {
+            std::string value = trim(line.substr(colon + 1));
+            if (startsWithIgnoreCase(line, 0, "Content-Disposition:"))
+            {
+                part.name = getHeaderParameter(value, "name");
+                part.fileName = getHeaderParameter(value, "filename");
+            }
+            else if (startsWithIgnoreCase(line, 0, "Content-Type:"))
+                part.contentType = value;
+        }
+
+        lineStart = lineEnd + 2;
+    }
+
+    if (part.contentType.empty())
+        part.contentType = "text/plain";
+
+    return !part.name.empty();
+}
+
+
+
+/*  Parse the next chunk of a multipart body.
+    Basic Structure of a multipart body:
+        --boundary
+        Content-Disposition: form-data; name="field"
+
+        value
+        --boundary
+        Content-Disposition: form-data; name="file"; filename="a.txt"
+        Content-Type: text/plain
+
+        <file data>
+        --boundary--
+
+    Only a tail as long as the delimiter is kept between chunks, so memory does not
+    depend on the size of the parts.
+*/
+bool MultipartParser::feed(const char* data, size_t length)
+{
+    if (state == State::ERROR)
+        return false;
+
+    if (state == State::EPILOGUE)
+        return true;
+
+    buffer.append(data, length);
+
+    while (true)
+    {
+        switch (state)
+        {
+            case State::PREAMBLE:
+            {
+                size_t pos = buffer.find(delimiter);
+                if (pos == std::string::npos)
+                {
+                    // Keep just enough to match a delimiter split across chunks
+                    if (buffer.length() >= delimiter.length())
+                        buffer.erase(0, buffer.length() - delimiter.length() + 1);
+                    return true;
+                }
+                buffer.erase(0, pos + delimiter.length());
+                state = State::AFTER_BOUNDARY;
+                break;
+            }
+
+            case State::AFTER_BOUNDARY:
+                if (buffer.length() < 2)
+                    return true;
+
+                if (buffer.compare(0, 2, "--") == 0)
+                {
+                    state = State::EPILOGUE;
+                    buffer.clear();
+                    return true;
+                }
+                if (buffer.compare(0, 2, "\r\n") != 0)
+                {
+                    state = State::ERROR;
+                    return false;
+                }
+                buffer.erase(0, 2);
+                state = State::HEADERS;
+                break;
+
+            case State::HEADERS:
+            {
+                // A part without headers starts directly with the empty line
+                size_t headerEnd = buffer.compare(0, 2, "\r\n") == 0 ? 0 : buffer.find("\r\n\r\n");
+                if (headerEnd == std::string::npos)
+                {
+                    if (buffer.length() > MAX_PART_HEADER_SIZE)
+                    {
+                        state = State::ERROR;
+                        return false;
+                    }
+                    return true;
+                }
+
+                if (!parsePartHeaders(buffer.substr(0, headerEnd)))
+                {
+                    state = State::ERROR;
+                    return false;
+                }
+                buffer.erase(0, headerEnd == 0 ? 2 : headerEnd + 4);
+                state = State::BODY;
+                break;
+            }
+
+            case State::BODY:
+            {
+                size_t pos = buffer.find(delimiter);
+                if (pos == std::string::npos)
+                {
+                    // Everything except a possible partial delimiter belongs to the part
+                    if (buffer.length() >= delimiter.length())
+                    {
+                        size_t safe = buffer.length() - delimiter.length() + 1;
+                        if (!appendToPart(buffer.data(), safe))
+                        {
+                            state = State::ERROR;
+                            return false;
+                        }
+                        buffer.erase(0, safe);
+                    }
+                    return true;
+                }
+
+                if (!appendToPart(buffer.data(), pos) || !completePart())
+                {
+                    state = State::ERROR;
+                    return false;
+                }
+                buffer.erase(0, pos + delimiter.length());
+                state = State::AFTER_BOUNDARY;
+                break;
+            }
+
+            default:
+                return state != State::ERROR;
+        }
+    }
+}
+
+
+
+// The body is valid only if the closing boundary was seen
+bool MultipartParser::finish()
+{
+    return state == State::EPILOGUE;
+}
+
+
+
+/*  Create the parser for a request body based on its Content-Type.
+    Examples:
+        multipart/form-data; boundary=----WebKitFormBoundary7MA4YWxkTrZu0gW
+        application/x-www-form-urlencoded
+*/
+std::unique_ptr<FormParser> createFormParser(const std::string& contentType, PartCallback callback, size_t spoolThreshold)
+{
+    if (startsWithIgnoreCase(contentType, 0, "multipart/form-data"))
+    {
+        std::string boundary = getHeaderParameter(contentType, "boundary");
+        if (boundary.empty() || boundary.length() > 70)
+            return nullptr;
+        return std::unique_ptr<FormParser>(new MultipartParser(boundary, std::move(callback), spoolThreshold));
+    }
+
+    if (startsWithIgnoreCase(contentType, 0, "application/x-www-form-urlencoded"))
+        return std::unique_ptr<FormParser>(new UrlEncodedParser(std::move(callback), spoolThreshold));
+
+    return nullptr;
+}
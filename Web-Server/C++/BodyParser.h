@@ -0,0 +1,82 @@
+// Streaming parsers for request bodies (multipart/form-data and application/x-www-form-urlencoded)
+#include <string>
+#include <memory>
+#include <functional>
+
+// A single form field or file part produced by the body parsers
+struct FormPart {
+    std::string name;               // Name of the form field
+    std::string fileName;           // Original file name (empty for plain fields)
+    std::string contentType;        // Content type of the part
+    std::string value;              // Value of the part while it is held in memory
+    std::string spoolPath;          // Path of the temporary file once the part is spooled to disk
+    size_t size = 0;                // Total size of the part in bytes
+};
+
+// Callback invoked for every completed part. A spooled file is removed once the
+// callback returns, so handlers that want to keep it must rename it.
+using PartCallback = std::function<void(const FormPart&)>;
+
+// Base class of the body parsers, fed with the body in chunks as they are read
+class FormParser {
+public:
+    FormParser(PartCallback callback, size_t spoolThreshold);
+    virtual ~FormParser();
+    virtual bool feed(const char* data, size_t length) = 0;   // Consume the next chunk of the body
+    virtual bool finish() = 0;                                 // Called once the whole body is consumed
+
+protected:
+    PartCallback onPart;            // Receives every completed part
+    size_t spoolThreshold;          // Parts larger than this are written to disk
+    FormPart part;                  // Part currently being parsed
+    int spoolFd;                    // File descriptor of the spool file, -1 while in memory
+
+    bool appendToPart(const char* data, size_t length);        // Add data to the current part, spooling if needed
+    bool completePart();                                       // Hand the current part to the callback and reset it
+    void discardPart();                                        // Drop the current part and any spool file
+};
+
+// Parser for application/x-www-form-urlencoded bodies
+class UrlEncodedParser : public FormParser {
+public:
+    UrlEncodedParser(PartCallback callback, size_t spoolThreshold);
+    bool feed(const char* data, size_t length) override;
+    bool finish() override;
+
+private:
+    bool inValue;                   // Whether the bytes belong to the value (after '=')
+    int pendingHexDigits;           // Hex digits still expected after a '%'
+    int pendingByte;                // Partially decoded percent-escaped byte
+
+    bool appendDecoded(char ch);    // Append one decoded byte to the name or value
+};
+
+// Parser for multipart/form-data bodies
+class MultipartParser : public FormParser {
+public:
+    MultipartParser(const std::string& boundary, PartCallback callback, size_t spoolThreshold);
+    bool feed(const char* data, size_t length) override;
+    bool finish() override;
+
+private:
+    enum class State {
+        PREAMBLE,                   // Skipping everything before the first boundary
+        AFTER_BOUNDARY,             // Deciding between the next part and the closing boundary
+        HEADERS,                    // Reading the headers of a part
+        BODY,                       // Streaming the body of a part
+        EPILOGUE,                   // Closing boundary seen, ignoring the rest
+        ERROR
+    };
+
+    State state;
+    std::string delimiter;          // "\r\n--" followed by the boundary
+    std::string buffer;             // Unconsumed bytes, bounded by the chunk and delimiter sizes
+
+    bool parsePartHeaders(const std::string& headers);
+};
+
+// Extract a parameter (e.g. boundary, name, filename) from a header value
+std::string getHeaderParameter(const std::string& headerValue, const std::string& parameter);
+
+// Create a parser matching the Content-Type header, nullptr if the type is not a form
+std::unique_ptr<FormParser> createFormParser(const std::string& contentType, PartCallback callback, size_t spoolThreshold);
@@ -0,0 +1,223 @@
+#include <cstdio>
+#include <cstdint>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "ConditionalRequest.h"
+
+
+
+const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+const uint64_t FNV_PRIME = 1099511628211ULL;
+
+
+
+// Continue an FNV-1a hash over more bytes, so content can be hashed in pieces
+static uint64_t hashBytes(uint64_t hash, const char* data, size_t length)
+{
+    for (size_t i = 0; i < length; i++)
+    {
+        hash ^= (unsigned char)data[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+
+
+// Quote the hash and the length as a strong ETag
+static std::string formatETag(uint64_t hash, size_t length)
+{
+    char etag[48];
+    snprintf(etag, sizeof(etag), "\"%016llx-%llx\"", (unsigned long long)hash, (unsigned long long)length);
+    return etag;
+}
+
+
+
+/*  Strong ETag from the FNV-1a hash and the length of the content.
+    Example: "\"9f2c4d1a03b7e6c5-28f\""
+*/
+std::string computeETag(const char* data, size_t length)
+{
+    return formatETag(hashBytes(FNV_OFFSET_BASIS, data, length), length);
+}
+
+
+
+// Format a time as an IMF-fixdate, e.g. "Sun, 06 Nov 1994 08:49:37 GMT"
+std::string formatHttpDate(time_t time)
+{
+    struct tm gmt;
+    gmtime_r(&time, &gmt);
+
+    char date[64];
+    strftime(date, sizeof(date), "%a, %d %b %Y %H:%M:%S GMT", &gmt);
+    return date;
+}
+
+
+
+// Parse an IMF-fixdate, the only format servers have to generate
+bool parseHttpDate(const std::string& date, time_t& time)
+{
+    struct tm gmt = {};
+    const char* end = strptime(date.c_str(), "%a, %d %b %Y %H:%M:%S GMT", &gmt);
+    if (end == nullptr || *end != '\0')
+        return false;
+
+    time = timegm(&gmt);
+    return true;
+}
+
+
+
+// Compute the ETag of a file, reading it in fixed-size chunks so large files are not loaded into memory
+static bool hashFile(const std::string& filePath, std::string& etag)
+{
+    int fd = open(filePath.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    uint64_t hash = FNV_OFFSET_BASIS;
+    size_t length = 0;
+    char buffer[64 * 1024];
+    ssize_t bytesRead;
+    while ((bytesRead = read(fd, buffer, sizeof(buffer))) > 0)
+    {
+        hash = hashBytes(hash, buffer, bytesRead);
+        length += bytesRead;
+    }
+    close(fd);
+
+    if (bytesRead < 0)
+        return false;
+
+    etag = formatETag(hash, length);
+    return true;
+}
+
+
+
+// Validators of a file, the content is hashed again only when the file changed
+bool ValidatorCache::getFileValidators(const std::string& filePath, Validators& validators)
+{
+    struct stat fileStat;
+    if (stat(filePath.c_str(), &fileStat) != 0)
+        return false;
+
+    // Files and routes share the cache, keep their keys apart
+    std::string key = "file:" + filePath;
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        auto it = entries.find(key);
+        if (it != entries.end() &&
+            it->second.device == fileStat.st_dev && it->second.inode == fileStat.st_ino &&
+            it->second.size == fileStat.st_size &&
+            it->second.modified.tv_sec == fileStat.st_mtim.tv_sec &&
+            it->second.modified.tv_nsec == fileStat.st_mtim.tv_nsec)
+        {
+            validators = it->second.validators;
+            return true;
+        }
+    }
+
+    // Hash outside the lock, other routes keep being served meanwhile
+    Entry entry;
+    if (!hashFile(filePath, entry.validators.etag))
+        return false;
+
+    entry.validators.modifiedTime = fileStat.st_mtim.tv_sec;
+    entry.validators.lastModified = formatHttpDate(fileStat.st_mtim.tv_sec);
+    entry.device = fileStat.st_dev;
+    entry.inode = fileStat.st_ino;
+    entry.size = fileStat.st_size;
+    entry.modified = fileStat.st_mtim;
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    entries[key] = entry;
+    validators = entry.validators;
+    return true;
+}
+
+
+
+// Validators of the last body generated by a cacheable route, false until it ran once
+bool ValidatorCache::getBodyValidators(const std::string& route, Validators& validators)
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto it = entries.find(route);
+    if (it == entries.end())
+        return false;
+
+    validators = it->second.validators;
+    return true;
+}
+
+
+
+// Remember the validators of a generated body, Last-Modified moves only when the body changes
+void ValidatorCache::storeBodyValidators(const std::string& route, const std::string& body, Validators& validators)
+{
+    std::string etag = computeETag(body.data(), body.length());
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    Entry& entry = entries[route];
+    if (entry.validators.etag != etag)
+    {
+        entry.validators.etag = etag;
+        entry.validators.modifiedTime = time(nullptr);
+        entry.validators.lastModified = formatHttpDate(entry.validators.modifiedTime);
+    }
+    validators = entry.validators;
+}
+
+
+
+// Check whether an If-None-Match list contains the entity tag (weak comparison)
+static bool matchesEntityTag(const std::string& ifNoneMatch, const std::string& etag)
+{
+    size_t pos = 0;
+    while (pos < ifNoneMatch.length())
+    {
+        pos = ifNoneMatch.find_first_not_of(" \t,", pos);
+        if (pos == std::string::npos)
+            break;
+
+        if (ifNoneMatch[pos] == '*')
+            return true;
+
+        if (ifNoneMatch.compare(pos, 2, "W/") == 0)
+            pos += 2;
+
+        if (pos >= ifNoneMatch.length() || ifNoneMatch[pos] != '"')
+            return false;
+
+        size_t end = ifNoneMatch.find('"', pos + 1);
+        if (end == std::string::npos)
+            return false;
+
+        if (ifNoneMatch.compare(pos, end - pos + 1, etag) == 0)
+            return true;
+
+        pos = end + 1;
+    }
+    return false;
+}
+
+
+
+/*  Decide whether a 304 Not Modified can be sent.
+    If-None-Match takes precedence, If-Modified-Since is only evaluated without it.
+*/
+bool isNotModified(const std::string& ifNoneMatch, const std::string& ifModifiedSince, const Validators& validators)
+{
+    if (!ifNoneMatch.empty())
+        return matchesEntityTag(ifNoneMatch, validators.etag);
+
+    time_t since;
+    if (!ifModifiedSince.empty() && parseHttpDate(ifModifiedSince, since))
+        return validators.modifiedTime <= since;
+
+    return false;
+}
@@ -0,0 +1,40 @@
+// Validators (ETag, Last-Modified) and evaluation of conditional requests
+#include <string>
+#include <mutex>
+#include <ctime>
+#include <unordered_map>
+#include <sys/stat.h>
+
+// Validators of a representation
+struct Validators {
+    std::string etag;               // Strong entity tag, quoted
+    std::string lastModified;       // IMF-fixdate, e.g. "Sun, 06 Nov 1994 08:49:37 GMT"
+    time_t modifiedTime;            // Last-Modified as seconds since the epoch
+};
+
+// Caches validators so they are recomputed only when the underlying data changes
+class ValidatorCache {
+public:
+    bool getFileValidators(const std::string& filePath, Validators& validators);    // Rehashes the file only if stat() changed
+    bool getBodyValidators(const std::string& route, Validators& validators);       // Validators of the last body generated by a route
+    void storeBodyValidators(const std::string& route, const std::string& body, Validators& validators);
+
+private:
+    struct Entry {
+        Validators validators;
+        dev_t device;               // File identity and state when the ETag was computed
+        ino_t inode;
+        off_t size;
+        struct timespec modified;
+    };
+
+    std::mutex cacheMutex;
+    std::unordered_map<std::string, Entry> entries;
+};
+
+std::string computeETag(const char* data, size_t length);
+std::string formatHttpDate(time_t time);
+bool parseHttpDate(const std::string& date, time_t& time);
+
+// Evaluate the If-None-Match and If-Modified-Since headers (RFC 7232) of a GET request
+bool isNotModified(const std::string& ifNoneMatch, const std::string& ifModifiedSince, const Validators& validators);
@@ -0,0 +1,158 @@
+#include <cstring>
+#include <cstdint>
+#include <strings.h>
+
+#include "RequestParser.h"
+
+// Character classes of RFC 9110, looked up once per byte
+struct CharacterClasses {
+    bool token[256];                // tchar, allowed in methods and field names
+    bool target[256];               // Visible ASCII, allowed in the request target
+    bool fieldValue[256];           // field-vchar plus SP and HTAB, allowed in field values
+
+    CharacterClasses()
+    {
+        const char* tokenSymbols = "!#$%&'*+-.^_`|~";
+        for (int c = 0; c < 256; c++)
+        {
+            token[c]      = (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                            (c != 0 && strchr(tokenSymbols, c) != nullptr);
+            target[c]     = c > 0x20 && c < 0x7F;
+            fieldValue[c] = (c >= 0x20 && c != 0x7F) || c == '\t';
+        }
+    }
+};
+
+static const CharacterClasses characterClasses;
+
+
+
+// Length of the run of bytes of a class starting at pos
+static size_t scanClass(const bool* characterClass, const char* pos, const char* end)
+{
+    const char* start = pos;
+    while (pos < end && characterClass[(unsigned char)*pos])
+        pos++;
+    return pos - start;
+}
+
+
+
+/*  Parse a request head.
+    Example:
+        GET /api/greet HTTP/1.1\r\n
+        Host: localhost:8080\r\n
+        Content-Length: 0\r\n
+        \r\n
+
+    Besides the grammar, requests that would let the server and a proxy disagree on
+    where the body ends are rejected: differing Content-Length fields, and
+    Transfer-Encoding, which is not supported.
+*/
+RequestHeadStatus parseRequestHead(const char* data, size_t length, HttpRequestHead& head)
+{
+    const char* headEnd = (const char*)memmem(data, length, "\r\n\r\n", 4);
+    if (headEnd == nullptr)
+        return RequestHeadStatus::Incomplete;
+
+    const char* pos = data;
+    const char* end = headEnd + 2;      // Lines are parsed up to the CRLF of the last one
+
+    // Request line: method SP request-target SP HTTP-version CRLF
+    size_t methodLength = scanClass(characterClasses.token, pos, end);
+    if (methodLength == 0 || pos[methodLength] != ' ')
+        return RequestHeadStatus::Invalid;
+    head.method.assign(pos, methodLength);
+    pos += methodLength + 1;
+
+    size_t pathLength = scanClass(characterClasses.target, pos, end);
+    if (pathLength == 0 || pos[pathLength] != ' ')
+        return RequestHeadStatus::Invalid;
+    head.path.assign(pos, pathLength);
+    pos += pathLength + 1;
+
+    if (end - pos < 10 || memcmp(pos, "HTTP/", 5) != 0 || pos[5] < '0' || pos[5] > '9' ||
+        pos[6] != '.' || pos[7] < '0' || pos[7] > '9' || pos[8] != '\r' || pos[9] != '\n')
+        return RequestHeadStatus::Invalid;
+    head.httpVersion.assign(pos, 8);
+    pos += 10;
+
+    // Header fields: field-name ":" OWS field-value OWS CRLF
+    head.headers.clear();
+    head.contentLength = 0;
+    bool hasContentLength = false;
+    while (pos < end)
+    {
+        size_t nameLength = scanClass(characterClasses.token, pos, end);
+        if (nameLength == 0 || pos[nameLength] != ':')
+            return RequestHeadStatus::Invalid;   // Also rejects obsolete line folding
+
+        const char* valueStart = pos + nameLength + 1;
+        const char* valueEnd = valueStart + scanClass(characterClasses.fieldValue, valueStart, end);
+        if (valueEnd[0] != '\r' || valueEnd[1] != '\n')
+            return RequestHeadStatus::Invalid;   // Control characters, bare CR or LF
+
+        const char* lineEnd = valueEnd + 2;
+        while (valueStart < valueEnd && (*valueStart == ' ' || *valueStart == '\t'))
+            valueStart++;
+        while (valueEnd > valueStart && (valueEnd[-1] == ' ' || valueEnd[-1] == '\t'))
+            valueEnd--;
+
+        head.headers.emplace_back(std::string(pos, nameLength), std::string(valueStart, valueEnd - valueStart));
+        const std::string& name  = head.headers.back().first;
+        const std::string& value = head.headers.back().second;
+
+        if (strcasecmp(name.c_str(), "Content-Length") == 0)
+        {
+            size_t contentLength;
+            if (!parseContentLength(value, contentLength) || (hasContentLength && contentLength != head.contentLength))
+                return RequestHeadStatus::Invalid;
+            head.contentLength = contentLength;
+            hasContentLength = true;
+        }
+        else if (strcasecmp(name.c_str(), "Transfer-Encoding") == 0)
+            return RequestHeadStatus::Invalid;
+
+        pos = lineEnd;
+    }
+
+    head.length = headEnd + 4 - data;
+    return RequestHeadStatus::Complete;
+}
+
+
+
+// Parse a Content-Length value, e.g. "1024"
+bool parseContentLength(const std::string& value, size_t& contentLength)
+{
+    if (value.empty())
+        return false;
+
+    size_t result = 0;
+    for (char c : value)
+    {
+        if (c < '0' || c > '9')
+            return false;
+
+        size_t digit = c - '0';
+        if (result > (SIZE_MAX - digit) / 10)
+            return false;
+        result = result * 10 + digit;
+    }
+
+    contentLength = result;
+    return true;
+}
+
+
+
+// Value of a header field, e.g. getHeaderValue(head, "content-type") returns "application/json"
+std::string getHeaderValue(const HttpRequestHead& head, const std::string& name)
+{
+    for (const auto& header : head.headers)
+    {
+        if (strcasecmp(header.first.c_str(), name.c_str()) == 0)
+            return header.second;
+    }
+    return "";
+}
@@ -0,0 +1,29 @@
+// Strict parser for the head of an HTTP/1.1 request (request line and header fields)
+#include <string>
+#include <vector>
+#include <utility>
+
+// Request line and header fields of a request
+struct HttpRequestHead {
+    std::string method;             // e.g. "GET"
+    std::string path;               // Request target, e.g. "/api/greet"
+    std::string httpVersion;        // e.g. "HTTP/1.1"
+    std::vector<std::pair<std::string, std::string>> headers;  // Field names and values in request order
+    size_t length = 0;              // Bytes up to and including the empty line ending the head
+    size_t contentLength = 0;       // Value of Content-Length, 0 without it
+};
+
+enum class RequestHeadStatus {
+    Complete,                       // The head was parsed
+    Incomplete,                     // The empty line ending the head was not received yet
+    Invalid                         // The head is malformed, the request gets 400 Bad Request
+};
+
+// Parse the head at the start of data, the body that follows it is not touched
+RequestHeadStatus parseRequestHead(const char* data, size_t length, HttpRequestHead& head);
+
+// Parse a Content-Length value (1*DIGIT), rejecting values that do not fit in a size_t
+bool parseContentLength(const std::string& value, size_t& contentLength);
+
+// Value of a header field (case-insensitive name), empty if the field is absent
+std::string getHeaderValue(const HttpRequestHead& head, const std::string& name);
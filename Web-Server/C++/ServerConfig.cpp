@@ -0,0 +1,269 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <iterator>
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+
+#include "../../JSON-Parser/C++/arena.h"
+#include "../../JSON-Parser/C++/dom.h"
+
+#include "ServerConfig.h"
+
+
+
+// Configuration equivalent to the routes and limits that used to be compiled in
+ServerConfig defaultServerConfig(int port, int threads)
+{
+    ServerConfig config;
+    config.listeners.push_back(port);
+    config.threads = threads;
+
+    RouteConfig homePage;
+    homePage.handler = "homePage";
+    homePage.path = "/";
+    config.routes.push_back(homePage);
+    homePage.path = "/index.html";
+    config.routes.push_back(homePage);
+
+    RouteConfig dummyPage;
+    dummyPage.path = "/dummy.html";
+    dummyPage.handler = "dummyPage";
+    config.routes.push_back(dummyPage);
+
+    RouteConfig greet;
+    greet.path = "/api/greet";
+    greet.handler = "greet";
+    config.routes.push_back(greet);
+
+    RouteConfig post;
+    post.path = "/api/post";
+    post.handler = "post";
+    config.routes.push_back(post);
+
+    RouteConfig upload;
+    upload.path = "/api/upload";
+    upload.handler = "upload";
+    config.routes.push_back(upload);
+
+    RouteConfig echo;
+    echo.path = "/ws/echo";
+    echo.webSocket = "echo";
+    config.routes.push_back(echo);
+
+    RouteConfig chat;
+    chat.path = "/ws/chat";
+    chat.webSocket = "chat";
+    config.routes.push_back(chat);
+
+    return config;
+}
+
+
+
+// Read a string member, keeping the default if it is absent
+static bool readString(const JsonValue& object, const std::string& key, std::string& target, std::string& error)
+{
+    const JsonValue* value = object.find(key);
+    if (value == nullptr)
+        return true;
+
+    if (value->type != JSONSTRING)
+    {
+        error = "\"" + key + "\" must be a string";
+        return false;
+    }
+    target = value->getString();
+    return true;
+}
+
+
+
+// Read an array member, array is null if it is absent
+static bool readArray(const JsonValue& object, const std::string& key, const JsonValue*& array, std::string& error)
+{
+    array = object.find(key);
+    if (array == nullptr || array->type == JSONARRAY)
+        return true;
+
+    error = "\"" + key + "\" must be an array";
+    return false;
+}
+
+
+
+// Read a boolean member, keeping the default if it is absent
+static bool readBoolean(const JsonValue& object, const std::string& key, bool& target, std::string& error)
+{
+    const JsonValue* value = object.find(key);
+    if (value == nullptr)
+        return true;
+
+    if (value->type != JSONBOOLEAN)
+    {
+        error = "\"" + key + "\" must be true or false";
+        return false;
+    }
+    target = value->boolean;
+    return true;
+}
+
+
+
+// Read an integer member between minimum and the largest T, keeping the default if it is absent
+template <typename T>
+static bool readNumber(const JsonValue& object, const std::string& key, T& target, int64_t minimum, std::string& error)
+{
+    const JsonValue* value = object.find(key);
+    if (value == nullptr)
+        return true;
+
+    int64_t number;
+    if (!value->getInt64(number) || number < minimum || (uint64_t)number > (uint64_t)std::numeric_limits<T>::max())
+    {
+        error = "\"" + key + "\" must be an integer between " + std::to_string(minimum) +
+                " and " + std::to_string(std::numeric_limits<T>::max());
+        return false;
+    }
+    target = (T)number;
+    return true;
+}
+
+
+
+/*  Read a configuration file.
+    Example:
+        {
+            "listeners": [ { "port": 8080 } ],
+            "threads": 4,
+            "chunkSize": 1024,
+            "backlog": 10,
+            "limits": { "maxHeaderSize": 65536, "maxBodySize": 16777216, "uploadSpoolThreshold": 65536, "maxUploadSize": 4294967296 },
+            "staticRoots": [ { "prefix": "/static/", "directory": "public" } ],
+            "routes": [
+                { "path": "/", "file": "public/index.html", "contentType": "text/html" },
+                { "path": "/api/greet", "handler": "greet", "cacheable": true },
+                { "path": "/ws/chat", "webSocket": "chat" }
+            ]
+        }
+*/
+bool loadServerConfig(const std::string& fileName, ServerConfig& config, std::string& error)
+{
+    std::ifstream inputFile(fileName);
+    if (!inputFile.is_open())
+    {
+        error = "cannot open " + fileName;
+        return false;
+    }
+
+    std::string contents((std::istreambuf_iterator<char>(inputFile)), std::istreambuf_iterator<char>());
+
+    // Parse with the JSON parser of this repository into a value tree
+    JsonDocument document;
+    if (!document.parse(contents.data(), contents.length()))
+    {
+        error = fileName + " is not valid JSON";
+        return false;
+    }
+
+    const JsonValue& root = document.root();
+    if (root.type != JSONOBJECT)
+    {
+        error = "the configuration must be an object";
+        return false;
+    }
+
+    ServerConfig loaded;
+    const JsonValue *listeners, *staticRoots, *routes;
+    if (!readArray(root, "listeners", listeners, error) ||
+        !readArray(root, "staticRoots", staticRoots, error) ||
+        !readArray(root, "routes", routes, error))
+        return false;
+
+    if (listeners == nullptr || listeners->at(0) == nullptr)
+    {
+        error = "at least one listener is needed in \"listeners\"";
+        return false;
+    }
+
+    for (size_t i = 0; listeners->at(i) != nullptr; i++)
+    {
+        const JsonValue& listener = *listeners->at(i);
+        int port = 0;
+        if (!readNumber(listener, "port", port, 1, error))
+            return false;
+        if (port > 65535)
+        {
+            error = "listeners need a \"port\" between 1 and 65535";
+            return false;
+        }
+        loaded.listeners.push_back(port);
+    }
+
+    if (!readNumber(root, "threads", loaded.threads, 1, error) ||
+        !readNumber(root, "chunkSize", loaded.chunkSize, MIN_CHUNK_SIZE, error) ||
+        !readNumber(root, "backlog", loaded.backlog, 1, error))
+        return false;
+
+    if (const JsonValue* limits = root.find("limits"))
+    {
+        if (limits->type != JSONOBJECT)
+        {
+            error = "\"limits\" must be an object";
+            return false;
+        }
+
+        if (!readNumber(*limits, "maxHeaderSize", loaded.maxHeaderSize, MIN_HEADER_SIZE, error) ||
+            !readNumber(*limits, "maxBodySize", loaded.maxBodySize, 1, error) ||
+            !readNumber(*limits, "uploadSpoolThreshold", loaded.uploadSpoolThreshold, 1, error) ||
+            !readNumber(*limits, "maxUploadSize", loaded.maxUploadSize, 1, error))
+            return false;
+    }
+
+    if (staticRoots != nullptr)
+    {
+        for (size_t i = 0; staticRoots->at(i) != nullptr; i++)
+        {
+            const JsonValue& entry = *staticRoots->at(i);
+            StaticRootConfig staticRoot;
+            if (!readString(entry, "prefix", staticRoot.prefix, error) ||
+                !readString(entry, "directory", staticRoot.directory, error))
+                return false;
+            if (staticRoot.prefix.empty() || staticRoot.prefix[0] != '/' || staticRoot.directory.empty())
+            {
+                error = "static roots need a \"prefix\" starting with / and a \"directory\"";
+                return false;
+            }
+            loaded.staticRoots.push_back(staticRoot);
+        }
+    }
+
+    if (routes != nullptr)
+    {
+        for (size_t i = 0; routes->at(i) != nullptr; i++)
+        {
+            const JsonValue& entry = *routes->at(i);
+            RouteConfig route;
+            if (!readString(entry, "path", route.path, error) ||
+                !readString(entry, "method", route.method, error) ||
+                !readString(entry, "handler", route.handler, error) ||
+                !readString(entry, "file", route.file, error) ||
+                !readString(entry, "contentType", route.contentType, error) ||
+                !readString(entry, "webSocket", route.webSocket, error) ||
+                !readBoolean(entry, "cacheable", route.cacheable, error))
+                return false;
+
+            if (route.path.empty() || (route.handler.empty() && route.file.empty() && route.webSocket.empty()))
+            {
+                error = "routes need a \"path\" and one of \"handler\", \"file\" or \"webSocket\"";
+                return false;
+            }
+            loaded.routes.push_back(route);
+        }
+    }
+
+    config = loaded;
+    return true;
+}
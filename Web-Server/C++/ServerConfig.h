@@ -0,0 +1,43 @@
+// Declarative server configuration, read from a JSON file
+#include <string>
+#include <vector>
+
+// Smallest values accepted from a configuration file
+const int MIN_CHUNK_SIZE = 64;          // Holds a typical request line in one read
+const size_t MIN_HEADER_SIZE = 1024;    // Leaves room for the request line and a few headers
+
+// A route declared in the configuration
+struct RouteConfig {
+    std::string path;               // Request path, e.g. "/api/greet"
+    std::string method;             // Overrides the method of the built-in handler (optional)
+    std::string handler;            // Name of a built-in handler, e.g. "greet"
+    std::string file;               // File served by the route (optional)
+    std::string contentType;        // Overrides the content type of the response (optional)
+    std::string webSocket;          // Name of a built-in WebSocket handler, e.g. "chat"
+    bool cacheable = false;         // Whether 304s may skip the handler
+};
+
+// A directory whose files are served below a path prefix
+struct StaticRootConfig {
+    std::string prefix;             // e.g. "/static/"
+    std::string directory;          // e.g. "public"
+};
+
+struct ServerConfig {
+    std::vector<int> listeners;                 // Ports to listen on
+    int threads = 4;                            // Number of worker threads
+    int chunkSize = 1024;                       // Size of the buffer for reading client data
+    int backlog = 10;                           // Number of connections to queue
+    size_t maxHeaderSize = 64 * 1024;           // Larger request heads get 400 Bad Request
+    size_t maxBodySize = 16 * 1024 * 1024;      // Larger buffered bodies get 413 Payload Too Large
+    size_t uploadSpoolThreshold = 64 * 1024;    // Uploaded parts larger than this are spooled to disk
+    size_t maxUploadSize = 4ULL * 1024 * 1024 * 1024;   // Larger streamed uploads get 413 Payload Too Large
+    std::vector<RouteConfig> routes;
+    std::vector<StaticRootConfig> staticRoots;
+};
+
+// Configuration equivalent to the routes and limits that used to be compiled in
+ServerConfig defaultServerConfig(int port, int threads);
+
+// Read a configuration file, validated with the project's JSON parser
+bool loadServerConfig(const std::string& fileName, ServerConfig& config, std::string& error);
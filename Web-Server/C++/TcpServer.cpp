@@ -19,10 +19,13 @@ std::string getHttpStatusInString(HttpStatus status)
 {
     switch (status)
     {
+        case HttpStatus::SwitchingProtocols: return "101 Switching Protocols";
         case HttpStatus::OK: return "200 OK";
+        case HttpStatus::NotModified: return "304 Not Modified";
         case HttpStatus::NotFound: return "404 Not Found";
         case HttpStatus::MethodNotAllowed: return "405 Method Not Allowed";
         case HttpStatus::BadRequest: return "400 Bad Request";
+        case HttpStatus::PayloadTooLarge: return "413 Payload Too Large";
         default: return "Unknown Status";
     }
 }
@@ -40,44 +43,107 @@ std::string getHttpContentTypeInString(HttpContentType type)
     }
 }
 
-// Constructor implementation
+// To get the content type of a file from its extension
+std::string getContentTypeForFile(const std::string& filePath)
+{
+    static const std::unordered_map<std::string, std::string> contentTypes = {
+        {"html", "text/html"}, {"htm", "text/html"}, {"txt", "text/plain"}, {"css", "text/css"},
+        {"js", "application/javascript"}, {"json", "application/json"}, {"xml", "application/xml"},
+        {"png", "image/png"}, {"jpg", "image/jpeg"}, {"jpeg", "image/jpeg"}, {"gif", "image/gif"},
+        {"svg", "image/svg+xml"}, {"ico", "image/x-icon"}
+    };
+
+    size_t dot = filePath.rfind('.');
+    if (dot != std::string::npos && filePath.find('/', dot) == std::string::npos)
+    {
+        auto it = contentTypes.find(filePath.substr(dot + 1));
+        if (it != contentTypes.end())
+            return it->second;
+    }
+    return "application/octet-stream";
+}
+
+// Constructor implementation, serving the default routes on one port
 TcpServer::TcpServer(int port, int threadPoolSize)
-    : portNumber(port), serverSocket(-1), addrLen(sizeof(serverAddr))
+    : clientSocket(-1), addrLen(sizeof(clientAddr)), stopping(false), workerCount(0)
 {
-    // Initialize the server address structure
-    serverAddr.sin_family = AF_INET;            // Set address family to IPv4
-    serverAddr.sin_addr.s_addr = INADDR_ANY;    // Accept connections from any IP address
-    serverAddr.sin_port = htons(portNumber);    // Convert port number to network byte order
+    setupHandlers(); // Initialize the built-in request handlers
+    initialize(defaultServerConfig(port, threadPoolSize));
+}
 
-    // Start the server and handle any initialization errors
-    if (startServer() != 0)
+// Constructor implementation, serving what the configuration file declares
+TcpServer::TcpServer(const std::string& configFile)
+    : clientSocket(-1), addrLen(sizeof(clientAddr)), configFile(configFile), stopping(false), workerCount(0)
+{
+    setupHandlers(); // Initialize the built-in request handlers
+
+    ServerConfig config;
+    std::string error;
+    if (!loadServerConfig(configFile, config, error))
     {
-        std::cerr << "Failure in starting the server\n";
+        std::cerr << "Failure in loading the configuration: " << error << "\n";
         return;
     }
+    initialize(config);
+}
+
+// Start the listeners, the WebSocket hub, the reload thread and the workers
+void TcpServer::initialize(const ServerConfig& config)
+{
+    std::string error;
+    std::shared_ptr<const ServerSnapshot> routes = buildSnapshot(config, error);
+    if (!routes)
+    {
+        std::cerr << "Failure in setting up the routes: " << error << "\n";
+        return;
+    }
+    std::atomic_store(&snapshot, routes);
+
+    // Start the server and handle any initialization errors
+    for (int port : config.listeners)
+    {
+        int serverSocket = startServer(port);
+        if (serverSocket < 0)
+        {
+            std::cerr << "Failure in starting the server\n";
+            return;
+        }
+        serverSockets.push_back(serverSocket);
+    }
 
-    setupHandlers(); // Initialize the request handlers for different routes
+    // SIGHUP is blocked here and inherited by every thread created below,
+    // so it is only ever received by the reload thread
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGHUP);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    reloadThread = std::thread(&TcpServer::reloadOnSignal, this);
+
+    // Start the event loop serving WebSocket connections
+    webSocketHub.start();
 
     // Create a pool of worker threads
-    for (int i = 0; i < threadPoolSize; ++i)
-        threadPool.emplace_back(&TcpServer::workerThread, this);
+    resizeThreadPool(config.threads);
 }
 
 // Destructor implementation
 TcpServer::~TcpServer()
 {
-    // Ensure the server socket is closed when the TcpServer object is destroyed
-    closeSocket(serverSocket);
+    stopping = true;
+
+    // Ensure the server sockets are closed when the TcpServer object is destroyed
+    for (int serverSocket : serverSockets)
+        closeSocket(serverSocket);
 
-    // Join all worker threads
+    // Wake up the reload thread so it sees stopping
+    if (reloadThread.joinable())
     {
-        std::lock_guard<std::mutex> lock(queueMutex);
-        // Notify all threads to exit
-        // Empty the queue
-        clientQueue = std::queue<int>();
+        pthread_kill(reloadThread.native_handle(), SIGHUP);
+        reloadThread.join();
     }
 
-    queueCondVar.notify_all();
+    // Ask every worker thread to exit
+    resizeThreadPool(0);
 
     for (auto &thread : threadPool)
     {
@@ -89,53 +155,74 @@ TcpServer::~TcpServer()
 // Method to listen for incoming client connections
 int TcpServer::listenServer()
 {
+    std::shared_ptr<const ServerSnapshot> routes = currentSnapshot();
+    if (!routes || serverSockets.empty())
+        return 1;
+
     std::cout << "Server started listening\n";
 
-    // Set the socket to listen for incoming connections with a queue size of BACKLOG
-    if (listen(serverSocket, BACKLOG) < 0)
+    std::vector<struct pollfd> pollFds;
+    for (size_t i = 0; i < serverSockets.size(); i++)
     {
-        std::cerr << "Failure in listening server\n";
-        closeSocket(serverSocket);
-        return 1;
-    }
+        // Set the socket to listen for incoming connections with a queue size of backlog
+        if (listen(serverSockets[i], routes->config.backlog) < 0)
+        {
+            std::cerr << "Failure in listening server\n";
+            return 1;
+        }
 
-    std::cout << "Server is listening on PORT " << portNumber << "\n";
+        std::cout << "Server is listening on PORT " << routes->config.listeners[i] << "\n";
+        pollFds.push_back({serverSockets[i], POLLIN, 0});
+    }
 
     while (true) // Infinite loop to accept incoming connections
     {
-        // Accept the incoming client connection
-        clientSocket = accept(serverSocket, (struct sockaddr *)&clientAddr, &addrLen);
-        if (clientSocket < 0)
-        {
-            std::cerr << "Failure in accepting the incoming client connection\n";
-            continue; // Continue to next iteration on failure
-        }
+        // Wait until one of the listeners has a pending connection
+        if (poll(pollFds.data(), pollFds.size(), -1) < 0)
+            continue;
 
-        // Add client socket to the queue
+        for (auto& pollFd : pollFds)
         {
-            std::lock_guard<std::mutex> lock(queueMutex);
-            clientQueue.push(clientSocket);
+            if (!(pollFd.revents & POLLIN))
+                continue;
+
+            // Accept the incoming client connection
+            clientSocket = accept(pollFd.fd, (struct sockaddr *)&clientAddr, &addrLen);
+            if (clientSocket < 0)
+            {
+                std::cerr << "Failure in accepting the incoming client connection\n";
+                continue; // Continue to next listener on failure
+            }
+
+            // Add client socket to the queue
+            {
+                std::lock_guard<std::mutex> lock(queueMutex);
+                clientQueue.push(clientSocket);
+            }
+            queueCondVar.notify_one(); // Notify a worker thread
         }
-        queueCondVar.notify_one(); // Notify a worker thread
     }
 
-    // Close the server socket after exiting the loop (this point is never reached)
-    closeSocket(serverSocket);
-
     return 0;
 }
 
-// Start the server
-int TcpServer::startServer()
+// Start a server socket bound to the port, returns -1 on failure
+int TcpServer::startServer(int port)
 {
     std::cout << "Starting the server\n";
-    
+
+    // Initialize the server address structure
+    struct sockaddr_in serverAddr;
+    serverAddr.sin_family = AF_INET;            // Set address family to IPv4
+    serverAddr.sin_addr.s_addr = INADDR_ANY;    // Accept connections from any IP address
+    serverAddr.sin_port = htons(port);          // Convert port number to network byte order
+
     // Create the server socket
-    serverSocket = socket(AF_INET, SOCK_STREAM, 0);
+    int serverSocket = socket(AF_INET, SOCK_STREAM, 0);
     if (serverSocket < 0)
     {
         std::cerr << "Failure in socket creation\n";
-        return 1;
+        return -1;
     }
 
     std::cout << "Socket successfully created\n";
@@ -145,12 +232,159 @@ int TcpServer::startServer()
     {
         std::cerr << "Failure in binding the socket to the specific address and port\n";
         closeSocket(serverSocket);
-        return 1;
+        return -1;
     }
 
     std::cout << "Socket successfully binded to address and port\n";
 
-    return 0;
+    return serverSocket;
+}
+
+// Get the snapshot a new request works with, it stays valid until the request is done
+std::shared_ptr<const ServerSnapshot> TcpServer::currentSnapshot()
+{
+    return std::atomic_load(&snapshot);
+}
+
+/*  Build the routes of a configuration.
+    Routes name a built-in handler ("handler"), serve a file ("file"), or accept
+    WebSocket upgrades ("webSocket").
+*/
+std::shared_ptr<const ServerSnapshot> TcpServer::buildSnapshot(const ServerConfig& config, std::string& error)
+{
+    std::shared_ptr<ServerSnapshot> routes = std::make_shared<ServerSnapshot>();
+    routes->config = config;
+
+    for (const RouteConfig& route : config.routes)
+    {
+        if (!route.webSocket.empty())
+        {
+            auto it = builtinWebSocketHandlers.find(route.webSocket);
+            if (it == builtinWebSocketHandlers.end())
+            {
+                error = "unknown WebSocket handler \"" + route.webSocket + "\"";
+                return nullptr;
+            }
+            routes->webSocketRoutes[route.path] = it->second;
+            continue;
+        }
+
+        RequestHandler handler;
+        if (!route.handler.empty())
+        {
+            auto it = builtinHandlers.find(route.handler);
+            if (it == builtinHandlers.end())
+            {
+                error = "unknown handler \"" + route.handler + "\"";
+                return nullptr;
+            }
+            handler = it->second;
+        }
+        else
+        {
+            std::string filePath = route.file;
+            handler = {HttpMethod::GET, [filePath] { return readFile(filePath); }, getContentTypeForFile(filePath)};
+        }
+
+        if (!route.file.empty())
+            handler.filePath = route.file;
+        if (!route.contentType.empty())
+            handler.responseType = route.contentType;
+        if (!route.method.empty())
+        {
+            handler.method = getHttpMethod(route.method);
+            if (handler.method == HttpMethod::INVALID)
+            {
+                error = "invalid method \"" + route.method + "\" for " + route.path;
+                return nullptr;
+            }
+        }
+        handler.cacheable = handler.cacheable || route.cacheable;
+
+        routes->requestHandlers[route.path] = handler;
+    }
+
+    return routes;
+}
+
+// Load the configuration file again and publish the new routes and limits
+bool TcpServer::reloadConfig()
+{
+    if (configFile.empty())
+    {
+        std::cerr << "No configuration file to reload\n";
+        return false;
+    }
+
+    ServerConfig config;
+    std::string error;
+    std::shared_ptr<const ServerSnapshot> routes;
+    if (!loadServerConfig(configFile, config, error) || !(routes = buildSnapshot(config, error)))
+    {
+        // Keep serving with the current configuration
+        std::cerr << "Failure in reloading the configuration: " << error << "\n";
+        return false;
+    }
+
+    std::shared_ptr<const ServerSnapshot> previous = std::atomic_exchange(&snapshot, routes);
+
+    if (config.listeners != previous->config.listeners || config.backlog != previous->config.backlog)
+        std::cerr << "Changes to listeners and backlog take effect after a restart\n";
+
+    resizeThreadPool(config.threads);
+
+    std::cout << "Configuration reloaded from " << configFile << "\n";
+    return true;
+}
+
+// Start new workers, or ask surplus ones to exit once they finish their request and join them
+void TcpServer::resizeThreadPool(int threads)
+{
+    std::vector<std::thread> exited;
+    {
+        std::unique_lock<std::mutex> lock(queueMutex);
+
+        for (; workerCount < threads; workerCount++)
+            threadPool.emplace_back(&TcpServer::workerThread, this);
+
+        size_t surplus = 0;
+        for (; workerCount > threads; workerCount--, surplus++)
+            clientQueue.push(-1);
+
+        queueCondVar.notify_all();
+
+        // Take the threads of the workers that exited out of the pool
+        workerExitCondVar.wait(lock, [this, surplus] { return exitedWorkers.size() >= surplus; });
+        for (std::thread::id id : exitedWorkers)
+        {
+            auto it = std::find_if(threadPool.begin(), threadPool.end(),
+                                   [id](const std::thread& thread) { return thread.get_id() == id; });
+            exited.push_back(std::move(*it));
+            threadPool.erase(it);
+        }
+        exitedWorkers.clear();
+    }
+
+    for (auto &thread : exited)
+        thread.join();
+}
+
+// Wait for SIGHUP and reload the configuration
+void TcpServer::reloadOnSignal()
+{
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGHUP);
+
+    while (true)
+    {
+        int signal;
+        if (sigwait(&signals, &signal) != 0 || stopping)
+            return;
+
+        std::cout << "SIGHUP received, reloading the configuration\n";
+        reloadConfig();
+    }
 }
 
 // Close the socket
@@ -163,8 +397,13 @@ void TcpServer::closeSocket(int socket)
 // Handle incoming client requests
 int TcpServer::handleClient(int clientSocket)
 {
+    // The request is served with the routes and limits current when it arrived
+    std::shared_ptr<const ServerSnapshot> routes = currentSnapshot();
+    const ServerConfig& config = routes->config;
+
     std::string request;
-    char buffer[CHUNK_SIZE];
+    HttpRequestHead head;
+    std::vector<char> buffer(config.chunkSize);
     ssize_t bytesRead;
     bool headersComplete  = false;
     size_t contentLength  = 0;
@@ -173,7 +412,7 @@ int TcpServer::handleClient(int clientSocket)
     // Read the client request
     while (true)
     {
-        bytesRead = read(clientSocket, buffer, CHUNK_SIZE - 1);
+        bytesRead = read(clientSocket, buffer.data(), buffer.size() - 1);
         if (bytesRead <= 0)
         {
             if (bytesRead == 0)
@@ -186,26 +425,64 @@ int TcpServer::handleClient(int clientSocket)
         }
 
         buffer[bytesRead] = '\0';
-        request.append(buffer, bytesRead);
+        request.append(buffer.data(), bytesRead);
         totalBytesRead += bytesRead;
 
         if (!headersComplete)
         {
-            size_t headerEnd = request.find("\r\n\r\n");
-            if (headerEnd != std::string::npos)
+            // Malformed heads and heads over the limit are rejected before any handler runs
+            RequestHeadStatus status = parseRequestHead(request.data(), request.length(), head);
+            if (status == RequestHeadStatus::Invalid ||
+                (status == RequestHeadStatus::Incomplete ? request.length() : head.length) > config.maxHeaderSize)
+            {
+                sendResponse(clientSocket, {"", getHttpStatusInString(HttpStatus::BadRequest),
+                                           getHttpContentTypeInString(HttpContentType::TEXT_PLAIN)});
+                closeSocket(clientSocket);
+                return 1;
+            }
+
+            if (status == RequestHeadStatus::Complete)
             {
                 headersComplete = true;
+                contentLength = head.contentLength;
 
-                size_t contentLengthPos = request.find("Content-Length: ");
-                if (contentLengthPos != std::string::npos)
+                // If we've read beyond the headers, adjust totalBytesRead
+                totalBytesRead = request.length() - head.length;
+
+                // Stream form uploads to their handler instead of buffering the body
+                std::unique_ptr<FormParser> formParser = createUploadParser(*routes, head);
+                if (formParser)
                 {
-                    size_t valueStart = contentLengthPos + 16; // length of "Content-Length: "
-                    size_t valueEnd   = request.find("\r\n", valueStart);
-                    contentLength     = std::stoul(request.substr(valueStart, valueEnd - valueStart));
+                    // Uploads are spooled to disk, which must not be filled by one request
+                    if (contentLength > config.maxUploadSize)
+                    {
+                        sendResponse(clientSocket, {"", getHttpStatusInString(HttpStatus::PayloadTooLarge),
+                                                   getHttpContentTypeInString(HttpContentType::TEXT_PLAIN)});
+                        closeSocket(clientSocket);
+                        return 1;
+                    }
+
+                    std::string bodyStart = request.substr(head.length);
+                    request.erase(head.length);
+
+                    if (!streamRequestBody(clientSocket, *formParser, bodyStart, contentLength, config))
+                    {
+                        sendResponse(clientSocket, {"", getHttpStatusInString(HttpStatus::BadRequest),
+                                                   getHttpContentTypeInString(HttpContentType::TEXT_PLAIN)});
+                        closeSocket(clientSocket);
+                        return 1;
+                    }
+                    break;
                 }
 
-                // If we've read beyond the headers, adjust totalBytesRead
-                totalBytesRead = request.length() - (headerEnd + 4);
+                // Other bodies are buffered, so their size is limited
+                if (contentLength > config.maxBodySize)
+                {
+                    sendResponse(clientSocket, {"", getHttpStatusInString(HttpStatus::PayloadTooLarge),
+                                               getHttpContentTypeInString(HttpContentType::TEXT_PLAIN)});
+                    closeSocket(clientSocket);
+                    return 1;
+                }
             }
         }
 
@@ -214,37 +491,149 @@ int TcpServer::handleClient(int clientSocket)
             break;
     }
 
+    // WebSocket connections stay open, the hub takes over the socket
+    if (isWebSocketUpgrade(*routes, head))
+        return upgradeToWebSocket(*routes, clientSocket, head, request.substr(head.length));
+
     // Process the request and generate a response
-    auto [responseBody, status, contentType] = processRequest(request);
+    HttpResponse response = processRequest(*routes, head);
+
+    int result = sendResponse(clientSocket, response);
+
+    // Close the client socket after responding
+    closeSocket(clientSocket);
+    return result;
+}
 
+// Write an HTTP response to the client socket
+int TcpServer::sendResponse(int clientSocket, const HttpResponse& response)
+{
     // Create the HTTP response
     std::ostringstream responseStream;
-    responseStream << "HTTP/1.1 " << status << "\r\n"
-                   << "Content-Type: " << contentType << "\r\n"
-                   << "Content-Length: " << responseBody.length() << "\r\n"
+    responseStream << "HTTP/1.1 " << response.status << "\r\n";
+
+    // A 304 has no body, so it carries neither Content-Type nor Content-Length
+    if (response.status != getHttpStatusInString(HttpStatus::NotModified))
+        responseStream << "Content-Type: " << response.contentType << "\r\n"
+                       << "Content-Length: " << response.body.length() << "\r\n";
+
+    responseStream << response.headers
                    << "\r\n"
-                   << responseBody;
+                   << response.body;
 
     // Send the HTTP response
-    const std::string& response = responseStream.str();
-    ssize_t totalBytesSent = 0;
-    while (totalBytesSent < response.length())
+    return writeToSocket(clientSocket, responseStream.str());
+}
+
+// Write the whole buffer to the client socket
+int TcpServer::writeToSocket(int clientSocket, const std::string& data)
+{
+    size_t totalBytesSent = 0;
+    while (totalBytesSent < data.length())
     {
-        ssize_t sent = write(clientSocket, response.c_str() + totalBytesSent, response.length() - totalBytesSent);
+        ssize_t sent = write(clientSocket, data.c_str() + totalBytesSent, data.length() - totalBytesSent);
         if (sent < 0)
         {
             std::cerr << "Failure in writing to client socket\n";
-            closeSocket(clientSocket);
             return 1;
         }
         totalBytesSent += sent;
     }
+    return 0;
+}
 
-    // Close the client socket after responding
-    closeSocket(clientSocket);
+// Check whether the request asks to upgrade a WebSocket route
+bool TcpServer::isWebSocketUpgrade(const ServerSnapshot& routes, const HttpRequestHead& head)
+{
+    if (getHttpMethod(head.method) != HttpMethod::GET || routes.webSocketRoutes.find(head.path) == routes.webSocketRoutes.end())
+        return false;
+
+    std::string upgrade = getHeaderValue(head, "Upgrade");
+    return strcasecmp(upgrade.c_str(), "websocket") == 0;
+}
+
+/*  Complete the WebSocket opening handshake.
+    Request:
+        GET /ws/chat HTTP/1.1
+        Upgrade: websocket
+        Connection: Upgrade
+        Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==
+        Sec-WebSocket-Version: 13
+
+    Response:
+        HTTP/1.1 101 Switching Protocols
+        Upgrade: websocket
+        Connection: Upgrade
+        Sec-WebSocket-Accept: s3pPLMBiTxaQ9kYGzzhZRbK+xOo=
+*/
+int TcpServer::upgradeToWebSocket(const ServerSnapshot& routes, int clientSocket, const HttpRequestHead& head, const std::string& initialData)
+{
+    std::string key = getHeaderValue(head, "Sec-WebSocket-Key");
+    if (key.empty() || getHeaderValue(head, "Sec-WebSocket-Version") != "13")
+    {
+        sendResponse(clientSocket, {"", getHttpStatusInString(HttpStatus::BadRequest),
+                                    getHttpContentTypeInString(HttpContentType::TEXT_PLAIN)});
+        closeSocket(clientSocket);
+        return 1;
+    }
+
+    std::cout << "WebSocket upgrade, Path: " << head.path << "\n";
+
+    std::ostringstream responseStream;
+    responseStream << "HTTP/1.1 " << getHttpStatusInString(HttpStatus::SwitchingProtocols) << "\r\n"
+                   << "Upgrade: websocket\r\n"
+                   << "Connection: Upgrade\r\n"
+                   << "Sec-WebSocket-Accept: " << computeWebSocketAccept(key) << "\r\n"
+                   << "\r\n";
+
+    // The hub sends the 101 once the connection is registered, frames sent right
+    // after the handshake may already be in the request buffer (initialData)
+    if (webSocketHub.addConnection(clientSocket, head.path, routes.webSocketRoutes.at(head.path), responseStream.str(), initialData) == 0)
+        return 1;
     return 0;
 }
 
+// Get a streaming body parser if the request targets an upload route with a form body
+std::unique_ptr<FormParser> TcpServer::createUploadParser(const ServerSnapshot& routes, const HttpRequestHead& head)
+{
+    auto it = routes.requestHandlers.find(head.path);
+    if (it == routes.requestHandlers.end() || !it->second.partHandler || it->second.method != getHttpMethod(head.method))
+        return nullptr;
+
+    return createFormParser(getHeaderValue(head, "Content-Type"), it->second.partHandler, routes.config.uploadSpoolThreshold);
+}
+
+// Feed the request body to the parser chunk by chunk, without keeping it in memory
+bool TcpServer::streamRequestBody(int clientSocket, FormParser& parser, const std::string& bodyStart, size_t contentLength, const ServerConfig& config)
+{
+    if (contentLength > config.maxUploadSize)
+        return false;
+
+    size_t chunkSize = config.chunkSize;
+    size_t remaining = contentLength;
+    size_t initial = std::min(bodyStart.length(), remaining);
+    if (!parser.feed(bodyStart.data(), initial))
+        return false;
+    remaining -= initial;
+
+    std::vector<char> buffer(chunkSize);
+    while (remaining > 0)
+    {
+        ssize_t bytesRead = read(clientSocket, buffer.data(), std::min(remaining, chunkSize));
+        if (bytesRead <= 0)
+        {
+            std::cerr << "Failure in reading the request body\n";
+            return false;
+        }
+
+        if (!parser.feed(buffer.data(), bytesRead))
+            return false;
+        remaining -= bytesRead;
+    }
+
+    return parser.finish();
+}
+
 void TcpServer::workerThread()
 {
     while (true)
@@ -257,6 +646,14 @@ void TcpServer::workerThread()
 
             clientSocket = clientQueue.front();
             clientQueue.pop();
+
+            // The pool is shrinking
+            if (clientSocket < 0)
+            {
+                exitedWorkers.push_back(std::this_thread::get_id());
+                workerExitCondVar.notify_one();
+                return;
+            }
         }
 
         std::cout << "Thread Id: " << std::this_thread::get_id() << "\n";
@@ -267,19 +664,24 @@ void TcpServer::workerThread()
     }
 }
 
-// Initialize the request handlers for different routes
+// Initialize the built-in handlers, routes in the configuration refer to them by name
 void TcpServer::setupHandlers()
 {
-    // Handle requests to the root path
-    requestHandlers["/"] = {HttpMethod::GET, handleHomePage, "text/html"};
-    // Handle requests to index.html
-    requestHandlers["/index.html"] = {HttpMethod::GET, handleHomePage, "text/html"};
-    // Handle requests to dummy.html
-    requestHandlers["/dummy.html"] = {HttpMethod::GET, handleDummyPage, "text/html"};
-    // Handle API greet requests
-    requestHandlers["/api/greet"] = {HttpMethod::GET, handleGreetRequest, "application/json"};
+    // Serve the home page
+    builtinHandlers["homePage"] = {HttpMethod::GET, handleHomePage, "text/html", nullptr, HOME_PAGE_FILE};
+    // Serve dummy.html
+    builtinHandlers["dummyPage"] = {HttpMethod::GET, handleDummyPage, "text/html", nullptr, DUMMY_PAGE_FILE};
+    // Handle API greet requests, the greeting never changes
+    builtinHandlers["greet"] = {HttpMethod::GET, handleGreetRequest, "application/json", nullptr, "", true};
     // Handle API post requests
-    requestHandlers["/api/post"] = {HttpMethod::POST, handlePostRequest, "application/json"};
+    builtinHandlers["post"] = {HttpMethod::POST, handlePostRequest, "application/json"};
+    // Handle form uploads, the parts are streamed to handleUploadPart
+    builtinHandlers["upload"] = {HttpMethod::POST, handleUploadRequest, "application/json", handleUploadPart};
+
+    // WebSocket echo, messages are sent back to the sender
+    builtinWebSocketHandlers["echo"] = handleEchoMessage;
+    // WebSocket chat, messages are broadcast to every connection on the route
+    builtinWebSocketHandlers["chat"] = handleChatMessage;
 }
 
 /* Processing the client request
@@ -293,17 +695,12 @@ void TcpServer::setupHandlers()
 
         {"key": "value"}
 */
-std::tuple<std::string, std::string, std::string> TcpServer::processRequest(const std::string& request)
+HttpResponse TcpServer::processRequest(const ServerSnapshot& routes, const HttpRequestHead& head)
 {
-    // Extract the first line of the request
-    std::istringstream requestStream(request);
-    std::string requestLine;
-    std::getline(requestStream, requestLine);
-
-    // Parse the request line
-    std::istringstream requestLineStream(requestLine);
-    std::string method, path, httpVersion;
-    requestLineStream >> method >> path >> httpVersion;
+    // The request line was already parsed with the head
+    const std::string& method = head.method;
+    const std::string& path = head.path;
+    const std::string& httpVersion = head.httpVersion;
 
     // Check for valid HTTP methods
     if (getHttpMethod(method) == HttpMethod::INVALID)
@@ -316,18 +713,19 @@ std::tuple<std::string, std::string, std::string> TcpServer::processRequest(cons
     if (path != "")
     {
         // Find a match in request handlers
-        auto it = requestHandlers.find(path);
-        if (it != requestHandlers.end())
+        auto it = routes.requestHandlers.find(path);
+        if (it != routes.requestHandlers.end())
         {
             // Key found, access the RequestHandler
             const RequestHandler& handler = it->second;
             if (handler.method == getHttpMethod(method)) // If a matching handler is found
-            {
-                std::string body = handler.handlerFunction();   // Call the handler function
-                return {body, getHttpStatusInString(HttpStatus::OK), handler.responseType};  // Return the response body, status, and content type
-            }
+                return runHandler(head, handler);
         }
 
+        // Look for a file below the static roots
+        if (getHttpMethod(method) == HttpMethod::GET && !routes.config.staticRoots.empty())
+            return serveStaticFile(routes, head);
+
         // If no handler matched, return a 404 response
         return {handleNotFound(), getHttpStatusInString(HttpStatus::NotFound), getHttpContentTypeInString(HttpContentType::TEXT_HTML)};
     }
@@ -335,3 +733,69 @@ std::tuple<std::string, std::string, std::string> TcpServer::processRequest(cons
     // If the request format is malformed, return a 400 response
     return {"", getHttpStatusInString(HttpStatus::BadRequest), getHttpContentTypeInString(HttpContentType::TEXT_PLAIN)};
 }
+
+
+/*  Serve a file below a static root.
+    Example: with { "prefix": "/static/", "directory": "public" }, /static/dummy.html serves public/dummy.html
+*/
+HttpResponse TcpServer::serveStaticFile(const ServerSnapshot& routes, const HttpRequestHead& head)
+{
+    const std::string& path = head.path;
+    for (const StaticRootConfig& staticRoot : routes.config.staticRoots)
+    {
+        if (path.compare(0, staticRoot.prefix.length(), staticRoot.prefix) != 0)
+            continue;
+
+        // Never leave the root directory
+        std::string relativePath = path.substr(staticRoot.prefix.length());
+        if (relativePath.empty() || relativePath.find("..") != std::string::npos)
+            continue;
+
+        std::string filePath = staticRoot.directory + "/" + relativePath;
+        struct stat fileStat;
+        if (stat(filePath.c_str(), &fileStat) != 0 || !S_ISREG(fileStat.st_mode))
+            continue;
+
+        RequestHandler handler = {HttpMethod::GET, [filePath] { return readFile(filePath); },
+                                  getContentTypeForFile(filePath), nullptr, filePath};
+        return runHandler(head, handler);
+    }
+
+    return {handleNotFound(), getHttpStatusInString(HttpStatus::NotFound), getHttpContentTypeInString(HttpContentType::TEXT_HTML)};
+}
+
+/*  Call the handler of a route.
+    File-backed and cacheable routes get an ETag and a Last-Modified date. A GET whose
+    If-None-Match / If-Modified-Since still match is answered with 304 Not Modified
+    before the handler runs, so the body is neither generated nor sent.
+*/
+HttpResponse TcpServer::runHandler(const HttpRequestHead& head, const RequestHandler& handler)
+{
+    const std::string& path = head.path;
+    Validators validators;
+    bool hasValidators = false;
+    if (!handler.filePath.empty())
+        hasValidators = validatorCache.getFileValidators(handler.filePath, validators);
+    else if (handler.cacheable)
+        hasValidators = validatorCache.getBodyValidators(path, validators);
+
+    if (hasValidators && handler.method == HttpMethod::GET &&
+        isNotModified(getHeaderValue(head, "If-None-Match"), getHeaderValue(head, "If-Modified-Since"), validators))
+    {
+        return {"", getHttpStatusInString(HttpStatus::NotModified), handler.responseType,
+                "ETag: " + validators.etag + "\r\nLast-Modified: " + validators.lastModified + "\r\n"};
+    }
+
+    std::string body = handler.handlerFunction();   // Call the handler function
+
+    if (handler.filePath.empty() && handler.cacheable)
+    {
+        validatorCache.storeBodyValidators(path, body, validators);
+        hasValidators = true;
+    }
+
+    HttpResponse response = {body, getHttpStatusInString(HttpStatus::OK), handler.responseType};  // Return the response body, status, and content type
+    if (hasValidators)
+        response.headers = "ETag: " + validators.etag + "\r\nLast-Modified: " + validators.lastModified + "\r\n";
+    return response;
+}
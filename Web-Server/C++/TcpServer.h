@@ -1,5 +1,6 @@
 #include <iostream>
 #include <cstring>
+#include <strings.h>
 #include <sstream>
 #include <sys/types.h>
 #include <sys/socket.h>
@@ -12,11 +13,18 @@
 #include <mutex>
 #include <condition_variable>
 #include <functional>
+#include <algorithm>
 #include <unordered_map>
+#include <memory>
+#include <atomic>
+#include <csignal>
+#include <poll.h>
 
-// Define constants
-const int CHUNK_SIZE = 1024;    // Size of the buffer for reading client data
-const int BACKLOG = 10;         // Number of connections to queue
+#include "BodyParser.h"
+#include "WebSocket.h"
+#include "ConditionalRequest.h"
+#include "ServerConfig.h"
+#include "RequestParser.h"
 
 enum class HttpMethod {
     GET,
@@ -32,10 +40,13 @@ enum class HttpMethod {
 HttpMethod getHttpMethod(const std::string& method);
 
 enum class HttpStatus {
+    SwitchingProtocols,
     OK,
+    NotModified,
     NotFound,
     MethodNotAllowed,
-    BadRequest
+    BadRequest,
+    PayloadTooLarge
 };
 
 std::string getHttpStatusInString(HttpStatus status);
@@ -49,38 +60,82 @@ enum class HttpContentType {
 
 std::string getHttpContentTypeInString(HttpContentType type);
 
+std::string getContentTypeForFile(const std::string& filePath);
+
 // Struct to hold request handler information
 struct RequestHandler {
     HttpMethod method;                              // Method that this handler responds to
     std::function<std::string()> handlerFunction;   // Function to handle requests for this URL
     std::string responseType;                       // Content type of the response
+    PartCallback partHandler = nullptr;             // Receives form fields and files as they are uploaded (optional)
+    std::string filePath = "";                      // File served by the handler, its validators are derived from it (optional)
+    bool cacheable = false;                         // Whether the handler always returns the same body, so 304s can skip it
+};
+
+// Struct to hold a response before it is written to the socket
+struct HttpResponse {
+    std::string body;                               // Response body
+    std::string status;                             // Status line, e.g. "200 OK"
+    std::string contentType;                        // Content type of the body
+    std::string headers = "";                       // Additional header lines, each ending with \r\n
+};
+
+// Immutable routes and limits. Requests keep the snapshot they started with,
+// a reload publishes a new one without waiting for them.
+struct ServerSnapshot {
+    ServerConfig config;                                                // Limits, listeners and static roots
+    std::unordered_map <std::string, RequestHandler> requestHandlers;   // To hold request handlers
+    std::unordered_map <std::string, WebSocketHandler> webSocketRoutes; // To hold the routes accepting WebSocket upgrades
 };
 
 // TcpServer class definition
 class TcpServer {
 public:
-    TcpServer(int port, int threadPoolSize = 4);    // Constructor to initialize the server
+    TcpServer(int port, int threadPoolSize = 4);    // Constructor to initialize the server with the default routes
+    TcpServer(const std::string& configFile);       // Constructor to initialize the server from a configuration file
     ~TcpServer();                                   // Destructor to clean up resources
     int listenServer();                             // To start listening for client connections
+    bool reloadConfig();                            // To apply the configuration file again (also done on SIGHUP)
 
 private:
-    int serverSocket;                           // File descriptor for the server socket
+    std::vector<int> serverSockets;             // File descriptors of the listening sockets
     int clientSocket;                           // File descriptor for the client socket
-    struct sockaddr_in serverAddr;              // Structure to hold the server address information
     struct sockaddr_in clientAddr;              // Structure to hold the client address information
     socklen_t addrLen;                          // Length of the address structures
-    int portNumber;                             // Port number on which the server listens
-    std::unordered_map <std::string, RequestHandler> requestHandlers; // To hold request handlers
+    std::string configFile;                     // Configuration file, empty when started with a port
+    std::shared_ptr<const ServerSnapshot> snapshot; // Current routes and limits, swapped atomically
+    std::unordered_map <std::string, RequestHandler> builtinHandlers;           // Handlers routes can refer to by name
+    std::unordered_map <std::string, WebSocketHandler> builtinWebSocketHandlers; // WebSocket handlers routes can refer to by name
+    WebSocketHub webSocketHub;                  // Serves the upgraded connections
+    ValidatorCache validatorCache;              // ETags and Last-Modified dates of files and cacheable routes
+    std::thread reloadThread;                   // Waits for SIGHUP
+    std::atomic<bool> stopping;                 // Set by the destructor
 
     std::vector<std::thread> threadPool;        // Thread pool
-    std::queue<int> clientQueue;                // Queue to hold client sockets
+    int workerCount;                            // Number of workers that should be running
+    std::queue<int> clientQueue;                // Queue to hold client sockets (-1 asks a worker to exit)
     std::mutex queueMutex;                      // Mutex to synchronize access to the client queue
     std::condition_variable queueCondVar;       // Condition variable to notify worker threads
+    std::vector<std::thread::id> exitedWorkers; // Workers that took a -1 and are exiting, not joined yet
+    std::condition_variable workerExitCondVar;  // Condition variable to notify a shrinking pool
 
-    int startServer();                          // To set up the server socket
+    void initialize(const ServerConfig& config);    // To start the listeners, the hub and the workers
+    int startServer(int port);                  // To set up a server socket
     void closeSocket(int socket);               // To close the socket
+    std::shared_ptr<const ServerSnapshot> currentSnapshot();    // To get the snapshot for a new request
+    std::shared_ptr<const ServerSnapshot> buildSnapshot(const ServerConfig& config, std::string& error);
+    void resizeThreadPool(int threads);         // To start workers, or stop and join them
+    void reloadOnSignal();                      // Method run by the reload thread
     int handleClient(int clientSocket);         // To handle incoming client requests
-    std::tuple<std::string, std::string, std::string> processRequest(const std::string& request);   // Method to process requests
-    void setupHandlers();                       // Function to initialize the request handlers
+    int sendResponse(int clientSocket, const HttpResponse& response);  // To write a response
+    int writeToSocket(int clientSocket, const std::string& data);  // To write the whole buffer to the socket
+    bool isWebSocketUpgrade(const ServerSnapshot& routes, const HttpRequestHead& head);  // To check for an upgrade to a WebSocket route
+    int upgradeToWebSocket(const ServerSnapshot& routes, int clientSocket, const HttpRequestHead& head, const std::string& initialData);   // To complete the handshake and hand over the socket
+    std::unique_ptr<FormParser> createUploadParser(const ServerSnapshot& routes, const HttpRequestHead& head);    // To get a streaming parser for upload routes
+    bool streamRequestBody(int clientSocket, FormParser& parser, const std::string& bodyStart, size_t contentLength, const ServerConfig& config);   // To feed the body to the parser
+    HttpResponse processRequest(const ServerSnapshot& routes, const HttpRequestHead& head);    // Method to process requests
+    HttpResponse serveStaticFile(const ServerSnapshot& routes, const HttpRequestHead& head); // To serve files below the static roots
+    HttpResponse runHandler(const HttpRequestHead& head, const RequestHandler& handler); // To call a handler, answering 304 when possible
+    void setupHandlers();                       // Function to initialize the built-in handlers
     void workerThread();                        // Method run by each worker thread
 };
@@ -0,0 +1,775 @@
+#include <iostream>
+#include <cstring>
+#include <ctime>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include "WebSocket.h"
+
+// GUID appended to the client key by the opening handshake (RFC 6455 section 1.3)
+const char* const WEBSOCKET_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+
+
+// Compute the SHA-1 digest of a message (used only by the opening handshake)
+static void sha1(const std::string& message, uint8_t digest[20])
+{
+    uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+
+    // Pad the message to a multiple of 64 bytes, ending with its length in bits
+    std::string data = message;
+    data += (char)0x80;
+    while (data.length() % 64 != 56)
+        data += (char)0x00;
+    uint64_t bitLength = (uint64_t)message.length() * 8;
+    for (int i = 7; i >= 0; i--)
+        data += (char)(bitLength >> (i * 8));
+
+    for (size_t block = 0; block < data.length(); block += 64)
+    {
+        uint32_t w[80];
+        for (int i = 0; i < 16; i++)
+        {
+            const uint8_t* p = (const uint8_t*)data.data() + block + i * 4;
+            w[i] = (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+        }
+        for (int i = 16; i < 80; i++)
+        {
+            uint32_t x = w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16];
+            w[i] = (x << 1) | (x >> 31);
+        }
+
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; i++)
+        {
+            uint32_t f, k;
+            if (i < 20)      { f = (b & c) | (~b & d);           k = 0x5A827999; }
+            else if (i < 40) { f = b ^ c ^ d;                    k = 0x6ED9EBA1; }
+            else if (i < 60) { f = (b & c) | (b & d) | (c & d);  k = 0x8F1BBCDC; }
+            else             { f = b ^ c ^ d;                    k = 0xCA62C1D6; }
+
+            uint32_t temp = ((a << 5) | (a >> 27)) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = (b << 30) | (b >> 2);
+            b = a;
+            a = temp;
+        }
+        h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+    }
+
+    for (int i = 0; i < 5; i++)
+    {
+        digest[i * 4]     = h[i] >> 24;
+        digest[i * 4 + 1] = h[i] >> 16;
+        digest[i * 4 + 2] = h[i] >> 8;
+        digest[i * 4 + 3] = h[i];
+    }
+}
+
+
+
+// Encode bytes in base64
+static std::string base64Encode(const uint8_t* data, size_t length)
+{
+    static const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string encoded;
+
+    for (size_t i = 0; i < length; i += 3)
+    {
+        uint32_t group = (uint32_t)data[i] << 16;
+        if (i + 1 < length) group |= (uint32_t)data[i + 1] << 8;
+        if (i + 2 < length) group |= data[i + 2];
+
+        encoded += alphabet[(group >> 18) & 0x3F];
+        encoded += alphabet[(group >> 12) & 0x3F];
+        encoded += i + 1 < length ? alphabet[(group >> 6) & 0x3F] : '=';
+        encoded += i + 2 < length ? alphabet[group & 0x3F] : '=';
+    }
+    return encoded;
+}
+
+
+
+// Sec-WebSocket-Accept is base64(SHA-1(key + GUID))
+std::string computeWebSocketAccept(const std::string& key)
+{
+    uint8_t digest[20];
+    sha1(key + WEBSOCKET_GUID, digest);
+    return base64Encode(digest, sizeof(digest));
+}
+
+
+
+// Unmask eight bytes at a time, the mask bytes are already rotated to the start of data
+static void unmaskScalar(char* data, size_t length, const uint8_t mask[4])
+{
+    uint8_t pattern[8];
+    for (int i = 0; i < 8; i++)
+        pattern[i] = mask[i % 4];
+
+    uint64_t mask64;
+    memcpy(&mask64, pattern, sizeof(mask64));
+
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8)
+    {
+        uint64_t word;
+        memcpy(&word, data + i, sizeof(word));
+        word ^= mask64;
+        memcpy(data + i, &word, sizeof(word));
+    }
+    for (; i < length; i++)
+        data[i] ^= mask[i % 4];
+}
+
+
+
+#if defined(__x86_64__)
+// Unmask sixteen bytes at a time (SSE2 is part of the x86-64 baseline)
+static void unmaskSse2(char* data, size_t length, const uint8_t mask[4])
+{
+    int32_t mask32;
+    memcpy(&mask32, mask, sizeof(mask32));
+    __m128i maskVector = _mm_set1_epi32(mask32);
+
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16)
+    {
+        __m128i block = _mm_loadu_si128((const __m128i*)(data + i));
+        _mm_storeu_si128((__m128i*)(data + i), _mm_xor_si128(block, maskVector));
+    }
+    // i is a multiple of 4, so the mask stays in phase
+    unmaskScalar(data + i, length - i, mask);
+}
+
+
+
+// Unmask thirty-two bytes at a time
+__attribute__((target("avx2")))
+static void unmaskAvx2(char* data, size_t length, const uint8_t mask[4])
+{
+    int32_t mask32;
+    memcpy(&mask32, mask, sizeof(mask32));
+    __m256i maskVector = _mm256_set1_epi32(mask32);
+
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32)
+    {
+        __m256i block = _mm256_loadu_si256((const __m256i*)(data + i));
+        _mm256_storeu_si256((__m256i*)(data + i), _mm256_xor_si256(block, maskVector));
+    }
+    unmaskScalar(data + i, length - i, mask);
+}
+#endif
+
+
+
+typedef void (*UnmaskFunction)(char* data, size_t length, const uint8_t mask[4]);
+
+// Pick the widest implementation supported by the CPU
+static UnmaskFunction selectUnmaskFunction()
+{
+#if defined(__x86_64__)
+    if (__builtin_cpu_supports("avx2"))
+        return unmaskAvx2;
+    return unmaskSse2;
+#else
+    return unmaskScalar;
+#endif
+}
+
+
+
+// Unmask a payload in place, the byte at payload position p is XORed with mask[p % 4]
+void unmaskPayload(char* data, size_t length, const uint8_t mask[4], size_t offset)
+{
+    static const UnmaskFunction unmask = selectUnmaskFunction();
+
+    uint8_t rotated[4];
+    for (int i = 0; i < 4; i++)
+        rotated[i] = mask[(offset + i) % 4];
+
+    unmask(data, length, rotated);
+}
+
+
+
+/*  Parse a client frame.
+    Basic Structure of a WebSocket frame:
+        byte 0      : FIN | RSV1-3 | opcode
+        byte 1      : MASK | payload length (7 bits, 126 = 16 bit length follows, 127 = 64 bit length follows)
+        [2 or 8]    : extended payload length
+        [4]         : masking key (always present in client frames)
+        payload
+*/
+long parseWebSocketFrame(char* buffer, size_t length, WebSocketFrame& frame)
+{
+    if (length < 2)
+        return 0;
+
+    const uint8_t* bytes = (const uint8_t*)buffer;
+    bool fin = bytes[0] & 0x80;
+    uint8_t opcode = bytes[0] & 0x0F;
+    bool masked = bytes[1] & 0x80;
+    uint64_t payloadLength = bytes[1] & 0x7F;
+
+    // No extensions are negotiated, and clients must mask
+    if ((bytes[0] & 0x70) != 0 || !masked)
+        return -1;
+
+    if (opcode > 0x2 && (opcode < 0x8 || opcode > 0xA))
+        return -1;
+
+    // Control frames are never fragmented and carry at most 125 bytes
+    if (opcode >= 0x8 && (!fin || payloadLength > 125))
+        return -1;
+
+    size_t headerLength = 2;
+    if (payloadLength == 126)
+    {
+        if (length < 4)
+            return 0;
+        payloadLength = (uint64_t)bytes[2] << 8 | bytes[3];
+        headerLength = 4;
+    }
+    else if (payloadLength == 127)
+    {
+        if (length < 10)
+            return 0;
+        payloadLength = 0;
+        for (int i = 2; i < 10; i++)
+            payloadLength = payloadLength << 8 | bytes[i];
+        headerLength = 10;
+    }
+
+    if (payloadLength > WEBSOCKET_MAX_MESSAGE_SIZE)
+        return -1;
+
+    const uint8_t* mask = bytes + headerLength;
+    headerLength += 4;
+
+    if (length < headerLength + payloadLength)
+        return 0;
+
+    unmaskPayload(buffer + headerLength, payloadLength, mask);
+
+    frame.fin = fin;
+    frame.opcode = (WebSocketOpcode)opcode;
+    frame.payload = buffer + headerLength;
+    frame.payloadLength = payloadLength;
+    return headerLength + payloadLength;
+}
+
+
+
+// Encode an unmasked frame as sent by the server
+std::string encodeWebSocketFrame(WebSocketOpcode opcode, const char* payload, size_t length)
+{
+    std::string frame;
+    frame.reserve(length + 10);
+    frame += (char)(0x80 | (uint8_t)opcode);
+
+    if (length < 126)
+        frame += (char)length;
+    else if (length <= 0xFFFF)
+    {
+        frame += (char)126;
+        frame += (char)(length >> 8);
+        frame += (char)length;
+    }
+    else
+    {
+        frame += (char)127;
+        for (int i = 7; i >= 0; i--)
+            frame += (char)((uint64_t)length >> (i * 8));
+    }
+
+    frame.append(payload, length);
+    return frame;
+}
+
+
+
+// Constructor implementation
+WebSocketHub::WebSocketHub()
+    : epollFd(-1), wakeFd(-1), running(false), nextConnectionId(1)
+{
+    pingFrame = std::make_shared<const std::string>(encodeWebSocketFrame(WebSocketOpcode::PING, "", 0));
+}
+
+
+
+// Destructor stops the event loop and closes every connection
+WebSocketHub::~WebSocketHub()
+{
+    if (running)
+    {
+        running = false;
+        uint64_t one = 1;
+        if (write(wakeFd, &one, sizeof(one)) < 0)
+            std::cerr << "Failure in waking up the WebSocket event loop\n";
+    }
+
+    if (eventThread.joinable())
+        eventThread.join();
+
+    for (auto& entry : connections)
+        close(entry.second->socket);
+
+    if (epollFd >= 0)
+        close(epollFd);
+    if (wakeFd >= 0)
+        close(wakeFd);
+}
+
+
+
+// Create the epoll instance and start the event loop thread
+bool WebSocketHub::start()
+{
+    epollFd = epoll_create1(0);
+    wakeFd = eventfd(0, EFD_NONBLOCK);
+    if (epollFd < 0 || wakeFd < 0)
+    {
+        std::cerr << "Failure in creating the WebSocket event loop\n";
+        return false;
+    }
+
+    // Connection ids start at 1, id 0 stands for the wake-up descriptor
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.u64 = 0;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event);
+
+    running = true;
+    eventThread = std::thread(&WebSocketHub::eventLoop, this);
+    return true;
+}
+
+
+
+/*  Take over an upgraded socket. The handshake response is queued before any
+    frame, after the connection subscribed to its route, so no broadcast sent
+    once the client sees it is missed. initialData holds bytes read after the
+    handshake request. Returns 0 if the connection could not be added, its
+    socket is then closed.
+*/
+uint64_t WebSocketHub::addConnection(int socket, const std::string& route, WebSocketHandler handler,
+                                     const std::string& handshake, const std::string& initialData)
+{
+    fcntl(socket, F_SETFL, fcntl(socket, F_GETFL, 0) | O_NONBLOCK);
+
+    std::vector<ReceivedMessage> received;
+    uint64_t connectionId;
+    {
+        std::lock_guard<std::mutex> lock(hubMutex);
+        connectionId = nextConnectionId++;
+
+        std::unique_ptr<Connection> connection(new Connection());
+        connection->id = connectionId;
+        connection->socket = socket;
+        connection->route = route;
+        connection->handler = std::move(handler);
+        connection->readBuffer = initialData;
+        connection->messageOpcode = WebSocketOpcode::CONTINUATION;
+        connection->writeOffset = 0;
+        connection->waitingForWritable = false;
+        connection->lastActivity = time(nullptr);
+
+        struct epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.u64 = connectionId;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, socket, &event) < 0)
+        {
+            std::cerr << "Failure in registering the WebSocket connection\n";
+            close(socket);
+            return 0;
+        }
+
+        Connection& added = *connection;
+        connections[connectionId] = std::move(connection);
+        subscribers[route].insert(connectionId);
+
+        if (!handshake.empty() && !enqueueFrame(added, std::make_shared<const std::string>(handshake)))
+        {
+            std::cerr << "Failure in sending the WebSocket handshake\n";
+            closeConnection(connectionId);
+            return 0;
+        }
+
+        if (!processFrames(added, received))
+            closeConnection(connectionId);
+    }
+
+    for (auto& message : received)
+        message.handler(*this, message.connectionId, message.message);
+
+    return connectionId;
+}
+
+
+
+// Send a text message to a single connection
+bool WebSocketHub::send(uint64_t connectionId, const std::string& message)
+{
+    SharedFrame frame = std::make_shared<const std::string>(
+        encodeWebSocketFrame(WebSocketOpcode::TEXT, message.data(), message.length()));
+
+    std::lock_guard<std::mutex> lock(hubMutex);
+    auto it = connections.find(connectionId);
+    if (it == connections.end())
+        return false;
+
+    if (!enqueueFrame(*it->second, frame))
+    {
+        closeConnection(connectionId);
+        return false;
+    }
+    return true;
+}
+
+
+
+// Encode the message once and queue the same buffer on every subscriber of the route
+size_t WebSocketHub::broadcast(const std::string& route, const std::string& message)
+{
+    SharedFrame frame = std::make_shared<const std::string>(
+        encodeWebSocketFrame(WebSocketOpcode::TEXT, message.data(), message.length()));
+
+    std::lock_guard<std::mutex> lock(hubMutex);
+    auto it = subscribers.find(route);
+    if (it == subscribers.end())
+        return 0;
+
+    size_t delivered = 0;
+    std::vector<uint64_t> failed;
+    for (uint64_t connectionId : it->second)
+    {
+        if (enqueueFrame(*connections[connectionId], frame))
+            delivered++;
+        else
+            failed.push_back(connectionId);
+    }
+
+    for (uint64_t connectionId : failed)
+        closeConnection(connectionId);
+
+    return delivered;
+}
+
+
+
+// Route a connection subscribed to
+std::string WebSocketHub::getRoute(uint64_t connectionId)
+{
+    std::lock_guard<std::mutex> lock(hubMutex);
+    auto it = connections.find(connectionId);
+    return it == connections.end() ? "" : it->second->route;
+}
+
+
+
+// Number of open connections
+size_t WebSocketHub::connectionCount()
+{
+    std::lock_guard<std::mutex> lock(hubMutex);
+    return connections.size();
+}
+
+
+
+// Wait for socket events, handlers are called without holding the hub lock
+void WebSocketHub::eventLoop()
+{
+    const int MAX_EVENTS = 64;
+    struct epoll_event events[MAX_EVENTS];
+    time_t lastPing = time(nullptr);
+
+    while (running)
+    {
+        int count = epoll_wait(epollFd, events, MAX_EVENTS, 1000);
+        if (count < 0 && errno != EINTR)
+        {
+            std::cerr << "Failure in waiting for WebSocket events\n";
+            break;
+        }
+
+        std::vector<ReceivedMessage> received;
+        {
+            std::lock_guard<std::mutex> lock(hubMutex);
+
+            for (int i = 0; i < count; i++)
+            {
+                uint64_t connectionId = events[i].data.u64;
+                if (connectionId == 0)
+                {
+                    // Woken up by the destructor, running is now false
+                    uint64_t value;
+                    ssize_t ignored = read(wakeFd, &value, sizeof(value));
+                    (void)ignored;
+                    continue;
+                }
+
+                auto it = connections.find(connectionId);
+                if (it == connections.end())
+                    continue;
+
+                Connection& connection = *it->second;
+                bool open = true;
+                if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+                    open = readFromConnection(connection, received);
+                if (open && (events[i].events & EPOLLOUT))
+                    open = flushConnection(connection);
+
+                if (!open)
+                    closeConnection(connectionId);
+            }
+
+            time_t now = time(nullptr);
+            if (now - lastPing >= WEBSOCKET_PING_INTERVAL)
+            {
+                sendPings(now);
+                lastPing = now;
+            }
+        }
+
+        for (auto& message : received)
+            message.handler(*this, message.connectionId, message.message);
+    }
+}
+
+
+
+// Read everything available on the socket and process the complete frames
+bool WebSocketHub::readFromConnection(Connection& connection, std::vector<ReceivedMessage>& received)
+{
+    char buffer[16 * 1024];
+    while (true)
+    {
+        ssize_t bytesRead = recv(connection.socket, buffer, sizeof(buffer), MSG_DONTWAIT);
+        if (bytesRead > 0)
+        {
+            connection.readBuffer.append(buffer, bytesRead);
+            connection.lastActivity = time(nullptr);
+
+            // A frame never needs more than its payload and a 14 byte header
+            if (connection.readBuffer.length() > WEBSOCKET_MAX_MESSAGE_SIZE + 14)
+                return false;
+            continue;
+        }
+
+        if (bytesRead == 0)
+            return false;   // Client closed the connection
+        if (errno == EINTR)
+            continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+            break;
+        return false;
+    }
+
+    return processFrames(connection, received);
+}
+
+
+
+// Handle the complete frames in the read buffer
+bool WebSocketHub::processFrames(Connection& connection, std::vector<ReceivedMessage>& received)
+{
+    size_t offset = 0;
+    bool open = true;
+
+    while (open)
+    {
+        WebSocketFrame frame;
+        long frameLength = parseWebSocketFrame(&connection.readBuffer[offset], connection.readBuffer.length() - offset, frame);
+        if (frameLength < 0)
+            return false;
+        if (frameLength == 0)
+            break;
+        offset += frameLength;
+
+        bool messageInProgress = connection.messageOpcode != WebSocketOpcode::CONTINUATION;
+        switch (frame.opcode)
+        {
+            case WebSocketOpcode::TEXT:
+            case WebSocketOpcode::BINARY:
+                if (messageInProgress)
+                    return false;
+
+                if (frame.fin)
+                    received.push_back({connection.id, connection.handler, std::string(frame.payload, frame.payloadLength)});
+                else
+                {
+                    connection.message.assign(frame.payload, frame.payloadLength);
+                    connection.messageOpcode = frame.opcode;
+                }
+                break;
+
+            case WebSocketOpcode::CONTINUATION:
+                if (!messageInProgress || connection.message.length() + frame.payloadLength > WEBSOCKET_MAX_MESSAGE_SIZE)
+                    return false;
+
+                connection.message.append(frame.payload, frame.payloadLength);
+                if (frame.fin)
+                {
+                    received.push_back({connection.id, connection.handler, std::move(connection.message)});
+                    connection.message.clear();
+                    connection.messageOpcode = WebSocketOpcode::CONTINUATION;
+                }
+                break;
+
+            case WebSocketOpcode::PING:
+                open = enqueueFrame(connection, std::make_shared<const std::string>(
+                    encodeWebSocketFrame(WebSocketOpcode::PONG, frame.payload, frame.payloadLength)));
+                break;
+
+            case WebSocketOpcode::PONG:
+                break;  // Receiving it already refreshed lastActivity
+
+            case WebSocketOpcode::CLOSE:
+                // Echo the status code back before closing (best effort)
+                enqueueFrame(connection, std::make_shared<const std::string>(
+                    encodeWebSocketFrame(WebSocketOpcode::CLOSE, frame.payload, std::min(frame.payloadLength, (size_t)2))));
+                return false;
+        }
+    }
+
+    connection.readBuffer.erase(0, offset);
+    return open;
+}
+
+
+
+// Queue a frame and try to send it right away
+bool WebSocketHub::enqueueFrame(Connection& connection, const SharedFrame& frame)
+{
+    if (connection.writeQueue.size() >= WEBSOCKET_MAX_QUEUED_FRAMES)
+        return false;
+
+    connection.writeQueue.push_back(frame);
+
+    // If the socket is full, the event loop flushes once it becomes writable
+    if (connection.waitingForWritable)
+        return true;
+    return flushConnection(connection);
+}
+
+
+
+// Write queued frames with a single gathered write, waiting for EPOLLOUT if the socket is full
+bool WebSocketHub::flushConnection(Connection& connection)
+{
+    const int MAX_IOVECS = 16;
+
+    while (!connection.writeQueue.empty())
+    {
+        struct iovec iov[MAX_IOVECS];
+        int iovCount = 0;
+        for (auto it = connection.writeQueue.begin(); it != connection.writeQueue.end() && iovCount < MAX_IOVECS; ++it)
+        {
+            size_t skip = iovCount == 0 ? connection.writeOffset : 0;
+            iov[iovCount].iov_base = (void*)((*it)->data() + skip);
+            iov[iovCount].iov_len = (*it)->length() - skip;
+            iovCount++;
+        }
+
+        struct msghdr header = {};
+        header.msg_iov = iov;
+        header.msg_iovlen = iovCount;
+
+        ssize_t sent = sendmsg(connection.socket, &header, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                return false;
+
+            if (!connection.waitingForWritable)
+            {
+                struct epoll_event event = {};
+                event.events = EPOLLIN | EPOLLOUT;
+                event.data.u64 = connection.id;
+                epoll_ctl(epollFd, EPOLL_CTL_MOD, connection.socket, &event);
+                connection.waitingForWritable = true;
+            }
+            return true;
+        }
+
+        // Drop the frames that were sent completely
+        size_t remaining = sent;
+        while (remaining > 0)
+        {
+            size_t left = connection.writeQueue.front()->length() - connection.writeOffset;
+            if (remaining < left)
+            {
+                connection.writeOffset += remaining;
+                break;
+            }
+            remaining -= left;
+            connection.writeQueue.pop_front();
+            connection.writeOffset = 0;
+        }
+    }
+
+    if (connection.waitingForWritable)
+    {
+        struct epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.u64 = connection.id;
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, connection.socket, &event);
+        connection.waitingForWritable = false;
+    }
+    return true;
+}
+
+
+
+// Remove a connection and close its socket (hub lock held)
+void WebSocketHub::closeConnection(uint64_t connectionId)
+{
+    auto it = connections.find(connectionId);
+    if (it == connections.end())
+        return;
+
+    Connection& connection = *it->second;
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, connection.socket, nullptr);
+    close(connection.socket);
+
+    auto route = subscribers.find(connection.route);
+    if (route != subscribers.end())
+    {
+        route->second.erase(connectionId);
+        if (route->second.empty())
+            subscribers.erase(route);
+    }
+
+    connections.erase(it);
+}
+
+
+
+// Ping every connection, dropping those silent for two intervals (hub lock held)
+void WebSocketHub::sendPings(time_t now)
+{
+    std::vector<uint64_t> stale;
+    for (auto& entry : connections)
+    {
+        Connection& connection = *entry.second;
+        if (now - connection.lastActivity > 2 * WEBSOCKET_PING_INTERVAL || !enqueueFrame(connection, pingFrame))
+            stale.push_back(entry.first);
+    }
+
+    for (uint64_t connectionId : stale)
+        closeConnection(connectionId);
+}
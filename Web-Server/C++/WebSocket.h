@@ -0,0 +1,107 @@
+// WebSocket (RFC 6455) framing and the hub that serves upgraded connections
+#include <string>
+#include <memory>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include <cstdint>
+
+const size_t WEBSOCKET_MAX_MESSAGE_SIZE = 1024 * 1024;     // Larger messages close the connection
+const size_t WEBSOCKET_MAX_QUEUED_FRAMES = 1024;           // Slow subscribers are dropped beyond this
+const int WEBSOCKET_PING_INTERVAL = 30;                     // Seconds between keep-alive pings
+
+enum class WebSocketOpcode : uint8_t {
+    CONTINUATION = 0x0,
+    TEXT = 0x1,
+    BINARY = 0x2,
+    CLOSE = 0x8,
+    PING = 0x9,
+    PONG = 0xA
+};
+
+// A decoded frame, the payload points into the connection's read buffer
+struct WebSocketFrame {
+    bool fin;
+    WebSocketOpcode opcode;
+    const char* payload;
+    size_t payloadLength;
+};
+
+class WebSocketHub;
+
+// Called for every complete text or binary message received on a route
+using WebSocketHandler = std::function<void(WebSocketHub& hub, uint64_t connectionId, const std::string& message)>;
+
+// Compute the Sec-WebSocket-Accept value for a Sec-WebSocket-Key
+std::string computeWebSocketAccept(const std::string& key);
+
+// Unmask a payload in place, offset is the position of data within the payload
+void unmaskPayload(char* data, size_t length, const uint8_t mask[4], size_t offset = 0);
+
+// Parse a client frame at the start of buffer, unmasking it in place.
+// Returns the size of the frame, 0 if incomplete, -1 if malformed.
+long parseWebSocketFrame(char* buffer, size_t length, WebSocketFrame& frame);
+
+// Encode an unmasked server frame
+std::string encodeWebSocketFrame(WebSocketOpcode opcode, const char* payload, size_t length);
+
+// Serves all upgraded connections from a single epoll thread. Outgoing frames are
+// shared buffers, so a broadcast encodes a message once for every subscriber.
+class WebSocketHub {
+public:
+    WebSocketHub();
+    ~WebSocketHub();
+    bool start();                                                   // Start the event loop thread
+    uint64_t addConnection(int socket, const std::string& route, WebSocketHandler handler,
+                           const std::string& handshake, const std::string& initialData);
+    bool send(uint64_t connectionId, const std::string& message);   // Send a text message to one connection
+    size_t broadcast(const std::string& route, const std::string& message); // Send a text message to every subscriber of a route
+    std::string getRoute(uint64_t connectionId);                   // Route of a connection, empty once it is closed
+    size_t connectionCount();
+
+private:
+    typedef std::shared_ptr<const std::string> SharedFrame;
+
+    struct Connection {
+        uint64_t id;
+        int socket;
+        std::string route;
+        WebSocketHandler handler;
+        std::string readBuffer;                 // Bytes received but not yet parsed
+        std::string message;                    // Fragments of the message being received
+        WebSocketOpcode messageOpcode;
+        std::deque<SharedFrame> writeQueue;     // Frames waiting to be sent
+        size_t writeOffset;                     // Bytes of the first queued frame already sent
+        bool waitingForWritable;                // Whether EPOLLOUT is enabled
+        time_t lastActivity;                    // Last time anything was received
+    };
+
+    struct ReceivedMessage {
+        uint64_t connectionId;
+        WebSocketHandler handler;
+        std::string message;
+    };
+
+    int epollFd;
+    int wakeFd;                                 // eventfd used to stop the event loop
+    std::atomic<bool> running;
+    std::thread eventThread;
+    std::mutex hubMutex;                        // Guards the connections and subscribers
+    uint64_t nextConnectionId;
+    std::unordered_map<uint64_t, std::unique_ptr<Connection>> connections;
+    std::unordered_map<std::string, std::unordered_set<uint64_t>> subscribers;
+    SharedFrame pingFrame;
+
+    void eventLoop();
+    bool readFromConnection(Connection& connection, std::vector<ReceivedMessage>& received);
+    bool processFrames(Connection& connection, std::vector<ReceivedMessage>& received);
+    bool enqueueFrame(Connection& connection, const SharedFrame& frame);
+    bool flushConnection(Connection& connection);
+    void closeConnection(uint64_t connectionId);
+    void sendPings(time_t now);
+};
@@ -0,0 +1,97 @@
+/*  Broadcast benchmark: fans messages out to thousands of WebSocket subscribers.
+    Subscribers are socket pairs handed directly to the hub, so the numbers measure
+    the broadcast path (one encoded frame shared by every connection) and not the handshake.
+
+    Build (from the Web-Server/C++ directory):
+        g++ -O2 -std=c++17 WebSocket.cpp benchmarks/broadcastBenchmark.cpp -o broadcast_benchmark -pthread
+
+    Run:
+        ./broadcast_benchmark [subscribers] [messages] [messageSize]
+*/
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+
+#include "../WebSocket.h"
+
+
+
+int main(int argc, char* argv[])
+{
+    size_t subscriberCount = argc > 1 ? std::stoul(argv[1]) : 2000;
+    size_t messageCount = argc > 2 ? std::stoul(argv[2]) : 1000;
+    size_t messageSize = argc > 3 ? std::stoul(argv[3]) : 256;
+
+    WebSocketHub hub;
+    if (!hub.start())
+        return 1;
+
+    // The client ends are drained by a single reader thread
+    int epollFd = epoll_create1(0);
+    std::vector<int> clientSockets;
+    for (size_t i = 0; i < subscriberCount; i++)
+    {
+        int sockets[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) < 0)
+        {
+            std::cerr << "Failure in creating subscriber " << i << "\n";
+            return 1;
+        }
+
+        hub.addConnection(sockets[0], "/bench", [](WebSocketHub&, uint64_t, const std::string&) {}, "", "");
+        clientSockets.push_back(sockets[1]);
+
+        struct epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.fd = sockets[1];
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, sockets[1], &event);
+    }
+
+    std::string message(messageSize, 'x');
+    size_t frameSize = encodeWebSocketFrame(WebSocketOpcode::TEXT, message.data(), message.length()).length();
+    size_t expectedBytes = frameSize * messageCount * subscriberCount;
+
+    std::thread reader([&] {
+        char buffer[64 * 1024];
+        struct epoll_event events[256];
+        size_t receivedBytes = 0;
+        while (receivedBytes < expectedBytes)
+        {
+            int count = epoll_wait(epollFd, events, 256, 1000);
+            if (count == 0 && hub.connectionCount() < subscriberCount)
+                break;  // Subscribers were dropped, nothing more will arrive
+            for (int i = 0; i < count; i++)
+            {
+                ssize_t bytesRead = read(events[i].data.fd, buffer, sizeof(buffer));
+                if (bytesRead > 0)
+                    receivedBytes += bytesRead;
+            }
+        }
+    });
+
+    auto start = std::chrono::steady_clock::now();
+
+    size_t deliveries = 0;
+    for (size_t i = 0; i < messageCount; i++)
+        deliveries += hub.broadcast("/bench", message);
+
+    reader.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "*************************************\n";
+    std::cout << "Subscribers         : " << subscriberCount << "\n";
+    std::cout << "Messages            : " << messageCount << " x " << messageSize << " bytes\n";
+    std::cout << "Deliveries          : " << deliveries << "\n";
+    std::cout << "Dropped subscribers : " << subscriberCount - hub.connectionCount() << "\n";
+    std::cout << "Time                : " << seconds << " s\n";
+    std::cout << "Deliveries/s        : " << deliveries / seconds << "\n";
+    std::cout << "Throughput          : " << deliveries * frameSize / seconds / (1024 * 1024) << " MB/s\n";
+
+    for (int clientSocket : clientSockets)
+        close(clientSocket);
+    close(epollFd);
+    return 0;
+}
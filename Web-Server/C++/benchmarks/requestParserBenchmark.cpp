@@ -0,0 +1,176 @@
+/*  Request parser benchmark: throughput of parseRequestHead() against the parsing the
+    server did per request before it (request line read with istringstream in three
+    places, Content-Length found by a case-sensitive search and std::stoul, headers
+    looked up by scanning the raw request). Exits with 1 when the strict parser is
+    slower than minRatio times the old parsing, so runtests.bash catches regressions.
+
+    Build (from the Web-Server/C++ directory):
+        g++ -O2 -std=c++17 RequestParser.cpp benchmarks/requestParserBenchmark.cpp -o request_parser_benchmark
+
+    Run:
+        ./request_parser_benchmark [iterations] [minRatio]
+*/
+#include <iostream>
+#include <sstream>
+#include <chrono>
+#include <cstring>
+#include <strings.h>
+#include <vector>
+
+#include "../RequestParser.h"
+
+// Typical heads: a browser page load, a conditional API call and a JSON post
+const char* const REQUESTS[] = {
+    "GET /index.html HTTP/1.1\r\n"
+    "Host: localhost:8080\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:128.0) Gecko/20100101 Firefox/128.0\r\n"
+    "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
+    "Accept-Language: en-US,en;q=0.5\r\n"
+    "Accept-Encoding: gzip, deflate, br\r\n"
+    "Connection: keep-alive\r\n"
+    "Upgrade-Insecure-Requests: 1\r\n"
+    "If-Modified-Since: Sun, 06 Nov 1994 08:49:37 GMT\r\n"
+    "If-None-Match: \"f74225ba3e069cbb-28f\"\r\n"
+    "\r\n",
+
+    "GET /api/greet HTTP/1.1\r\n"
+    "Host: localhost:8080\r\n"
+    "User-Agent: curl/8.5.0\r\n"
+    "Accept: */*\r\n"
+    "If-None-Match: \"91da0e1dfb36d881-29\"\r\n"
+    "\r\n",
+
+    "POST /api/post HTTP/1.1\r\n"
+    "Host: localhost:8080\r\n"
+    "User-Agent: curl/8.5.0\r\n"
+    "Accept: */*\r\n"
+    "Content-Type: application/json\r\n"
+    "Content-Length: 16\r\n"
+    "\r\n"
+    "{\"key\": \"value\"}"
+};
+
+
+
+// Header lookup on the raw request, as the server did before RequestParser
+static std::string legacyGetHeaderValue(const std::string& request, const std::string& name)
+{
+    size_t lineStart = request.find("\r\n");
+    size_t headEnd = request.find("\r\n\r\n");
+    while (lineStart != std::string::npos && lineStart < headEnd)
+    {
+        lineStart += 2;
+        size_t lineEnd = request.find("\r\n", lineStart);
+        if (lineEnd == std::string::npos)
+            lineEnd = request.length();
+
+        size_t colon = request.find(':', lineStart);
+        if (colon < lineEnd && colon - lineStart == name.length() &&
+            strncasecmp(request.c_str() + lineStart, name.c_str(), name.length()) == 0)
+        {
+            size_t valueStart = request.find_first_not_of(" \t", colon + 1);
+            size_t valueEnd   = request.find_last_not_of(" \t", lineEnd - 1);
+            if (valueStart == std::string::npos || valueStart >= lineEnd)
+                return "";
+            return request.substr(valueStart, valueEnd - valueStart + 1);
+        }
+
+        lineStart = lineEnd;
+    }
+    return "";
+}
+
+
+
+// The parsing work the server did per request before RequestParser
+static size_t legacyParse(const std::string& request)
+{
+    size_t result = request.find("\r\n\r\n") + 4;
+
+    size_t contentLengthPos = request.find("Content-Length: ");
+    if (contentLengthPos != std::string::npos)
+    {
+        size_t valueStart = contentLengthPos + 16;
+        size_t valueEnd   = request.find("\r\n", valueStart);
+        result += std::stoul(request.substr(valueStart, valueEnd - valueStart));
+    }
+
+    // createUploadParser, isWebSocketUpgrade and processRequest each read the request line
+    size_t requestLineLength = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        std::istringstream requestLineStream(request.substr(0, request.find("\r\n")));
+        std::string method, path, httpVersion;
+        requestLineStream >> method >> path >> httpVersion;
+        requestLineLength = method.length() + path.length();
+    }
+    result += requestLineLength;
+
+    result += legacyGetHeaderValue(request, "If-None-Match").length();
+    result += legacyGetHeaderValue(request, "If-Modified-Since").length();
+    return result;
+}
+
+
+
+// The same work with the strict parser
+static size_t strictParse(const std::string& request)
+{
+    HttpRequestHead head;
+    if (parseRequestHead(request.data(), request.length(), head) != RequestHeadStatus::Complete)
+        return 0;
+
+    size_t result = head.length + head.contentLength + head.method.length() + head.path.length();
+    result += getHeaderValue(head, "If-None-Match").length();
+    result += getHeaderValue(head, "If-Modified-Since").length();
+    return result;
+}
+
+
+
+// Parse every request iterations times, returns MB/s
+template <typename Parse>
+static double measureThroughput(const std::vector<std::string>& requests, long iterations, Parse parse, size_t& checksum)
+{
+    size_t bytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < iterations; i++)
+    {
+        for (const std::string& request : requests)
+        {
+            checksum += parse(request);
+            bytes += request.length();
+        }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return bytes / elapsed.count() / (1024 * 1024);
+}
+
+
+
+int main(int argc, char* argv[])
+{
+    long iterations = argc > 1 ? std::atol(argv[1]) : 200000;
+    double minRatio = argc > 2 ? std::atof(argv[2]) : 1.0;
+
+    std::vector<std::string> requests(std::begin(REQUESTS), std::end(REQUESTS));
+
+    size_t legacyChecksum = 0, strictChecksum = 0;
+    double legacy = measureThroughput(requests, iterations, legacyParse, legacyChecksum);
+    double strict = measureThroughput(requests, iterations, strictParse, strictChecksum);
+
+    std::cout << "Previous parsing : " << legacy << " MB/s\n";
+    std::cout << "parseRequestHead : " << strict << " MB/s (" << strict / legacy << "x)\n";
+
+    if (legacyChecksum != strictChecksum)
+    {
+        std::cout << "The parsers returned different results\n";
+        return 1;
+    }
+    if (strict < legacy * minRatio)
+    {
+        std::cout << "Throughput regression: below " << minRatio << "x the previous parsing\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,151 @@
+/*  Upload benchmark: streams a multipart/form-data body of several GB to /api/upload
+    on an in-process server and samples the resident set size while doing so.
+    With the streaming body parser the RSS stays flat regardless of the upload size.
+
+    Build (from the Web-Server/C++ directory):
+        g++ -O2 -std=c++17 BodyParser.cpp WebSocket.cpp ConditionalRequest.cpp ServerConfig.cpp RequestParser.cpp ../../JSON-Parser/C++/common.cpp ../../JSON-Parser/C++/numbers.cpp ../../JSON-Parser/C++/structural.cpp ../../JSON-Parser/C++/utf8.cpp ../../JSON-Parser/C++/lexer.cpp ../../JSON-Parser/C++/parser.cpp ../../JSON-Parser/C++/unescape.cpp ../../JSON-Parser/C++/arena.cpp ../../JSON-Parser/C++/dom.cpp ../../JSON-Parser/C++/keyTable.cpp routes.cpp TcpServer.cpp benchmarks/uploadBenchmark.cpp -o upload_benchmark -pthread
+
+    Run:
+        ./upload_benchmark <port_number> [sizeInMB]
+*/
+#include <chrono>
+#include <fstream>
+
+#include "../TcpServer.h"
+
+const size_t MB = 1024 * 1024;
+const size_t SEND_CHUNK_SIZE = 64 * 1024;
+
+
+
+// Current resident set size in MB, read from /proc
+double currentRssInMB()
+{
+    std::ifstream statm("/proc/self/statm");
+    long pages = 0, residentPages = 0;
+    statm >> pages >> residentPages;
+    return residentPages * (double)sysconf(_SC_PAGESIZE) / MB;
+}
+
+
+
+// Send a whole buffer over the socket
+bool sendAll(int socket, const char* data, size_t length)
+{
+    while (length > 0)
+    {
+        ssize_t sent = write(socket, data, length);
+        if (sent <= 0)
+            return false;
+        data += sent;
+        length -= sent;
+    }
+    return true;
+}
+
+
+
+// Connect to the local server, retrying while it starts up
+int connectToServer(int portNumber)
+{
+    struct sockaddr_in addr;
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(portNumber);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    for (int attempt = 0; attempt < 50; attempt++)
+    {
+        int clientSocket = socket(AF_INET, SOCK_STREAM, 0);
+        if (connect(clientSocket, (struct sockaddr *)&addr, sizeof(addr)) == 0)
+            return clientSocket;
+        close(clientSocket);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    return -1;
+}
+
+
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2 || argc > 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " <port_number> [sizeInMB]\n";
+        return 1;
+    }
+
+    int portNumber = std::stoi(argv[1]);
+    size_t uploadSize = (argc == 3 ? std::stoul(argv[2]) : 2048) * MB;
+
+    // The server runs for the lifetime of the process
+    std::thread([portNumber] {
+        TcpServer server(portNumber);
+        server.listenServer();
+    }).detach();
+
+    int clientSocket = connectToServer(portNumber);
+    if (clientSocket < 0)
+    {
+        std::cerr << "Failure in connecting to the server\n";
+        return 1;
+    }
+
+    const std::string boundary = "----BenchmarkBoundary7MA4YWxkTrZu0gW";
+    const std::string partHead = "--" + boundary + "\r\n"
+                                 "Content-Disposition: form-data; name=\"file\"; filename=\"upload.bin\"\r\n"
+                                 "Content-Type: application/octet-stream\r\n\r\n";
+    const std::string partTail = "\r\n--" + boundary + "--\r\n";
+
+    std::ostringstream head;
+    head << "POST /api/upload HTTP/1.1\r\n"
+         << "Host: localhost\r\n"
+         << "Content-Type: multipart/form-data; boundary=" << boundary << "\r\n"
+         << "Content-Length: " << partHead.length() + uploadSize + partTail.length() << "\r\n"
+         << "\r\n"
+         << partHead;
+
+    std::vector<char> chunk(SEND_CHUNK_SIZE);
+    for (size_t i = 0; i < chunk.size(); i++)
+        chunk[i] = 'a' + i % 26;
+
+    double startRss = currentRssInMB();
+    double peakRss = startRss;
+    auto start = std::chrono::steady_clock::now();
+
+    bool sent = sendAll(clientSocket, head.str().data(), head.str().length());
+    for (size_t total = 0; sent && total < uploadSize; )
+    {
+        size_t length = std::min(chunk.size(), uploadSize - total);
+        sent = sendAll(clientSocket, chunk.data(), length);
+        total += length;
+
+        if (total % (256 * MB) == 0)
+        {
+            double rss = currentRssInMB();
+            peakRss = std::max(peakRss, rss);
+            std::cout << "Sent " << total / MB << " MB, RSS: " << rss << " MB\n";
+        }
+    }
+    sent = sent && sendAll(clientSocket, partTail.data(), partTail.length());
+
+    // Wait for the response
+    char response[1024] = {0};
+    ssize_t bytesRead = read(clientSocket, response, sizeof(response) - 1);
+    close(clientSocket);
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (!sent || bytesRead <= 0 || strncmp(response, "HTTP/1.1 200", 12) != 0)
+    {
+        std::cerr << "Upload failed\n";
+        return 1;
+    }
+
+    std::cout << "*************************************\n";
+    std::cout << "Upload size     : " << uploadSize / MB << " MB\n";
+    std::cout << "Throughput      : " << uploadSize / MB / seconds << " MB/s\n";
+    std::cout << "RSS at start    : " << startRss << " MB\n";
+    std::cout << "Peak RSS sampled: " << peakRss << " MB\n";
+
+    return 0;
+}
@@ -3,13 +3,17 @@
 // Function to process command-line arguments
 int processArguments(int argc, char *argv[])
 {
-    // Check if the user provided at least one argument (the port number)
-    if (argc < 2)
+    // Check if the user provided at least one argument (the port number or --config <file>)
+    if (argc < 2 || (std::string(argv[1]) == "--config" && argc < 3))
     {
-        std::cerr << "Usage: " << argv[0] << " <port_number>\n";
+        std::cerr << "Usage: " << argv[0] << " <port_number> | --config <config_file>\n";
         return 1;
     }
 
+    // The configuration file is checked when it is loaded
+    if (std::string(argv[1]) == "--config")
+        return 0;
+
     // Access the port number argument
     std::string portStr = argv[1];
 
@@ -36,6 +40,13 @@ int main(int argc, char* argv[])
     if (processArguments(argc, argv) != 0)
         return 1; // Exit if arguments are invalid
 
+    // Create an instance of TcpServer configured from the file
+    if (std::string(argv[1]) == "--config")
+    {
+        TcpServer server = TcpServer(std::string(argv[2]));
+        return server.listenServer();
+    }
+
     // Retrieve the port number argument
     std::string portStr = argv[1];
     int portNumber = std::stoi(portStr); // Convert to integer
@@ -0,0 +1,157 @@
+/*  Fuzz target for the request path: the head parser, checked against the reference
+    parser, and the form body parsers the rest of the input is streamed to.
+
+    With libFuzzer (clang):
+        clang++ -std=c++17 -g -O1 -fsanitize=fuzzer,address,undefined RequestParser.cpp BodyParser.cpp tests/ReferenceParser.cpp fuzz/requestFuzzer.cpp -o request_fuzzer
+        ./request_fuzzer -dict=fuzz/http.dict fuzz_corpus tests
+
+    Without libFuzzer, REPLAY_MAIN builds a driver that replays files and, with -runs=N,
+    tries N random mutations of them:
+        g++ -std=c++17 -g -O1 -fsanitize=address,undefined -DREPLAY_MAIN RequestParser.cpp BodyParser.cpp tests/ReferenceParser.cpp fuzz/requestFuzzer.cpp -o request_fuzzer
+        ./request_fuzzer -runs=200000 tests
+*/
+#include <cstdint>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <string>
+
+#include "../RequestParser.h"
+#include "../BodyParser.h"
+
+// Declared by tests/ReferenceParser.h, which includes RequestParser.h again
+bool compareWithReference(const char* data, size_t length, std::string& difference);
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    const char* input = (const char*)data;
+
+    std::string difference;
+    if (!compareWithReference(input, size, difference))
+    {
+        fprintf(stderr, "Request parsers disagree: %s\n", difference.c_str());
+        abort();
+    }
+
+    HttpRequestHead head;
+    if (parseRequestHead(input, size, head) != RequestHeadStatus::Complete)
+        return 0;
+
+    // Stream the body in small chunks, so part boundaries and escapes get split
+    std::unique_ptr<FormParser> formParser = createFormParser(getHeaderValue(head, "Content-Type"),
+                                                              [](const FormPart&) {}, 1 << 20);
+    if (!formParser)
+        return 0;
+
+    size_t pos = head.length;
+    size_t chunk = 1 + size % 7;
+    while (pos < size)
+    {
+        size_t length = std::min(chunk, size - pos);
+        if (!formParser->feed(input + pos, length))
+            return 0;
+        pos += length;
+    }
+    formParser->finish();
+    return 0;
+}
+
+#ifdef REPLAY_MAIN
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <random>
+#include <vector>
+#include <dirent.h>
+
+// Fragments inserted by the mutator, the same as in fuzz/http.dict
+static const char* const FRAGMENTS[] = {
+    "\r\n", "\r\n\r\n", "\n", "\r", ":", " ", "\t", "\0", "HTTP/1.1", "Content-Length: ", "content-length:",
+    "Transfer-Encoding: chunked", "18446744073709551616", "99999999999999999999", "-1", ",",
+    "Content-Type: multipart/form-data; boundary=", "Content-Type: application/x-www-form-urlencoded", "--", "%", "%2", "\xff"
+};
+
+// Read a file, or every file of a directory
+static void readInputs(const std::string& path, std::vector<std::string>& inputs)
+{
+    if (DIR* directory = opendir(path.c_str()))
+    {
+        while (struct dirent* entry = readdir(directory))
+        {
+            if (entry->d_name[0] != '.')
+                readInputs(path + "/" + entry->d_name, inputs);
+        }
+        closedir(directory);
+        return;
+    }
+
+    std::ifstream inputFile(path, std::ios::binary);
+    std::stringstream content;
+    content << inputFile.rdbuf();
+    inputs.push_back(content.str());
+}
+
+// Apply one random edit: flip, insert, erase or duplicate bytes, or insert a fragment
+static void mutate(std::string& input, std::mt19937& random)
+{
+    size_t pos = input.empty() ? 0 : random() % (input.length() + 1);
+    switch (random() % 5)
+    {
+        case 0:
+            if (pos < input.length())
+                input[pos] ^= 1 << (random() % 8);
+            break;
+        case 1:
+            input.insert(pos, 1, (char)random());
+            break;
+        case 2:
+            input.erase(pos, random() % 8);
+            break;
+        case 3:
+            if (pos < input.length())
+                input.insert(pos, input.substr(pos, random() % 16));
+            break;
+        default:
+        {
+            const char* fragment = FRAGMENTS[random() % (sizeof(FRAGMENTS) / sizeof(FRAGMENTS[0]))];
+            input.insert(pos, fragment, *fragment == '\0' ? 1 : strlen(fragment));
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    long runs = 0;
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg.compare(0, 6, "-runs=") == 0)
+            runs = std::atol(arg.c_str() + 6);
+        else
+            readInputs(arg, inputs);
+    }
+
+    if (inputs.empty())
+    {
+        std::cerr << "Usage: " << argv[0] << " [-runs=N] <file_or_directory>...\n";
+        return 1;
+    }
+
+    for (const std::string& input : inputs)
+        LLVMFuzzerTestOneInput((const uint8_t*)input.data(), input.length());
+
+    std::mt19937 random(12345);
+    for (long run = 0; run < runs; run++)
+    {
+        std::string input = inputs[random() % inputs.size()];
+        for (int edits = 1 + random() % 4; edits > 0; edits--)
+            mutate(input, random);
+        LLVMFuzzerTestOneInput((const uint8_t*)input.data(), input.length());
+    }
+
+    std::cout << "Replayed " << inputs.size() << " inputs and " << runs << " mutations\n";
+    return 0;
+}
+#endif
@@ -2,6 +2,10 @@
 #include <fstream>
 #include <streambuf>
 
+#include "BodyParser.h"
+#include "WebSocket.h"
+#include "routes.h"
+
 std::string readFile(const std::string& filename)
 {
     std::ifstream file(filename);
@@ -13,12 +17,12 @@ std::string readFile(const std::string& filename)
 
 std::string handleHomePage()
 {
-    return readFile("public/index.html");
+    return readFile(HOME_PAGE_FILE);
 }
 
 std::string handleDummyPage()
 {
-    return readFile("public/dummy.html");
+    return readFile(DUMMY_PAGE_FILE);
 }
 
 std::string handleNotFound()
@@ -35,3 +39,33 @@ std::string handlePostRequest()
 {
     return R"({"message": "POST request received!", "status": "success"})";
 }
+
+
+std::string handleUploadRequest()
+{
+    return R"({"message": "Upload received!", "status": "success"})";
+}
+
+// Called for every uploaded field and file as soon as it is complete
+void handleUploadPart(const FormPart& part)
+{
+    if (part.fileName.empty())
+        std::cout << "Field: " << part.name << ", Size: " << part.size << "\n";
+    else
+        std::cout << "File: " << part.name << ", FileName: " << part.fileName << ", ContentType: "
+                  << part.contentType << ", Size: " << part.size << "\n";
+}
+
+// Send a WebSocket message back to its sender
+void handleEchoMessage(WebSocketHub& hub, uint64_t connectionId, const std::string& message)
+{
+    hub.send(connectionId, message);
+}
+
+// Relay a WebSocket message to every client connected to the same chat route
+void handleChatMessage(WebSocketHub& hub, uint64_t connectionId, const std::string& message)
+{
+    std::string route = hub.getRoute(connectionId);
+    if (!route.empty())
+        hub.broadcast(route, message);
+}
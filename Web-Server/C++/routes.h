@@ -1,8 +1,23 @@
 // Handle routes
 #include <iostream>
 
+#include <cstdint>
+
+struct FormPart;
+class WebSocketHub;
+
+// Files served by the page handlers
+const std::string HOME_PAGE_FILE = "public/index.html";
+const std::string DUMMY_PAGE_FILE = "public/dummy.html";
+
+std::string readFile(const std::string& filename);
 std::string handleHomePage();
 std::string handleDummyPage();
 std::string handleNotFound();
 std::string handleGreetRequest();
 std::string handlePostRequest();
+
+std::string handleUploadRequest();
+void handleUploadPart(const FormPart& part);
+void handleEchoMessage(WebSocketHub& hub, uint64_t connectionId, const std::string& message);
+void handleChatMessage(WebSocketHub& hub, uint64_t connectionId, const std::string& message);
@@ -0,0 +1,72 @@
+#!/bin/bash
+
+# Check if the 'request_parser_test' executable exists
+if [ ! -x ./request_parser_test ]; then
+  echo "Error: 'request_parser_test' executable not found or not executable."
+  exit 1
+fi
+
+# Specify the folder containing the requests
+folder="./tests/"
+
+# Check if the folder exists
+if [ ! -d "$folder" ]; then
+  echo "Error: Folder '$folder' does not exist."
+  exit 1
+fi
+
+# Initialize counters for VALID REQUEST and INVALID REQUEST
+total_cases=0
+correct_result=0
+incorrect_result=0
+
+
+# Loop through all requests in the folder and execute 'request_parser_test' for each file
+for filename in "$folder"/*.http; do
+  if [ -f "$filename" ]; then
+    echo "Processing file: $filename"
+    output=$(./request_parser_test "$filename")
+    echo $output
+    ((total_cases++))
+    if [ "$output" == "VALID REQUEST" ] && [[ "$filename" == *pass* ]]; then
+      ((correct_result++))
+    elif [ "$output" == "INVALID REQUEST" ] && [[ "$filename" == *fail* ]]; then
+      ((correct_result++))
+    fi
+  fi
+done
+
+((incorrect_result = total_cases - correct_result))
+
+# Replay the requests and random mutations of them through the fuzz target
+fuzz_result="skipped"
+if [ -x ./request_fuzzer ]; then
+  if ./request_fuzzer -runs=100000 "$folder" > /dev/null; then
+    fuzz_result="passed"
+  else
+    fuzz_result="FAILED"
+  fi
+fi
+
+# Check that the strict parser is not slower than the parsing it replaced
+throughput_result="skipped"
+if [ -x ./request_parser_benchmark ]; then
+  ./request_parser_benchmark
+  if [ $? -eq 0 ]; then
+    throughput_result="passed"
+  else
+    throughput_result="FAILED"
+  fi
+fi
+
+# Print the counts
+echo "*************************************"
+echo "Number of test cases        : $total_cases"
+echo "Number of test cases passed : $correct_result"
+echo "Number of test cases failed : $incorrect_result"
+echo "Fuzz replay                 : $fuzz_result"
+echo "Throughput check            : $throughput_result"
+
+if [ $incorrect_result -ne 0 ] || [ "$fuzz_result" == "FAILED" ] || [ "$throughput_result" == "FAILED" ]; then
+  exit 1
+fi
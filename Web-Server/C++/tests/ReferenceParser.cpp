@@ -0,0 +1,182 @@
+#include <cctype>
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+
+#include "ReferenceParser.h"
+
+
+
+static bool isTokenChar(char c)
+{
+    return std::isalnum((unsigned char)c) || (c != '\0' && strchr("!#$%&'*+-.^_`|~", c) != nullptr);
+}
+
+
+
+static bool isToken(const std::string& str)
+{
+    if (str.empty())
+        return false;
+    for (char c : str)
+    {
+        if (!isTokenChar(c))
+            return false;
+    }
+    return true;
+}
+
+
+
+static std::string toLower(std::string str)
+{
+    for (char& c : str)
+        c = std::tolower((unsigned char)c);
+    return str;
+}
+
+
+
+/*  Reference parser.
+    Splits the head on CRLF, then checks each line against the RFC 9110 / 9112 rules
+    with the string functions of the standard library.
+*/
+RequestHeadStatus parseReferenceRequestHead(const std::string& request, HttpRequestHead& head)
+{
+    size_t headEnd = request.find("\r\n\r\n");
+    if (headEnd == std::string::npos)
+        return RequestHeadStatus::Incomplete;
+
+    std::vector<std::string> lines;
+    size_t lineStart = 0;
+    while (lineStart < headEnd + 2)
+    {
+        size_t lineEnd = request.find("\r\n", lineStart);
+        lines.push_back(request.substr(lineStart, lineEnd - lineStart));
+        lineStart = lineEnd + 2;
+    }
+
+    // Request line
+    const std::string& requestLine = lines[0];
+    size_t firstSpace = requestLine.find(' ');
+    if (firstSpace == std::string::npos)
+        return RequestHeadStatus::Invalid;
+    size_t secondSpace = requestLine.find(' ', firstSpace + 1);
+    if (secondSpace == std::string::npos)
+        return RequestHeadStatus::Invalid;
+
+    std::string method  = requestLine.substr(0, firstSpace);
+    std::string path    = requestLine.substr(firstSpace + 1, secondSpace - firstSpace - 1);
+    std::string version = requestLine.substr(secondSpace + 1);
+
+    if (!isToken(method) || path.empty())
+        return RequestHeadStatus::Invalid;
+    for (char c : path)
+    {
+        if ((unsigned char)c <= 0x20 || (unsigned char)c >= 0x7F)
+            return RequestHeadStatus::Invalid;
+    }
+    if (version.length() != 8 || version.compare(0, 5, "HTTP/") != 0 ||
+        !std::isdigit((unsigned char)version[5]) || version[6] != '.' || !std::isdigit((unsigned char)version[7]))
+        return RequestHeadStatus::Invalid;
+
+    head.method = method;
+    head.path = path;
+    head.httpVersion = version;
+    head.headers.clear();
+    head.contentLength = 0;
+
+    // Header fields
+    bool hasContentLength = false;
+    for (size_t i = 1; i < lines.size(); i++)
+    {
+        const std::string& line = lines[i];
+        size_t colon = line.find(':');
+        if (colon == std::string::npos || !isToken(line.substr(0, colon)))
+            return RequestHeadStatus::Invalid;
+
+        std::string value = line.substr(colon + 1);
+        for (char c : value)
+        {
+            unsigned char byte = c;
+            if ((byte < 0x20 && byte != '\t') || byte == 0x7F)
+                return RequestHeadStatus::Invalid;
+        }
+
+        size_t valueStart = value.find_first_not_of(" \t");
+        size_t valueEnd = value.find_last_not_of(" \t");
+        value = valueStart == std::string::npos ? "" : value.substr(valueStart, valueEnd - valueStart + 1);
+
+        std::string name = line.substr(0, colon);
+        if (toLower(name) == "content-length")
+        {
+            if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos)
+                return RequestHeadStatus::Invalid;
+
+            size_t contentLength;
+            try {
+                unsigned long long parsed = std::stoull(value);
+                if (parsed > SIZE_MAX)
+                    return RequestHeadStatus::Invalid;
+                contentLength = parsed;
+            } catch (const std::out_of_range& e) {
+                return RequestHeadStatus::Invalid;
+            }
+
+            if (hasContentLength && contentLength != head.contentLength)
+                return RequestHeadStatus::Invalid;
+            head.contentLength = contentLength;
+            hasContentLength = true;
+        }
+        else if (toLower(name) == "transfer-encoding")
+            return RequestHeadStatus::Invalid;
+
+        head.headers.emplace_back(name, value);
+    }
+
+    head.length = headEnd + 4;
+    return RequestHeadStatus::Complete;
+}
+
+
+
+static const char* statusName(RequestHeadStatus status)
+{
+    switch (status)
+    {
+        case RequestHeadStatus::Complete: return "complete";
+        case RequestHeadStatus::Incomplete: return "incomplete";
+        default: return "invalid";
+    }
+}
+
+
+
+// Compare the results of both parsers field by field
+bool compareWithReference(const char* data, size_t length, std::string& difference)
+{
+    HttpRequestHead head, reference;
+    RequestHeadStatus status = parseRequestHead(data, length, head);
+    RequestHeadStatus referenceStatus = parseReferenceRequestHead(std::string(data, length), reference);
+
+    if (status != referenceStatus)
+        difference = std::string("status: ") + statusName(status) + " vs " + statusName(referenceStatus);
+    else if (status != RequestHeadStatus::Complete)
+        return true;
+    else if (head.method != reference.method)
+        difference = "method: " + head.method + " vs " + reference.method;
+    else if (head.path != reference.path)
+        difference = "path: " + head.path + " vs " + reference.path;
+    else if (head.httpVersion != reference.httpVersion)
+        difference = "version: " + head.httpVersion + " vs " + reference.httpVersion;
+    else if (head.headers != reference.headers)
+        difference = "headers";
+    else if (head.contentLength != reference.contentLength)
+        difference = "Content-Length: " + std::to_string(head.contentLength) + " vs " + std::to_string(reference.contentLength);
+    else if (head.length != reference.length)
+        difference = "head length: " + std::to_string(head.length) + " vs " + std::to_string(reference.length);
+    else
+        return true;
+
+    return false;
+}
@@ -0,0 +1,9 @@
+// Second, deliberately simple implementation of the request head grammar.
+// The differential tests and the fuzzer check that parseRequestHead() agrees with it.
+#include "../RequestParser.h"
+
+// Parse a request head by splitting it into lines
+RequestHeadStatus parseReferenceRequestHead(const std::string& request, HttpRequestHead& head);
+
+// Run both parsers on the same input, false with a description of the first difference
+bool compareWithReference(const char* data, size_t length, std::string& difference);
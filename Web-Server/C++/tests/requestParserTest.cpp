@@ -0,0 +1,48 @@
+/*  Differential test of the request head parser.
+    Parses a raw request with parseRequestHead() and with the reference parser and
+    prints VALID REQUEST or INVALID REQUEST, or MISMATCH when the parsers disagree.
+
+    Build (from Web-Server/C++):
+        g++ -std=c++17 RequestParser.cpp tests/ReferenceParser.cpp tests/requestParserTest.cpp -o request_parser_test
+*/
+#include <iostream>
+#include <fstream>
+#include <sstream>
+
+#include "ReferenceParser.h"
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <fileName>\n";
+        return 1;
+    }
+
+    std::ifstream inputFile(argv[1], std::ios::binary);
+    if (!inputFile.is_open())
+    {
+        std::cerr << "Error opening file: " << argv[1] << "\n";
+        return 1;
+    }
+
+    std::stringstream content;
+    content << inputFile.rdbuf();
+    std::string request = content.str();
+
+    std::string difference;
+    if (!compareWithReference(request.data(), request.length(), difference))
+    {
+        std::cout << "MISMATCH " << difference << "\n";
+        return 2;
+    }
+
+    // A file ending before the empty line is not a valid request either
+    HttpRequestHead head;
+    if (parseRequestHead(request.data(), request.length(), head) == RequestHeadStatus::Complete)
+        std::cout << "VALID REQUEST\n";
+    else
+        std::cout << "INVALID REQUEST\n";
+
+    return 0;
+}